@@ -0,0 +1,423 @@
+// PcapReader.h: TCP segments out of pcap and pcapng captures.
+// Captures are parsed in place (the caller maps the file) and every TCP segment is handed to a callback with its
+// payload pointing into the capture, so multi-GB captures are read without copying packets.
+//
+// Supported: pcap (micro/nanosecond, either byte order), pcapng (any number of sections and interfaces, if_tsresol,
+// if_tsoffset), Ethernet (+VLAN tags), Linux cooked (SLL, SLL2), BSD/Npcap loopback (NULL, LOOP) and raw IPv4/IPv6.
+// IP fragments are skipped, diver traffic never gets fragmented on loopback or a LAN.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const uint8_t TcpFin = 0x01;
+static const uint8_t TcpSyn = 0x02;
+static const uint8_t TcpRst = 0x04;
+
+struct TcpSegment {
+    uint64_t timestampNs;
+    uint8_t ipVersion;  // 4 or 6
+    // IPv4 addresses only use the first 4 bytes
+    uint8_t srcAddress[16];
+    uint8_t dstAddress[16];
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint32_t seq;
+    uint8_t flags;
+    const uint8_t* payload;
+    // Bytes of payload in the capture. Might be less than `wireLength` if the capture's snaplen cut the packet.
+    size_t payloadLength;
+    size_t wireLength;
+};
+
+struct CaptureStats {
+    uint64_t packets = 0;
+    uint64_t tcpSegments = 0;
+    uint64_t skippedPackets = 0;  // Not TCP, fragments or unknown link types
+    bool truncated = false;       // The file ended in the middle of a record
+};
+
+// ----------------
+// Byte Order
+// ----------------
+
+inline uint16_t ReadBe16(const uint8_t* p) { return (uint16_t)((p[0] << 8) | p[1]); }
+inline uint32_t ReadBe32(const uint8_t* p) { return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]; }
+
+inline uint16_t ReadU16(const uint8_t* p, bool swapped) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return swapped ? (uint16_t)((v >> 8) | (v << 8)) : v;
+}
+
+inline uint32_t ReadU32(const uint8_t* p, bool swapped) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return swapped ? __builtin_bswap32(v) : v;
+}
+
+inline uint64_t ReadU64(const uint8_t* p, bool swapped) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return swapped ? __builtin_bswap64(v) : v;
+}
+
+// ----------------
+// Packet Decoding
+// ----------------
+
+enum LinkType : uint32_t {
+    LinkNull = 0,
+    LinkEthernet = 1,
+    LinkRaw = 101,
+    LinkLoop = 108,
+    LinkLinuxSll = 113,
+    LinkIpv4 = 228,
+    LinkIpv6 = 229,
+    LinkLinuxSll2 = 276,
+};
+
+// Fills `segment` (except its timestamp) from an IP packet. Returns false if it isn't an unfragmented TCP segment.
+inline bool DecodeIpPacket(const uint8_t* p, size_t length, TcpSegment* segment) {
+    if (length < 1) {
+        return false;
+    }
+    const uint8_t* tcp;
+    size_t tcpLength;     // Captured
+    size_t tcpWireLength; // As the IP header says
+    uint8_t version = p[0] >> 4;
+    if (version == 4) {
+        if (length < 20) {
+            return false;
+        }
+        size_t headerLength = (size_t)(p[0] & 0x0F) * 4;
+        size_t totalLength = ReadBe16(p + 2);
+        uint16_t fragment = ReadBe16(p + 6);
+        // More fragments or a fragment's offset
+        if (p[9] != 6 || (fragment & 0x3FFF) != 0 || headerLength < 20 || totalLength < headerLength || length < headerLength) {
+            return false;
+        }
+        memset(segment->srcAddress, 0, sizeof(segment->srcAddress));
+        memset(segment->dstAddress, 0, sizeof(segment->dstAddress));
+        memcpy(segment->srcAddress, p + 12, 4);
+        memcpy(segment->dstAddress, p + 16, 4);
+        tcp = p + headerLength;
+        tcpWireLength = totalLength - headerLength;
+        // Ethernet pads short frames, those bytes aren't part of the packet
+        tcpLength = (length < totalLength ? length : totalLength) - headerLength;
+    } else if (version == 6) {
+        if (length < 40) {
+            return false;
+        }
+        size_t payloadLength = ReadBe16(p + 4);
+        uint8_t nextHeader = p[6];
+        memcpy(segment->srcAddress, p + 8, 16);
+        memcpy(segment->dstAddress, p + 24, 16);
+        size_t offset = 40;
+        size_t end = 40 + payloadLength;
+        // Hop-by-hop, routing and destination options. Fragments (44) and anything else aren't followed.
+        while (nextHeader == 0 || nextHeader == 43 || nextHeader == 60) {
+            if (offset + 8 > length) {
+                return false;
+            }
+            nextHeader = p[offset];
+            offset += ((size_t)p[offset + 1] + 1) * 8;
+        }
+        if (nextHeader != 6 || offset > end || offset > length) {
+            return false;
+        }
+        tcp = p + offset;
+        tcpWireLength = end - offset;
+        tcpLength = (length < end ? length : end) - offset;
+    } else {
+        return false;
+    }
+
+    if (tcpLength < 20) {
+        return false;
+    }
+    size_t dataOffset = (size_t)(tcp[12] >> 4) * 4;
+    if (dataOffset < 20 || dataOffset > tcpLength || dataOffset > tcpWireLength) {
+        return false;
+    }
+    segment->ipVersion = version;
+    segment->srcPort = ReadBe16(tcp);
+    segment->dstPort = ReadBe16(tcp + 2);
+    segment->seq = ReadBe32(tcp + 4);
+    segment->flags = tcp[13];
+    segment->payload = tcp + dataOffset;
+    segment->payloadLength = tcpLength - dataOffset;
+    segment->wireLength = tcpWireLength - dataOffset;
+    return true;
+}
+
+// Strips the link layer header. Returns false for link types and protocols other than IP.
+inline bool DecodeLinkLayer(uint32_t linkType, const uint8_t* p, size_t length, TcpSegment* segment) {
+    uint16_t etherType;
+    switch (linkType) {
+    case LinkEthernet: {
+        if (length < 14) {
+            return false;
+        }
+        size_t offset = 12;
+        etherType = ReadBe16(p + offset);
+        // 802.1Q and 802.1ad tags
+        while ((etherType == 0x8100 || etherType == 0x88A8) && offset + 6 <= length) {
+            offset += 4;
+            etherType = ReadBe16(p + offset);
+        }
+        offset += 2;
+        if (etherType != 0x0800 && etherType != 0x86DD) {
+            return false;
+        }
+        return DecodeIpPacket(p + offset, length - offset, segment);
+    }
+    case LinkNull:
+    case LinkLoop:
+        // The address family's value (and byte order) depends on the capturing OS, the IP header's version is enough
+        return length > 4 && DecodeIpPacket(p + 4, length - 4, segment);
+    case LinkRaw:
+    case LinkIpv4:
+    case LinkIpv6:
+        return DecodeIpPacket(p, length, segment);
+    case LinkLinuxSll:
+        if (length < 16) {
+            return false;
+        }
+        etherType = ReadBe16(p + 14);
+        return (etherType == 0x0800 || etherType == 0x86DD) && DecodeIpPacket(p + 16, length - 16, segment);
+    case LinkLinuxSll2:
+        if (length < 20) {
+            return false;
+        }
+        etherType = ReadBe16(p);
+        return (etherType == 0x0800 || etherType == 0x86DD) && DecodeIpPacket(p + 20, length - 20, segment);
+    default:
+        return false;
+    }
+}
+
+// ----------------
+// Capture Files
+// ----------------
+
+static const uint32_t PcapMagicMicros = 0xA1B2C3D4;
+static const uint32_t PcapMagicNanos = 0xA1B23C4D;
+static const uint32_t PcapngSectionHeader = 0x0A0D0D0A;
+static const uint32_t PcapngByteOrderMagic = 0x1A2B3C4D;
+
+namespace pcap_detail {
+
+template <typename OnSegment>
+inline void HandlePacket(uint32_t linkType, uint64_t timestampNs, const uint8_t* data, size_t length, CaptureStats* stats, OnSegment& onSegment) {
+    ++stats->packets;
+    TcpSegment segment;
+    if (!DecodeLinkLayer(linkType, data, length, &segment)) {
+        ++stats->skippedPackets;
+        return;
+    }
+    segment.timestampNs = timestampNs;
+    ++stats->tcpSegments;
+    onSegment(segment);
+}
+
+template <typename OnSegment>
+inline bool ReadPcap(const uint8_t* data, size_t size, CaptureStats* stats, OnSegment& onSegment, std::string* error) {
+    if (size < 24) {
+        *error = "pcap header is truncated";
+        return false;
+    }
+    uint32_t magic;
+    memcpy(&magic, data, sizeof(magic));
+    bool swapped = magic == __builtin_bswap32(PcapMagicMicros) || magic == __builtin_bswap32(PcapMagicNanos);
+    bool nanos = magic == PcapMagicNanos || magic == __builtin_bswap32(PcapMagicNanos);
+    // Upper bits hold the FCS length
+    uint32_t linkType = ReadU32(data + 20, swapped) & 0xFFFF;
+
+    size_t offset = 24;
+    while (offset + 16 <= size) {
+        uint64_t seconds = ReadU32(data + offset, swapped);
+        uint64_t fraction = ReadU32(data + offset + 4, swapped);
+        size_t capturedLength = ReadU32(data + offset + 8, swapped);
+        offset += 16;
+        if (capturedLength > size - offset) {
+            stats->truncated = true;
+            return true;
+        }
+        uint64_t timestampNs = seconds * 1000000000ull + (nanos ? fraction : fraction * 1000);
+        HandlePacket(linkType, timestampNs, data + offset, capturedLength, stats, onSegment);
+        offset += capturedLength;
+    }
+    stats->truncated = offset != size;
+    return true;
+}
+
+struct PcapngInterface {
+    uint32_t linkType;
+    // Timestamps are in units of 10^-exponent (or 2^-exponent) seconds
+    bool binaryResolution;
+    uint8_t exponent;
+    int64_t offsetSeconds;
+
+    uint64_t ToNanos(uint64_t units) const {
+        uint64_t ns;
+        if (binaryResolution) {
+            uint8_t shift = exponent > 63 ? 63 : exponent;
+            uint64_t mask = (1ull << shift) - 1;
+            ns = (units >> shift) * 1000000000ull + (uint64_t)(((unsigned __int128)(units & mask) * 1000000000ull) >> shift);
+        } else if (exponent <= 9) {
+            static const uint64_t Scale[] = { 1000000000ull, 100000000ull, 10000000ull, 1000000ull, 100000ull,
+                                              10000ull, 1000ull, 100ull, 10ull, 1ull };
+            ns = units * Scale[exponent];
+        } else {
+            uint64_t divisor = 1;
+            for (uint8_t i = 9; i < exponent && i < 28; ++i) {
+                divisor *= 10;
+            }
+            ns = units / divisor;
+        }
+        return ns + (uint64_t)(offsetSeconds * 1000000000ll);
+    }
+};
+
+inline void ReadInterfaceOptions(const uint8_t* p, size_t length, bool swapped, PcapngInterface* iface) {
+    size_t offset = 0;
+    while (offset + 4 <= length) {
+        uint16_t code = ReadU16(p + offset, swapped);
+        uint16_t optionLength = ReadU16(p + offset + 2, swapped);
+        offset += 4;
+        if (code == 0 || optionLength > length - offset) {
+            return;
+        }
+        if (code == 9 && optionLength >= 1) { // if_tsresol
+            iface->binaryResolution = (p[offset] & 0x80) != 0;
+            iface->exponent = p[offset] & 0x7F;
+        } else if (code == 14 && optionLength >= 8) { // if_tsoffset
+            iface->offsetSeconds = (int64_t)ReadU64(p + offset, swapped);
+        }
+        offset += (optionLength + 3) & ~3u;
+    }
+}
+
+template <typename OnSegment>
+inline bool ReadPcapng(const uint8_t* data, size_t size, CaptureStats* stats, OnSegment& onSegment, std::string* error) {
+    std::vector<PcapngInterface> interfaces;
+    bool swapped = false;
+    uint64_t lastTimestampNs = 0;
+    size_t offset = 0;
+    while (offset + 12 <= size) {
+        const uint8_t* block = data + offset;
+        // The section header's type reads the same in both byte orders
+        uint32_t type;
+        memcpy(&type, block, sizeof(type));
+        if (type == PcapngSectionHeader) {
+            // Byte order is per section
+            uint32_t byteOrder;
+            memcpy(&byteOrder, block + 8, sizeof(byteOrder));
+            if (byteOrder == PcapngByteOrderMagic) {
+                swapped = false;
+            } else if (byteOrder == __builtin_bswap32(PcapngByteOrderMagic)) {
+                swapped = true;
+            } else {
+                *error = "Bad pcapng byte order magic";
+                return false;
+            }
+            interfaces.clear();
+        }
+        type = ReadU32(block, swapped);
+        uint32_t blockLength = ReadU32(block + 4, swapped);
+        if (blockLength < 12 || blockLength % 4 != 0) {
+            *error = "Bad pcapng block length";
+            return false;
+        }
+        if (blockLength > size - offset) {
+            stats->truncated = true;
+            return true;
+        }
+        const uint8_t* body = block + 8;
+        size_t bodyLength = blockLength - 12;
+
+        switch (type) {
+        case 1: { // Interface Description
+            if (bodyLength < 8) {
+                break;
+            }
+            PcapngInterface iface = { ReadU16(body, swapped), false, 6, 0 };
+            ReadInterfaceOptions(body + 8, bodyLength - 8, swapped, &iface);
+            interfaces.push_back(iface);
+            break;
+        }
+        case 6: { // Enhanced Packet
+            if (bodyLength < 20) {
+                break;
+            }
+            uint32_t interfaceId = ReadU32(body, swapped);
+            uint64_t units = ((uint64_t)ReadU32(body + 4, swapped) << 32) | ReadU32(body + 8, swapped);
+            size_t capturedLength = ReadU32(body + 12, swapped);
+            if (interfaceId >= interfaces.size() || capturedLength > bodyLength - 20) {
+                ++stats->skippedPackets;
+                break;
+            }
+            lastTimestampNs = interfaces[interfaceId].ToNanos(units);
+            HandlePacket(interfaces[interfaceId].linkType, lastTimestampNs, body + 20, capturedLength, stats, onSegment);
+            break;
+        }
+        case 3: { // Simple Packet. No timestamp, the previous packet's one is the best guess.
+            if (bodyLength < 4 || interfaces.empty()) {
+                break;
+            }
+            size_t originalLength = ReadU32(body, swapped);
+            size_t capturedLength = originalLength < bodyLength - 4 ? originalLength : bodyLength - 4;
+            HandlePacket(interfaces[0].linkType, lastTimestampNs, body + 4, capturedLength, stats, onSegment);
+            break;
+        }
+        case 2: { // Packet (obsolete)
+            if (bodyLength < 20) {
+                break;
+            }
+            uint16_t interfaceId = ReadU16(body, swapped);
+            uint64_t units = ((uint64_t)ReadU32(body + 4, swapped) << 32) | ReadU32(body + 8, swapped);
+            size_t capturedLength = ReadU32(body + 12, swapped);
+            if (interfaceId >= interfaces.size() || capturedLength > bodyLength - 20) {
+                ++stats->skippedPackets;
+                break;
+            }
+            lastTimestampNs = interfaces[interfaceId].ToNanos(units);
+            HandlePacket(interfaces[interfaceId].linkType, lastTimestampNs, body + 20, capturedLength, stats, onSegment);
+            break;
+        }
+        default:
+            // Name resolution, statistics, custom blocks...
+            break;
+        }
+        offset += blockLength;
+    }
+    stats->truncated = offset != size;
+    return true;
+}
+
+} // namespace pcap_detail
+
+// Calls `onSegment(const TcpSegment&)` for every TCP segment of a pcap or pcapng capture, in file order.
+// Returns false (and sets `error`) if the data isn't a capture. A capture cut in the middle of a record still returns true.
+template <typename OnSegment>
+inline bool ReadCapture(const uint8_t* data, size_t size, CaptureStats* stats, OnSegment&& onSegment, std::string* error) {
+    if (size < 4) {
+        *error = "File is too short to be a capture";
+        return false;
+    }
+    uint32_t magic;
+    memcpy(&magic, data, sizeof(magic));
+    if (magic == PcapMagicMicros || magic == PcapMagicNanos ||
+        magic == __builtin_bswap32(PcapMagicMicros) || magic == __builtin_bswap32(PcapMagicNanos)) {
+        return pcap_detail::ReadPcap(data, size, stats, onSegment, error);
+    }
+    if (magic == PcapngSectionHeader) {
+        return pcap_detail::ReadPcapng(data, size, stats, onSegment, error);
+    }
+    *error = "Not a pcap or pcapng capture";
+    return false;
+}
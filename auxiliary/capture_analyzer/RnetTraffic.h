@@ -0,0 +1,776 @@
+// RnetTraffic.h: rNET sessions out of TCP segments.
+// Each TCP direction is reassembled and cut into SimpleHttp messages (request/status line, headers, Content-Length
+// body). Bodies are never copied, only counted, and headers are only buffered when a packet splits them.
+//
+// Requests are paired with the responses travelling the other way on the same connection by their `requestId`
+// (query parameter in requests, header in responses). Which side opened the connection doesn't matter: the diver
+// connects out to Lifeboat and still receives requests on that connection. Messages without an ID are paired in order.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "PcapReader.h"
+
+// Headers which don't end by then aren't SimpleHttp
+static const size_t MaxHeadersLength = 64 * 1024;
+// Out of order data kept (per direction) while waiting for a missing segment. Beyond that the missing bytes are skipped.
+static const size_t MaxOutOfOrderBytes = 16 * 1024 * 1024;
+
+struct RnetMessage {
+    bool isRequest;
+    int status;             // Responses only
+    std::string path;       // Requests only, without the query string
+    std::string requestId;  // Empty if the message has none
+    uint64_t firstByteNs;
+    uint64_t lastByteNs;
+    uint64_t headersLength;
+    uint64_t bodyLength;
+};
+
+// ----------------
+// Message Parsing
+// ----------------
+
+// Cuts a byte stream into SimpleHttp messages. After a gap (lost segments) it skips to the next request/status line.
+class SimpleHttpStreamParser {
+public:
+    // Calls `onMessage(const RnetMessage&)` for every message completed by `data`
+    template <typename OnMessage>
+    void Feed(const uint8_t* data, size_t length, uint64_t timestampNs, OnMessage&& onMessage) {
+        while (length > 0) {
+            if (m_state == State::Seeking) {
+                size_t consumed = Seek(data, length, timestampNs);
+                data += consumed;
+                length -= consumed;
+            } else if (m_state == State::Headers) {
+                size_t consumed = FeedHeaders(data, length, timestampNs, onMessage);
+                data += consumed;
+                length -= consumed;
+            } else {
+                size_t consumed = length < m_bodyRemaining ? length : (size_t)m_bodyRemaining;
+                m_bodyRemaining -= consumed;
+                m_message.lastByteNs = timestampNs;
+                data += consumed;
+                length -= consumed;
+                if (m_bodyRemaining == 0) {
+                    Complete(onMessage);
+                }
+            }
+        }
+    }
+
+    // Bytes of the stream were lost. The message in progress is dropped.
+    void Gap() {
+        if (m_state != State::Seeking || !m_tail.empty()) {
+            ++m_resyncs;
+        }
+        m_state = State::Seeking;
+        m_headers.clear();
+        m_tail.clear();
+    }
+
+    uint64_t Resyncs() const { return m_resyncs; }
+    uint64_t SkippedBytes() const { return m_skippedBytes; }
+    uint64_t Messages() const { return m_messages; }
+
+private:
+    enum class State {
+        Seeking,
+        Headers,
+        Body,
+    };
+
+    static const size_t MaxTokenLength = 9;
+
+    // Whether a request or status line starts at `p`. `available` might be shorter than the token, then it's a prefix match.
+    static bool MatchesStart(const uint8_t* p, size_t available, bool* complete) {
+        static const char* const Tokens[] = { "GET /", "POST /", "PUT /", "DELETE /", "HTTP/1.1 ", "HTTP/1.0 " };
+        for (const char* token : Tokens) {
+            size_t tokenLength = strlen(token);
+            size_t compared = available < tokenLength ? available : tokenLength;
+            if (memcmp(p, token, compared) == 0) {
+                *complete = compared == tokenLength;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Skips to the next message start and returns how many bytes it consumed. Starts split between two calls are kept in
+    // `m_tail`.
+    size_t Seek(const uint8_t* data, size_t length, uint64_t timestampNs) {
+        if (!m_tail.empty()) {
+            uint8_t joined[MaxTokenLength * 2];
+            size_t tailLength = m_tail.size();
+            size_t added = length < MaxTokenLength ? length : MaxTokenLength;
+            memcpy(joined, m_tail.data(), tailLength);
+            memcpy(joined + tailLength, data, added);
+            for (size_t i = 0; i < tailLength; ++i) {
+                bool complete;
+                if (!MatchesStart(joined + i, tailLength + added - i, &complete)) {
+                    continue;
+                }
+                m_skippedBytes += i;
+                if (!complete) {
+                    // Still a prefix, `data` is shorter than the token
+                    m_tail.assign(joined + i, joined + tailLength + added);
+                    return added;
+                }
+                // The message's first bytes are the end of the tail, the rest is fed as headers
+                StartMessage(m_tailTimestampNs);
+                m_headers.assign(m_tail.begin() + i, m_tail.end());
+                m_tail.clear();
+                return 0;
+            }
+            m_skippedBytes += tailLength;
+            m_tail.clear();
+        }
+
+        for (size_t i = 0; i < length; ++i) {
+            uint8_t c = data[i];
+            if (c != 'G' && c != 'P' && c != 'D' && c != 'H') {
+                continue;
+            }
+            bool complete;
+            if (!MatchesStart(data + i, length - i, &complete)) {
+                continue;
+            }
+            m_skippedBytes += i;
+            if (complete) {
+                StartMessage(timestampNs);
+                return i;
+            }
+            // Might continue in the next call
+            m_tail.assign(data + i, data + length);
+            m_tailTimestampNs = timestampNs;
+            return length;
+        }
+        m_skippedBytes += length;
+        return length;
+    }
+
+    void StartMessage(uint64_t timestampNs) {
+        m_state = State::Headers;
+        m_headers.clear();
+        m_message = RnetMessage();
+        m_message.firstByteNs = timestampNs;
+    }
+
+    // Position right after the "\r\n\r\n" ending the headers, counting from `data`, or 0 if it's not in `data`
+    size_t FindHeadersEnd(const uint8_t* data, size_t length) const {
+        // The terminator might start in the bytes buffered so far
+        size_t buffered = m_headers.size();
+        for (size_t k = 1; k <= 3 && k <= length; ++k) {
+            if (buffered + k < 4) {
+                continue;
+            }
+            uint8_t last[4];
+            for (size_t j = 0; j < 4; ++j) {
+                size_t index = buffered + k - 4 + j;
+                last[j] = index < buffered ? m_headers[index] : data[index - buffered];
+            }
+            if (memcmp(last, "\r\n\r\n", 4) == 0) {
+                return k;
+            }
+        }
+        const uint8_t* p = data;
+        const uint8_t* end = data + length;
+        while ((p = (const uint8_t*)memchr(p, '\r', end - p)) != nullptr) {
+            if (end - p >= 4 && memcmp(p, "\r\n\r\n", 4) == 0) {
+                return (p - data) + 4;
+            }
+            ++p;
+        }
+        return 0;
+    }
+
+    template <typename OnMessage>
+    size_t FeedHeaders(const uint8_t* data, size_t length, uint64_t timestampNs, OnMessage& onMessage) {
+        m_message.lastByteNs = timestampNs;
+        size_t end = FindHeadersEnd(data, length);
+        size_t taken = end != 0 ? end : length;
+        if (m_headers.size() + taken > MaxHeadersLength) {
+            // Not SimpleHttp after all. Looking for a message past the bogus start.
+            ++m_resyncs;
+            m_state = State::Seeking;
+            m_headers.clear();
+            return 1 < length ? 1 : length;
+        }
+        m_headers.insert(m_headers.end(), data, data + taken);
+        if (end == 0) {
+            return taken;
+        }
+
+        if (!ParseHeaders()) {
+            ++m_resyncs;
+            m_state = State::Seeking;
+            m_headers.clear();
+            return taken;
+        }
+        m_message.headersLength = m_headers.size();
+        m_headers.clear();
+        if (m_bodyRemaining == 0) {
+            Complete(onMessage);
+        } else {
+            m_state = State::Body;
+        }
+        return taken;
+    }
+
+    static bool EqualsIgnoreCase(const char* a, const char* b, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            char x = a[i] >= 'A' && a[i] <= 'Z' ? (char)(a[i] + 32) : a[i];
+            char y = b[i] >= 'A' && b[i] <= 'Z' ? (char)(b[i] + 32) : b[i];
+            if (x != y) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool ParseNumber(const char* p, const char* end, uint64_t* value) {
+        while (p < end && *p == ' ') {
+            ++p;
+        }
+        if (p == end) {
+            return false;
+        }
+        uint64_t result = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            result = result * 10 + (uint64_t)(*p - '0');
+        }
+        *value = result;
+        return true;
+    }
+
+    bool ParseHeaders() {
+        const char* begin = (const char*)m_headers.data();
+        const char* end = begin + m_headers.size();
+        const char* lineEnd = (const char*)memchr(begin, '\r', end - begin);
+        if (lineEnd == nullptr) {
+            return false;
+        }
+
+        // <Method> <Target> HTTP/1.1 or HTTP/1.1 <Status> <Reason>
+        const char* firstSpace = (const char*)memchr(begin, ' ', lineEnd - begin);
+        if (firstSpace == nullptr) {
+            return false;
+        }
+        m_message.isRequest = !(lineEnd - begin >= 5 && memcmp(begin, "HTTP/", 5) == 0);
+        if (m_message.isRequest) {
+            const char* target = firstSpace + 1;
+            const char* targetEnd = target;
+            while (targetEnd < lineEnd && *targetEnd != ' ') {
+                ++targetEnd;
+            }
+            const char* query = (const char*)memchr(target, '?', targetEnd - target);
+            m_message.path.assign(target, query != nullptr ? query : targetEnd);
+            // requestId=<id> in the query string
+            for (const char* p = query; p != nullptr && p < targetEnd;) {
+                const char* pairStart = p + 1;
+                const char* pairEnd = (const char*)memchr(pairStart, '&', targetEnd - pairStart);
+                if (pairEnd == nullptr) {
+                    pairEnd = targetEnd;
+                }
+                if (pairEnd - pairStart > 10 && memcmp(pairStart, "requestId=", 10) == 0) {
+                    m_message.requestId.assign(pairStart + 10, pairEnd);
+                }
+                p = pairEnd < targetEnd ? pairEnd : nullptr;
+            }
+        } else {
+            uint64_t status = 0;
+            ParseNumber(firstSpace + 1, lineEnd, &status);
+            m_message.status = (int)status;
+        }
+
+        m_bodyRemaining = 0;
+        for (const char* line = lineEnd + 2; line < end;) {
+            const char* next = (const char*)memchr(line, '\r', end - line);
+            if (next == nullptr || next == line) {
+                break;
+            }
+            const char* colon = (const char*)memchr(line, ':', next - line);
+            if (colon != nullptr) {
+                size_t nameLength = colon - line;
+                if (nameLength == 14 && EqualsIgnoreCase(line, "Content-Length", 14)) {
+                    if (!ParseNumber(colon + 1, next, &m_bodyRemaining)) {
+                        return false;
+                    }
+                } else if (nameLength == 9 && EqualsIgnoreCase(line, "requestId", 9)) {
+                    const char* value = colon + 1;
+                    while (value < next && *value == ' ') {
+                        ++value;
+                    }
+                    m_message.requestId.assign(value, next);
+                }
+            }
+            line = next + 2;
+        }
+        m_message.bodyLength = m_bodyRemaining;
+        return true;
+    }
+
+    template <typename OnMessage>
+    void Complete(OnMessage& onMessage) {
+        ++m_messages;
+        m_state = State::Seeking;
+        onMessage(m_message);
+    }
+
+    State m_state = State::Seeking;
+    std::vector<uint8_t> m_headers;
+    std::vector<uint8_t> m_tail;
+    uint64_t m_tailTimestampNs = 0;
+    uint64_t m_bodyRemaining = 0;
+    RnetMessage m_message = RnetMessage();
+    uint64_t m_resyncs = 0;
+    uint64_t m_skippedBytes = 0;
+    uint64_t m_messages = 0;
+};
+
+// ----------------
+// TCP Reassembly
+// ----------------
+
+inline bool SeqBefore(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+// One direction of a TCP connection. Delivers the stream's bytes in order, once each.
+class TcpDirection {
+public:
+    // Calls `deliver(data, length, timestampNs)` with in-order data and `gap()` where bytes are missing
+    template <typename Deliver, typename OnGap>
+    void Add(const TcpSegment& segment, Deliver& deliver, OnGap& gap) {
+        if (segment.flags & TcpSyn) {
+            m_nextSeq = segment.seq + 1;
+            m_synced = true;
+            return;
+        }
+        if (segment.wireLength == 0) {
+            return;
+        }
+        if (!m_synced) {
+            // Capture started mid-connection
+            m_nextSeq = segment.seq;
+            m_synced = true;
+        }
+
+        uint32_t seq = segment.seq;
+        const uint8_t* data = segment.payload;
+        size_t captured = segment.payloadLength;
+        size_t wire = segment.wireLength;
+        if (SeqBefore(seq, m_nextSeq)) {
+            uint32_t overlap = m_nextSeq - seq;
+            if (overlap >= wire) {
+                // Retransmission of delivered data
+                return;
+            }
+            seq += overlap;
+            wire -= overlap;
+            size_t trimmed = overlap < captured ? overlap : captured;
+            data += trimmed;
+            captured -= trimmed;
+        }
+
+        if (seq != m_nextSeq) {
+            Buffer(seq, data, captured, wire, segment.timestampNs);
+            if (m_bufferedBytes > MaxOutOfOrderBytes) {
+                // The missing segment isn't coming, skipping to what we have
+                gap();
+                m_nextSeq = m_buffered.begin()->first;
+                Drain(segment.timestampNs, deliver, gap);
+            }
+            return;
+        }
+        DeliverRange(data, captured, wire, segment.timestampNs, deliver, gap);
+        Drain(segment.timestampNs, deliver, gap);
+    }
+
+    // End of the capture. Whatever is buffered is delivered, with gaps for the holes.
+    template <typename Deliver, typename OnGap>
+    void Flush(Deliver& deliver, OnGap& gap) {
+        while (!m_buffered.empty()) {
+            gap();
+            m_nextSeq = m_buffered.begin()->first;
+            Drain(0, deliver, gap);
+        }
+    }
+
+private:
+    struct Pending {
+        uint64_t timestampNs;
+        size_t wireLength;
+        std::vector<uint8_t> data;  // Might be shorter than wireLength (snaplen)
+    };
+
+    struct SeqLess {
+        bool operator()(uint32_t a, uint32_t b) const { return SeqBefore(a, b); }
+    };
+
+    void Buffer(uint32_t seq, const uint8_t* data, size_t captured, size_t wire, uint64_t timestampNs) {
+        auto it = m_buffered.find(seq);
+        if (it != m_buffered.end()) {
+            if (it->second.wireLength >= wire) {
+                return;
+            }
+            m_bufferedBytes -= it->second.data.size();
+        }
+        Pending& pending = m_buffered[seq];
+        pending.timestampNs = timestampNs;
+        pending.wireLength = wire;
+        pending.data.assign(data, data + captured);
+        m_bufferedBytes += captured;
+    }
+
+    template <typename DeliverFn, typename OnGap>
+    void DeliverRange(const uint8_t* data, size_t captured, size_t wire, uint64_t timestampNs, DeliverFn& deliver, OnGap& gap) {
+        if (captured > 0) {
+            deliver(data, captured, timestampNs);
+        }
+        if (captured < wire) {
+            // Cut by the snaplen
+            gap();
+        }
+        m_nextSeq += (uint32_t)wire;
+    }
+
+    // Buffered segments are readable once the hole before them is filled, at `timestampNs`
+    template <typename DeliverFn, typename OnGap>
+    void Drain(uint64_t timestampNs, DeliverFn& deliver, OnGap& gap) {
+        while (!m_buffered.empty()) {
+            auto it = m_buffered.begin();
+            uint32_t seq = it->first;
+            if (SeqBefore(m_nextSeq, seq)) {
+                return;
+            }
+            Pending pending = std::move(it->second);
+            m_bufferedBytes -= pending.data.size();
+            m_buffered.erase(it);
+
+            uint32_t overlap = m_nextSeq - seq;
+            if (overlap >= pending.wireLength) {
+                continue;
+            }
+            size_t trimmed = overlap < pending.data.size() ? overlap : pending.data.size();
+            DeliverRange(pending.data.data() + trimmed, pending.data.size() - trimmed, pending.wireLength - overlap,
+                pending.timestampNs > timestampNs ? pending.timestampNs : timestampNs, deliver, gap);
+        }
+    }
+
+    bool m_synced = false;
+    uint32_t m_nextSeq = 0;
+    // Ordered by sequence number, wrap-around included (a window never spans half the sequence space)
+    std::map<uint32_t, Pending, SeqLess> m_buffered;
+    size_t m_bufferedBytes = 0;
+};
+
+// ----------------
+// Statistics
+// ----------------
+
+// Percentile of sorted values, nearest rank
+template <typename T>
+inline T Percentile(const std::vector<T>& sorted, double percentile) {
+    if (sorted.empty()) {
+        return T();
+    }
+    size_t rank = (size_t)std::ceil(percentile / 100.0 * (double)sorted.size());
+    rank = rank == 0 ? 1 : (rank > sorted.size() ? sorted.size() : rank);
+    return sorted[rank - 1];
+}
+
+struct EndpointStats {
+    // Request's first byte to response's last byte, in microseconds (capped at ~71 minutes)
+    std::vector<uint32_t> latenciesUs;
+    uint64_t requestBodyBytes = 0;
+    uint64_t responseBodyBytes = 0;
+    uint64_t maxRequestBody = 0;
+    uint64_t maxResponseBody = 0;
+    uint64_t errors = 0;       // Non-200 responses
+    uint64_t unanswered = 0;   // Requests without a response in the capture
+};
+
+struct ConcurrencyBucket {
+    uint64_t startNs;
+    uint64_t started = 0;
+    uint64_t completed = 0;
+    uint64_t peakInFlight = 0;
+};
+
+// ----------------
+// Analysis
+// ----------------
+
+class RnetTrafficAnalyzer {
+public:
+    // Only connections with one of these ports are analyzed. Empty for all.
+    std::vector<uint16_t> ports;
+
+    void AddSegment(const TcpSegment& segment) {
+        if (!ports.empty() && std::find(ports.begin(), ports.end(), segment.srcPort) == ports.end() &&
+            std::find(ports.begin(), ports.end(), segment.dstPort) == ports.end()) {
+            return;
+        }
+        if (segment.timestampNs < m_firstNs) {
+            m_firstNs = segment.timestampNs;
+        }
+        if (segment.timestampNs > m_lastNs) {
+            m_lastNs = segment.timestampNs;
+        }
+
+        bool reversed;
+        ConnectionKey key = MakeKey(segment, &reversed);
+        auto it = m_connections.find(key);
+        if (it == m_connections.end()) {
+            // ACKs of connections we never saw data or a handshake for aren't worth tracking
+            if (segment.wireLength == 0 && !(segment.flags & TcpSyn)) {
+                return;
+            }
+            it = m_connections.emplace(key, Connection()).first;
+            it->second.id = m_nextConnectionId++;
+        }
+        Connection& connection = it->second;
+        int direction = reversed ? 1 : 0;
+
+        auto deliver = [&](const uint8_t* data, size_t length, uint64_t timestampNs) {
+            connection.parsers[direction].Feed(data, length, timestampNs, [&](const RnetMessage& message) {
+                OnMessage(connection, direction, message);
+            });
+        };
+        auto gap = [&]() { connection.parsers[direction].Gap(); };
+        connection.tcp[direction].Add(segment, deliver, gap);
+
+        if (segment.flags & (TcpFin | TcpRst)) {
+            connection.closed[direction] = true;
+            if ((segment.flags & TcpRst) || (connection.closed[0] && connection.closed[1])) {
+                Close(connection);
+                m_connections.erase(it);
+            }
+        }
+    }
+
+    // Call once the whole capture was read
+    void Finish() {
+        for (auto& kvp : m_connections) {
+            Close(kvp.second);
+        }
+        m_connections.clear();
+    }
+
+    const std::map<std::string, EndpointStats>& Endpoints() const { return m_endpoints; }
+    uint64_t Connections() const { return m_nextConnectionId; }
+    uint64_t RnetConnections() const { return m_rnetConnections; }
+    uint64_t MatchedRequests() const { return m_matched; }
+    uint64_t OrphanResponses() const { return m_orphanResponses; }
+    uint64_t Resyncs() const { return m_resyncs; }
+    uint64_t FirstTimestampNs() const { return m_firstNs == UINT64_MAX ? 0 : m_firstNs; }
+    uint64_t LastTimestampNs() const { return m_lastNs; }
+
+    uint64_t UnansweredRequests() const {
+        uint64_t unanswered = 0;
+        for (const auto& kvp : m_endpoints) {
+            unanswered += kvp.second.unanswered;
+        }
+        return unanswered;
+    }
+
+    // Sorts the latencies. Call before reading percentiles.
+    void SortLatencies() {
+        for (auto& kvp : m_endpoints) {
+            std::sort(kvp.second.latenciesUs.begin(), kvp.second.latenciesUs.end());
+        }
+    }
+
+    // Requests started, completed and the most in flight at once, per `intervalNs` since the first packet
+    std::vector<ConcurrencyBucket> Concurrency(uint64_t intervalNs) {
+        std::vector<ConcurrencyBucket> buckets;
+        if (intervalNs == 0 || m_lastNs < FirstTimestampNs()) {
+            return buckets;
+        }
+        uint64_t origin = FirstTimestampNs();
+        size_t count = (size_t)((m_lastNs - origin) / intervalNs) + 1;
+        buckets.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            buckets[i].startNs = origin + i * intervalNs;
+        }
+
+        std::sort(m_starts.begin(), m_starts.end());
+        std::sort(m_ends.begin(), m_ends.end());
+        // Sweep: at equal times ends go first, a request answered when the next one starts didn't overlap it
+        size_t s = 0;
+        size_t e = 0;
+        uint64_t inFlight = 0;
+        while (s < m_starts.size() || e < m_ends.size()) {
+            bool isEnd = e < m_ends.size() && (s == m_starts.size() || m_ends[e] <= m_starts[s]);
+            uint64_t t = isEnd ? m_ends[e++] : m_starts[s++];
+            ConcurrencyBucket& bucket = buckets[std::min(count - 1, (size_t)((t - origin) / intervalNs))];
+            if (isEnd) {
+                --inFlight;
+                ++bucket.completed;
+            } else {
+                ++inFlight;
+                ++bucket.started;
+            }
+            bucket.peakInFlight = std::max(bucket.peakInFlight, inFlight);
+        }
+        // Requests running through a whole bucket count towards its peak too
+        inFlight = 0;
+        for (ConcurrencyBucket& bucket : buckets) {
+            bucket.peakInFlight = std::max(bucket.peakInFlight, inFlight);
+            inFlight = inFlight + bucket.started - bucket.completed;
+        }
+        return buckets;
+    }
+
+private:
+    struct ConnectionKey {
+        uint8_t addressA[16];
+        uint8_t addressB[16];
+        uint16_t portA;
+        uint16_t portB;
+
+        bool operator==(const ConnectionKey& other) const { return memcmp(this, &other, sizeof(*this)) == 0; }
+    };
+
+    struct ConnectionKeyHash {
+        size_t operator()(const ConnectionKey& key) const {
+            // FNV-1a
+            uint64_t hash = 14695981039346656037ull;
+            const uint8_t* p = (const uint8_t*)&key;
+            for (size_t i = 0; i < sizeof(key); ++i) {
+                hash ^= p[i];
+                hash *= 1099511628211ull;
+            }
+            return (size_t)hash;
+        }
+    };
+
+    struct PendingRequest {
+        std::string path;
+        uint64_t firstByteNs;
+        uint64_t bodyLength;
+    };
+
+    struct Connection {
+        uint64_t id = 0;
+        bool sawMessage = false;
+        bool closed[2] = { false, false };
+        TcpDirection tcp[2];
+        SimpleHttpStreamParser parsers[2];
+        // Requests sent in each direction, by ID
+        std::unordered_map<std::string, PendingRequest> pending[2];
+        // Requests without an ID, answered in order
+        std::vector<PendingRequest> unnamed[2];
+        size_t unnamedHead[2] = { 0, 0 };
+    };
+
+    static ConnectionKey MakeKey(const TcpSegment& segment, bool* reversed) {
+        // Both directions share a key, the lower endpoint first
+        int order = memcmp(segment.srcAddress, segment.dstAddress, 16);
+        *reversed = order > 0 || (order == 0 && segment.srcPort > segment.dstPort);
+        ConnectionKey key;
+        memcpy(key.addressA, *reversed ? segment.dstAddress : segment.srcAddress, 16);
+        memcpy(key.addressB, *reversed ? segment.srcAddress : segment.dstAddress, 16);
+        key.portA = *reversed ? segment.dstPort : segment.srcPort;
+        key.portB = *reversed ? segment.srcPort : segment.dstPort;
+        return key;
+    }
+
+    void OnMessage(Connection& connection, int direction, const RnetMessage& message) {
+        if (!connection.sawMessage) {
+            connection.sawMessage = true;
+            ++m_rnetConnections;
+        }
+        if (message.isRequest) {
+            PendingRequest request = { message.path, message.firstByteNs, message.bodyLength };
+            if (message.requestId.empty()) {
+                connection.unnamed[direction].push_back(std::move(request));
+                return;
+            }
+            auto inserted = connection.pending[direction].emplace(message.requestId, request);
+            if (!inserted.second) {
+                // ID reused before the first request was answered
+                ++m_endpoints[inserted.first->second.path].unanswered;
+                inserted.first->second = std::move(request);
+            }
+            return;
+        }
+
+        // Responses answer requests which went the other way
+        int requestDirection = 1 - direction;
+        PendingRequest request;
+        auto it = message.requestId.empty() ? connection.pending[requestDirection].end()
+                                            : connection.pending[requestDirection].find(message.requestId);
+        if (it != connection.pending[requestDirection].end()) {
+            request = std::move(it->second);
+            connection.pending[requestDirection].erase(it);
+        } else if (connection.unnamedHead[requestDirection] < connection.unnamed[requestDirection].size()) {
+            std::vector<PendingRequest>& unnamed = connection.unnamed[requestDirection];
+            size_t& head = connection.unnamedHead[requestDirection];
+            request = std::move(unnamed[head++]);
+            if (head == unnamed.size()) {
+                unnamed.clear();
+                head = 0;
+            }
+        } else {
+            ++m_orphanResponses;
+            return;
+        }
+
+        EndpointStats& stats = m_endpoints[request.path];
+        uint64_t latencyUs = message.lastByteNs > request.firstByteNs ? (message.lastByteNs - request.firstByteNs) / 1000 : 0;
+        stats.latenciesUs.push_back((uint32_t)std::min<uint64_t>(latencyUs, UINT32_MAX));
+        stats.requestBodyBytes += request.bodyLength;
+        stats.responseBodyBytes += message.bodyLength;
+        stats.maxRequestBody = std::max(stats.maxRequestBody, request.bodyLength);
+        stats.maxResponseBody = std::max(stats.maxResponseBody, message.bodyLength);
+        if (message.status != 200) {
+            ++stats.errors;
+        }
+        m_starts.push_back(request.firstByteNs);
+        m_ends.push_back(std::max(message.lastByteNs, request.firstByteNs));
+        ++m_matched;
+    }
+
+    void Close(Connection& connection) {
+        for (int direction = 0; direction < 2; ++direction) {
+            // Data still waiting for a missing segment
+            auto deliver = [&](const uint8_t* data, size_t length, uint64_t timestampNs) {
+                connection.parsers[direction].Feed(data, length, timestampNs, [&](const RnetMessage& message) {
+                    OnMessage(connection, direction, message);
+                });
+            };
+            auto gap = [&]() { connection.parsers[direction].Gap(); };
+            connection.tcp[direction].Flush(deliver, gap);
+        }
+        for (int direction = 0; direction < 2; ++direction) {
+            for (const auto& kvp : connection.pending[direction]) {
+                ++m_endpoints[kvp.second.path].unanswered;
+            }
+            for (size_t i = connection.unnamedHead[direction]; i < connection.unnamed[direction].size(); ++i) {
+                ++m_endpoints[connection.unnamed[direction][i].path].unanswered;
+            }
+            m_resyncs += connection.parsers[direction].Resyncs();
+        }
+    }
+
+    std::unordered_map<ConnectionKey, Connection, ConnectionKeyHash> m_connections;
+    std::map<std::string, EndpointStats> m_endpoints;
+    std::vector<uint64_t> m_starts;
+    std::vector<uint64_t> m_ends;
+    uint64_t m_nextConnectionId = 0;
+    uint64_t m_rnetConnections = 0;
+    uint64_t m_matched = 0;
+    uint64_t m_orphanResponses = 0;
+    uint64_t m_resyncs = 0;
+    uint64_t m_firstNs = UINT64_MAX;
+    uint64_t m_lastNs = 0;
+};
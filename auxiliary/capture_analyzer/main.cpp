@@ -0,0 +1,163 @@
+// Offline analyzer of rNET traffic captures (pcap/pcapng), for diagnosing slow sessions without clicking through
+// Wireshark (see ../dissector/rnet.lua for that).
+//   RnetCaptureAnalyzer [--port PORT]... [--interval SECONDS] [--csv] CAPTURE
+// Reports per-endpoint latency percentiles and payload sizes, and how many requests were in flight over time.
+// Latency is measured from a request's first byte to its response's last byte, as seen where the capture was taken.
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "PcapReader.h"
+#include "RnetTraffic.h"
+
+// Concurrency tables longer than this get a wider interval (unless one was asked for)
+static const size_t MaxConcurrencyRows = 120;
+
+static void PrintUsage() {
+    fprintf(stderr,
+        "Usage: RnetCaptureAnalyzer [--port PORT]... [--interval SECONDS] [--csv] CAPTURE\n"
+        "  --port PORT         Only analyze connections to/from PORT (repeatable). Default: every TCP connection.\n"
+        "  --interval SECONDS  Width of the concurrency table's rows. Default: 1, widened for long captures.\n"
+        "  --csv               Print the endpoints table as CSV only\n");
+}
+
+static double Ms(uint32_t us) { return us / 1000.0; }
+
+static void PrintEndpointsCsv(const RnetTrafficAnalyzer& analyzer) {
+    printf("endpoint,count,unanswered,errors,p50_ms,p90_ms,p99_ms,max_ms,avg_request_bytes,avg_response_bytes,max_response_bytes,total_response_bytes\n");
+    for (const auto& kvp : analyzer.Endpoints()) {
+        const EndpointStats& stats = kvp.second;
+        size_t count = stats.latenciesUs.size();
+        printf("%s,%zu,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%llu,%llu\n", kvp.first.c_str(), count,
+            (unsigned long long)stats.unanswered, (unsigned long long)stats.errors,
+            Ms(Percentile(stats.latenciesUs, 50)), Ms(Percentile(stats.latenciesUs, 90)),
+            Ms(Percentile(stats.latenciesUs, 99)), Ms(count ? stats.latenciesUs.back() : 0),
+            (unsigned long long)(count ? stats.requestBodyBytes / count : 0),
+            (unsigned long long)(count ? stats.responseBodyBytes / count : 0),
+            (unsigned long long)stats.maxResponseBody, (unsigned long long)stats.responseBodyBytes);
+    }
+}
+
+static void PrintEndpoints(const RnetTrafficAnalyzer& analyzer) {
+    printf("%-28s %9s %7s %7s %9s %9s %9s %9s %11s %11s %11s\n", "Endpoint", "Count", "NoResp", "Errors",
+        "p50 ms", "p90 ms", "p99 ms", "max ms", "Req avg B", "Resp avg B", "Resp max B");
+    for (const auto& kvp : analyzer.Endpoints()) {
+        const EndpointStats& stats = kvp.second;
+        size_t count = stats.latenciesUs.size();
+        printf("%-28s %9zu %7llu %7llu %9.3f %9.3f %9.3f %9.3f %11llu %11llu %11llu\n", kvp.first.c_str(), count,
+            (unsigned long long)stats.unanswered, (unsigned long long)stats.errors,
+            Ms(Percentile(stats.latenciesUs, 50)), Ms(Percentile(stats.latenciesUs, 90)),
+            Ms(Percentile(stats.latenciesUs, 99)), Ms(count ? stats.latenciesUs.back() : 0),
+            (unsigned long long)(count ? stats.requestBodyBytes / count : 0),
+            (unsigned long long)(count ? stats.responseBodyBytes / count : 0),
+            (unsigned long long)stats.maxResponseBody);
+    }
+}
+
+static void PrintConcurrency(RnetTrafficAnalyzer& analyzer, double intervalSeconds, bool intervalGiven) {
+    uint64_t durationNs = analyzer.LastTimestampNs() - analyzer.FirstTimestampNs();
+    uint64_t intervalNs = (uint64_t)(intervalSeconds * 1e9);
+    if (intervalNs == 0) {
+        intervalNs = 1;
+    }
+    if (!intervalGiven && durationNs / intervalNs >= MaxConcurrencyRows) {
+        // Whole seconds, enough of them to fit
+        uint64_t seconds = durationNs / 1000000000ull / MaxConcurrencyRows + 1;
+        intervalNs = seconds * 1000000000ull;
+    }
+
+    printf("\nConcurrency (%.3f s intervals)\n", intervalNs / 1e9);
+    printf("%10s %10s %10s %10s\n", "Time s", "Started", "Completed", "Peak");
+    for (const ConcurrencyBucket& bucket : analyzer.Concurrency(intervalNs)) {
+        printf("%10.3f %10llu %10llu %10llu\n", (bucket.startNs - analyzer.FirstTimestampNs()) / 1e9,
+            (unsigned long long)bucket.started, (unsigned long long)bucket.completed, (unsigned long long)bucket.peakInFlight);
+    }
+}
+
+int main(int argc, char** argv) {
+    RnetTrafficAnalyzer analyzer;
+    double intervalSeconds = 1;
+    bool intervalGiven = false;
+    bool csv = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            analyzer.ports.push_back((uint16_t)atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            intervalSeconds = atof(argv[++i]);
+            intervalGiven = true;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if (argv[i][0] != '-' && path == nullptr) {
+            path = argv[i];
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (path == nullptr || intervalSeconds <= 0) {
+        PrintUsage();
+        return 2;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "Failed to read %s\n", path);
+        close(fd);
+        return 1;
+    }
+    size_t size = (size_t)st.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Failed to map %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    // Read once, front to back
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    auto start = std::chrono::steady_clock::now();
+    CaptureStats captureStats;
+    std::string error;
+    bool read = ReadCapture((const uint8_t*)mapping, size, &captureStats,
+        [&](const TcpSegment& segment) { analyzer.AddSegment(segment); }, &error);
+    analyzer.Finish();
+    analyzer.SortLatencies();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    munmap(mapping, size);
+    if (!read) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return 1;
+    }
+
+    if (csv) {
+        PrintEndpointsCsv(analyzer);
+        return 0;
+    }
+
+    printf("Capture: %s (%.1f MB, analyzed in %.2f s, %.0f MB/s)%s\n", path, size / 1e6, elapsed,
+        elapsed > 0 ? size / 1e6 / elapsed : 0.0, captureStats.truncated ? " [TRUNCATED]" : "");
+    printf("Packets: %llu (%llu TCP), duration %.3f s\n", (unsigned long long)captureStats.packets,
+        (unsigned long long)captureStats.tcpSegments, (analyzer.LastTimestampNs() - analyzer.FirstTimestampNs()) / 1e9);
+    printf("Connections: %llu (%llu rNET)\n", (unsigned long long)analyzer.Connections(), (unsigned long long)analyzer.RnetConnections());
+    printf("Requests: %llu answered, %llu unanswered, %llu responses without a request, %llu stream resyncs\n\n",
+        (unsigned long long)analyzer.MatchedRequests(), (unsigned long long)analyzer.UnansweredRequests(),
+        (unsigned long long)analyzer.OrphanResponses(), (unsigned long long)analyzer.Resyncs());
+    PrintEndpoints(analyzer);
+    PrintConcurrency(analyzer, intervalSeconds, intervalGiven);
+    return 0;
+}
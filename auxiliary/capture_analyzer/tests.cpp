@@ -0,0 +1,561 @@
+// Tests of the rNET capture analyzer against captures built in memory.
+//   RnetCaptureTests                 Correctness checks (used by ctest)
+//   RnetCaptureTests --bench [MB]    Analysis throughput on a synthetic capture of about MB megabytes (default 512)
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "PcapReader.h"
+#include "RnetTraffic.h"
+
+static int g_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "CHECK FAILED: %s (%s:%d)\n", #cond, __FILE__, __LINE__); \
+            ++g_failures; \
+        } \
+    } while (0)
+
+// ----------------
+// Capture Building
+// ----------------
+
+typedef std::vector<uint8_t> Bytes;
+
+static void PutBe16(Bytes& b, uint16_t v) { b.push_back((uint8_t)(v >> 8)); b.push_back((uint8_t)v); }
+static void PutBe32(Bytes& b, uint32_t v) { PutBe16(b, (uint16_t)(v >> 16)); PutBe16(b, (uint16_t)v); }
+
+static void PutLe(Bytes& b, uint64_t v, int size, bool bigEndian = false) {
+    for (int i = 0; i < size; ++i) {
+        int shift = bigEndian ? (size - 1 - i) * 8 : i * 8;
+        b.push_back((uint8_t)(v >> shift));
+    }
+}
+
+static Bytes ToBytes(const std::string& s) { return Bytes(s.begin(), s.end()); }
+
+struct Endpoint {
+    uint8_t address[16];
+    uint16_t port;
+};
+
+static Endpoint V4(uint8_t last, uint16_t port) {
+    Endpoint e = {};
+    e.address[0] = 127;
+    e.address[3] = last;
+    e.port = port;
+    return e;
+}
+
+static Endpoint V6(uint8_t last, uint16_t port) {
+    Endpoint e = {};
+    e.address[15] = last;
+    e.port = port;
+    return e;
+}
+
+// An IP packet carrying a TCP segment
+static Bytes IpPacket(bool ipv6, const Endpoint& src, const Endpoint& dst, uint32_t seq, uint8_t flags, const Bytes& payload) {
+    Bytes tcp;
+    PutBe16(tcp, src.port);
+    PutBe16(tcp, dst.port);
+    PutBe32(tcp, seq);
+    PutBe32(tcp, 0);          // Ack
+    tcp.push_back(5 << 4);    // Data offset
+    tcp.push_back(flags | 0x10);
+    PutBe16(tcp, 65535);      // Window
+    PutBe16(tcp, 0);          // Checksum (not verified)
+    PutBe16(tcp, 0);          // Urgent
+    tcp.insert(tcp.end(), payload.begin(), payload.end());
+
+    Bytes ip;
+    if (ipv6) {
+        PutBe32(ip, 0x60000000);
+        PutBe16(ip, (uint16_t)tcp.size());
+        ip.push_back(6);  // TCP
+        ip.push_back(64);
+        ip.insert(ip.end(), src.address, src.address + 16);
+        ip.insert(ip.end(), dst.address, dst.address + 16);
+    } else {
+        ip.push_back(0x45);
+        ip.push_back(0);
+        PutBe16(ip, (uint16_t)(20 + tcp.size()));
+        PutBe32(ip, 0x00004000);  // Don't fragment
+        ip.push_back(64);
+        ip.push_back(6);
+        PutBe16(ip, 0);
+        ip.insert(ip.end(), src.address, src.address + 4);
+        ip.insert(ip.end(), dst.address, dst.address + 4);
+    }
+    ip.insert(ip.end(), tcp.begin(), tcp.end());
+    return ip;
+}
+
+static Bytes LinkFrame(uint32_t linkType, bool ipv6, const Bytes& ip) {
+    Bytes frame;
+    switch (linkType) {
+    case LinkEthernet:
+        frame.resize(12, 0xAA);
+        PutBe16(frame, ipv6 ? 0x86DD : 0x0800);
+        break;
+    case LinkNull:
+        PutLe(frame, ipv6 ? 30 : 2, 4);
+        break;
+    case LinkLinuxSll2:
+        PutBe16(frame, ipv6 ? 0x86DD : 0x0800);
+        frame.resize(20, 0);
+        break;
+    default:
+        break;
+    }
+    frame.insert(frame.end(), ip.begin(), ip.end());
+    return frame;
+}
+
+struct Packet {
+    uint64_t timestampNs;
+    Bytes frame;
+};
+
+// Builds the packets of one TCP connection
+class Conversation {
+public:
+    Conversation(uint32_t linkType, bool ipv6, Endpoint a, Endpoint b, std::vector<Packet>* packets)
+        : m_linkType(linkType), m_ipv6(ipv6), m_a(a), m_b(b), m_packets(packets) {
+        m_seq[0] = 1000;
+        m_seq[1] = 50000;
+    }
+
+    // `fromA`: sent by the endpoint which opened the connection
+    void Syn(uint64_t timestampNs) {
+        Add(timestampNs, true, m_seq[0]++, TcpSyn, Bytes());
+        Add(timestampNs, false, m_seq[1]++, TcpSyn, Bytes());
+    }
+
+    // Sends data in one segment and returns its sequence number
+    uint32_t Send(uint64_t timestampNs, bool fromA, const Bytes& data) {
+        uint32_t seq = m_seq[fromA ? 0 : 1];
+        Add(timestampNs, fromA, seq, 0, data);
+        m_seq[fromA ? 0 : 1] += (uint32_t)data.size();
+        return seq;
+    }
+
+    // Takes sequence numbers without sending (for segments sent later, out of order, or never)
+    uint32_t Reserve(bool fromA, size_t length) {
+        uint32_t seq = m_seq[fromA ? 0 : 1];
+        m_seq[fromA ? 0 : 1] += (uint32_t)length;
+        return seq;
+    }
+
+    void Add(uint64_t timestampNs, bool fromA, uint32_t seq, uint8_t flags, const Bytes& data) {
+        Bytes ip = IpPacket(m_ipv6, fromA ? m_a : m_b, fromA ? m_b : m_a, seq, flags, data);
+        m_packets->push_back(Packet{ timestampNs, LinkFrame(m_linkType, m_ipv6, ip) });
+    }
+
+    void Fin(uint64_t timestampNs) {
+        Add(timestampNs, true, m_seq[0], TcpFin, Bytes());
+        Add(timestampNs, false, m_seq[1], TcpFin, Bytes());
+    }
+
+private:
+    uint32_t m_linkType;
+    bool m_ipv6;
+    Endpoint m_a;
+    Endpoint m_b;
+    uint32_t m_seq[2];
+    std::vector<Packet>* m_packets;
+};
+
+static Bytes WritePcap(uint32_t linkType, const std::vector<Packet>& packets, bool bigEndian = false) {
+    Bytes file;
+    PutLe(file, PcapMagicMicros, 4, bigEndian);
+    PutLe(file, 2, 2, bigEndian);
+    PutLe(file, 4, 2, bigEndian);
+    PutLe(file, 0, 4, bigEndian);
+    PutLe(file, 0, 4, bigEndian);
+    PutLe(file, 262144, 4, bigEndian);
+    PutLe(file, linkType, 4, bigEndian);
+    for (const Packet& packet : packets) {
+        PutLe(file, packet.timestampNs / 1000000000ull, 4, bigEndian);
+        PutLe(file, packet.timestampNs % 1000000000ull / 1000, 4, bigEndian);
+        PutLe(file, packet.frame.size(), 4, bigEndian);
+        PutLe(file, packet.frame.size(), 4, bigEndian);
+        file.insert(file.end(), packet.frame.begin(), packet.frame.end());
+    }
+    return file;
+}
+
+static void PutBlock(Bytes& file, uint32_t type, const Bytes& body) {
+    Bytes padded = body;
+    padded.resize((body.size() + 3) & ~3u, 0);
+    uint32_t length = (uint32_t)(12 + padded.size());
+    PutLe(file, type, 4);
+    PutLe(file, length, 4);
+    file.insert(file.end(), padded.begin(), padded.end());
+    PutLe(file, length, 4);
+}
+
+// pcapng with a single interface and nanosecond timestamps
+static Bytes WritePcapng(uint32_t linkType, const std::vector<Packet>& packets) {
+    Bytes file;
+    Bytes shb;
+    PutLe(shb, PcapngByteOrderMagic, 4);
+    PutLe(shb, 1, 2);
+    PutLe(shb, 0, 2);
+    PutLe(shb, ~0ull, 8);
+    PutBlock(file, PcapngSectionHeader, shb);
+
+    Bytes idb;
+    PutLe(idb, linkType, 2);
+    PutLe(idb, 0, 2);
+    PutLe(idb, 0, 4);
+    PutLe(idb, 9, 2);   // if_tsresol
+    PutLe(idb, 1, 2);
+    idb.push_back(9);   // 10^-9
+    idb.resize(idb.size() + 3, 0);
+    PutLe(idb, 0, 4);   // opt_endofopt
+    PutBlock(file, 1, idb);
+
+    // Statistics and other blocks are skipped
+    PutBlock(file, 5, Bytes(16, 0));
+
+    for (const Packet& packet : packets) {
+        Bytes epb;
+        PutLe(epb, 0, 4);
+        PutLe(epb, packet.timestampNs >> 32, 4);
+        PutLe(epb, packet.timestampNs & 0xFFFFFFFF, 4);
+        PutLe(epb, packet.frame.size(), 4);
+        PutLe(epb, packet.frame.size(), 4);
+        epb.insert(epb.end(), packet.frame.begin(), packet.frame.end());
+        PutBlock(file, 6, epb);
+    }
+    return file;
+}
+
+static Bytes Request(const std::string& path, const std::string& requestId, const std::string& body = "") {
+    std::string target = path + (requestId.empty() ? "?a=1" : "?requestId=" + requestId + "&type_filter=*");
+    std::string s = "GET " + target + " HTTP/1.1\r\n";
+    if (!body.empty()) {
+        s += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+    return ToBytes(s + "\r\n" + body);
+}
+
+static Bytes Response(const std::string& requestId, const std::string& body, int status = 200) {
+    std::string s = "HTTP/1.1 " + std::to_string(status) + " OK\r\nConnection: close\r\n";
+    if (!requestId.empty()) {
+        s += "requestId: " + requestId + "\r\n";
+    }
+    s += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    return ToBytes(s);
+}
+
+static const uint64_t Second = 1000000000ull;
+static const uint64_t Ms = 1000000ull;
+
+static void Analyze(const Bytes& file, RnetTrafficAnalyzer* analyzer, CaptureStats* stats = nullptr) {
+    CaptureStats localStats;
+    std::string error;
+    bool read = ReadCapture(file.data(), file.size(), stats ? stats : &localStats,
+        [&](const TcpSegment& segment) { analyzer->AddSegment(segment); }, &error);
+    CHECK(read);
+    analyzer->Finish();
+    analyzer->SortLatencies();
+}
+
+static const EndpointStats* Find(const RnetTrafficAnalyzer& analyzer, const std::string& path) {
+    auto it = analyzer.Endpoints().find(path);
+    return it == analyzer.Endpoints().end() ? nullptr : &it->second;
+}
+
+// ----------------
+// Tests
+// ----------------
+
+static void VerifyPcapPairs() {
+    std::vector<Packet> packets;
+    Conversation c(LinkEthernet, false, V4(1, 41000), V4(1, 9977), &packets);
+    c.Syn(10 * Second);
+    c.Send(10 * Second + 1 * Ms, true, Request("/ping", "1"));
+    c.Send(10 * Second + 3 * Ms + 500000, false, Response("1", "{\"status\":\"pong\"}"));
+    // No IDs, answered in order
+    c.Send(11 * Second, true, Request("/types", ""));
+    c.Send(11 * Second + 7 * Ms, false, Response("", "[]", 500));
+    c.Fin(12 * Second);
+
+    CaptureStats stats;
+    RnetTrafficAnalyzer analyzer;
+    Analyze(WritePcap(LinkEthernet, packets), &analyzer, &stats);
+
+    CHECK(stats.packets == packets.size());
+    CHECK(!stats.truncated);
+    CHECK(analyzer.MatchedRequests() == 2);
+    CHECK(analyzer.UnansweredRequests() == 0);
+    CHECK(analyzer.OrphanResponses() == 0);
+    CHECK(analyzer.RnetConnections() == 1);
+    const EndpointStats* ping = Find(analyzer, "/ping");
+    CHECK(ping != nullptr && ping->latenciesUs.size() == 1 && ping->latenciesUs[0] == 2500);
+    CHECK(ping != nullptr && ping->responseBodyBytes == 17 && ping->errors == 0);
+    const EndpointStats* types = Find(analyzer, "/types");
+    CHECK(types != nullptr && types->latenciesUs.size() == 1 && types->latenciesUs[0] == 7000);
+    CHECK(types != nullptr && types->errors == 1);
+}
+
+static void VerifyPcapngOutOfOrderAndSplit() {
+    std::vector<Packet> packets;
+    Conversation c(LinkLinuxSll2, true, V6(1, 41001), V6(2, 9977), &packets);
+    c.Syn(1 * Second);
+
+    // Two pipelined requests in one segment
+    Bytes pipelined = Request("/heap", "5", "{\"filter\":\"*\"}");
+    Bytes second = Request("/get_field", "6");
+    pipelined.insert(pipelined.end(), second.begin(), second.end());
+    c.Send(1 * Second + 100, true, pipelined);
+
+    // Answered out of order
+    c.Send(1 * Second + 2 * Ms, false, Response("6", "{\"value\":1}"));
+
+    // The second response is split in three, the headers included. The middle segment is late and the first one retransmitted.
+    Bytes heap = Response("5", std::string(3000, 'x'));
+    Bytes part1(heap.begin(), heap.begin() + 20);
+    Bytes part2(heap.begin() + 20, heap.begin() + 1500);
+    Bytes part3(heap.begin() + 1500, heap.end());
+    uint32_t seq1 = c.Reserve(false, part1.size());
+    uint32_t seq2 = c.Reserve(false, part2.size());
+    uint32_t seq3 = c.Reserve(false, part3.size());
+    c.Add(1 * Second + 10 * Ms, false, seq1, 0, part1);
+    c.Add(1 * Second + 11 * Ms, false, seq3, 0, part3);
+    c.Add(1 * Second + 12 * Ms, false, seq1, 0, part1);
+    c.Add(1 * Second + 13 * Ms, false, seq2, 0, part2);
+    c.Fin(2 * Second);
+
+    RnetTrafficAnalyzer analyzer;
+    Analyze(WritePcapng(LinkLinuxSll2, packets), &analyzer);
+
+    CHECK(analyzer.MatchedRequests() == 2);
+    CHECK(analyzer.Resyncs() == 0);
+    const EndpointStats* heapStats = Find(analyzer, "/heap");
+    // Completed when the late middle segment fills the hole
+    CHECK(heapStats != nullptr && heapStats->latenciesUs.size() == 1 && heapStats->latenciesUs[0] == 12999);
+    CHECK(heapStats != nullptr && heapStats->responseBodyBytes == 3000 && heapStats->requestBodyBytes == 14);
+    const EndpointStats* field = Find(analyzer, "/get_field");
+    CHECK(field != nullptr && field->latenciesUs.size() == 1 && field->latenciesUs[0] == 1999);
+}
+
+static void VerifyReverseConnection() {
+    // The diver connects to Lifeboat, then receives requests over that connection
+    std::vector<Packet> packets;
+    Conversation c(LinkNull, false, V4(1, 52000), V4(1, 9977), &packets);
+    c.Syn(5 * Second);
+    c.Send(5 * Second + 1 * Ms, true, Request("/proxy_intro", "999", "{\"role\":\"diver\"}"));
+    c.Send(5 * Second + 2 * Ms, false, Response("999", "{\"status\":\"OK\"}"));
+    // Relay IDs
+    c.Send(5 * Second + 10 * Ms, false, Request("/invoke", "10"));
+    c.Send(5 * Second + 11 * Ms, false, Request("/invoke", "11"));
+    c.Send(5 * Second + 15 * Ms, true, Response("11", "{}"));
+    c.Send(5 * Second + 16 * Ms, true, Response("10", "{}"));
+    // Answers a request which went the same way: not a match
+    c.Send(5 * Second + 17 * Ms, false, Response("10", "{}"));
+
+    RnetTrafficAnalyzer analyzer;
+    Analyze(WritePcap(LinkNull, packets), &analyzer);
+
+    CHECK(analyzer.MatchedRequests() == 3);
+    CHECK(analyzer.OrphanResponses() == 1);
+    const EndpointStats* invoke = Find(analyzer, "/invoke");
+    CHECK(invoke != nullptr && invoke->latenciesUs.size() == 2);
+    CHECK(invoke != nullptr && invoke->latenciesUs[0] == 4000 && invoke->latenciesUs[1] == 6000);
+    CHECK(Find(analyzer, "/proxy_intro") != nullptr);
+}
+
+static void VerifyGapResync() {
+    std::vector<Packet> packets;
+    Conversation c(LinkEthernet, false, V4(1, 41002), V4(1, 9977), &packets);
+    c.Syn(1 * Second);
+    c.Send(1 * Second + 1 * Ms, true, Request("/heap", "1"));
+    Bytes heap = Response("1", std::string(5000, 'y'));
+    Bytes part1(heap.begin(), heap.begin() + 1000);
+    Bytes part3(heap.begin() + 2000, heap.end());
+    c.Send(1 * Second + 2 * Ms, false, part1);
+    c.Reserve(false, 1000);  // Lost
+    c.Send(1 * Second + 3 * Ms, false, part3);
+    c.Send(1 * Second + 4 * Ms, true, Request("/ping", "2"));
+    c.Send(1 * Second + 5 * Ms, false, Response("2", "{\"status\":\"pong\"}"));
+
+    RnetTrafficAnalyzer analyzer;
+    Analyze(WritePcap(LinkEthernet, packets), &analyzer);
+
+    // The lost bytes are only skipped at the end of the capture, the ping is delivered after them
+    CHECK(analyzer.MatchedRequests() == 1);
+    CHECK(analyzer.UnansweredRequests() == 1);
+    CHECK(analyzer.Resyncs() >= 1);
+    const EndpointStats* ping = Find(analyzer, "/ping");
+    CHECK(ping != nullptr && ping->latenciesUs.size() == 1);
+    const EndpointStats* heapStats = Find(analyzer, "/heap");
+    CHECK(heapStats != nullptr && heapStats->latenciesUs.empty() && heapStats->unanswered == 1);
+}
+
+static void VerifyHeadersSplitAtTerminator() {
+    SimpleHttpStreamParser parser;
+    Bytes message = Response("3", "{}");
+    std::vector<RnetMessage> messages;
+    auto onMessage = [&](const RnetMessage& m) { messages.push_back(m); };
+    // Byte by byte, so every boundary (the start token and "\r\n\r\n" included) is split
+    for (size_t i = 0; i < message.size(); ++i) {
+        parser.Feed(&message[i], 1, i, onMessage);
+    }
+    CHECK(messages.size() == 1);
+    CHECK(messages.size() == 1 && !messages[0].isRequest && messages[0].requestId == "3" && messages[0].bodyLength == 2);
+    CHECK(messages.size() == 1 && messages[0].lastByteNs == message.size() - 1);
+    CHECK(parser.SkippedBytes() == 0);
+
+    // Junk before a message is skipped
+    Bytes junk = ToBytes("garbage HTTP/1.");
+    Bytes request = Request("/ping", "4");
+    junk.insert(junk.end(), request.begin(), request.end());
+    parser.Feed(junk.data(), junk.size(), 0, onMessage);
+    CHECK(messages.size() == 2 && messages.back().isRequest && messages.back().path == "/ping");
+}
+
+static void VerifyConcurrency() {
+    std::vector<Packet> packets;
+    for (int i = 0; i < 3; ++i) {
+        Conversation c(LinkEthernet, false, V4(1, (uint16_t)(42000 + i)), V4(1, 9977), &packets);
+        c.Syn(0);
+        // [1s, 1.5s], [1.1s, 2.2s], [1.2s, 1.3s]
+        uint64_t start = 1 * Second + i * 100 * Ms;
+        uint64_t end = i == 0 ? 1500 * Ms : (i == 1 ? 2200 * Ms : 1300 * Ms);
+        c.Send(start, true, Request("/heap", "1"));
+        c.Send(end, false, Response("1", "[]"));
+    }
+    RnetTrafficAnalyzer analyzer;
+    Analyze(WritePcap(LinkEthernet, packets), &analyzer);
+
+    std::vector<ConcurrencyBucket> buckets = analyzer.Concurrency(1 * Second);
+    CHECK(buckets.size() == 3);
+    if (buckets.size() == 3) {
+        CHECK(buckets[0].started == 0 && buckets[0].peakInFlight == 0);
+        CHECK(buckets[1].started == 3 && buckets[1].completed == 2 && buckets[1].peakInFlight == 3);
+        // The second request is still running when the bucket starts
+        CHECK(buckets[2].started == 0 && buckets[2].completed == 1 && buckets[2].peakInFlight == 1);
+    }
+    const EndpointStats* heap = Find(analyzer, "/heap");
+    CHECK(heap != nullptr && Percentile(heap->latenciesUs, 50) == 500000 && Percentile(heap->latenciesUs, 99) == 1100000);
+}
+
+static void VerifyBigEndianAndPortFilter() {
+    std::vector<Packet> packets;
+    Conversation diver(LinkEthernet, false, V4(1, 41003), V4(1, 9977), &packets);
+    diver.Send(1 * Second, true, Request("/ping", "1"));
+    diver.Send(2 * Second, false, Response("1", "{}"));
+    Conversation other(LinkEthernet, false, V4(1, 41004), V4(1, 8080), &packets);
+    other.Send(1 * Second, true, Request("/index.html", ""));
+    other.Send(2 * Second, false, Response("", "<html/>"));
+
+    RnetTrafficAnalyzer all;
+    Analyze(WritePcap(LinkEthernet, packets, true), &all);
+    CHECK(all.MatchedRequests() == 2);
+
+    RnetTrafficAnalyzer filtered;
+    filtered.ports.push_back(9977);
+    Analyze(WritePcap(LinkEthernet, packets, true), &filtered);
+    CHECK(filtered.MatchedRequests() == 1);
+    CHECK(Find(filtered, "/index.html") == nullptr);
+}
+
+static void VerifyTruncatedFile() {
+    std::vector<Packet> packets;
+    Conversation c(LinkEthernet, false, V4(1, 41005), V4(1, 9977), &packets);
+    c.Send(1 * Second, true, Request("/ping", "1"));
+    c.Send(2 * Second, false, Response("1", "{}"));
+    Bytes file = WritePcapng(LinkEthernet, packets);
+    file.resize(file.size() - 10);
+
+    CaptureStats stats;
+    RnetTrafficAnalyzer analyzer;
+    Analyze(file, &analyzer, &stats);
+    CHECK(stats.truncated);
+    CHECK(stats.packets == 1);
+    CHECK(analyzer.UnansweredRequests() == 1);
+
+    std::string error;
+    CaptureStats ignored;
+    CHECK(!ReadCapture((const uint8_t*)"not a capture", 13, &ignored, [](const TcpSegment&) {}, &error));
+}
+
+// ----------------
+// Benchmark
+// ----------------
+
+static void Bench(size_t megabytes) {
+    // Many connections with interleaved requests, like a fleet of clients hammering a diver
+    const int connections = 64;
+    Bytes smallBody = ToBytes("{\"value\":\"" + std::string(200, 'v') + "\"}");
+    std::string bigBody(60000, 'h');
+    std::vector<Packet> packets;
+    std::vector<Conversation> conversations;
+    conversations.reserve(connections);
+    for (int i = 0; i < connections; ++i) {
+        conversations.emplace_back(LinkEthernet, false, V4(1, (uint16_t)(40000 + i)), V4(2, 9977), &packets);
+        conversations.back().Syn(0);
+    }
+
+    // Built in chunks, the capture is written once
+    Bytes file = WritePcap(LinkEthernet, packets);
+    packets.clear();
+    uint64_t t = Second;
+    uint64_t requests = 0;
+    while (file.size() < megabytes * 1000000ull) {
+        for (int i = 0; i < connections; ++i) {
+            Conversation& c = conversations[i];
+            std::string id = std::to_string(requests++);
+            bool heap = requests % 50 == 0;
+            c.Send(t, true, Request(heap ? "/heap" : "/get_field", id));
+            Bytes response = heap ? Response(id, bigBody) : Response(id, std::string(smallBody.begin(), smallBody.end()));
+            // MSS sized segments
+            for (size_t offset = 0; offset < response.size(); offset += 1448) {
+                size_t end = std::min(response.size(), offset + 1448);
+                c.Send(t + 50000 + offset, false, Bytes(response.begin() + offset, response.begin() + end));
+            }
+            t += 7000;
+        }
+        Bytes chunk = WritePcap(LinkEthernet, packets);
+        file.insert(file.end(), chunk.begin() + 24, chunk.end());
+        packets.clear();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    RnetTrafficAnalyzer analyzer;
+    Analyze(file, &analyzer);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%.0f MB, %llu requests: %.2f s, %.0f MB/s, %.0f requests/s\n", file.size() / 1e6,
+        (unsigned long long)analyzer.MatchedRequests(), elapsed, file.size() / 1e6 / elapsed, analyzer.MatchedRequests() / elapsed);
+    CHECK(analyzer.MatchedRequests() == requests);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        Bench(argc > 2 ? (size_t)atoi(argv[2]) : 512);
+    } else {
+        VerifyPcapPairs();
+        VerifyPcapngOutOfOrderAndSplit();
+        VerifyReverseConnection();
+        VerifyGapResync();
+        VerifyHeadersSplitAtTerminator();
+        VerifyConcurrency();
+        VerifyBigEndianAndPortFilter();
+        VerifyTruncatedFile();
+    }
+
+    if (g_failures != 0) {
+        fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+using System.Collections.Concurrent;
+using System.Net.Sockets;
+using System.Threading.Channels;
+using ScubaDiver.API.Protocol.SimpleHttp;
+
+namespace Lifeboat;
+
+/// <summary>
+/// A connection (of either a client or the diver) which the relay reads whole frames from and writes whole frames to.
+/// Frames are written by a single writer so concurrent senders never interleave on the socket.
+/// </summary>
+public class RelayConnection : IDisposable
+{
+    private readonly TcpClient _client;
+    private readonly NetworkStream _stream;
+    private readonly SimpleHttpFrameReader _reader;
+    private readonly Channel<byte[]> _outgoing;
+    private readonly Task _writer;
+
+    public string Name { get; }
+
+    public RelayConnection(TcpClient client, SimpleHttpFrameReader reader, string name)
+    {
+        _client = client;
+        _stream = client.GetStream();
+        _reader = reader;
+        Name = name;
+        _outgoing = Channel.CreateUnbounded<byte[]>(new UnboundedChannelOptions() { SingleReader = true });
+        _writer = Task.Run(WriterLoop);
+    }
+
+    /// <returns>Next frame or null if the connection closed</returns>
+    public async Task<byte[]> ReadFrameAsync()
+    {
+        try
+        {
+            return await _reader.ReadFrameAsync(CancellationToken.None).ConfigureAwait(false);
+        }
+        catch (Exception ex) when (ex is IOException || ex is ObjectDisposedException)
+        {
+            return null;
+        }
+    }
+
+    /// <returns>False if the connection was disposed and the frame was dropped</returns>
+    public bool Send(byte[] frame) => _outgoing.Writer.TryWrite(frame);
+
+    private async Task WriterLoop()
+    {
+        try
+        {
+            await foreach (byte[] frame in _outgoing.Reader.ReadAllAsync().ConfigureAwait(false))
+            {
+                await _stream.WriteAsync(frame).ConfigureAwait(false);
+            }
+        }
+        catch (Exception ex) when (ex is IOException || ex is ObjectDisposedException)
+        {
+            // Connection closed. Reader will notice as well.
+        }
+    }
+
+    public void Dispose()
+    {
+        _outgoing.Writer.TryComplete();
+        try { _client.Close(); } catch { }
+        _reader.Dispose();
+    }
+}
+
+public class RelayClientConnection : RelayConnection
+{
+    // <Client's request ID to: Relay's request ID>
+    public ConcurrentDictionary<string, string> PendingRequests { get; } = new();
+
+    public RelayClientConnection(TcpClient client, SimpleHttpFrameReader reader, string name) : base(client, reader, name) { }
+}
+
+public class RelayDiverConnection : RelayConnection
+{
+    private int _inFlight;
+    public int InFlight => Volatile.Read(ref _inFlight);
+
+    private int _closed;
+    /// <summary>
+    /// Set once the relay stopped reading this connection's responses
+    /// </summary>
+    public bool Closed => Volatile.Read(ref _closed) != 0;
+
+    public RelayDiverConnection(TcpClient client, SimpleHttpFrameReader reader, string name) : base(client, reader, name) { }
+
+    public void RequestSent() => Interlocked.Increment(ref _inFlight);
+    public void ResponseReceived() => Interlocked.Decrement(ref _inFlight);
+    public void MarkClosed() => Interlocked.Exchange(ref _closed, 1);
+}
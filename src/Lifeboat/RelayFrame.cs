@@ -0,0 +1,144 @@
+using System.Text;
+
+namespace Lifeboat;
+
+/// <summary>
+/// Helpers for inspecting and patching raw SimpleHttp messages without decoding them.
+/// Only the header section is ever searched. Bodies are copied as-is.
+/// </summary>
+public static class RelayFrame
+{
+    private static readonly byte[] HeadersTerminator = { (byte)'\r', (byte)'\n', (byte)'\r', (byte)'\n' };
+
+    /// <returns>Length of the header section (including the empty line), or -1 if not found</returns>
+    public static int FindHeadersLength(byte[] frame)
+    {
+        int index = frame.AsSpan().IndexOf(HeadersTerminator);
+        return index == -1 ? -1 : index + HeadersTerminator.Length;
+    }
+
+    /// <summary>
+    /// Gets the path of a request (e.g., "/heap" for "GET /heap?type_filter=* HTTP/1.1")
+    /// </summary>
+    public static string GetPath(byte[] frame, int headersLength)
+    {
+        if (!TryGetTarget(frame, headersLength, out int targetStart, out int targetEnd))
+            return null;
+        int queryStart = frame.AsSpan(targetStart, targetEnd - targetStart).IndexOf((byte)'?');
+        int pathEnd = queryStart == -1 ? targetEnd : targetStart + queryStart;
+        return Encoding.ASCII.GetString(frame, targetStart, pathEnd - targetStart);
+    }
+
+    /// <summary>
+    /// Finds the (still URL-encoded) value of a query string parameter in a request's first line.
+    /// </summary>
+    public static bool TryFindQueryParameter(byte[] frame, int headersLength, string name, out int valueStart, out int valueLength)
+    {
+        valueStart = valueLength = 0;
+        if (!TryGetTarget(frame, headersLength, out int targetStart, out int targetEnd))
+            return false;
+
+        ReadOnlySpan<byte> target = frame.AsSpan(targetStart, targetEnd - targetStart);
+        int queryStart = target.IndexOf((byte)'?');
+        if (queryStart == -1)
+            return false;
+
+        int position = queryStart + 1;
+        while (position < target.Length)
+        {
+            int pairEnd = target.Slice(position).IndexOf((byte)'&');
+            pairEnd = pairEnd == -1 ? target.Length : position + pairEnd;
+
+            ReadOnlySpan<byte> pair = target.Slice(position, pairEnd - position);
+            int equals = pair.IndexOf((byte)'=');
+            if (equals == name.Length && AsciiEquals(pair.Slice(0, equals), name, ignoreCase: false))
+            {
+                valueStart = targetStart + position + equals + 1;
+                valueLength = pair.Length - equals - 1;
+                return true;
+            }
+
+            position = pairEnd + 1;
+        }
+        return false;
+    }
+
+    /// <summary>
+    /// Finds the value of a header (e.g., "requestId: 12") in a message's header section.
+    /// </summary>
+    public static bool TryFindHeader(byte[] frame, int headersLength, string name, out int valueStart, out int valueLength)
+    {
+        valueStart = valueLength = 0;
+        ReadOnlySpan<byte> headers = frame.AsSpan(0, headersLength);
+
+        // Skipping the request/status line
+        int lineStart = headers.IndexOf((byte)'\n') + 1;
+        while (lineStart > 0 && lineStart < headers.Length)
+        {
+            int lineLength = headers.Slice(lineStart).IndexOf((byte)'\r');
+            if (lineLength <= 0)
+                break;
+
+            ReadOnlySpan<byte> line = headers.Slice(lineStart, lineLength);
+            int colon = line.IndexOf((byte)':');
+            if (colon == name.Length && AsciiEquals(line.Slice(0, colon), name, ignoreCase: true))
+            {
+                int start = colon + 1;
+                while (start < line.Length && line[start] == (byte)' ')
+                    start++;
+                valueStart = lineStart + start;
+                valueLength = line.Length - start;
+                return true;
+            }
+
+            lineStart += lineLength + 2;
+        }
+        return false;
+    }
+
+    /// <summary>
+    /// Creates a copy of the frame where the range [start, start+length) is replaced with the ASCII bytes of <paramref name="value"/>.
+    /// </summary>
+    public static byte[] Replace(byte[] frame, int start, int length, string value)
+    {
+        byte[] patched = new byte[frame.Length - length + value.Length];
+        Buffer.BlockCopy(frame, 0, patched, 0, start);
+        Encoding.ASCII.GetBytes(value, 0, value.Length, patched, start);
+        Buffer.BlockCopy(frame, start + length, patched, start + value.Length, frame.Length - start - length);
+        return patched;
+    }
+
+    public static string GetAscii(byte[] frame, int start, int length) => Encoding.ASCII.GetString(frame, start, length);
+
+    private static bool TryGetTarget(byte[] frame, int headersLength, out int targetStart, out int targetEnd)
+    {
+        targetStart = targetEnd = 0;
+        ReadOnlySpan<byte> headers = frame.AsSpan(0, headersLength);
+        int lineEnd = headers.IndexOf((byte)'\r');
+        if (lineEnd == -1)
+            return false;
+
+        // <Method> <Target> HTTP/1.1
+        int firstSpace = headers.Slice(0, lineEnd).IndexOf((byte)' ');
+        int lastSpace = headers.Slice(0, lineEnd).LastIndexOf((byte)' ');
+        if (firstSpace == -1 || lastSpace <= firstSpace)
+            return false;
+
+        targetStart = firstSpace + 1;
+        targetEnd = lastSpace;
+        return true;
+    }
+
+    private static bool AsciiEquals(ReadOnlySpan<byte> bytes, string value, bool ignoreCase)
+    {
+        for (int i = 0; i < bytes.Length; i++)
+        {
+            char c = (char)bytes[i];
+            if (c == value[i])
+                continue;
+            if (!ignoreCase || char.ToLowerInvariant(c) != char.ToLowerInvariant(value[i]))
+                return false;
+        }
+        return true;
+    }
+}
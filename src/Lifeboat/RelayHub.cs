@@ -0,0 +1,265 @@
+using System.Collections.Concurrent;
+using System.Collections.Specialized;
+using System.Net;
+using System.Net.Sockets;
+using ScubaDiver.API.Protocol.SimpleHttp;
+
+namespace Lifeboat;
+
+/// <summary>
+/// Relays requests of many clients over a pool of reverse connections from the diver.
+/// Frames are never decoded. The relay only reads the request line/headers to find the 'requestId', replaces it with a
+/// relay-unique ID (clients' IDs collide) and forwards the frame. Bodies are copied untouched.
+/// </summary>
+public class RelayHub
+{
+    private record PendingRequest(RelayClientConnection Client, string ClientRequestId, RelayDiverConnection Diver);
+
+    private readonly int _port;
+
+    // Copy-on-write array so picking a diver connection doesn't need a lock
+    private readonly object _diversLock = new();
+    private RelayDiverConnection[] _divers = Array.Empty<RelayDiverConnection>();
+
+    // <Relay's request ID to: Request info>
+    private readonly ConcurrentDictionary<string, PendingRequest> _pending = new();
+    private long _nextRequestId = 10;
+    private int _nextConnectionId;
+
+    public RelayHub(int port)
+    {
+        _port = port;
+    }
+
+    public async Task RunAsync()
+    {
+        TcpListener listener = new TcpListener(IPAddress.Any, _port);
+        listener.Start();
+        Log("Waiting for diver and clients...");
+
+        while (true)
+        {
+            TcpClient tcpClient = await listener.AcceptTcpClientAsync().ConfigureAwait(false);
+            _ = HandleConnectionAsync(tcpClient);
+        }
+    }
+
+    private void Log(string msg) => Console.WriteLine($"[{_port}] " + msg);
+
+    private async Task HandleConnectionAsync(TcpClient tcpClient)
+    {
+        tcpClient.NoDelay = true;
+        string name = $"#{Interlocked.Increment(ref _nextConnectionId)} ({tcpClient.Client.RemoteEndPoint})";
+        SimpleHttpFrameReader reader = new SimpleHttpFrameReader(tcpClient.GetStream());
+
+        // The first frame tells us who's on the other side. Divers introduce themselves, clients just send requests.
+        byte[] first;
+        try
+        {
+            first = await reader.ReadFrameAsync(CancellationToken.None).ConfigureAwait(false);
+        }
+        catch (IOException)
+        {
+            first = null;
+        }
+        int headersLength = first != null ? RelayFrame.FindHeadersLength(first) : -1;
+        if (headersLength == -1)
+        {
+            Log($"Connection {name} closed prematurely");
+            reader.Dispose();
+            tcpClient.Close();
+            return;
+        }
+
+        if (IsDiverIntro(first, headersLength))
+        {
+            using RelayDiverConnection diver = new RelayDiverConnection(tcpClient, reader, name);
+            diver.Send(EncodeResponse(HttpStatusCode.OK, "{\"status\":\"OK\"}", GetRequestId(first, headersLength) ?? "999"));
+            AddDiver(diver);
+            Log($" ~~~~> Diver connection {name} added. Diver connections: {_divers.Length} <~~~~~");
+            await RunDiverAsync(diver).ConfigureAwait(false);
+            return;
+        }
+
+        using RelayClientConnection client = new RelayClientConnection(tcpClient, reader, name);
+        Log($"Client {name} connected");
+        await RunClientAsync(client, first).ConfigureAwait(false);
+        Log($"Client {name} disconnected");
+    }
+
+    private static bool IsDiverIntro(byte[] frame, int headersLength)
+    {
+        if (RelayFrame.GetPath(frame, headersLength) != "/proxy_intro")
+            return false;
+        string body = RelayFrame.GetAscii(frame, headersLength, frame.Length - headersLength);
+        return body == "{\"role\":\"diver\"}";
+    }
+
+    private static string GetRequestId(byte[] frame, int headersLength)
+    {
+        if (!RelayFrame.TryFindQueryParameter(frame, headersLength, "requestId", out int start, out int length))
+            return null;
+        return RelayFrame.GetAscii(frame, start, length);
+    }
+
+    #region Clients
+
+    private async Task RunClientAsync(RelayClientConnection client, byte[] firstFrame)
+    {
+        byte[] frame = firstFrame;
+        while (frame != null)
+        {
+            ForwardRequest(client, frame);
+            frame = await client.ReadFrameAsync().ConfigureAwait(false);
+        }
+
+        // Nobody will read the responses of this client's pending requests. Let the diver know.
+        foreach (KeyValuePair<string, string> kvp in client.PendingRequests)
+        {
+            if (_pending.TryGetValue(kvp.Value, out PendingRequest pending))
+                SendCancellation(pending.Diver, kvp.Value);
+        }
+    }
+
+    private void ForwardRequest(RelayClientConnection client, byte[] frame)
+    {
+        int headersLength = RelayFrame.FindHeadersLength(frame);
+        if (!RelayFrame.TryFindQueryParameter(frame, headersLength, "requestId", out int idStart, out int idLength))
+        {
+            Log($"Client {client.Name} sent a request without a 'requestId'. Dropping it.");
+            return;
+        }
+        string clientRequestId = RelayFrame.GetAscii(frame, idStart, idLength);
+        string relayRequestId = Interlocked.Increment(ref _nextRequestId).ToString();
+
+        // Cancellations must reach the same diver connection as the request they cancel
+        RelayDiverConnection diver = null;
+        if (RelayFrame.GetPath(frame, headersLength) == "/cancel_request" &&
+            RelayFrame.TryFindQueryParameter(frame, headersLength, "target_request_id", out int targetStart, out int targetLength) &&
+            client.PendingRequests.TryGetValue(RelayFrame.GetAscii(frame, targetStart, targetLength), out string relayTargetId) &&
+            _pending.TryGetValue(relayTargetId, out PendingRequest target))
+        {
+            diver = target.Diver;
+            // Patching the later parameter first so the earlier one's offsets stay valid
+            frame = targetStart > idStart
+                ? RelayFrame.Replace(RelayFrame.Replace(frame, targetStart, targetLength, relayTargetId), idStart, idLength, relayRequestId)
+                : RelayFrame.Replace(RelayFrame.Replace(frame, idStart, idLength, relayRequestId), targetStart, targetLength, relayTargetId);
+        }
+        else
+        {
+            diver = PickDiver();
+            frame = RelayFrame.Replace(frame, idStart, idLength, relayRequestId);
+        }
+
+        if (diver == null)
+        {
+            client.Send(EncodeResponse(HttpStatusCode.OK, "{\"error\":\"Lifeboat: No diver is connected\"}", clientRequestId));
+            return;
+        }
+
+        _pending[relayRequestId] = new PendingRequest(client, clientRequestId, diver);
+        client.PendingRequests[clientRequestId] = relayRequestId;
+        diver.RequestSent();
+        // The diver might have closed after it was picked, when its pending requests were already failed
+        if (!diver.Send(frame) || diver.Closed)
+            FailPending(relayRequestId);
+    }
+
+    #endregion
+
+    #region Divers
+
+    private void AddDiver(RelayDiverConnection diver)
+    {
+        lock (_diversLock)
+        {
+            _divers = _divers.Append(diver).ToArray();
+        }
+    }
+
+    private void RemoveDiver(RelayDiverConnection diver)
+    {
+        lock (_diversLock)
+        {
+            _divers = _divers.Where(d => d != diver).ToArray();
+        }
+    }
+
+    /// <returns>The diver connection with the least requests in-flight, or null if none are connected</returns>
+    private RelayDiverConnection PickDiver()
+    {
+        RelayDiverConnection[] divers = _divers;
+        RelayDiverConnection best = null;
+        foreach (RelayDiverConnection diver in divers)
+        {
+            if (best == null || diver.InFlight < best.InFlight)
+                best = diver;
+        }
+        return best;
+    }
+
+    private async Task RunDiverAsync(RelayDiverConnection diver)
+    {
+        byte[] frame;
+        while ((frame = await diver.ReadFrameAsync().ConfigureAwait(false)) != null)
+        {
+            int headersLength = RelayFrame.FindHeadersLength(frame);
+            if (!RelayFrame.TryFindHeader(frame, headersLength, "requestId", out int idStart, out int idLength))
+            {
+                Log($"Diver connection {diver.Name} sent a response without a 'requestId'. Dropping it.");
+                continue;
+            }
+
+            // Unknown IDs belong to requests the relay made on its own (e.g., cancellations)
+            if (!_pending.TryRemove(RelayFrame.GetAscii(frame, idStart, idLength), out PendingRequest pending))
+                continue;
+
+            diver.ResponseReceived();
+            pending.Client.PendingRequests.TryRemove(pending.ClientRequestId, out _);
+            pending.Client.Send(RelayFrame.Replace(frame, idStart, idLength, pending.ClientRequestId));
+        }
+
+        RemoveDiver(diver);
+        // Marked before failing the pending requests so requests registered after this loop notice it
+        diver.MarkClosed();
+        Log($"Diver connection {diver.Name} closed. Diver connections: {_divers.Length}");
+
+        // Fail whatever was waiting on this connection
+        foreach (KeyValuePair<string, PendingRequest> kvp in _pending.Where(kvp => kvp.Value.Diver == diver).ToList())
+        {
+            FailPending(kvp.Key);
+        }
+    }
+
+    private void FailPending(string relayRequestId)
+    {
+        // Either the diver's cleanup or the forwarding client gets to remove it, never both
+        if (!_pending.TryRemove(relayRequestId, out PendingRequest pending))
+            return;
+        pending.Client.PendingRequests.TryRemove(pending.ClientRequestId, out _);
+        pending.Client.Send(EncodeResponse(HttpStatusCode.OK, "{\"error\":\"Lifeboat: Diver connection closed\"}", pending.ClientRequestId));
+    }
+
+    private void SendCancellation(RelayDiverConnection diver, string relayTargetId)
+    {
+        NameValueCollection queryString = new NameValueCollection
+        {
+            ["target_request_id"] = relayTargetId,
+            ["requestId"] = Interlocked.Increment(ref _nextRequestId).ToString()
+        };
+        HttpRequestSummary cancelRequest = HttpRequestSummary.FromJson("/cancel_request", queryString, null);
+        if (SimpleHttpEncoder.TryEncodeHttpRequest(cancelRequest, out byte[] encoded))
+            diver.Send(encoded);
+    }
+
+    #endregion
+
+    private static byte[] EncodeResponse(HttpStatusCode status, string body, string requestId)
+    {
+        Dictionary<string, string> headers = new Dictionary<string, string>();
+        headers["requestId"] = requestId;
+        HttpResponseSummary response = HttpResponseSummary.FromJson(status, body, headers);
+        SimpleHttpEncoder.TryEncodeHttpResponse(response, out byte[] encoded);
+        return encoded;
+    }
+}
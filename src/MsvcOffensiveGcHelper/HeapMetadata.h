@@ -0,0 +1,274 @@
+// HeapMetadata.h: Object sizes from the heap's own metadata.
+// The offensive GC used to learn class sizes by hooking every `operator new` and matching the returned addresses
+// with constructor calls. Instead, the size of an object's heap block can be read from the block's header (_HEAP_ENTRY),
+// which the NT heap keeps right before every allocation. Headers are decoded with the heap's encoding key and checked
+// against their checksum and the heap's segments, so addresses which aren't heap blocks are rejected without calling
+// into the heap. Blocks the decoder can't read (LFH blocks, segment heap blocks) are left to a fallback (HeapSize).
+//
+// This header is portable (no Windows APIs). Memory is read through a callback so the parser can be tested on Linux
+// against captured heap segments.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Reads `size` bytes at `address`. Returns false if the memory isn't readable.
+typedef bool (*HeapMemoryReader)(void* context, uint64_t address, void* buffer, size_t size);
+
+// Size of the block at `address` in the heap at `heap`, or 0 if it isn't one of the heap's blocks
+typedef uint64_t (*HeapSizeFallback)(void* context, uint64_t heap, uint64_t address);
+
+static const uint32_t NtHeapSignature = 0xFFEEFFEE;
+static const uint32_t SegmentHeapSignature = 0xDDEEDDEE;
+
+static const uint8_t HeapEntryBusy = 0x01;
+static const uint8_t HeapEntryVirtualAlloc = 0x08;
+// Set in the (never encoded) UnusedBytes of LFH blocks
+static const uint8_t HeapEntryLfh = 0x80;
+
+// Heaps with more segments are cut short. Real heaps have a handful.
+static const size_t MaxHeapSegments = 256;
+
+// Field offsets of _HEAP, _HEAP_SEGMENT and _HEAP_ENTRY (Windows 10 and 11)
+struct NtHeapLayout {
+    uint32_t pointerSize;
+    uint32_t granularity;       // Heap unit. Also the size of a block's header.
+    uint32_t signature;         // _HEAP_SEGMENT.SegmentSignature
+    uint32_t encodeFlagMask;    // _HEAP.EncodeFlagMask
+    uint32_t encoding;          // _HEAP.Encoding, a _HEAP_ENTRY XORed over every header
+    uint32_t segmentList;       // _HEAP.SegmentList
+    uint32_t segmentListEntry;  // _HEAP_SEGMENT.SegmentListEntry
+    uint32_t firstEntry;        // _HEAP_SEGMENT.FirstEntry
+    uint32_t lastValidEntry;    // _HEAP_SEGMENT.LastValidEntry
+    // _HEAP_ENTRY.Size. Followed by Flags, SmallTagIndex (checksum), PreviousSize, SegmentOffset and UnusedBytes.
+    uint32_t entrySize;
+
+    static NtHeapLayout For(uint32_t pointerSize) {
+        if (pointerSize == 8) {
+            return NtHeapLayout{ 8, 16, 0x10, 0x7C, 0x80, 0x120, 0x18, 0x40, 0x48, 0x8 };
+        }
+        return NtHeapLayout{ 4, 8, 0x8, 0x4C, 0x50, 0xA4, 0x10, 0x24, 0x28, 0x0 };
+    }
+};
+
+enum class HeapKind {
+    Nt,
+    Segment,
+};
+
+struct HeapInfo {
+    uint64_t address;
+    HeapKind kind;
+    NtHeapLayout layout;
+    bool encoded;
+    uint8_t encoding[8];
+    // [FirstEntry, LastValidEntry) of every segment
+    std::vector<std::pair<uint64_t, uint64_t>> segments;
+
+    bool InSegments(uint64_t address) const {
+        for (const std::pair<uint64_t, uint64_t>& segment : segments) {
+            if (segment.first <= address && address < segment.second) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+enum class HeapBlockKind {
+    NotFound,
+    Backend,  // Size decoded from the header
+    Lfh,      // In the heap, but only the heap can tell the size
+};
+
+inline bool ReadHeapPointer(HeapMemoryReader read, void* context, uint64_t address, uint32_t pointerSize, uint64_t* value) {
+    *value = 0;
+    return read(context, address, value, pointerSize);
+}
+
+// Reads a heap's encoding and segments. Returns false if `heapAddress` isn't a heap.
+inline bool ReadHeapInfo(HeapMemoryReader read, void* context, uint64_t heapAddress, uint32_t pointerSize, HeapInfo* heap) {
+    heap->address = heapAddress;
+    heap->layout = NtHeapLayout::For(pointerSize);
+    heap->encoded = false;
+    heap->segments.clear();
+    const NtHeapLayout& layout = heap->layout;
+
+    uint32_t signature;
+    if (!read(context, heapAddress + layout.signature, &signature, sizeof(signature))) {
+        return false;
+    }
+    if (signature == SegmentHeapSignature) {
+        heap->kind = HeapKind::Segment;
+        return true;
+    }
+    if (signature != NtHeapSignature) {
+        return false;
+    }
+    heap->kind = HeapKind::Nt;
+
+    uint32_t encodeFlagMask;
+    if (!read(context, heapAddress + layout.encodeFlagMask, &encodeFlagMask, sizeof(encodeFlagMask)) ||
+        !read(context, heapAddress + layout.encoding + layout.entrySize, heap->encoding, sizeof(heap->encoding))) {
+        return false;
+    }
+    heap->encoded = encodeFlagMask != 0;
+
+    // The heap itself is the first segment, and every segment is in the list
+    uint64_t head = heapAddress + layout.segmentList;
+    uint64_t link;
+    if (!ReadHeapPointer(read, context, head, pointerSize, &link)) {
+        return false;
+    }
+    while (link != head && link != 0 && heap->segments.size() < MaxHeapSegments) {
+        uint64_t segment = link - layout.segmentListEntry;
+        uint64_t first;
+        uint64_t last;
+        if (!ReadHeapPointer(read, context, segment + layout.firstEntry, pointerSize, &first) ||
+            !ReadHeapPointer(read, context, segment + layout.lastValidEntry, pointerSize, &last) ||
+            !ReadHeapPointer(read, context, link, pointerSize, &link)) {
+            return false;
+        }
+        if (first < last) {
+            heap->segments.emplace_back(first, last);
+        }
+    }
+    return !heap->segments.empty();
+}
+
+// Decodes the header of the block `userAddress` was allocated at. `userSize` is the size asked for at allocation.
+inline HeapBlockKind DecodeHeapBlock(HeapMemoryReader read, void* context, const HeapInfo& heap, uint64_t userAddress, uint64_t* userSize) {
+    const NtHeapLayout& layout = heap.layout;
+    if (heap.kind != HeapKind::Nt || userAddress % layout.granularity != 0) {
+        return HeapBlockKind::NotFound;
+    }
+    uint64_t header = userAddress - layout.granularity;
+    if (!heap.InSegments(header)) {
+        return HeapBlockKind::NotFound;
+    }
+
+    uint8_t raw[8];
+    if (!read(context, header + layout.entrySize, raw, sizeof(raw))) {
+        return HeapBlockKind::NotFound;
+    }
+    uint8_t entry[8];
+    for (size_t i = 0; i < sizeof(entry); ++i) {
+        entry[i] = heap.encoded ? raw[i] ^ heap.encoding[i] : raw[i];
+    }
+
+    uint8_t checksum = entry[0] ^ entry[1] ^ entry[2];
+    uint8_t flags = entry[2];
+    if (checksum == entry[3] && (flags & HeapEntryBusy) && !(flags & HeapEntryVirtualAlloc)) {
+        uint64_t blockSize = (uint64_t)(entry[0] | (entry[1] << 8)) * layout.granularity;
+        // UnusedBytes counts the header too
+        uint64_t unused = entry[7];
+        if (unused >= layout.granularity && unused < blockSize) {
+            *userSize = blockSize - unused;
+            return HeapBlockKind::Backend;
+        }
+    }
+    // LFH headers are encoded with a key the heap doesn't hold
+    if (raw[7] & HeapEntryLfh) {
+        return HeapBlockKind::Lfh;
+    }
+    return HeapBlockKind::NotFound;
+}
+
+// ----------------
+// Sizes Cache
+// ----------------
+
+// Block sizes by vftable. Instances of a class are allocated with the same size, so one lookup per class is enough.
+class VftableSizeCache {
+public:
+    bool TryGet(uint64_t vftable, uint64_t* size) const {
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto it = m_sizes.find(vftable);
+        if (it == m_sizes.end()) {
+            return false;
+        }
+        *size = it->second;
+        return true;
+    }
+
+    void Add(uint64_t vftable, uint64_t size) {
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto it = m_sizes.find(vftable);
+        // Objects of derived classes may share the vftable's allocation site but never shrink it
+        if (it == m_sizes.end() || size < it->second) {
+            m_sizes[vftable] = size;
+        }
+    }
+
+    size_t Count() const {
+        std::lock_guard<std::mutex> guard(m_lock);
+        return m_sizes.size();
+    }
+
+private:
+    mutable std::mutex m_lock;
+    std::unordered_map<uint64_t, uint64_t> m_sizes;
+};
+
+// ----------------
+// Batch Queries
+// ----------------
+
+// Fills `sizes` with the block sizes of the objects at `addresses`, 0 where unknown, and returns how many were found.
+// `vftables` are the objects' cache keys. Without them each object's first pointer is used.
+inline size_t QueryObjectSizes(HeapMemoryReader read, HeapSizeFallback fallback, void* context, const std::vector<HeapInfo>& heaps,
+    VftableSizeCache& cache, const uint64_t* addresses, const uint64_t* vftables, size_t count, uint64_t* sizes) {
+    if (heaps.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            sizes[i] = 0;
+        }
+        return 0;
+    }
+    uint32_t pointerSize = heaps[0].layout.pointerSize;
+
+    size_t found = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t address = addresses[i];
+        sizes[i] = 0;
+        uint64_t vftable = 0;
+        if (vftables != nullptr) {
+            vftable = vftables[i];
+        } else {
+            ReadHeapPointer(read, context, address, pointerSize, &vftable);
+        }
+        if (vftable != 0 && cache.TryGet(vftable, &sizes[i])) {
+            ++found;
+            continue;
+        }
+
+        uint64_t size = 0;
+        for (const HeapInfo& heap : heaps) {
+            HeapBlockKind kind = DecodeHeapBlock(read, context, heap, address, &size);
+            if (kind == HeapBlockKind::Backend) {
+                break;
+            }
+            // Segment heaps are always asked, there's no cheap way to tell their blocks apart
+            if ((kind == HeapBlockKind::Lfh || heap.kind == HeapKind::Segment) && fallback != nullptr) {
+                size = fallback(context, heap.address, address);
+                if (size != 0) {
+                    break;
+                }
+            }
+            size = 0;
+        }
+        if (size == 0) {
+            continue;
+        }
+
+        sizes[i] = size;
+        ++found;
+        if (vftable != 0) {
+            cache.Add(vftable, size);
+        }
+    }
+    return found;
+}
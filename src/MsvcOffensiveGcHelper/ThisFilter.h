@@ -0,0 +1,198 @@
+// ThisFilter.h: Native `this` filter for detoured functions.
+// A detoured instance method normally enters managed code on every call, even when the client only hooked
+// one object. The filter stub sits between the detour and the managed hook: It checks the first argument
+// (`this`) against a set of addresses and only enters managed code on a hit. Misses jump straight to the original.
+//
+// This header is portable (no Windows APIs) so the set and the stub can be tested and benchmarked on Linux.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+// The stub calls ThisFilterContains with the Microsoft x64 calling convention
+#if defined(_WIN32)
+#define THIS_FILTER_STUB_CALL
+#else
+#define THIS_FILTER_STUB_CALL __attribute__((ms_abi))
+#endif
+
+// ----------------
+// Address Set
+// ----------------
+
+// Open addressing hash set. Immutable once published so lookups never lock.
+struct ThisFilterTable {
+    size_t mask;
+    uintptr_t slots[1]; // Actually `mask + 1` slots. 0 marks an empty slot.
+};
+
+class ThisFilter {
+public:
+    ThisFilter() {
+        m_table.store(AllocateTable(1), std::memory_order_release);
+    }
+
+    ~ThisFilter() {
+        free(m_table.load());
+        for (ThisFilterTable* table : m_retired) {
+            free(table);
+        }
+    }
+
+    ThisFilter(const ThisFilter&) = delete;
+    ThisFilter& operator=(const ThisFilter&) = delete;
+
+    bool Contains(uintptr_t address) const {
+        const ThisFilterTable* table = m_table.load(std::memory_order_acquire);
+        size_t i = Hash(address) & table->mask;
+        while (true) {
+            uintptr_t slot = table->slots[i];
+            if (slot == address) {
+                return address != 0;
+            }
+            if (slot == 0) {
+                return false;
+            }
+            i = (i + 1) & table->mask;
+        }
+    }
+
+    // Replaces the whole set. Callers are expected to be rare (hook registrations) so every change builds a new table.
+    void Set(const uintptr_t* addresses, size_t count) {
+        // Keeping the load under 50% so misses stop probing quickly
+        size_t capacity = 2;
+        while (capacity < count * 2) {
+            capacity *= 2;
+        }
+
+        ThisFilterTable* table = AllocateTable(capacity);
+        for (size_t n = 0; n < count; ++n) {
+            uintptr_t address = addresses[n];
+            if (address == 0) {
+                continue;
+            }
+            size_t i = Hash(address) & table->mask;
+            while (table->slots[i] != 0 && table->slots[i] != address) {
+                i = (i + 1) & table->mask;
+            }
+            table->slots[i] = address;
+        }
+
+        std::lock_guard<std::mutex> guard(m_writeLock);
+        ThisFilterTable* old = m_table.exchange(table, std::memory_order_acq_rel);
+        // Hooked threads might still be probing the old table. Tables are small and changes are rare,
+        // so they are only freed with the filter itself.
+        m_retired.push_back(old);
+    }
+
+private:
+    static size_t Hash(uintptr_t address) {
+        // Objects are at least 8 bytes aligned. Fibonacci hashing spreads the remaining bits.
+        uint64_t h = (uint64_t)(address >> 3) * 0x9E3779B97F4A7C15ull;
+        return (size_t)(h >> 17);
+    }
+
+    static ThisFilterTable* AllocateTable(size_t capacity) {
+        size_t size = offsetof(ThisFilterTable, slots) + capacity * sizeof(uintptr_t);
+        ThisFilterTable* table = (ThisFilterTable*)calloc(1, size);
+        table->mask = capacity - 1;
+        return table;
+    }
+
+    std::atomic<ThisFilterTable*> m_table;
+    std::mutex m_writeLock;
+    std::vector<ThisFilterTable*> m_retired;
+};
+
+inline bool THIS_FILTER_STUB_CALL ThisFilterContains(const ThisFilter* filter, uintptr_t address) {
+    return filter->Contains(address);
+}
+
+// ----------------
+// Stub
+// ----------------
+
+// Read by the stub's code, which follows it in memory (the code addresses these fields RIP-relative)
+struct ThisFilterStubData {
+    void* onHit;          // Managed hook
+    void* onMiss;         // Original function (Detours trampoline). Calls enter managed code until it's set.
+    ThisFilter* filter;
+    uint64_t passAll;     // Non-zero when some hook isn't instance specific
+    void* contains;       // ThisFilterContains
+};
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define THIS_FILTER_STUB_SUPPORTED 1
+
+// x64 (Microsoft ABI). All argument registers, including xmm0-3, are preserved for whichever target is jumped to.
+static const uint8_t ThisFilterStubCode[] = {
+    0x48, 0x83, 0x3D, 0xE8, 0xFF, 0xFF, 0xFF, 0x00, // cmp qword ptr [passAll], 0
+    0x75, 0x62,                                     // jne hit
+    0x48, 0x83, 0x3D, 0xCE, 0xFF, 0xFF, 0xFF, 0x00, // cmp qword ptr [onMiss], 0
+    0x74, 0x58,                                     // je hit
+    0x51,                                           // push rcx
+    0x52,                                           // push rdx
+    0x41, 0x50,                                     // push r8
+    0x41, 0x51,                                     // push r9
+    0x48, 0x83, 0xEC, 0x68,                         // sub rsp, 0x68 (shadow space + xmm0-3 + alignment)
+    0xF3, 0x0F, 0x7F, 0x44, 0x24, 0x20,             // movdqu [rsp+0x20], xmm0
+    0xF3, 0x0F, 0x7F, 0x4C, 0x24, 0x30,             // movdqu [rsp+0x30], xmm1
+    0xF3, 0x0F, 0x7F, 0x54, 0x24, 0x40,             // movdqu [rsp+0x40], xmm2
+    0xF3, 0x0F, 0x7F, 0x5C, 0x24, 0x50,             // movdqu [rsp+0x50], xmm3
+    0x48, 0x89, 0xCA,                               // mov rdx, rcx (this)
+    0x48, 0x8B, 0x0D, 0xA8, 0xFF, 0xFF, 0xFF,       // mov rcx, [filter]
+    0xFF, 0x15, 0xB2, 0xFF, 0xFF, 0xFF,             // call [contains]
+    0xF3, 0x0F, 0x6F, 0x44, 0x24, 0x20,             // movdqu xmm0, [rsp+0x20]
+    0xF3, 0x0F, 0x6F, 0x4C, 0x24, 0x30,             // movdqu xmm1, [rsp+0x30]
+    0xF3, 0x0F, 0x6F, 0x54, 0x24, 0x40,             // movdqu xmm2, [rsp+0x40]
+    0xF3, 0x0F, 0x6F, 0x5C, 0x24, 0x50,             // movdqu xmm3, [rsp+0x50]
+    0x48, 0x83, 0xC4, 0x68,                         // add rsp, 0x68
+    0x41, 0x59,                                     // pop r9
+    0x41, 0x58,                                     // pop r8
+    0x5A,                                           // pop rdx
+    0x59,                                           // pop rcx
+    0x84, 0xC0,                                     // test al, al
+    0x74, 0x06,                                     // je miss
+    0xFF, 0x25, 0x66, 0xFF, 0xFF, 0xFF,             // hit: jmp [onHit]
+    0xFF, 0x25, 0x68, 0xFF, 0xFF, 0xFF,             // miss: jmp [onMiss]
+};
+
+static const size_t ThisFilterStubSize = sizeof(ThisFilterStubData) + sizeof(ThisFilterStubCode);
+
+// Writes a stub into `memory` (ThisFilterStubSize bytes, must be executable) and returns its entry point.
+// The stub starts in pass-all mode (every call goes to `onHit`) with no miss target.
+inline void* WriteThisFilterStub(uint8_t* memory, void* onHit, ThisFilter* filter) {
+    ThisFilterStubData* data = (ThisFilterStubData*)memory;
+    data->onHit = onHit;
+    data->onMiss = nullptr;
+    data->filter = filter;
+    data->passAll = 1;
+    data->contains = (void*)&ThisFilterContains;
+
+    uint8_t* entry = memory + sizeof(ThisFilterStubData);
+    memcpy(entry, ThisFilterStubCode, sizeof(ThisFilterStubCode));
+    return entry;
+}
+
+#else
+// No stub for this architecture, detoured functions always enter managed code
+#define THIS_FILTER_STUB_SUPPORTED 0
+#endif
+
+inline ThisFilterStubData* GetThisFilterStubData(void* entry) {
+    return (ThisFilterStubData*)((uint8_t*)entry - sizeof(ThisFilterStubData));
+}
+
+// Points an existing stub at a new managed hook, for functions that are hooked again after being unhooked.
+// The stub goes back to pass-all mode with no miss target, like a newly written one.
+inline void RetargetThisFilterStub(void* entry, void* onHit) {
+    ThisFilterStubData* data = GetThisFilterStubData(entry);
+    data->passAll = 1;
+    data->onMiss = nullptr;
+    data->onHit = onHit;
+}
@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <windows.h>
+#include "ThisFilter.h"
+#include "HeapMetadata.h"
 
 // A macro to allow invocation with a format string
 #define msgboxf(format, ...) \
@@ -129,6 +131,98 @@ EXPORT int AllocateHookForModule(void* originalFree) {
     return -1;
 }
 
+// ----------------
+// `this` Filters
+// ----------------
+
+// Creates a filter stub (see ThisFilter.h) for a detoured function.
+// Stubs are never freed: A hooked thread might be running one at any time. Callers keep one stub per function
+// and reuse it (ReuseThisFilterStub) when the function is hooked again.
+extern "C" EXPORT void* CreateThisFilterStub(void* onHit) {
+#if THIS_FILTER_STUB_SUPPORTED
+    uint8_t* memory = (uint8_t*)VirtualAlloc(NULL, ThisFilterStubSize, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+    if (memory == NULL) {
+        debugf("[mogHelper][ERROR] CreateThisFilterStub failed to allocate stub memory. Error: %lu\n", GetLastError());
+        return NULL;
+    }
+    void* entry = WriteThisFilterStub(memory, onHit, new ThisFilter());
+    FlushInstructionCache(GetCurrentProcess(), memory, ThisFilterStubSize);
+    return entry;
+#else
+    return NULL;
+#endif
+}
+
+// Points a stub of an unhooked function at the managed hook of its new detour (see RetargetThisFilterStub).
+extern "C" EXPORT void ReuseThisFilterStub(void* stub, void* onHit) {
+    RetargetThisFilterStub(stub, onHit);
+}
+
+// Sets where misses go. Until then every call goes to the `onHit` target.
+extern "C" EXPORT void SetThisFilterMissTarget(void* stub, void* onMiss) {
+    GetThisFilterStubData(stub)->onMiss = onMiss;
+}
+
+// Replaces the addresses the stub lets through. With passAll, every call goes through and the addresses are ignored.
+extern "C" EXPORT void SetThisFilterAddresses(void* stub, const uintptr_t* addresses, int count, int passAll) {
+    ThisFilterStubData* data = GetThisFilterStubData(stub);
+    if (!passAll) {
+        // Addresses first so turning off pass-all never drops calls of the new set
+        data->filter->Set(addresses, (size_t)count);
+    }
+    data->passAll = passAll ? 1 : 0;
+}
+
+// ----------------
+// Object Sizes
+// ----------------
+
+// Sizes found for every vftable so far (see HeapMetadata.h)
+VftableSizeCache vftableSizes;
+
+// Addresses come from scans and hooks, they might not be mapped anymore
+bool SafeRead(void* context, uint64_t address, void* buffer, size_t size) {
+    __try {
+        memcpy(buffer, (const void*)(uintptr_t)address, size);
+        return true;
+    }
+    __except (EXCEPTION_EXECUTE_HANDLER) {
+        return false;
+    }
+}
+
+// For blocks only the heap can measure. HeapSize isn't safe on addresses outside the heap, so they're validated first.
+uint64_t HeapSizeIfValid(void* context, uint64_t heap, uint64_t address) {
+    HANDLE heapHandle = (HANDLE)(uintptr_t)heap;
+    const void* block = (const void*)(uintptr_t)address;
+    if (!HeapValidate(heapHandle, 0, block)) {
+        return 0;
+    }
+    SIZE_T size = HeapSize(heapHandle, 0, block);
+    return size == (SIZE_T)-1 ? 0 : (uint64_t)size;
+}
+
+// Writes the allocation sizes of the objects at `addresses` into `sizes` (0 where unknown) and returns how many were found.
+// Sizes are cached by `vftables`. If null, each object's first pointer is used.
+extern "C" EXPORT int QueryObjectSizes(const uint64_t* addresses, const uint64_t* vftables, int count, uint64_t* sizes) {
+    // Heaps come and go, so they're listed on each query
+    DWORD heapsCount = GetProcessHeaps(0, NULL);
+    std::vector<HANDLE> heapHandles(heapsCount);
+    heapsCount = GetProcessHeaps(heapsCount, heapHandles.data());
+
+    std::vector<HeapInfo> heaps;
+    for (DWORD i = 0; i < heapsCount && i < heapHandles.size(); ++i) {
+        HeapInfo heap;
+        if (ReadHeapInfo(SafeRead, NULL, (uint64_t)(uintptr_t)heapHandles[i], sizeof(void*), &heap)) {
+            heaps.push_back(heap);
+        }
+    }
+    if (heaps.empty()) {
+        debugf("[mogHelper][ERROR] QueryObjectSizes found none of the process' %lu heaps\n", heapsCount);
+    }
+    return (int)QueryObjectSizes(SafeRead, HeapSizeIfValid, NULL, heaps, vftableSizes, addresses, vftables, (size_t)count, sizes);
+}
+
 
 
 
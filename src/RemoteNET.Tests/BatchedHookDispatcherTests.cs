@@ -0,0 +1,123 @@
+using System.Net;
+using ScubaDiver.API;
+using ScubaDiver.API.Interactions.Callbacks;
+using ScubaDiver.Hooking;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class BatchedHookDispatcherTests
+    {
+        // Nothing listens there, every delivery fails
+        private static readonly IPEndPoint DeadEndpoint = new IPEndPoint(IPAddress.Loopback, 1);
+
+        private static CallbackInvocationRequest FakeEncode(int token, BatchedHookDispatcher.PendingInvocation invocation, List<ulong> pinned)
+        {
+            ulong address = 0x1000 + (ulong)(int)invocation.Parameters[0];
+            pinned.Add(address);
+            return new CallbackInvocationRequest()
+            {
+                Token = token,
+                ThreadID = invocation.ThreadId,
+                RetValue = ObjectOrRemoteAddress.Null,
+                Parameters = new List<ObjectOrRemoteAddress>() { ObjectOrRemoteAddress.FromToken(address, "Fake") }
+            };
+        }
+
+        private static BatchedHookDispatcher.PendingInvocation Invocation(int i) => new()
+        {
+            ThreadId = 1,
+            Parameters = new object[] { i }
+        };
+
+        [Test]
+        public void TryEnqueue_DoesNotEncodeOnHookedThread()
+        {
+            // Arrange
+            int encodingThread = 0;
+            using ManualResetEventSlim encoded = new ManualResetEventSlim();
+            using BatchedHookDispatcher dispatcher = new BatchedHookDispatcher(
+                (token, invocation, pinned) =>
+                {
+                    encodingThread = Environment.CurrentManagedThreadId;
+                    encoded.Set();
+                    return FakeEncode(token, invocation, pinned);
+                },
+                (clientId, address) => { },
+                addresses => { });
+            dispatcher.Register(1, DeadEndpoint, 16, null);
+
+            // Act
+            bool accepted = dispatcher.TryEnqueue(1, Invocation(0));
+
+            // Assert
+            Assert.That(accepted, Is.True);
+            Assert.That(encoded.Wait(TimeSpan.FromSeconds(5)), Is.True);
+            Assert.That(encodingThread, Is.Not.EqualTo(Environment.CurrentManagedThreadId));
+        }
+
+        [Test]
+        public void Flush_DeliveryFails_UnpinsBatch()
+        {
+            // Arrange
+            List<ulong> unpinned = new List<ulong>();
+            List<ulong> leased = new List<ulong>();
+            using ManualResetEventSlim unpinnedEvent = new ManualResetEventSlim();
+            using BatchedHookDispatcher dispatcher = new BatchedHookDispatcher(
+                FakeEncode,
+                (clientId, address) => { lock (leased) leased.Add(address); },
+                addresses =>
+                {
+                    lock (unpinned) unpinned.AddRange(addresses);
+                    unpinnedEvent.Set();
+                });
+            dispatcher.Register(1, DeadEndpoint, 16, 1234);
+
+            // Act
+            dispatcher.TryEnqueue(1, Invocation(1));
+            dispatcher.TryEnqueue(1, Invocation(2));
+
+            // Assert
+            Assert.That(unpinnedEvent.Wait(TimeSpan.FromSeconds(5)), Is.True);
+            lock (unpinned)
+                Assert.That(unpinned, Is.EquivalentTo(new[] { 0x1001UL, 0x1002UL }));
+            lock (leased)
+                Assert.That(leased, Is.Empty);
+        }
+
+        [Test]
+        public void TryEnqueue_RingFull_DroppedInvocationsAreNeverPinned()
+        {
+            // Arrange
+            int encodedCount = 0;
+            using ManualResetEventSlim release = new ManualResetEventSlim();
+            using BatchedHookDispatcher dispatcher = new BatchedHookDispatcher(
+                (token, invocation, pinned) =>
+                {
+                    // Holds the delivery thread so the ring fills up
+                    release.Wait();
+                    Interlocked.Increment(ref encodedCount);
+                    return FakeEncode(token, invocation, pinned);
+                },
+                (clientId, address) => { },
+                addresses => { });
+            dispatcher.Register(1, DeadEndpoint, 4, null);
+
+            // Act
+            dispatcher.TryEnqueue(1, Invocation(0));
+            Thread.Sleep(200);
+            int accepted = 0;
+            for (int i = 1; i <= 20; i++)
+            {
+                if (dispatcher.TryEnqueue(1, Invocation(i)))
+                    accepted++;
+            }
+            release.Set();
+            Thread.Sleep(500);
+
+            // Assert
+            Assert.That(accepted, Is.LessThanOrEqualTo(4));
+            Assert.That(encodedCount, Is.LessThanOrEqualTo(1 + 4));
+        }
+    }
+}
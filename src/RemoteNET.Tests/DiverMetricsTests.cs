@@ -0,0 +1,132 @@
+using System.Diagnostics;
+using ScubaDiver;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class DiverMetricsTests
+    {
+        private static long Ticks(double seconds) => (long)(seconds * Stopwatch.Frequency);
+
+        [Test]
+        public void Export_Histogram_BucketsAreCumulative()
+        {
+            // Arrange
+            DiverMetrics metrics = new DiverMetrics();
+            EndpointMetrics ping = metrics.ForEndpoint("/ping");
+            ping.HandlerTime.Record(Ticks(0.0002));
+            ping.HandlerTime.Record(Ticks(0.003));
+            ping.HandlerTime.Record(Ticks(100));
+
+            // Act
+            string text = metrics.Export();
+
+            // Assert
+            Assert.That(text, Does.Contain("# TYPE diver_request_handler_seconds histogram\n"));
+            Assert.That(text, Does.Contain("diver_request_handler_seconds_bucket{endpoint=\"/ping\",le=\"0.0005\"} 1\n"));
+            Assert.That(text, Does.Contain("diver_request_handler_seconds_bucket{endpoint=\"/ping\",le=\"0.005\"} 2\n"));
+            Assert.That(text, Does.Contain("diver_request_handler_seconds_bucket{endpoint=\"/ping\",le=\"30\"} 2\n"));
+            Assert.That(text, Does.Contain("diver_request_handler_seconds_bucket{endpoint=\"/ping\",le=\"+Inf\"} 3\n"));
+            Assert.That(text, Does.Contain("diver_request_handler_seconds_count{endpoint=\"/ping\"} 3\n"));
+        }
+
+        [Test]
+        public void Export_Counters_PerEndpoint()
+        {
+            // Arrange
+            DiverMetrics metrics = new DiverMetrics();
+            metrics.ForEndpoint("/ping").RecordResponse(18, failed: false);
+            metrics.ForEndpoint("/ping").RecordResponse(18, failed: false);
+            metrics.ForEndpoint("/heap").RecordResponse(40, failed: true);
+
+            // Act
+            string text = metrics.Export();
+
+            // Assert
+            Assert.That(text, Does.Contain("diver_requests_total{endpoint=\"/ping\"} 2\n"));
+            Assert.That(text, Does.Contain("diver_requests_total{endpoint=\"/heap\"} 1\n"));
+            Assert.That(text, Does.Contain("diver_request_failures_total{endpoint=\"/ping\"} 0\n"));
+            Assert.That(text, Does.Contain("diver_request_failures_total{endpoint=\"/heap\"} 1\n"));
+            Assert.That(text, Does.Contain("diver_response_bytes_total{endpoint=\"/ping\"} 36\n"));
+        }
+
+        [Test]
+        public void Export_GaugesAndScans()
+        {
+            // Arrange
+            DiverMetrics metrics = new DiverMetrics();
+            int pinned = 3;
+            metrics.AddGauge("diver_pinned_objects", "Pinned", () => pinned);
+            metrics.AddGauge("diver_requests_queued", "Queued", () => new[] { (DiverMetrics.Label("lane", "bulk"), 2.0) });
+            metrics.AddGauge("diver_broken", "Throws", (Func<double>)(() => throw new InvalidOperationException()));
+            metrics.RecordScan("instances", TimeSpan.FromMilliseconds(1500));
+            pinned = 5;
+
+            // Act
+            string text = metrics.Export();
+
+            // Assert
+            Assert.That(text, Does.Contain("# TYPE diver_pinned_objects gauge\ndiver_pinned_objects 5\n"));
+            Assert.That(text, Does.Contain("diver_requests_queued{lane=\"bulk\"} 2\n"));
+            Assert.That(text, Does.Not.Contain("diver_broken"));
+            Assert.That(text, Does.Contain("diver_scans_total{kind=\"instances\"} 1\n"));
+            Assert.That(text, Does.Contain("diver_last_scan_duration_seconds{kind=\"instances\"} 1.5"));
+        }
+
+        [Test]
+        public void Label_EscapesQuotesAndBackslashes()
+        {
+            // Act
+            string label = DiverMetrics.Label("endpoint", "a\"b\\c\nd");
+
+            // Assert
+            Assert.That(label, Is.EqualTo("endpoint=\"a\\\"b\\\\c\\nd\""));
+        }
+
+        [Test]
+        public void Record_Concurrently_NoneLost()
+        {
+            // Arrange
+            DiverMetrics metrics = new DiverMetrics();
+            EndpointMetrics endpoint = metrics.ForEndpoint("/invoke");
+
+            // Act
+            Parallel.For(0, 100_000, i =>
+            {
+                endpoint.HandlerTime.Record(i % 1000);
+                endpoint.RecordResponse(1, failed: false);
+            });
+
+            // Assert
+            Assert.That(endpoint.HandlerTime.Count, Is.EqualTo(100_000));
+            Assert.That(endpoint.Requests, Is.EqualTo(100_000));
+            Assert.That(endpoint.BytesOut, Is.EqualTo(100_000));
+        }
+
+        [Test]
+        [Explicit("Benchmark")]
+        public void Record_Overhead()
+        {
+            // Arrange
+            const int iterations = 10_000_000;
+            DiverMetrics metrics = new DiverMetrics();
+            Stopwatch sw = Stopwatch.StartNew();
+
+            // Act
+            for (int i = 0; i < iterations; i++)
+            {
+                EndpointMetrics endpoint = metrics.ForEndpoint("/get_field");
+                endpoint.QueueTime.Record(i & 0xFFFF);
+                endpoint.HandlerTime.Record(i & 0xFFFF);
+                endpoint.SerializationTime.Record(i & 0xFFFF);
+                endpoint.RecordResponse(64, failed: false);
+            }
+            sw.Stop();
+
+            // Assert
+            double nsPerRequest = sw.Elapsed.TotalMilliseconds * 1_000_000 / iterations;
+            TestContext.Out.WriteLine($"Metrics overhead: {nsPerRequest:F1}ns per request");
+            Assert.That(nsPerRequest, Is.GreaterThan(0));
+        }
+    }
+}
@@ -0,0 +1,89 @@
+using ScubaDiver;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class EnumerationCursorsTests
+    {
+        private DateTime _now;
+        private EnumerationCursors _cursors;
+
+        [SetUp]
+        public void SetUp()
+        {
+            _now = new DateTime(2024, 1, 1, 0, 0, 0, DateTimeKind.Utc);
+            _cursors = new EnumerationCursors(TimeSpan.FromMinutes(1), () => _now);
+        }
+
+        [Test]
+        public void TryRead_Pages_ContinueWhereLastPageEnded()
+        {
+            // Arrange
+            long cursor = _cursors.Open(Enumerable.Range(0, 5).GetEnumerator());
+            List<object> first = new();
+            List<object> second = new();
+
+            // Act
+            bool readFirst = _cursors.TryRead(cursor, 3, first, out bool firstDone);
+            bool readSecond = _cursors.TryRead(cursor, 3, second, out bool secondDone);
+
+            // Assert
+            Assert.That(readFirst && readSecond, Is.True);
+            Assert.That(first, Is.EqualTo(new object[] { 0, 1, 2 }));
+            Assert.That(second, Is.EqualTo(new object[] { 3, 4 }));
+            Assert.That(firstDone, Is.False);
+            Assert.That(secondDone, Is.True);
+            // Finished cursors are closed
+            Assert.That(_cursors.Count, Is.Zero);
+            Assert.That(_cursors.TryRead(cursor, 3, new List<object>(), out _), Is.False);
+        }
+
+        [Test]
+        public void Close_OpenCursor_DisposesEnumerator()
+        {
+            // Arrange
+            bool disposed = false;
+            IEnumerable<int> Items()
+            {
+                try
+                {
+                    yield return 1;
+                    yield return 2;
+                }
+                finally
+                {
+                    disposed = true;
+                }
+            }
+            long cursor = _cursors.Open(Items().GetEnumerator());
+            _cursors.TryRead(cursor, 1, new List<object>(), out _);
+
+            // Act
+            bool closed = _cursors.Close(cursor);
+
+            // Assert
+            Assert.That(closed, Is.True);
+            Assert.That(disposed, Is.True);
+            Assert.That(_cursors.Close(cursor), Is.False);
+        }
+
+        [Test]
+        public void CloseIdle_OnlyCursorsNotReadRecently()
+        {
+            // Arrange
+            long idle = _cursors.Open(Enumerable.Range(0, 10).GetEnumerator());
+            long active = _cursors.Open(Enumerable.Range(0, 10).GetEnumerator());
+
+            // Act
+            _now += TimeSpan.FromSeconds(45);
+            _cursors.TryRead(active, 1, new List<object>(), out _);
+            _now += TimeSpan.FromSeconds(30);
+            int closed = _cursors.CloseIdle();
+
+            // Assert
+            Assert.That(closed, Is.EqualTo(1));
+            Assert.That(_cursors.TryRead(idle, 1, new List<object>(), out _), Is.False);
+            Assert.That(_cursors.TryRead(active, 1, new List<object>(), out _), Is.True);
+        }
+    }
+}
@@ -0,0 +1,234 @@
+using System.Diagnostics;
+using System.Net;
+using System.Net.Sockets;
+using RemoteNET.Utils;
+using ScubaDiver;
+using ScubaDiver.API;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class FanOutTests
+    {
+        [Test]
+        public void Run_NeverExceedsMaxParallelism()
+        {
+            // Arrange
+            FanOut<int> fanOut = new FanOut<int>(3, Timeout.InfiniteTimeSpan);
+            int running = 0;
+            int maxRunning = 0;
+
+            // Act
+            List<FanOutResult<int, int>> results = fanOut.Run(Enumerable.Range(0, 20).ToList(), (target, _) =>
+            {
+                int now = Interlocked.Increment(ref running);
+                InterlockedMax(ref maxRunning, now);
+                Thread.Sleep(10);
+                Interlocked.Decrement(ref running);
+                return target * 2;
+            }).ToList();
+
+            // Assert
+            Assert.That(maxRunning, Is.LessThanOrEqualTo(3));
+            Assert.That(results.Select(r => r.Value).OrderBy(v => v), Is.EqualTo(Enumerable.Range(0, 20).Select(i => i * 2)));
+            Assert.That(results.All(r => r.Succeeded), Is.True);
+        }
+
+        [Test]
+        public void Run_SlowTargetTimesOut_OthersSucceed()
+        {
+            // Arrange
+            FanOut<int> fanOut = new FanOut<int>(4, TimeSpan.FromMilliseconds(200));
+            Stopwatch sw = Stopwatch.StartNew();
+
+            // Act
+            List<FanOutResult<int, int>> results = fanOut.Run(new[] { 0, 1, 2, 3 }, (target, token) =>
+            {
+                if (target == 2)
+                    token.WaitHandle.WaitOne(TimeSpan.FromSeconds(10));
+                return target;
+            }).ToList();
+            sw.Stop();
+
+            // Assert
+            Assert.That(results, Has.Count.EqualTo(4));
+            Assert.That(results.Single(r => r.Target == 2).TimedOut, Is.True);
+            Assert.That(results.Where(r => r.Target != 2).All(r => r.Succeeded), Is.True);
+            Assert.That(sw.Elapsed, Is.LessThan(TimeSpan.FromSeconds(5)));
+        }
+
+        [Test]
+        public void Run_TargetThrows_ErrorReportedForThatTargetOnly()
+        {
+            // Arrange
+            FanOut<string> fanOut = new FanOut<string>(2, Timeout.InfiniteTimeSpan);
+
+            // Act
+            List<FanOutResult<string, int>> results = fanOut.Run(new[] { "ok", "bad", "ok2" }, (target, _) =>
+            {
+                if (target == "bad")
+                    throw new InvalidOperationException("Diver is gone");
+                return target.Length;
+            }).ToList();
+
+            // Assert
+            FanOutResult<string, int> bad = results.Single(r => r.Target == "bad");
+            Assert.That(bad.Succeeded, Is.False);
+            Assert.That(bad.Error, Is.TypeOf<InvalidOperationException>());
+            Assert.That(bad.Index, Is.EqualTo(1));
+            Assert.That(results.Where(r => r.Target != "bad").All(r => r.Succeeded), Is.True);
+        }
+
+        [Test]
+        public void Run_ResultsStreamedAsTargetsRespond()
+        {
+            // Arrange
+            FanOut<int> fanOut = new FanOut<int>(2, Timeout.InfiniteTimeSpan);
+            int[] delaysMs = { 500, 10 };
+
+            // Act
+            List<int> order = fanOut.Run(new[] { 0, 1 }, (target, _) =>
+            {
+                Thread.Sleep(delaysMs[target]);
+                return target;
+            }).Select(r => r.Target).ToList();
+
+            // Assert
+            Assert.That(order, Is.EqualTo(new[] { 1, 0 }));
+        }
+
+        [Test]
+        public void Run_StoppedEarly_CancelsRemainingTargets()
+        {
+            // Arrange
+            FanOut<int> fanOut = new FanOut<int>(2, Timeout.InfiniteTimeSpan);
+            int canceled = 0;
+
+            // Act
+            FanOutResult<int, int> first = fanOut.Run(new[] { 0, 1 }, (target, token) =>
+            {
+                if (target == 1 && token.WaitHandle.WaitOne(TimeSpan.FromSeconds(10)))
+                    Interlocked.Increment(ref canceled);
+                return target;
+            }).First();
+            SpinWait.SpinUntil(() => Volatile.Read(ref canceled) == 1, TimeSpan.FromSeconds(5));
+
+            // Assert
+            Assert.That(first.Target, Is.EqualTo(0));
+            Assert.That(canceled, Is.EqualTo(1));
+        }
+
+        [Test]
+        public void Run_TargetRespondsAfterTimeout_LateValueDiscarded()
+        {
+            // Arrange
+            FanOut<int> fanOut = new FanOut<int>(2, TimeSpan.FromMilliseconds(100));
+            using ManualResetEventSlim discarded = new ManualResetEventSlim();
+            int discardedValue = 0;
+
+            // Act
+            List<FanOutResult<int, int>> results = fanOut.Run(new[] { 0, 1 }, (target, _) =>
+            {
+                // Ignores its token, like a connection attempt that can't be interrupted
+                if (target == 1)
+                    Thread.Sleep(500);
+                return target + 10;
+            }, onDiscarded: value =>
+            {
+                discardedValue = value;
+                discarded.Set();
+            }).ToList();
+
+            // Assert
+            Assert.That(results.Single(r => r.Target == 1).TimedOut, Is.True);
+            Assert.That(discarded.Wait(TimeSpan.FromSeconds(5)), Is.True);
+            Assert.That(discardedValue, Is.EqualTo(11));
+        }
+
+        [Test]
+        public void Run_StoppedEarly_UndeliveredValuesDiscarded()
+        {
+            // Arrange
+            FanOut<int> fanOut = new FanOut<int>(4, Timeout.InfiniteTimeSpan);
+            List<int> discarded = new List<int>();
+
+            // Act
+            FanOutResult<int, int> first = fanOut.Run(new[] { 0, 1, 2, 3 }, (target, _) => target,
+                onDiscarded: value => { lock (discarded) discarded.Add(value); }).First();
+            // Values of queries the stop caught mid-flight are discarded once they return
+            SpinWait.SpinUntil(() => { lock (discarded) return discarded.Count == 3; }, TimeSpan.FromSeconds(5));
+
+            // Assert
+            lock (discarded)
+                Assert.That(discarded, Is.EquivalentTo(new[] { 0, 1, 2, 3 }.Where(t => t != first.Target)));
+        }
+
+        [Test]
+        public void Run_StandInDivers_FanOutFasterThanSequential()
+        {
+            // Arrange
+            const int diversCount = 16;
+            TimeSpan responseDelay = TimeSpan.FromMilliseconds(20);
+            List<(RequestsScheduler scheduler, RnetRequestsListener listener)> divers = new();
+            List<DiverCommunicator> communicators = new();
+            for (int i = 0; i < diversCount; i++)
+            {
+                ushort port = GetFreePort();
+                RequestsScheduler scheduler = new RequestsScheduler("StandIn", msg =>
+                {
+                    Thread.Sleep(responseDelay);
+                    msg.ResponseSender("{\"status\":\"pong\"}");
+                }, _ => false);
+                RnetRequestsListener listener = new RnetRequestsListener(port);
+                listener.RequestReceived += (_, msg) => scheduler.Schedule(msg);
+                listener.Start();
+                divers.Add((scheduler, listener));
+                communicators.Add(new DiverCommunicator("127.0.0.1", port));
+            }
+            // Open all connections before timing
+            Assert.That(communicators.All(c => c.CheckAliveness()), Is.True);
+            FanOut<DiverCommunicator> fanOut = new FanOut<DiverCommunicator>(8, TimeSpan.FromSeconds(10));
+
+            // Act
+            Stopwatch sw = Stopwatch.StartNew();
+            int sequentialAlive = communicators.Count(c => c.CheckAliveness());
+            TimeSpan sequential = sw.Elapsed;
+            sw.Restart();
+            int fanOutAlive = fanOut.Run(communicators, (c, _) => c.CheckAliveness()).Count(r => r.Succeeded && r.Value);
+            TimeSpan parallel = sw.Elapsed;
+            TestContext.Out.WriteLine($"{diversCount} divers: sequential {diversCount / sequential.TotalSeconds:N0} requests/sec, " +
+                                      $"fan-out {diversCount / parallel.TotalSeconds:N0} requests/sec");
+
+            // Assert
+            Assert.That(sequentialAlive, Is.EqualTo(diversCount));
+            Assert.That(fanOutAlive, Is.EqualTo(diversCount));
+            Assert.That(parallel, Is.LessThan(sequential));
+
+            communicators.ForEach(c => c.Dispose());
+            foreach ((RequestsScheduler scheduler, RnetRequestsListener listener) in divers)
+            {
+                listener.Stop();
+                listener.Dispose();
+                scheduler.Dispose();
+            }
+        }
+
+        private static void InterlockedMax(ref int target, int value)
+        {
+            int current;
+            while ((current = Volatile.Read(ref target)) < value &&
+                   Interlocked.CompareExchange(ref target, value, current) != current)
+            {
+            }
+        }
+
+        private static ushort GetFreePort()
+        {
+            TcpListener l = new TcpListener(IPAddress.Loopback, 0);
+            l.Start();
+            int port = ((IPEndPoint)l.LocalEndpoint).Port;
+            l.Stop();
+            return (ushort)port;
+        }
+    }
+}
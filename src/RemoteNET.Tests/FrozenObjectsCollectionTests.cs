@@ -0,0 +1,93 @@
+using ScubaDiver;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class FrozenObjectsCollectionTests
+    {
+        [Test]
+        public void PinMany_MoreObjectsThanBucket_AllPinnedAtDistinctAddresses()
+        {
+            // Arrange
+            FrozenObjectsCollection freezer = new FrozenObjectsCollection();
+            List<object> objects = Enumerable.Range(0, FrozenObjectsCollection.BucketCapacity * 2 + 10)
+                .Select(i => (object)new object()).ToList();
+            try
+            {
+                // Act
+                ulong[] addresses = freezer.PinMany(objects);
+
+                // Assert
+                Assert.That(addresses.Distinct().Count(), Is.EqualTo(objects.Count));
+                for (int i = 0; i < objects.Count; i++)
+                {
+                    Assert.That(freezer.TryGetPinnedObject(addresses[i], out object pinned), Is.True);
+                    Assert.That(pinned, Is.SameAs(objects[i]));
+                }
+            }
+            finally
+            {
+                freezer.UnpinAll();
+            }
+        }
+
+        [Test]
+        public void UnpinMany_SomeObjects_OthersKeepTheirAddresses()
+        {
+            // Arrange
+            FrozenObjectsCollection freezer = new FrozenObjectsCollection();
+            List<object> objects = Enumerable.Range(0, 300).Select(i => (object)new byte[16]).ToList();
+            try
+            {
+                ulong[] addresses = freezer.PinMany(objects);
+                ulong[] toUnpin = addresses.Where((_, i) => i % 3 == 0).ToArray();
+
+                // Act
+                GC.Collect();
+                List<ulong> notPinned = freezer.UnpinMany(toUnpin.Append(0x1234ul));
+                GC.Collect();
+
+                // Assert
+                Assert.That(notPinned, Is.EqualTo(new[] { 0x1234ul }));
+                for (int i = 0; i < objects.Count; i++)
+                {
+                    bool shouldBePinned = i % 3 != 0;
+                    Assert.That(freezer.TryGetPinnedObject(addresses[i], out _), Is.EqualTo(shouldBePinned));
+                    if (shouldBePinned)
+                    {
+                        Assert.That(freezer.TryGetPinningAddress(objects[i], out ulong address), Is.True);
+                        Assert.That(address, Is.EqualTo(addresses[i]));
+                    }
+                }
+            }
+            finally
+            {
+                freezer.UnpinAll();
+            }
+        }
+
+        [Test]
+        public void Pin_EqualButDistinctObjects_PinnedSeparately()
+        {
+            // Arrange
+            FrozenObjectsCollection freezer = new FrozenObjectsCollection();
+            string first = new string('a', 4);
+            string second = new string('a', 4);
+            try
+            {
+                // Act
+                ulong firstAddress = freezer.Pin(first);
+                ulong secondAddress = freezer.Pin(second);
+                ulong firstAgain = freezer.Pin(first);
+
+                // Assert
+                Assert.That(secondAddress, Is.Not.EqualTo(firstAddress));
+                Assert.That(firstAgain, Is.EqualTo(firstAddress));
+            }
+            finally
+            {
+                freezer.UnpinAll();
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+using ScubaDiver.Hooking;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class HookInvocationRingTests
+    {
+        [Test]
+        public void DrainTo_AfterEnqueues_ReturnsItemsInOrder()
+        {
+            // Arrange
+            HookInvocationRing<string> ring = new HookInvocationRing<string>(8);
+            for (int i = 0; i < 5; i++)
+                ring.TryEnqueue(i.ToString());
+
+            // Act
+            List<string> drained = new List<string>();
+            int count = ring.DrainTo(drained, 100);
+
+            // Assert
+            Assert.That(count, Is.EqualTo(5));
+            Assert.That(drained, Is.EqualTo(new[] { "0", "1", "2", "3", "4" }));
+            Assert.That(ring.Count, Is.EqualTo(0));
+        }
+
+        [Test]
+        public void TryEnqueue_RingFull_DropsAndCounts()
+        {
+            // Arrange
+            HookInvocationRing<string> ring = new HookInvocationRing<string>(4);
+            for (int i = 0; i < 4; i++)
+                Assert.That(ring.TryEnqueue(i.ToString()), Is.True);
+
+            // Act
+            bool accepted = ring.TryEnqueue("overflow");
+            ring.TryEnqueue("overflow");
+
+            // Assert
+            Assert.That(accepted, Is.False);
+            Assert.That(ring.DroppedCount, Is.EqualTo(2));
+            List<string> drained = new List<string>();
+            ring.DrainTo(drained, 100);
+            Assert.That(drained, Does.Not.Contain("overflow"));
+            // Freed cells are reusable
+            Assert.That(ring.TryEnqueue("after"), Is.True);
+        }
+
+        [Test]
+        public void TryEnqueue_ConcurrentProducers_NothingLostOrDuplicated()
+        {
+            // Arrange
+            const int producers = 4;
+            const int perProducer = 50_000;
+            HookInvocationRing<string> ring = new HookInvocationRing<string>(1024);
+            HashSet<string> received = new HashSet<string>();
+            long dropped = 0;
+
+            // Act
+            Task[] tasks = Enumerable.Range(0, producers).Select(p => Task.Run(() =>
+            {
+                for (int i = 0; i < perProducer; i++)
+                    ring.TryEnqueue($"{p}:{i}");
+            })).ToArray();
+            List<string> drained = new List<string>();
+            while (!tasks.All(t => t.IsCompleted) || ring.Count > 0)
+            {
+                drained.Clear();
+                ring.DrainTo(drained, 256);
+                foreach (string item in drained)
+                    Assert.That(received.Add(item), Is.True, $"Duplicate item {item}");
+            }
+            dropped = ring.DroppedCount;
+
+            // Assert
+            Assert.That(received.Count + dropped, Is.EqualTo(producers * perProducer));
+        }
+    }
+}
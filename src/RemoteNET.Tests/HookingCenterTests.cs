@@ -0,0 +1,149 @@
+using System.Diagnostics;
+using ScubaDiver.Hooking;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class HookingCenterTests
+    {
+        private class Target
+        {
+            public ulong Address;
+        }
+
+        private static ulong ResolveTarget(object instance) => ((Target)instance).Address;
+
+        /// <summary>
+        /// Registers a callback and returns the unified callback the hooking center would have installed
+        /// </summary>
+        private static HarmonyWrapper.HookCallback Register(HookingCenter center, ulong instanceAddress, int token,
+            HarmonyWrapper.HookCallback callback, Func<object, ulong> resolver, HarmonyWrapper.HookCallback installed = null)
+        {
+            HarmonyWrapper.HookCallback unified = installed;
+            center.RegisterHookAndInstall("Target:Method:Prefix", instanceAddress, callback, token, unifiedCallback =>
+            {
+                unified = unifiedCallback;
+                return () => { };
+            }, resolver);
+            return unified;
+        }
+
+        [Test]
+        public void UnifiedCallback_InstanceRegistration_OnlyInvokedForThatInstance()
+        {
+            // Arrange
+            HookingCenter center = new HookingCenter();
+            int globalCalls = 0, firstCalls = 0, secondCalls = 0;
+            HarmonyWrapper.HookCallback unified = Register(center, 0, 1, (object _, object[] _, ref object _) => { globalCalls++; return true; }, ResolveTarget);
+            Register(center, 0x1000, 2, (object _, object[] _, ref object _) => { firstCalls++; return true; }, ResolveTarget, unified);
+            Register(center, 0x2000, 3, (object _, object[] _, ref object _) => { secondCalls++; return false; }, ResolveTarget, unified);
+            object retValue = null;
+
+            // Act
+            bool callOriginalFirst = unified(new Target { Address = 0x1000 }, Array.Empty<object>(), ref retValue);
+            bool callOriginalSecond = unified(new Target { Address = 0x2000 }, Array.Empty<object>(), ref retValue);
+            unified(new Target { Address = 0x3000 }, Array.Empty<object>(), ref retValue);
+
+            // Assert
+            Assert.That(globalCalls, Is.EqualTo(3));
+            Assert.That(firstCalls, Is.EqualTo(1));
+            Assert.That(secondCalls, Is.EqualTo(1));
+            Assert.That(callOriginalFirst, Is.True);
+            Assert.That(callOriginalSecond, Is.False);
+        }
+
+        [Test]
+        public void UnifiedCallback_OnlyGlobalRegistrations_DoesNotResolveInstance()
+        {
+            // Arrange
+            HookingCenter center = new HookingCenter();
+            int resolves = 0;
+            HarmonyWrapper.HookCallback unified = Register(center, 0, 1, (object _, object[] _, ref object _) => true,
+                instance => { resolves++; return ResolveTarget(instance); });
+            object retValue = null;
+
+            // Act
+            unified(new Target { Address = 0x1000 }, Array.Empty<object>(), ref retValue);
+
+            // Assert
+            Assert.That(resolves, Is.EqualTo(0));
+        }
+
+        [Test]
+        public void UnifiedCallback_AfterUnregister_NoLongerInvoked()
+        {
+            // Arrange
+            HookingCenter center = new HookingCenter();
+            int globalCalls = 0, instanceCalls = 0;
+            HarmonyWrapper.HookCallback unified = Register(center, 0, 1, (object _, object[] _, ref object _) => { globalCalls++; return true; }, ResolveTarget);
+            Register(center, 0x1000, 2, (object _, object[] _, ref object _) => { instanceCalls++; return true; }, ResolveTarget, unified);
+            object retValue = null;
+
+            // Act
+            center.UnregisterHookAndUninstall("Target:Method:Prefix", 2);
+            unified(new Target { Address = 0x1000 }, Array.Empty<object>(), ref retValue);
+
+            // Assert
+            Assert.That(globalCalls, Is.EqualTo(1));
+            Assert.That(instanceCalls, Is.EqualTo(0));
+        }
+
+        [Test]
+        public void GetInstanceFilter_TracksRegistrations_NullWhenAnyIsGlobal()
+        {
+            // Arrange
+            HookingCenter center = new HookingCenter();
+            List<ulong[]> filters = new List<ulong[]>();
+            center.DispatchChanged += unified => filters.Add(center.GetInstanceFilter(unified));
+            HarmonyWrapper.HookCallback unified = Register(center, 0x1000, 1, (object _, object[] _, ref object _) => true, ResolveTarget);
+
+            // Act
+            Register(center, 0x2000, 2, (object _, object[] _, ref object _) => true, ResolveTarget, unified);
+            Register(center, 0, 3, (object _, object[] _, ref object _) => true, ResolveTarget, unified);
+            center.UnregisterHookAndUninstall("Target:Method:Prefix", 3);
+            center.UnregisterHookAndUninstall("Target:Method:Prefix", 1);
+
+            // Assert
+            Assert.That(filters, Has.Count.EqualTo(5));
+            Assert.That(filters[0], Is.EquivalentTo(new[] { 0x1000UL }));
+            Assert.That(filters[1], Is.EquivalentTo(new[] { 0x1000UL, 0x2000UL }));
+            Assert.That(filters[2], Is.Null);
+            Assert.That(filters[3], Is.EquivalentTo(new[] { 0x1000UL, 0x2000UL }));
+            Assert.That(filters[4], Is.EquivalentTo(new[] { 0x2000UL }));
+        }
+
+        [Test]
+        [Explicit("Benchmark")]
+        public void Benchmark_PerCallOverheadByRegistrationsCount()
+        {
+            const int iterations = 5_000_000;
+            object[] args = Array.Empty<object>();
+            Target missed = new Target { Address = 0xFFFF_FFFF };
+
+            foreach (int registrations in new[] { 1, 100, 1_000, 10_000 })
+            {
+                // Arrange - One hot object among many hooked instances. The calls are on others.
+                HookingCenter center = new HookingCenter();
+                HarmonyWrapper.HookCallback unified = null;
+                for (int i = 0; i < registrations; i++)
+                {
+                    unified = Register(center, 0x1000 + (ulong)i * 8, i + 1, (object _, object[] _, ref object _) => true, ResolveTarget, unified);
+                }
+                object retValue = null;
+                for (int i = 0; i < 100_000; i++)
+                    unified(missed, args, ref retValue);
+
+                // Act
+                Stopwatch sw = Stopwatch.StartNew();
+                for (int i = 0; i < iterations; i++)
+                    unified(missed, args, ref retValue);
+                sw.Stop();
+
+                // Assert
+                double nsPerCall = sw.Elapsed.TotalMilliseconds * 1_000_000 / iterations;
+                TestContext.Out.WriteLine($"{registrations,6} instance registrations: {nsPerCall,6:F1}ns per call");
+                Assert.That(nsPerCall, Is.LessThan(1000));
+            }
+        }
+    }
+}
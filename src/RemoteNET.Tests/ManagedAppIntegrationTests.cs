@@ -1,5 +1,8 @@
 ﻿using RemoteNET.Access;
 using RemoteNET.Vessel;
+using ScubaDiver.API;
+using ScubaDiver.API.Interactions.Dumps;
+using System.Diagnostics;
 using System.Text;
 
 #pragma warning disable CS8602 // Dereference of a possibly null reference.
@@ -201,6 +204,121 @@ namespace RemoteNET.Tests
             Assert.That(res, Is.Not.Null);
             Assert.That(res, Is.EqualTo("10"));
         }
+
+        [Test]
+        public void SnapshotObjects_FieldReadsServedFromSnapshotUntilRefreshed()
+        {
+            // Arrange
+            using var target = new DisposableTarget(TestTargetExe);
+            var ro = (ManagedRemoteObject)GetSingleTestObject(target, out ManagedRemoteApp app);
+            dynamic dro = ro.Dynamify();
+
+            // Act
+            app.SnapshotObjects(new[] { ro });
+            // Changing the field behind the snapshot's back
+            app.Communicator.SetField(ro.RemoteToken, typeof(TestClass).FullName, nameof(TestClass.TestField1), ObjectOrRemoteAddress.FromObj(1337));
+            object snapshotValue = dro.TestField1;
+            app.RefreshSnapshots();
+            object refreshedValue = dro.TestField1;
+
+            // Assert
+            Assert.That(snapshotValue, Is.EqualTo(5));
+            Assert.That(refreshedValue, Is.EqualTo(1337));
+        }
+
+        [Test]
+        public void GetItems_RemoteList_SlicesAndEnumeratesInPages()
+        {
+            // Arrange
+            using var target = new DisposableTarget(TestTargetExe);
+            dynamic dro = GetSingleTestObject(target, out ManagedRemoteApp app).Dynamify();
+            dynamic list = dro.TestList;
+            object listObject = list;
+            ulong listToken = ((DynamicRemoteObject)listObject).__ro.RemoteToken;
+
+            // Act
+            ScubaDiver.API.Interactions.Object.ItemsRange slice = app.Communicator.GetItems(listToken, 290, 64);
+            List<int> enumerated = new();
+            foreach (object item in list)
+                enumerated.Add((int)item);
+            List<int> indexed = new();
+            for (int i = 0; i < 300; i++)
+                indexed.Add((int)list[i]);
+
+            // Assert
+            Assert.That(slice.TotalCount, Is.EqualTo(300));
+            Assert.That(slice.Items, Has.Count.EqualTo(10));
+            Assert.That(slice.Done, Is.True);
+            Assert.That(enumerated, Is.EqualTo(Enumerable.Range(0, 300)));
+            Assert.That(indexed, Is.EqualTo(Enumerable.Range(0, 300)));
+        }
+
+        [Test]
+        public void ReadMemory_ObjectHeaderAndUnmappedRange_ReadsMethodTableAndReportsFault()
+        {
+            // Arrange
+            using var target = new DisposableTarget(TestTargetExe);
+            var ro = (ManagedRemoteObject)GetSingleTestObject(target, out ManagedRemoteApp app);
+            ulong expectedMethodTable = app.Communicator.DumpHeap(typeof(TestClass).FullName).Objects.Single().MethodTable();
+            (ulong, int)[] ranges = { (ro.RemoteToken, sizeof(ulong)), (0x10, 16) };
+            byte[] buffer = new byte[sizeof(ulong) + 16];
+            bool[] succeeded = new bool[ranges.Length];
+
+            // Act
+            int readCount = app.Communicator.ReadMemory(ranges, buffer, succeeded);
+
+            // Assert
+            Assert.That(readCount, Is.EqualTo(1));
+            Assert.That(succeeded, Is.EqualTo(new[] { true, false }));
+            Assert.That(BitConverter.ToUInt64(buffer, 0), Is.EqualTo(expectedMethodTable));
+        }
+
+        [Test]
+        public void DumpHeap_WithoutGcCollect_FindsSameObjectAsCollectingDump()
+        {
+            // Arrange
+            using var target = new DisposableTarget(TestTargetExe);
+            var app = (ManagedRemoteApp)RemoteAppFactory.Connect(target.Process, RuntimeType.Managed);
+            ulong expectedAddress = app.Communicator.DumpHeap(typeof(TestClass).FullName).Objects.Single().Address;
+
+            // Act
+            HeapDump first = app.Communicator.DumpHeap(typeof(TestClass).FullName, true, gcCollect: false, CancellationToken.None);
+            HeapDump second = app.Communicator.DumpHeap(typeof(TestClass).FullName, true, gcCollect: false, CancellationToken.None);
+
+            // Assert
+            Assert.That(first.Objects.Single().Address, Is.EqualTo(expectedAddress));
+            Assert.That(second.Objects.Single().HashCode, Is.EqualTo(first.Objects.Single().HashCode));
+        }
+
+        [Test]
+        [Explicit("Benchmark")]
+        public void Benchmark_RepeatedMemberAccess_RequestsPerSecond()
+        {
+            // Arrange
+            using var target = new DisposableTarget(TestTargetExe);
+            RemoteObject ro = GetSingleTestObject(target, out _);
+            dynamic dro = ro.Dynamify();
+            const int iterations = 2_000;
+            for (int i = 0; i < 100; i++)
+            {
+                dro.TestMethod2(i);
+                _ = dro.TestField1;
+            }
+
+            // Act
+            Stopwatch sw = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+            {
+                dro.TestMethod2(i);
+                _ = dro.TestField1;
+            }
+            sw.Stop();
+
+            // Assert
+            double requestsPerSecond = 2 * iterations / sw.Elapsed.TotalSeconds;
+            TestContext.Out.WriteLine($"/invoke + /get_field: {requestsPerSecond:N0} requests/sec");
+            Assert.That(requestsPerSecond, Is.GreaterThan(0));
+        }
     }
 }
 #pragma warning restore CS8602 // Dereference of a possibly null reference.
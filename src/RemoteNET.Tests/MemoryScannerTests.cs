@@ -0,0 +1,44 @@
+using System.Runtime.InteropServices;
+using ScubaDiver;
+using ScubaDiver.Rtti;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class MemoryScannerTests
+    {
+        [Test]
+        public unsafe void ScanReferences_InteriorPointerAfterVftable_ReportsHitAndOwner()
+        {
+            // Arrange
+            nuint fakeVftable = unchecked((nuint)0x7ff0_1234_5670);
+            ulong xorMask = 0x5a5a_a5a5_5a5a_a5a5;
+            ulong* holder = (ulong*)NativeMemory.AllocZeroed(64);
+            byte* target = (byte*)NativeMemory.AllocZeroed(64);
+            try
+            {
+                holder[0] = fakeVftable;
+                holder[2] = (ulong)(target + 16);
+                ulong[] xoredTargets = { (ulong)target ^ xorMask };
+                ulong[] lengths = { 64 };
+                HashSet<nuint> knownXoredVftables = new() { fakeVftable ^ FirstClassTypeInfo.XorMask };
+
+                // Act
+                List<ReferenceHit> hits = new MemoryScanner().ScanReferences(xoredTargets, lengths, xorMask,
+                    knownXoredVftables, maxOwnerDistance: 0x40, maxHits: 1000, out bool truncated);
+
+                // Assert
+                ReferenceHit hit = hits.Single(h => h.Address == (ulong)&holder[2]);
+                Assert.That(hit.TargetIndex, Is.EqualTo(0));
+                Assert.That(hit.OwnerAddress, Is.EqualTo((ulong)holder));
+                Assert.That(hit.RegionBase, Is.LessThanOrEqualTo(hit.Address));
+                Assert.That(truncated, Is.False);
+            }
+            finally
+            {
+                NativeMemory.Free(holder);
+                NativeMemory.Free(target);
+            }
+        }
+    }
+}
@@ -0,0 +1,117 @@
+using ScubaDiver;
+using ScubaDiver.Rtti;
+using ScubaDiver.Snapshots;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class MemorySnapshotTests
+    {
+        private const int ChunkSize = 4096;
+        private const ulong RegionBase = 0x7ff6_0000_0000;
+
+        private string _path = null!;
+
+        [SetUp]
+        public void SetUp()
+        {
+            _path = Path.GetTempFileName();
+        }
+
+        [TearDown]
+        public void TearDown()
+        {
+            File.Delete(_path);
+        }
+
+        /// <summary>
+        /// Writes a single region holding the given memory. Chunks listed as unreadable fail to read.
+        /// </summary>
+        private unsafe void WriteSnapshot(byte[] memory, params int[] unreadableChunks)
+        {
+            using FileStream file = File.Create(_path);
+            using MemorySnapshotWriter writer = new MemorySnapshotWriter(file, 8, ChunkSize);
+            writer.AddModule(new RichModuleInfo(new ModuleInfo("test.dll", (nuint)RegionBase, (nuint)memory.Length),
+                new List<ModuleSection>() { new ModuleSection(".data", RegionBase, (ulong)memory.Length) }));
+            writer.WriteRegion(RegionBase, (ulong)memory.Length, (address, count, buffer) =>
+            {
+                int offset = (int)(address - RegionBase);
+                if (unreadableChunks.Contains(offset / ChunkSize))
+                    return false;
+                memory.AsSpan(offset, count).CopyTo(new Span<byte>(buffer, count));
+                return true;
+            });
+            writer.Finish();
+        }
+
+        [Test]
+        public void TryRead_SpanningDeflatedAndRawChunks_ReturnsOriginalBytes()
+        {
+            // Arrange
+            // First chunk is zeros (deflated), the rest is random (stored raw)
+            byte[] memory = new byte[ChunkSize * 3 + 100];
+            new Random(1234).NextBytes(memory.AsSpan(ChunkSize));
+            WriteSnapshot(memory);
+            byte[] read = new byte[64];
+
+            // Act
+            using MemorySnapshot snapshot = new MemorySnapshot(_path);
+            bool success = snapshot.TryRead(RegionBase + ChunkSize - 32, read);
+
+            // Assert
+            Assert.That(success, Is.True);
+            Assert.That(read, Is.EqualTo(memory.AsSpan(ChunkSize - 32, 64).ToArray()));
+            Assert.That(snapshot.Chunks[0].Flags, Is.EqualTo(SnapshotChunkFlags.Deflated));
+            Assert.That(snapshot.Chunks[1].Flags, Is.EqualTo(SnapshotChunkFlags.None));
+            Assert.That(snapshot.Modules.Single().Sections.Single().Name, Is.EqualTo(".data"));
+        }
+
+        [Test]
+        public void TryRead_UnreadableChunk_ReturnsFalse()
+        {
+            // Arrange
+            byte[] memory = new byte[ChunkSize * 3];
+            WriteSnapshot(memory, 1);
+            byte[] read = new byte[16];
+
+            // Act
+            using MemorySnapshot snapshot = new MemorySnapshot(_path);
+            bool insideUnreadable = snapshot.TryRead(RegionBase + ChunkSize + 8, read);
+            bool afterUnreadable = snapshot.TryRead(RegionBase + ChunkSize * 2 + 8, read);
+            bool outsideRegion = snapshot.TryRead(RegionBase + ChunkSize * 3, read);
+
+            // Assert
+            Assert.That(insideUnreadable, Is.False);
+            Assert.That(afterUnreadable, Is.True);
+            Assert.That(outsideRegion, Is.False);
+        }
+
+        [Test]
+        public unsafe void ReferenceScan_OwnerInPreviousChunk_ReportsOwner()
+        {
+            // Arrange
+            byte[] memory = new byte[ChunkSize * 2];
+            ulong fakeVftable = 0x7ff6_1234_5670;
+            ulong target = 0x1_0000_2000;
+            // The owner's vftable ends the first chunk, its field pointing into the target starts the second
+            BitConverter.TryWriteBytes(memory.AsSpan(ChunkSize - 16), fakeVftable);
+            BitConverter.TryWriteBytes(memory.AsSpan(ChunkSize + 8), target + 0x10);
+            WriteSnapshot(memory);
+            HashSet<nuint> knownXoredVftables = new() { (nuint)fakeVftable ^ FirstClassTypeInfo.XorMask };
+            ReferenceScan scan = new ReferenceScan(new[] { target }, new ulong[] { 0x100 }, 0, knownXoredVftables, 8,
+                maxOwnerDistance: 0x40, maxHits: 100);
+
+            // Act
+            using MemorySnapshot snapshot = new MemorySnapshot(_path);
+            snapshot.ForEachChunk(0x40, (region, bufferAddress, buffer, scanStart, size) =>
+                scan.ScanBuffer(bufferAddress, buffer, scanStart, size, region.BaseAddress, region.Size, CancellationToken.None));
+            List<ReferenceHit> hits = scan.GetHits(address => false, out bool truncated);
+
+            // Assert
+            ReferenceHit hit = hits.Single();
+            Assert.That(hit.Address, Is.EqualTo(RegionBase + ChunkSize + 8));
+            Assert.That(hit.OwnerAddress, Is.EqualTo(RegionBase + ChunkSize - 16));
+            Assert.That(truncated, Is.False);
+        }
+    }
+}
@@ -0,0 +1,231 @@
+using System.Diagnostics;
+using System.Reflection;
+using System.Runtime.CompilerServices;
+using ScubaDiver.API.Hooking;
+using ScubaDiver.API.Interactions.Profiling;
+using ScubaDiver.Hooking;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class MethodProfilerTests
+    {
+        [Test]
+        public void LatencyHistogram_Percentiles_WithinBucketPrecision()
+        {
+            // Arrange
+            LatencyHistogram histogram = new LatencyHistogram();
+
+            // Act
+            for (long value = 1; value <= 100_000; value++)
+                histogram.Record(value);
+
+            // Assert
+            Assert.That(histogram.TotalCount, Is.EqualTo(100_000));
+            Assert.That(histogram.Min, Is.EqualTo(1));
+            Assert.That(histogram.Max, Is.EqualTo(100_000));
+            Assert.That(histogram.GetValueAtPercentile(50), Is.EqualTo(50_000).Within(3).Percent);
+            Assert.That(histogram.GetValueAtPercentile(99), Is.EqualTo(99_000).Within(3).Percent);
+            Assert.That(histogram.GetValueAtPercentile(100), Is.EqualTo(100_000));
+        }
+
+        [Test]
+        public void LatencyHistogram_Add_MergesCounts()
+        {
+            // Arrange
+            LatencyHistogram first = new LatencyHistogram();
+            LatencyHistogram second = new LatencyHistogram();
+            first.Record(10);
+            second.Record(1_000_000);
+
+            // Act
+            LatencyHistogram merged = new LatencyHistogram();
+            merged.Add(first);
+            merged.Add(second);
+
+            // Assert
+            Assert.That(merged.TotalCount, Is.EqualTo(2));
+            Assert.That(merged.Min, Is.EqualTo(10));
+            Assert.That(merged.Max, Is.EqualTo(1_000_000));
+        }
+
+        [Test]
+        public void GetReport_CallsFromManyThreads_CountedPerThread()
+        {
+            // Arrange
+            MethodProfiler profiler = new MethodProfiler(1, "Type", "Method", bucketByInstance: false, instanceResolver: null);
+            object retValue = null;
+
+            // Act
+            Thread[] threads = Enumerable.Range(0, 4).Select(_ => new Thread(() =>
+            {
+                for (int i = 0; i < 1000; i++)
+                {
+                    profiler.Prefix(null, Array.Empty<object>(), ref retValue);
+                    profiler.Finalizer(null, Array.Empty<object>(), ref retValue);
+                }
+            })).ToArray();
+            foreach (Thread thread in threads)
+                thread.Start();
+            foreach (Thread thread in threads)
+                thread.Join();
+            ProfileReport report = profiler.GetReport(reset: false);
+
+            // Assert
+            Assert.That(report.TotalCalls, Is.EqualTo(4000));
+            Assert.That(report.CallsByThread, Has.Count.EqualTo(4));
+            Assert.That(report.CallsByThread.Values, Is.All.EqualTo(1000));
+        }
+
+        [Test]
+        public void GetReport_BucketByInstance_SeparatesInstances()
+        {
+            // Arrange
+            object first = new object();
+            object second = new object();
+            Dictionary<object, ulong> addresses = new Dictionary<object, ulong> { [first] = 0x1000, [second] = 0x2000 };
+            MethodProfiler profiler = new MethodProfiler(1, "Type", "Method", bucketByInstance: true, instance => addresses[instance]);
+            object retValue = null;
+
+            // Act
+            for (int i = 0; i < 3; i++)
+            {
+                profiler.Prefix(first, Array.Empty<object>(), ref retValue);
+                profiler.Finalizer(first, Array.Empty<object>(), ref retValue);
+            }
+            profiler.Prefix(second, Array.Empty<object>(), ref retValue);
+            profiler.Finalizer(second, Array.Empty<object>(), ref retValue);
+            ProfileReport report = profiler.GetReport(reset: true);
+
+            // Assert
+            Assert.That(report.TotalCalls, Is.EqualTo(4));
+            Assert.That(report.Instances.Select(b => (b.InstanceAddress, b.Calls)),
+                Is.EqualTo(new[] { (0x1000UL, 3L), (0x2000UL, 1L) }));
+
+            // Reset applies on the next call of every thread
+            profiler.Prefix(second, Array.Empty<object>(), ref retValue);
+            profiler.Finalizer(second, Array.Empty<object>(), ref retValue);
+            Assert.That(profiler.GetReport(reset: false).TotalCalls, Is.EqualTo(1));
+        }
+
+        [Test]
+        public void Prefix_PastMaxDepth_CountsUntimedCallsAndKeepsOuterTimings()
+        {
+            // Arrange
+            MethodProfiler profiler = new MethodProfiler(1, "Type", "Method", bucketByInstance: false, instanceResolver: null);
+            object retValue = null;
+
+            // Act
+            for (int i = 0; i < 200; i++)
+                profiler.Prefix(null, Array.Empty<object>(), ref retValue);
+            for (int i = 0; i < 200; i++)
+                profiler.Finalizer(null, Array.Empty<object>(), ref retValue);
+            ProfileReport report = profiler.GetReport(reset: false);
+
+            // Assert
+            Assert.That(report.TotalCalls, Is.EqualTo(128));
+            Assert.That(report.UntimedCalls, Is.EqualTo(72));
+        }
+
+        [Test]
+        public void GetReport_Reset_LeavesOutIdleThreads()
+        {
+            // Arrange
+            MethodProfiler profiler = new MethodProfiler(1, "Type", "Method", bucketByInstance: false, instanceResolver: null);
+            Thread idle = new Thread(() =>
+            {
+                object retValue = null;
+                profiler.Prefix(null, Array.Empty<object>(), ref retValue);
+                profiler.Finalizer(null, Array.Empty<object>(), ref retValue);
+            });
+            idle.Start();
+            idle.Join();
+
+            // Act
+            ProfileReport first = profiler.GetReport(reset: true);
+            ProfileReport second = profiler.GetReport(reset: false);
+
+            // Assert
+            Assert.That(first.TotalCalls, Is.EqualTo(1));
+            Assert.That(second.TotalCalls, Is.EqualTo(0));
+            Assert.That(second.CallsByThread, Is.Empty);
+        }
+
+        // Profiled by the test below. Throws when asked to, otherwise calls itself with a throwing call and then works for a while.
+        [MethodImpl(MethodImplOptions.NoInlining)]
+        private static void ProfiledTarget(object shouldThrow)
+        {
+            if ((bool)shouldThrow)
+                throw new InvalidOperationException("Thrown by the profiled method");
+            try
+            {
+                ProfiledTarget(true);
+            }
+            catch (InvalidOperationException)
+            {
+            }
+            Thread.Sleep(50);
+        }
+
+        [Test]
+        public void Finalizer_ProfiledMethodThrows_EnclosingCallStillTimed()
+        {
+            // Arrange
+            MethodProfiler profiler = new MethodProfiler(1, "Type", "Method", bucketByInstance: false, instanceResolver: null);
+            MethodInfo target = typeof(MethodProfilerTests).GetMethod(nameof(ProfiledTarget), BindingFlags.NonPublic | BindingFlags.Static)!;
+            HarmonyWrapper.Instance.AddHook(target, HarmonyPatchPosition.Prefix, profiler.Prefix);
+            HarmonyWrapper.Instance.AddHook(target, HarmonyPatchPosition.Finalizer, profiler.Finalizer);
+
+            // Act
+            ProfileReport report;
+            try
+            {
+                // Far more throws than the profiler's max call depth
+                for (int i = 0; i < 200; i++)
+                    Assert.Throws<InvalidOperationException>(() => ProfiledTarget(true));
+                ProfiledTarget(false);
+                report = profiler.GetReport(reset: false);
+            }
+            finally
+            {
+                HarmonyWrapper.Instance.UnhookAnyHookPosition(target);
+            }
+
+            // Assert
+            Assert.That(report.TotalCalls, Is.EqualTo(202));
+            Assert.That(report.UntimedCalls, Is.EqualTo(0));
+            // The enclosing call popped its own timestamp, not the one its throwing call pushed
+            Assert.That(report.AllInstances.MaxNs, Is.GreaterThanOrEqualTo(40_000_000));
+        }
+
+        [Test]
+        [Explicit("Benchmark")]
+        public void Benchmark_PrefixFinalizerOverhead()
+        {
+            // Arrange
+            MethodProfiler profiler = new MethodProfiler(1, "Type", "Method", bucketByInstance: false, instanceResolver: null);
+            object[] args = Array.Empty<object>();
+            object retValue = null;
+            const int iterations = 10_000_000;
+            for (int i = 0; i < 100_000; i++)
+            {
+                profiler.Prefix(null, args, ref retValue);
+                profiler.Finalizer(null, args, ref retValue);
+            }
+
+            // Act
+            Stopwatch sw = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+            {
+                profiler.Prefix(null, args, ref retValue);
+                profiler.Finalizer(null, args, ref retValue);
+            }
+            sw.Stop();
+
+            // Assert
+            double nsPerCall = sw.Elapsed.TotalMilliseconds * 1_000_000 / iterations;
+            TestContext.Out.WriteLine($"Profiler overhead: {nsPerCall:F1}ns per call");
+            Assert.That(nsPerCall, Is.LessThan(1000));
+        }
+    }
+}
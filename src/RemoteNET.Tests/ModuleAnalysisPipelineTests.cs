@@ -0,0 +1,110 @@
+using System.Collections.Concurrent;
+using ScubaDiver;
+using ScubaDiver.API.Interactions.Dumps;
+using ScubaDiver.Rtti;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class ModuleAnalysisPipelineTests
+    {
+        private readonly ConcurrentQueue<string> _undecorated = new();
+        private readonly HashSet<string> _failingModules = new();
+
+        [SetUp]
+        public void SetUp()
+        {
+            _undecorated.Clear();
+            _failingModules.Clear();
+        }
+
+        private ModuleAnalysisPipeline<string> CreatePipeline(int backgroundWorkers = 1) => new ModuleAnalysisPipeline<string>(
+            moduleName => { },
+            moduleName =>
+            {
+                _undecorated.Enqueue(moduleName);
+                if (_failingModules.Contains(moduleName))
+                    throw new Exception($"Can't undecorate {moduleName}");
+                return new UndecoratedModule(moduleName, new RichModuleInfo(new ModuleInfo(moduleName, 0, 0), Array.Empty<ModuleSection>()));
+            },
+            module => module.Name,
+            backgroundWorkers);
+
+        private static ModuleAnalysisStage GetStage(ModuleAnalysisPipeline<string> pipeline, string moduleName) =>
+            pipeline.GetStatus().Modules.Single(module => module.Name == moduleName).Stage;
+
+        [Test]
+        public void Hook_TwoModules_InstallsInOrderOnce()
+        {
+            // Arrange
+            ModuleAnalysisPipeline<string> pipeline = CreatePipeline();
+            List<string> installed = new();
+
+            // Act
+            pipeline.Hook(new[] { "a.dll", "b.dll" }, installed.Add);
+            pipeline.Hook(new[] { "b.dll" }, installed.Add);
+
+            // Assert
+            Assert.That(installed, Is.EqualTo(new[] { "a.dll", "b.dll" }));
+            Assert.That(_undecorated.OrderBy(name => name), Is.EqualTo(new[] { "a.dll", "b.dll" }));
+            Assert.That(pipeline.GetStatus().Modules.Select(module => module.Stage),
+                Is.EqualTo(new[] { ModuleAnalysisStage.Hooked, ModuleAnalysisStage.Hooked }));
+        }
+
+        [Test]
+        public void Hook_FailingModule_ReportsErrorAndRetries()
+        {
+            // Arrange
+            ModuleAnalysisPipeline<string> pipeline = CreatePipeline();
+            List<string> installed = new();
+            _failingModules.Add("bad.dll");
+
+            // Act
+            pipeline.Hook(new[] { "bad.dll", "good.dll" }, installed.Add);
+            ModuleAnalysisDump.Module failed = pipeline.GetStatus().Modules.Single(module => module.Name == "bad.dll");
+            _failingModules.Clear();
+            pipeline.Hook(new[] { "bad.dll" }, installed.Add);
+
+            // Assert
+            Assert.That(failed.Stage, Is.EqualTo(ModuleAnalysisStage.Failed));
+            Assert.That(failed.Error, Does.Contain("bad.dll"));
+            Assert.That(installed, Is.EqualTo(new[] { "good.dll", "bad.dll" }));
+            Assert.That(GetStage(pipeline, "bad.dll"), Is.EqualTo(ModuleAnalysisStage.Hooked));
+        }
+
+        [Test]
+        public void EnqueueBackground_SingleWorker_AnalyzesByPriority()
+        {
+            // Arrange
+            ModuleAnalysisPipeline<string> pipeline = CreatePipeline(backgroundWorkers: 1);
+
+            // Act
+            pipeline.EnqueueBackground(new[] { ("low.dll", 5), ("high.dll", 1), ("mid.dll", 3) });
+            bool done = SpinWait.SpinUntil(() => pipeline.GetStatus().Modules.All(module => module.Stage == ModuleAnalysisStage.Analyzed),
+                TimeSpan.FromSeconds(10));
+
+            // Assert
+            Assert.That(done, Is.True);
+            Assert.That(_undecorated, Is.EqualTo(new[] { "high.dll", "mid.dll", "low.dll" }));
+            Assert.That(pipeline.GetStatus().Modules.All(module => module.Background), Is.True);
+        }
+
+        [Test]
+        public void Hook_AfterBackgroundAnalysis_DoesNotAnalyzeAgain()
+        {
+            // Arrange
+            ModuleAnalysisPipeline<string> pipeline = CreatePipeline();
+            List<string> installed = new();
+            pipeline.EnqueueBackground(new[] { ("a.dll", 0) });
+            SpinWait.SpinUntil(() => GetStage(pipeline, "a.dll") == ModuleAnalysisStage.Analyzed, TimeSpan.FromSeconds(10));
+
+            // Act
+            pipeline.Hook(new[] { "a.dll" }, installed.Add);
+
+            // Assert
+            Assert.That(installed, Is.EqualTo(new[] { "a.dll" }));
+            Assert.That(_undecorated, Is.EqualTo(new[] { "a.dll" }));
+            Assert.That(GetStage(pipeline, "a.dll"), Is.EqualTo(ModuleAnalysisStage.Hooked));
+        }
+    }
+}
@@ -0,0 +1,86 @@
+using System.Diagnostics;
+using System.Runtime.InteropServices;
+using ScubaDiver;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class NativeCallStubCacheTests
+    {
+        // Real native functions. Pointers of managed delegates won't do: Marshalling them back returns the original delegate.
+        // int MulDiv(int number, int numerator, int denominator)
+        private static readonly ulong MulDivAddress = (ulong)NativeLibrary.GetExport(NativeLibrary.Load("kernel32.dll"), "MulDiv");
+        // int _finite(double x)
+        private static readonly ulong FiniteAddress = (ulong)NativeLibrary.GetExport(NativeLibrary.Load("ucrtbase.dll"), "_finite");
+
+        private static NativeCallSignature MulDivSignature => new(MulDivAddress, CallingConvention.Winapi, 3, 0, typeof(nuint));
+        private static NativeCallSignature FiniteSignature => new(FiniteAddress, CallingConvention.Winapi, 1, 0b1, typeof(nuint));
+
+        // Both return an int, the upper half of the register is undefined
+        private static uint LowerHalf(object result) => (uint)(nuint)result;
+
+        [Test]
+        public void Invoker_IntegerAndFloatArgs_CallsNativeFunction()
+        {
+            // Arrange
+            NativeCallStubCache cache = new NativeCallStubCache();
+
+            // Act
+            object product = cache.GetOrCreate(MulDivSignature)(new object[] { (nuint)6, (nuint)14, (nuint)2 });
+            object finite = cache.GetOrCreate(FiniteSignature)(new object[] { 2.5 });
+            object infinite = cache.GetOrCreate(FiniteSignature)(new object[] { double.PositiveInfinity });
+
+            // Assert
+            Assert.That(LowerHalf(product), Is.EqualTo(42));
+            Assert.That(LowerHalf(finite), Is.Not.Zero);
+            Assert.That(LowerHalf(infinite), Is.Zero);
+        }
+
+        [Test]
+        public void GetOrCreate_SameSignature_ReusesInvokerUntilEvicted()
+        {
+            // Arrange
+            NativeCallStubCache cache = new NativeCallStubCache(capacity: 2);
+            NativeCallStubCache.NativeInvoker first = cache.GetOrCreate(MulDivSignature);
+
+            // Act
+            NativeCallStubCache.NativeInvoker again = cache.GetOrCreate(MulDivSignature);
+            cache.GetOrCreate(FiniteSignature);
+            cache.GetOrCreate(FiniteSignature with { FloatsBitmap = 0 });
+            NativeCallStubCache.NativeInvoker afterEviction = cache.GetOrCreate(MulDivSignature);
+
+            // Assert
+            Assert.That(again, Is.SameAs(first));
+            Assert.That(afterEviction, Is.Not.SameAs(first));
+        }
+
+        [Test]
+        [Explicit("Benchmark")]
+        public void Benchmark_RepeatedInvocation_UncachedVsCached()
+        {
+            // Arrange
+            const int iterations = 200_000;
+            NativeCallStubCache cache = new NativeCallStubCache();
+            object[] args = { (nuint)6, (nuint)14, (nuint)2 };
+            Type delegateType = NativeDelegatesFactory.GetDelegateType(typeof(nuint), 3, 0);
+
+            // Act - What every /invoke did before: Create the marshalling delegate and DynamicInvoke it
+            Stopwatch uncached = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+                Marshal.GetDelegateForFunctionPointer(new IntPtr((long)MulDivAddress), delegateType).DynamicInvoke(args);
+            uncached.Stop();
+
+            Stopwatch cached = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+                cache.GetOrCreate(MulDivSignature)(args);
+            cached.Stop();
+
+            // Assert
+            double uncachedNs = uncached.Elapsed.TotalMilliseconds * 1_000_000 / iterations;
+            double cachedNs = cached.Elapsed.TotalMilliseconds * 1_000_000 / iterations;
+            TestContext.Out.WriteLine($"Uncached: {uncachedNs,8:F1}ns per call");
+            TestContext.Out.WriteLine($"Cached:   {cachedNs,8:F1}ns per call");
+            Assert.That(cachedNs, Is.LessThan(uncachedNs));
+        }
+    }
+}
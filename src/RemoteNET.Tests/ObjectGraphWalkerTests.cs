@@ -0,0 +1,91 @@
+using System.Runtime.InteropServices;
+using ScubaDiver;
+using ScubaDiver.API.Interactions.Dumps;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class ObjectGraphWalkerTests
+    {
+        private const int ObjectSize = 32;
+        private readonly List<IntPtr> _allocations = new();
+        private readonly Dictionary<ulong, string> _types = new();
+
+        [TearDown]
+        public unsafe void TearDown()
+        {
+            foreach (IntPtr allocation in _allocations)
+                NativeMemory.Free((void*)allocation);
+            _allocations.Clear();
+            _types.Clear();
+        }
+
+        private unsafe ulong* NewObject(string typeName)
+        {
+            ulong* obj = (ulong*)NativeMemory.AllocZeroed(ObjectSize);
+            _allocations.Add((IntPtr)obj);
+            _types[(ulong)obj] = typeName;
+            return obj;
+        }
+
+        private unsafe ObjectGraphWalker CreateWalker() => new ObjectGraphWalker(8,
+            (address, destination, length) =>
+            {
+                Buffer.MemoryCopy((void*)address, destination, length, length);
+                return true;
+            },
+            address => _types.GetValueOrDefault(address),
+            (address, typeName) => ObjectSize);
+
+        [Test]
+        public unsafe void Walk_SharedChild_AddsNodeOnceWithBothEdges()
+        {
+            // Arrange
+            ulong* root = NewObject("app!Root");
+            ulong* left = NewObject("app!Left");
+            ulong* shared = NewObject("app!Shared");
+            root[1] = (ulong)left;
+            root[2] = (ulong)shared;
+            left[3] = (ulong)shared;
+            // Not an object of a known type
+            root[3] = 0x1234_5678;
+
+            // Act
+            ObjectGraphDump graph = CreateWalker().Walk(new[] { (ulong)root }, 3, _ => true, 100);
+
+            // Assert
+            Assert.That(graph.Nodes.Select(node => node.Address),
+                Is.EqualTo(new[] { (ulong)root, (ulong)left, (ulong)shared }));
+            Assert.That(graph.Nodes.Select(node => node.Depth), Is.EqualTo(new[] { 0, 1, 1 }));
+            Assert.That(graph.Edges.Select(edge => (edge.From, edge.Offset, edge.To)),
+                Is.EqualTo(new[] { (0, 8UL, 1), (0, 16UL, 2), (1, 24UL, 2) }));
+            Assert.That(graph.Types[graph.Nodes[2].Type], Is.EqualTo("app!Shared"));
+            Assert.That(graph.Truncated, Is.False);
+        }
+
+        [Test]
+        public unsafe void Walk_DepthFilterAndNodesLimits_AreHonored()
+        {
+            // Arrange
+            ulong* root = NewObject("app!Root");
+            ulong* child = NewObject("app!Child");
+            ulong* grandchild = NewObject("app!Child");
+            ulong* ignored = NewObject("app!Ignored");
+            root[1] = (ulong)child;
+            root[2] = (ulong)ignored;
+            child[1] = (ulong)grandchild;
+            ObjectGraphWalker walker = CreateWalker();
+            Predicate<string> onlyChildren = typeName => typeName == "app!Child";
+
+            // Act
+            ObjectGraphDump shallow = walker.Walk(new[] { (ulong)root }, 1, onlyChildren, 100);
+            ObjectGraphDump limited = walker.Walk(new[] { (ulong)root }, 3, _ => true, 2);
+
+            // Assert
+            Assert.That(shallow.Nodes.Select(node => node.Address), Is.EqualTo(new[] { (ulong)root, (ulong)child }));
+            Assert.That(shallow.Truncated, Is.False);
+            Assert.That(limited.Nodes, Has.Count.EqualTo(2));
+            Assert.That(limited.Truncated, Is.True);
+        }
+    }
+}
@@ -0,0 +1,45 @@
+using System.Text;
+using ScubaDiver;
+using ScubaDiver.API;
+using ScubaDiver.API.Interactions.Object;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class ObjectsSnapshotTests
+    {
+        private class Base
+        {
+            public int Hidden = 1;
+        }
+
+        private class Target : Base
+        {
+            public new int Hidden = 2;
+            public string Name = "name";
+            public StringBuilder Builder = new StringBuilder();
+            public object? Nothing = null;
+            public event EventHandler? Changed;
+            public void RaiseChanged() => Changed?.Invoke(this, EventArgs.Empty);
+        }
+
+        [Test]
+        public void CreateSnapshot_PrimitivesInlineAndReferencesLeftOut()
+        {
+            // Arrange
+            Target target = new Target();
+
+            // Act
+            ObjectsSnapshot.ObjectSnapshot snapshot = ObjectDumpFactory.CreateSnapshot(target, 0x2000);
+
+            // Assert
+            Assert.That(snapshot.Address, Is.EqualTo(0x2000));
+            Assert.That(snapshot.Type, Is.EqualTo(typeof(Target).FullName));
+            Assert.That(snapshot.Fields[nameof(Target.Hidden)].EncodedObject, Is.EqualTo("2"));
+            Assert.That(snapshot.Fields[nameof(Target.Name)].IsRemoteAddress, Is.False);
+            Assert.That(snapshot.Fields.ContainsKey(nameof(Target.Builder)), Is.False);
+            Assert.That(snapshot.Fields[nameof(Target.Nothing)].IsNull, Is.True);
+            Assert.That(snapshot.Fields.ContainsKey(nameof(Target.Changed)), Is.False);
+        }
+    }
+}
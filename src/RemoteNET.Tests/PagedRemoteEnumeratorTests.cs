@@ -0,0 +1,132 @@
+using RemoteNET.Internal;
+using ScubaDiver.API;
+using ScubaDiver.API.Interactions.Object;
+using ScubaDiver.API.Utils;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class PagedRemoteEnumeratorTests
+    {
+        private const long Cursor = 7;
+
+        // A remote collection of `count` ints, served `pageSize` at a time
+        private readonly List<(long cursor, int count)> _requests = new();
+        private readonly List<long> _closedCursors = new();
+        private readonly List<ulong> _releasedItems = new();
+        private int _served;
+
+        [SetUp]
+        public void SetUp()
+        {
+            _requests.Clear();
+            _closedCursors.Clear();
+            _releasedItems.Clear();
+            _served = 0;
+        }
+
+        // Odd items are remote objects at 0x1000 + i when `remoteItems` is set
+        private PagedRemoteEnumerator CreateEnumerator(int itemsCount, int pageSize, bool remoteItems = false) => new PagedRemoteEnumerator(
+            (cursor, count) =>
+            {
+                _requests.Add((cursor, count));
+                ItemsRange range = new ItemsRange();
+                for (; _served < itemsCount && range.Items.Count < count; _served++)
+                {
+                    range.Items.Add(remoteItems && _served % 2 == 1
+                        ? ObjectOrRemoteAddress.FromToken(0x1000 + (ulong)_served, "Item")
+                        : ObjectOrRemoteAddress.FromObj(_served));
+                }
+                range.Done = _served == itemsCount;
+                range.Cursor = range.Done ? 0 : Cursor;
+                return range;
+            },
+            (cursor, unreached) =>
+            {
+                _closedCursors.Add(cursor);
+                _releasedItems.AddRange(unreached);
+            },
+            item => item.IsRemoteAddress ? item.RemoteAddress : PrimitivesEncoder.Decode(item.EncodedObject, item.Type),
+            pageSize);
+
+        [Test]
+        public void MoveNext_AllItems_OneRequestPerPage()
+        {
+            // Arrange
+            PagedRemoteEnumerator enumerator = CreateEnumerator(10, 4);
+            List<object> items = new();
+
+            // Act
+            while (enumerator.MoveNext())
+                items.Add(enumerator.Current);
+
+            // Assert
+            Assert.That(items, Is.EqualTo(Enumerable.Range(0, 10).Cast<object>()));
+            Assert.That(_requests, Is.EqualTo(new[] { (0L, 4), (Cursor, 4), (Cursor, 4) }));
+            Assert.That(enumerator.MoveNext(), Is.False);
+            Assert.That(_requests, Has.Count.EqualTo(3));
+        }
+
+        [Test]
+        public void Dispose_UnfinishedEnumeration_ClosesCursor()
+        {
+            // Arrange
+            PagedRemoteEnumerator enumerator = CreateEnumerator(10, 4);
+            enumerator.MoveNext();
+
+            // Act
+            enumerator.Dispose();
+            enumerator.Dispose();
+
+            // Assert
+            Assert.That(_closedCursors, Is.EqualTo(new[] { Cursor }));
+        }
+
+        [Test]
+        public void Dispose_FinishedEnumeration_DoesNotCloseCursor()
+        {
+            // Arrange
+            PagedRemoteEnumerator enumerator = CreateEnumerator(3, 4);
+            while (enumerator.MoveNext())
+            {
+            }
+
+            // Act
+            enumerator.Dispose();
+
+            // Assert
+            Assert.That(_closedCursors, Is.Empty);
+        }
+
+        [Test]
+        public void Dispose_BrokenOffMidPage_ReleasesUnreachedItems()
+        {
+            // Arrange
+            PagedRemoteEnumerator enumerator = CreateEnumerator(10, 8, remoteItems: true);
+            enumerator.MoveNext();
+            enumerator.MoveNext();
+
+            // Act
+            enumerator.Dispose();
+
+            // Assert
+            Assert.That(_closedCursors, Is.EqualTo(new[] { Cursor }));
+            Assert.That(_releasedItems, Is.EqualTo(new[] { 0x1003ul, 0x1005ul, 0x1007ul }));
+        }
+
+        [Test]
+        public void Dispose_LastPageNotRead_ReleasesItemsWithoutCursor()
+        {
+            // Arrange
+            PagedRemoteEnumerator enumerator = CreateEnumerator(4, 8, remoteItems: true);
+            enumerator.MoveNext();
+
+            // Act
+            enumerator.Dispose();
+
+            // Assert
+            Assert.That(_closedCursors, Is.EqualTo(new[] { 0L }));
+            Assert.That(_releasedItems, Is.EqualTo(new[] { 0x1001ul, 0x1003ul }));
+        }
+    }
+}
@@ -0,0 +1,105 @@
+using ScubaDiver;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class PinLeasesTests
+    {
+        private DateTime _now;
+        private PinLeases _leases;
+
+        [SetUp]
+        public void SetUp()
+        {
+            _now = new DateTime(2024, 1, 1, 0, 0, 0, DateTimeKind.Utc);
+            _leases = new PinLeases(TimeSpan.FromMinutes(1), () => _now);
+        }
+
+        [Test]
+        public void Release_AddressHeldByAnotherClient_NotReleased()
+        {
+            // Arrange
+            _leases.Add(1, 0x1000);
+            _leases.Add(1, 0x2000);
+            _leases.Add(2, 0x2000);
+
+            // Act
+            List<ulong> releasedFirst = _leases.Release(1);
+            List<ulong> releasedSecond = _leases.Release(2);
+
+            // Assert
+            Assert.That(releasedFirst, Is.EqualTo(new[] { 0x1000ul }));
+            Assert.That(releasedSecond, Is.EqualTo(new[] { 0x2000ul }));
+        }
+
+        [Test]
+        public void Remove_AddressHeldByAnotherClient_StillHeld()
+        {
+            // Arrange
+            _leases.Add(1, 0x1000);
+            _leases.Add(2, 0x1000);
+            _leases.Add(1, 0x2000);
+
+            // Act
+            bool firstUnheld = _leases.Remove(1, 0x1000);
+            bool secondUnheld = _leases.Remove(1, 0x2000);
+
+            // Assert
+            Assert.That(firstUnheld, Is.False);
+            Assert.That(secondUnheld, Is.True);
+            Assert.That(_leases.IsHeld(0x1000), Is.True);
+            Assert.That(_leases.IsHeld(0x2000), Is.False);
+            Assert.That(_leases.Release(1), Is.Empty);
+        }
+
+        [Test]
+        public void GetExpiredClients_OnlySilentClients()
+        {
+            // Arrange
+            _leases.Add(1, 0x1000);
+            _leases.Add(2, 0x2000);
+
+            // Act
+            _now += TimeSpan.FromSeconds(45);
+            _leases.Renew(2);
+            _now += TimeSpan.FromSeconds(30);
+            List<int> expired = _leases.GetExpiredClients();
+
+            // Assert
+            Assert.That(expired, Is.EqualTo(new[] { 1 }));
+        }
+
+        [Test]
+        public void Forget_ExplicitlyUnpinnedAddress_NotReleasedAgain()
+        {
+            // Arrange
+            _leases.Add(1, 0x1000);
+            _leases.Add(1, 0x2000);
+
+            // Act
+            _leases.Forget(0x1000);
+            List<ulong> released = _leases.Release(1);
+
+            // Assert
+            Assert.That(released, Is.EqualTo(new[] { 0x2000ul }));
+        }
+
+        [Test]
+        public void GetStats_CountsAndSizesPerClient()
+        {
+            // Arrange
+            _leases.Add(1, 0x1000);
+            _leases.Add(1, 0x2000);
+            _leases.Add(2, 0x2000);
+            _leases.Renew(3);
+
+            // Act
+            Dictionary<int, (int count, ulong bytes)> stats = _leases.GetStats(address => address / 0x100);
+
+            // Assert
+            Assert.That(stats[1], Is.EqualTo((2, 0x30ul)));
+            Assert.That(stats[2], Is.EqualTo((1, 0x20ul)));
+            Assert.That(stats[3], Is.EqualTo((0, 0ul)));
+        }
+    }
+}
@@ -0,0 +1,187 @@
+using System.Diagnostics;
+using System.Reflection;
+using ScubaDiver;
+using ScubaDiver.API.Extensions;
+using ScubaDiver.API.Utils;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class ReflectionInvokersCacheTests
+    {
+        private class Target
+        {
+            public int Counter;
+            public readonly int ReadOnlyValue = 3;
+            private string _name = "initial";
+
+            public Target() { }
+            public Target(int counter) => Counter = counter;
+
+            public int Add(int a, int b) => a + b + Counter;
+            public string Describe(string prefix) => $"{prefix}{_name}";
+            public void Increment() => Counter++;
+            public static bool TryDouble(int value, out int doubled)
+            {
+                doubled = value * 2;
+                return true;
+            }
+        }
+
+        // Calls enough times to go through both the reflection and the compiled delegates
+        private const int Calls = ReflectionInvokersCache.CompileThreshold + 2;
+
+        [Test]
+        public void GetMethod_RepeatedCalls_SameResultsBeforeAndAfterCompilation()
+        {
+            // Arrange
+            ReflectionInvokersCache cache = new ReflectionInvokersCache();
+            Target target = new Target { Counter = 10 };
+
+            // Act
+            List<object> results = new List<object>();
+            for (int i = 0; i < Calls; i++)
+            {
+                ReflectionInvokersCache.CachedMethod method = cache.GetMethod(typeof(Target), nameof(Target.Add), Type.EmptyTypes, new[] { typeof(int), typeof(int) });
+                results.Add(method.Invoke(target, new object[] { 1, 2 }));
+            }
+
+            // Assert
+            Assert.That(results, Is.All.EqualTo(13));
+            Assert.That(cache.GetMethod(typeof(Target), nameof(Target.Add), Type.EmptyTypes, new[] { typeof(int), typeof(int) }),
+                Is.SameAs(cache.GetMethod(typeof(Target), nameof(Target.Add), Type.EmptyTypes, new[] { typeof(int), typeof(int) })));
+        }
+
+        [Test]
+        public void GetMethod_NullArgumentAndVoidReturn_InvokedLikeReflection()
+        {
+            // Arrange
+            ReflectionInvokersCache cache = new ReflectionInvokersCache();
+            Target target = new Target();
+
+            // Act
+            List<object> described = new List<object>();
+            for (int i = 0; i < Calls; i++)
+            {
+                described.Add(cache.GetMethod(typeof(Target), nameof(Target.Describe), Type.EmptyTypes, new Type[] { new WildCardType() })
+                    .Invoke(target, new object[] { null }));
+                Assert.That(cache.GetMethod(typeof(Target), nameof(Target.Increment), Type.EmptyTypes, Type.EmptyTypes)
+                    .Invoke(target, Array.Empty<object>()), Is.Null);
+            }
+
+            // Assert
+            Assert.That(described, Is.All.EqualTo("initial"));
+            Assert.That(target.Counter, Is.EqualTo(Calls));
+        }
+
+        [Test]
+        public void GetMethod_OutParameter_WrittenBackToArguments()
+        {
+            // Arrange
+            ReflectionInvokersCache cache = new ReflectionInvokersCache();
+            MethodInfo tryDouble = typeof(Target).GetMethod(nameof(Target.TryDouble))!;
+            Type[] argTypes = tryDouble.GetParameters().Select(p => p.ParameterType).ToArray();
+
+            // Act
+            object[] args = { 21, 0 };
+            for (int i = 0; i < Calls; i++)
+                cache.GetMethod(typeof(Target), nameof(Target.TryDouble), Type.EmptyTypes, argTypes).Invoke(null, args);
+
+            // Assert
+            Assert.That(args[1], Is.EqualTo(42));
+        }
+
+        [Test]
+        public void GetField_GetAndSet_IncludingPrivateAndReadOnly()
+        {
+            // Arrange
+            ReflectionInvokersCache cache = new ReflectionInvokersCache();
+            Target target = new Target();
+
+            // Act
+            for (int i = 0; i < Calls; i++)
+            {
+                cache.GetField(typeof(Target), nameof(Target.Counter)).SetValue(target, i);
+                cache.GetField(typeof(Target), "_name").SetValue(target, $"name{i}");
+            }
+            ReflectionInvokersCache.CachedField readOnly = cache.GetField(typeof(Target), nameof(Target.ReadOnlyValue));
+            for (int i = 0; i < Calls; i++)
+                readOnly.SetValue(target, 7);
+
+            // Assert
+            Assert.That(cache.GetField(typeof(Target), nameof(Target.Counter)).GetValue(target), Is.EqualTo(Calls - 1));
+            Assert.That(cache.GetField(typeof(Target), "_name").GetValue(target), Is.EqualTo($"name{Calls - 1}"));
+            Assert.That(target.ReadOnlyValue, Is.EqualTo(7));
+            Assert.That(cache.GetField(typeof(Target), "NoSuchField"), Is.Null);
+        }
+
+        [Test]
+        public void GetConstructor_PublicConstructors_MatchedByArgumentTypes()
+        {
+            // Arrange
+            ReflectionInvokersCache cache = new ReflectionInvokersCache();
+
+            // Act
+            Target created = null!;
+            for (int i = 0; i < Calls; i++)
+                created = (Target)cache.GetConstructor(typeof(Target), new[] { typeof(int) }).Invoke(new object[] { 5 });
+            ReflectionInvokersCache.CachedConstructor structCtor = cache.GetConstructor(typeof(DateTime), Type.EmptyTypes);
+
+            // Assert
+            Assert.That(created.Counter, Is.EqualTo(5));
+            // Structs have no parameterless constructor to call, these are left for Activator.CreateInstance
+            Assert.That(structCtor, Is.Null);
+        }
+
+        [Test]
+        public void PrimitivesEncoder_Decode_RepeatedTypes()
+        {
+            // Act
+            object first = PrimitivesEncoder.Decode("42", typeof(int).FullName);
+            object second = PrimitivesEncoder.Decode("43", typeof(int).FullName);
+            object text = PrimitivesEncoder.Decode("\"hi\"", typeof(string).FullName);
+
+            // Assert
+            Assert.That(first, Is.EqualTo(42));
+            Assert.That(second, Is.EqualTo(43));
+            Assert.That(text, Is.EqualTo("hi"));
+        }
+
+        [Test]
+        [Explicit("Benchmark")]
+        public void Benchmark_RequestsPerSecond_UncachedVsCached()
+        {
+            // Arrange - The resolving and invoking part of /invoke and /get_field, minus the transport
+            const int iterations = 200_000;
+            ReflectionInvokersCache cache = new ReflectionInvokersCache();
+            Target target = new Target();
+            Type[] argTypes = { typeof(int), typeof(int) };
+
+            // Act
+            Stopwatch uncached = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+            {
+                object[] args = { PrimitivesEncoder.Decode("1", typeof(int)), PrimitivesEncoder.Decode("2", typeof(int)) };
+                typeof(Target).GetMethodRecursive(nameof(Target.Add), Type.EmptyTypes, argTypes).Invoke(target, args);
+                typeof(Target).GetFieldRecursive(nameof(Target.Counter)).GetValue(target);
+            }
+            uncached.Stop();
+
+            Stopwatch cached = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+            {
+                object[] args = { PrimitivesEncoder.Decode("1", typeof(int)), PrimitivesEncoder.Decode("2", typeof(int)) };
+                cache.GetMethod(typeof(Target), nameof(Target.Add), Type.EmptyTypes, argTypes).Invoke(target, args);
+                cache.GetField(typeof(Target), nameof(Target.Counter)).GetValue(target);
+            }
+            cached.Stop();
+
+            // Assert
+            double uncachedRps = 2 * iterations / uncached.Elapsed.TotalSeconds;
+            double cachedRps = 2 * iterations / cached.Elapsed.TotalSeconds;
+            TestContext.Out.WriteLine($"Uncached: {uncachedRps,12:N0} requests/sec");
+            TestContext.Out.WriteLine($"Cached:   {cachedRps,12:N0} requests/sec");
+            Assert.That(cachedRps, Is.GreaterThan(uncachedRps));
+        }
+    }
+}
@@ -0,0 +1,113 @@
+using ScubaDiver;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class RequestsSchedulerTests
+    {
+        private static ScubaDiverMessage CreateMessage(string path, string requestId, int connectionId, Action<string> responseSender,
+            CancellationToken connectionToken = default)
+        {
+            Dictionary<string, string> queryString = new Dictionary<string, string> { ["requestId"] = requestId };
+            return new ScubaDiverMessage(queryString, path, string.Empty, responseSender)
+            {
+                ConnectionId = connectionId,
+                CancellationToken = connectionToken
+            };
+        }
+
+        /// <summary>
+        /// Executor which spins (like a heap scan) until its request is cancelled
+        /// </summary>
+        private static void SpinUntilCancelled(ScubaDiverMessage msg, ManualResetEventSlim started)
+        {
+            started.Set();
+            while (!msg.CancellationToken.IsCancellationRequested)
+                Thread.SpinWait(100);
+            msg.ResponseSender("cancelled");
+        }
+
+        [Test]
+        public void Cancel_RunningRequest_StopsWithinMilliseconds()
+        {
+            // Arrange
+            using ManualResetEventSlim started = new ManualResetEventSlim();
+            using RequestsScheduler scheduler = new RequestsScheduler("Test", msg => SpinUntilCancelled(msg, started), _ => true);
+            TaskCompletionSource<string> response = new TaskCompletionSource<string>();
+            scheduler.Schedule(CreateMessage("/heap", "7", 1, body => response.SetResult(body)));
+            Assert.That(started.Wait(TimeSpan.FromSeconds(5)), Is.True);
+
+            // Act
+            bool found = scheduler.Cancel(1, "7");
+
+            // Assert
+            Assert.That(found, Is.True);
+            Assert.That(response.Task.Wait(TimeSpan.FromMilliseconds(500)), Is.True);
+            Assert.That(response.Task.Result, Is.EqualTo("cancelled"));
+        }
+
+        [Test]
+        public void Cancel_RequestOfAnotherConnection_NotFound()
+        {
+            // Arrange
+            using ManualResetEventSlim started = new ManualResetEventSlim();
+            using RequestsScheduler scheduler = new RequestsScheduler("Test", msg => SpinUntilCancelled(msg, started), _ => true);
+            TaskCompletionSource<string> response = new TaskCompletionSource<string>();
+            scheduler.Schedule(CreateMessage("/heap", "7", 1, body => response.SetResult(body)));
+            Assert.That(started.Wait(TimeSpan.FromSeconds(5)), Is.True);
+
+            // Act
+            bool found = scheduler.Cancel(2, "7");
+
+            // Assert
+            Assert.That(found, Is.False);
+            Assert.That(response.Task.IsCompleted, Is.False);
+            scheduler.Cancel(1, "7");
+            Assert.That(response.Task.Wait(TimeSpan.FromSeconds(5)), Is.True);
+        }
+
+        [Test]
+        public void ConnectionDropped_RunningRequestCancelled()
+        {
+            // Arrange
+            using ManualResetEventSlim started = new ManualResetEventSlim();
+            using RequestsScheduler scheduler = new RequestsScheduler("Test", msg => SpinUntilCancelled(msg, started), _ => true);
+            using CancellationTokenSource connectionCts = new CancellationTokenSource();
+            TaskCompletionSource<string> response = new TaskCompletionSource<string>();
+            scheduler.Schedule(CreateMessage("/heap", "7", 1, body => response.SetResult(body), connectionCts.Token));
+            Assert.That(started.Wait(TimeSpan.FromSeconds(5)), Is.True);
+
+            // Act
+            connectionCts.Cancel();
+
+            // Assert
+            Assert.That(response.Task.Wait(TimeSpan.FromMilliseconds(500)), Is.True);
+        }
+
+        [Test]
+        public void BulkLaneSaturated_InteractiveRequestStillServed()
+        {
+            // Arrange
+            using ManualResetEventSlim releaseBulk = new ManualResetEventSlim();
+            using RequestsScheduler scheduler = new RequestsScheduler("Test", msg =>
+            {
+                if (msg.UrlAbsolutePath == "/heap")
+                    releaseBulk.Wait();
+                msg.ResponseSender(msg.UrlAbsolutePath);
+            }, endpoint => endpoint == "/heap");
+            for (int i = 0; i < RequestsScheduler.BulkWorkersCount * 4; i++)
+            {
+                scheduler.Schedule(CreateMessage("/heap", i.ToString(), 1, _ => { }));
+            }
+
+            // Act
+            TaskCompletionSource<string> response = new TaskCompletionSource<string>();
+            scheduler.Schedule(CreateMessage("/get_field", "1000", 1, body => response.SetResult(body)));
+
+            // Assert
+            Assert.That(response.Task.Wait(TimeSpan.FromSeconds(5)), Is.True);
+            Assert.That(response.Task.Result, Is.EqualTo("/get_field"));
+            releaseBulk.Set();
+        }
+    }
+}
@@ -0,0 +1,142 @@
+using System.Collections.Concurrent;
+using System.Collections.Specialized;
+using System.Diagnostics;
+using System.Net;
+using System.Net.Sockets;
+using ScubaDiver;
+using ScubaDiver.API.Protocol.SimpleHttp;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class RnetRequestsListenerTests
+    {
+        private static ushort GetFreePort()
+        {
+            TcpListener l = new TcpListener(IPAddress.Loopback, 0);
+            l.Start();
+            int port = ((IPEndPoint)l.LocalEndpoint).Port;
+            l.Stop();
+            return (ushort)port;
+        }
+
+        private static ConcurrentHttpClient Connect(ushort port)
+        {
+            TcpClient tcpClient = new TcpClient();
+            tcpClient.Connect(new IPEndPoint(IPAddress.Loopback, port));
+            return new ConcurrentHttpClient(tcpClient, -1);
+        }
+
+        private static HttpRequestSummary Request(string path, string value = "")
+        {
+            return HttpRequestSummary.FromJson(path, new NameValueCollection { ["value"] = value }, null);
+        }
+
+        /// <summary>
+        /// Creates a scheduler which sleeps for 'heapDelay' on "/heap" and answers everything else immediately
+        /// by echoing the 'value' query parameter. Like in the divers, "/heap" runs on the bulk lane.
+        /// </summary>
+        private static RequestsScheduler CreateScheduler(TimeSpan heapDelay)
+        {
+            return new RequestsScheduler("Test", msg =>
+            {
+                if (msg.UrlAbsolutePath == "/heap")
+                    Thread.Sleep(heapDelay);
+                msg.ResponseSender($"{{\"value\":\"{msg.QueryString.Get("value")}\"}}");
+            }, endpoint => endpoint == "/heap");
+        }
+
+        private static RnetRequestsListener StartListener(ushort port, RequestsScheduler scheduler)
+        {
+            RnetRequestsListener listener = new RnetRequestsListener(port);
+            listener.RequestReceived += (_, msg) => scheduler.Schedule(msg);
+            listener.Start();
+            return listener;
+        }
+
+        [Test]
+        public void ConcurrentRequests_ResponsesMatchRequests()
+        {
+            // Arrange
+            ushort port = GetFreePort();
+            using RequestsScheduler scheduler = CreateScheduler(TimeSpan.FromMilliseconds(5));
+            using RnetRequestsListener listener = StartListener(port, scheduler);
+            List<ConcurrentHttpClient> clients = Enumerable.Range(0, 4).Select(_ => Connect(port)).ToList();
+            ConcurrentBag<string> mismatches = new ConcurrentBag<string>();
+
+            // Act
+            Parallel.For(0, 400, new ParallelOptions { MaxDegreeOfParallelism = 64 }, i =>
+            {
+                ConcurrentHttpClient client = clients[i % clients.Count];
+                string path = i % 10 == 0 ? "/heap" : "/ping";
+                HttpResponseSummary resp = client.Send(Request(path, i.ToString()));
+                if (resp.BodyString != $"{{\"value\":\"{i}\"}}")
+                    mismatches.Add($"#{i}: {resp.BodyString}");
+            });
+
+            // Assert
+            Assert.That(mismatches, Is.Empty);
+            clients.ForEach(c => c.Dispose());
+            listener.Stop();
+        }
+
+        [Test, Explicit("Load benchmark. Reports /ping latency percentiles while /heap requests flood the listener.")]
+        public void Benchmark_PingLatencyUnderHeapStorm()
+        {
+            // Arrange
+            const int stormConnections = 4;
+            const int stormSendersPerConnection = 64;
+            const int pings = 500;
+            ushort port = GetFreePort();
+            using RequestsScheduler scheduler = CreateScheduler(TimeSpan.FromMilliseconds(200));
+            using RnetRequestsListener listener = StartListener(port, scheduler);
+            List<ConcurrentHttpClient> stormClients = Enumerable.Range(0, stormConnections).Select(_ => Connect(port)).ToList();
+            using ConcurrentHttpClient pingClient = Connect(port);
+
+            using CancellationTokenSource stormCts = new CancellationTokenSource();
+            int heapsDone = 0;
+            List<Thread> stormSenders = new List<Thread>();
+            foreach (ConcurrentHttpClient stormClient in stormClients)
+            {
+                for (int i = 0; i < stormSendersPerConnection; i++)
+                {
+                    Thread t = new Thread(() =>
+                    {
+                        while (!stormCts.IsCancellationRequested)
+                        {
+                            stormClient.Send(Request("/heap"));
+                            Interlocked.Increment(ref heapsDone);
+                        }
+                    }) { IsBackground = true };
+                    t.Start();
+                    stormSenders.Add(t);
+                }
+            }
+            // Let the storm build up
+            Thread.Sleep(TimeSpan.FromSeconds(1));
+
+            // Act
+            List<double> latenciesMs = new List<double>(pings);
+            Stopwatch total = Stopwatch.StartNew();
+            for (int i = 0; i < pings; i++)
+            {
+                Stopwatch sw = Stopwatch.StartNew();
+                pingClient.Send(Request("/ping", i.ToString()));
+                latenciesMs.Add(sw.Elapsed.TotalMilliseconds);
+            }
+            total.Stop();
+            stormCts.Cancel();
+
+            // Report
+            latenciesMs.Sort();
+            double Percentile(double p) => latenciesMs[Math.Min(latenciesMs.Count - 1, (int)(p / 100.0 * latenciesMs.Count))];
+            TestContext.Out.WriteLine($"/ping x{pings} under a /heap storm ({stormConnections} connections x {stormSendersPerConnection} senders, " +
+                                      $"{heapsDone} heaps served) took {total.Elapsed.TotalSeconds:F2}s");
+            TestContext.Out.WriteLine($"p50={Percentile(50):F2}ms p90={Percentile(90):F2}ms p99={Percentile(99):F2}ms max={latenciesMs.Last():F2}ms");
+
+            Assert.That(latenciesMs, Has.Count.EqualTo(pings));
+            stormClients.ForEach(c => c.Dispose());
+            listener.Stop();
+        }
+    }
+}
@@ -0,0 +1,37 @@
+using ScubaDiver.Rtti;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class RttiNameUndecoratorTests
+    {
+        [TestCase("?type_info@@", "type_info")]
+        [TestCase("?Foo@Bar@Baz@@", "Baz::Bar::Foo")]
+        [TestCase("??$vector@HV?$allocator@H@std@@@std@@", "std::vector<int,class std::allocator<int> >")]
+        [TestCase("??$Holder@PEAVWidget@ui@@$0BA@@ui@@", "ui::Holder<class ui::Widget * __ptr64,16>")]
+        [TestCase("??$pair@VKey@detail@@V12@@std@@", "std::pair<class detail::Key,class detail::Key>")]
+        [TestCase("?Impl@?A0x1b2c3d4e@@", "`anonymous namespace'::Impl")]
+        public void Undecorate_ClassSymbol_MatchesDbgHelpStyle(string symbol, string expected)
+        {
+            // Act
+            string name = RttiNameUndecorator.Undecorate(symbol);
+
+            // Assert
+            Assert.That(name, Is.EqualTo(expected));
+        }
+
+        [TestCase("Foo@@")]
+        [TestCase("?Foo@")]
+        [TestCase("?Fo\ao@@")]
+        [TestCase("?Foo@@trailing")]
+        [TestCase("??$vector@H")]
+        public void Undecorate_Garbage_ReturnsNull(string symbol)
+        {
+            // Act
+            string name = RttiNameUndecorator.Undecorate(symbol);
+
+            // Assert
+            Assert.That(name, Is.Null);
+        }
+    }
+}
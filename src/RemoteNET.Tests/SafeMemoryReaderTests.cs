@@ -0,0 +1,83 @@
+using System.Runtime.InteropServices;
+using ScubaDiver;
+using ScubaDiver.API.Interactions.Memory;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class SafeMemoryReaderTests
+    {
+        [Test]
+        public void ReadRanges_ScatteredAndFaultedRanges_StatusAndDataInRequestOrder()
+        {
+            // Arrange
+            byte[] memory = Enumerable.Range(0, 1024).Select(i => (byte)i).ToArray();
+            GCHandle handle = GCHandle.Alloc(memory, GCHandleType.Pinned);
+            try
+            {
+                ulong baseAddress = (ulong)handle.AddrOfPinnedObject();
+                // Out of order, close enough to be read together, far apart, unmapped and empty
+                ulong[] addresses = { baseAddress + 100, baseAddress + 10, 0x10, baseAddress + 1000, baseAddress };
+                int[] lengths = { 4, 8, 16, 3, 0 };
+
+                // Act
+                byte[] response = SafeMemoryReader.ReadRanges(addresses, lengths);
+
+                // Assert
+                byte read = (byte)ReadMemoryRequest.RangeStatus.Read;
+                byte faulted = (byte)ReadMemoryRequest.RangeStatus.Faulted;
+                Assert.That(response.Take(5), Is.EqualTo(new[] { read, read, faulted, read, read }));
+                byte[] expectedData = memory.Skip(100).Take(4)
+                    .Concat(memory.Skip(10).Take(8))
+                    .Concat(new byte[16])
+                    .Concat(memory.Skip(1000).Take(3))
+                    .ToArray();
+                Assert.That(response.Skip(5), Is.EqualTo(expectedData));
+            }
+            finally
+            {
+                handle.Free();
+            }
+        }
+
+        [Test]
+        public void ReadRanges_CoalescedSpanHitsUnmappedPage_OtherRangesStillRead()
+        {
+            // Arrange - The last readable bytes before a reserved-only page
+            IntPtr region = VirtualAlloc(IntPtr.Zero, 0x2000u, MemReserve, PageReadWrite);
+            VirtualAlloc(region, 0x1000u, MemCommit, PageReadWrite);
+            try
+            {
+                ulong pageEnd = (ulong)region + 0x1000;
+                Marshal.WriteByte((IntPtr)(long)(pageEnd - 8), 0x42);
+                ulong[] addresses = { pageEnd - 8, pageEnd + 8 };
+                int[] lengths = { 1, 1 };
+
+                // Act
+                byte[] response = SafeMemoryReader.ReadRanges(addresses, lengths);
+
+                // Assert
+                Assert.That(response, Is.EqualTo(new byte[] {
+                    (byte)ReadMemoryRequest.RangeStatus.Read,
+                    (byte)ReadMemoryRequest.RangeStatus.Faulted,
+                    0x42, 0x00 }));
+            }
+            finally
+            {
+                VirtualFree(region, UIntPtr.Zero, MemRelease);
+            }
+        }
+
+        private const uint MemCommit = 0x1000;
+        private const uint MemReserve = 0x2000;
+        private const uint MemRelease = 0x8000;
+        private const uint PageReadWrite = 0x04;
+
+        [DllImport("kernel32.dll", SetLastError = true)]
+        private static extern IntPtr VirtualAlloc(IntPtr lpAddress, UIntPtr dwSize, uint flAllocationType, uint flProtect);
+
+        [DllImport("kernel32.dll", SetLastError = true)]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        private static extern bool VirtualFree(IntPtr lpAddress, UIntPtr dwSize, uint dwFreeType);
+    }
+}
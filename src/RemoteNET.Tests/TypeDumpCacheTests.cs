@@ -0,0 +1,95 @@
+using ScubaDiver;
+using ScubaDiver.API.Interactions.Dumps;
+using ScubaDiver.API.Utils;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class TypeDumpCacheTests
+    {
+        private static TypeDump CreateDump(string typeName) => new TypeDump()
+        {
+            FullTypeName = typeName,
+            Assembly = "Assembly",
+            Methods = new List<TypeDump.TypeMethod>()
+        };
+
+        [Test]
+        public void GetOrCreate_SameKey_DumpsOnceUntilInvalidated()
+        {
+            // Arrange
+            TypeDumpCache cache = new TypeDumpCache();
+            int dumps = 0;
+            TypeDump Dump()
+            {
+                dumps++;
+                return CreateDump("MyType");
+            }
+
+            // Act
+            string first = cache.GetOrCreate("Assembly!MyType", Dump);
+            string second = cache.GetOrCreate("Assembly!MyType", Dump);
+            cache.Invalidate();
+            string afterInvalidation = cache.GetOrCreate("Assembly!MyType", Dump);
+
+            // Assert
+            Assert.That(dumps, Is.EqualTo(2));
+            Assert.That(second, Is.SameAs(first));
+            // Same content, same ETag
+            Assert.That(afterInvalidation, Is.EqualTo(first));
+        }
+
+        [Test]
+        public void GetOrCreate_CurrentETag_NotModifiedDump()
+        {
+            // Arrange
+            TypeDumpCache cache = new TypeDumpCache();
+            TypeDump full = JsonConvert.DeserializeObject<TypeDump>(cache.GetOrCreate("Assembly!MyType", () => CreateDump("MyType")));
+
+            // Act
+            TypeDump notModified = JsonConvert.DeserializeObject<TypeDump>(cache.GetOrCreate("Assembly!MyType", () => CreateDump("MyType"), full.ETag));
+            TypeDump staleETag = JsonConvert.DeserializeObject<TypeDump>(cache.GetOrCreate("Assembly!MyType", () => CreateDump("MyType"), "0000000000000000"));
+            TypeDump otherType = JsonConvert.DeserializeObject<TypeDump>(cache.GetOrCreate("Assembly!OtherType", () => CreateDump("OtherType"), full.ETag));
+
+            // Assert
+            Assert.That(full.ETag, Is.Not.Null);
+            Assert.That(full.NotModified, Is.False);
+            Assert.That(notModified.NotModified, Is.True);
+            Assert.That(notModified.ETag, Is.EqualTo(full.ETag));
+            Assert.That(notModified.FullTypeName, Is.Null);
+            Assert.That(staleETag.FullTypeName, Is.EqualTo("MyType"));
+            Assert.That(otherType.NotModified, Is.False);
+            Assert.That(otherType.ETag, Is.Not.EqualTo(full.ETag));
+        }
+
+        [Test]
+        public void GetOrCreate_ETagWrittenIntoJson_MatchesSerializedDump()
+        {
+            // Arrange
+            TypeDumpCache cache = new TypeDumpCache();
+
+            // Act
+            string json = cache.GetOrCreate("Assembly!MyType", () => CreateDump("MyType"));
+            TypeDump dump = JsonConvert.DeserializeObject<TypeDump>(json);
+
+            // Assert
+            Assert.That(dump.ETag, Is.Not.Null);
+            Assert.That(JsonConvert.SerializeObject(dump), Is.EqualTo(json));
+        }
+
+        [Test]
+        public void GetOrCreate_TypeNotFound_NotCached()
+        {
+            // Arrange
+            TypeDumpCache cache = new TypeDumpCache();
+
+            // Act
+            string missing = cache.GetOrCreate("Assembly!MyType", () => null!);
+            string found = cache.GetOrCreate("Assembly!MyType", () => CreateDump("MyType"));
+
+            // Assert
+            Assert.That(missing, Is.Null);
+            Assert.That(found, Is.Not.Null);
+        }
+    }
+}
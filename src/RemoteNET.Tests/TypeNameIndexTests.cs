@@ -0,0 +1,141 @@
+using System.Diagnostics;
+using ScubaDiver;
+using ScubaDiver.API.Utils;
+
+namespace RemoteNET.Tests
+{
+    [TestFixture]
+    public class TypeNameIndexTests
+    {
+        private static readonly string[] Names =
+        {
+            "ns::Foo",
+            "ns::FooBar",
+            "ns::detail::Foo",
+            "other::Foo",
+            "ns::Baz<ns::Foo *>",
+            "Fo",
+        };
+
+        private static TypeNameIndex<string> CreateIndex(IEnumerable<string> names)
+        {
+            TypeNameIndex<string> index = new TypeNameIndex<string>();
+            foreach (string name in names)
+                index.Add(name, name);
+            return index;
+        }
+
+        [TestCase(null)]
+        [TestCase("")]
+        [TestCase("*")]
+        [TestCase("ns::Foo")]
+        [TestCase("ns::Foo*")]
+        [TestCase("*Foo")]
+        [TestCase("*Foo*")]
+        [TestCase("ns::*Foo")]
+        [TestCase("*::Foo*")]
+        [TestCase("ns::*::*")]
+        [TestCase("*Fo*")]
+        [TestCase("*o*")]
+        [TestCase("*Missing*")]
+        [TestCase("ns::Baz<ns::Foo *>")]
+        public void Query_MatchesFilterPredicate(string filter)
+        {
+            // Arrange
+            TypeNameIndex<string> index = CreateIndex(Names);
+            Predicate<string> predicate = Filter.CreatePredicate(filter);
+
+            // Act
+            List<string> results = index.Query(filter);
+
+            // Assert
+            Assert.That(results, Is.EqualTo(Names.Where(name => predicate(name))));
+        }
+
+        [Test]
+        public void Query_NamesAddedAfterQuerying_AreFound()
+        {
+            // Arrange
+            TypeNameIndex<string> index = CreateIndex(Names);
+            _ = index.Query("ns::*");
+            _ = index.Query("*Bar*");
+
+            // Act
+            index.Add("ns::LateBar", "ns::LateBar");
+            List<string> prefixResults = index.Query("ns::L*");
+            List<string> substringResults = index.Query("*Bar*");
+
+            // Assert
+            Assert.That(prefixResults, Is.EqualTo(new[] { "ns::LateBar" }));
+            Assert.That(substringResults, Is.EqualTo(new[] { "ns::FooBar", "ns::LateBar" }));
+        }
+
+        [Test]
+        public void Exact_WildcardInName_TakenLiterally()
+        {
+            // Arrange
+            TypeNameIndex<string> index = CreateIndex(Names);
+
+            // Act
+            List<string> results = index.Exact("ns::Baz<ns::Foo *>");
+            List<string> noResults = index.Exact("ns::*");
+
+            // Assert
+            Assert.That(results, Is.EqualTo(new[] { "ns::Baz<ns::Foo *>" }));
+            Assert.That(noResults, Is.Empty);
+        }
+
+        [Test]
+        public void Add_SameNameTwice_ItemsKeptOnce()
+        {
+            // Arrange
+            TypeNameIndex<int> index = new TypeNameIndex<int>();
+
+            // Act
+            index.Add("Name", 1);
+            index.Add("Name", 1);
+            index.Add("Name", 2);
+
+            // Assert
+            Assert.That(index.Count, Is.EqualTo(1));
+            Assert.That(index.Query("Name"), Is.EqualTo(new[] { 1, 2 }));
+        }
+
+        [Test]
+        [Explicit("Benchmark")]
+        public void Benchmark_QueryVersusPredicateScan()
+        {
+            // Arrange
+            const int typesCount = 300_000;
+            const int iterations = 20;
+            List<string> names = Enumerable.Range(0, typesCount).Select(i => $"ns{i % 97}::detail::Type{i}<int>").ToList();
+            TypeNameIndex<string> index = CreateIndex(names);
+            string[] filters = { "ns42::detail::Type4242<int>", "ns42::*", "*Type12345<*" };
+            foreach (string filter in filters)
+                _ = index.Query(filter);
+
+            // Act
+            Stopwatch scan = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+            {
+                foreach (string filter in filters)
+                {
+                    Predicate<string> predicate = Filter.CreatePredicate(filter);
+                    _ = names.Where(name => predicate(name)).ToList();
+                }
+            }
+            scan.Stop();
+            Stopwatch indexed = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+            {
+                foreach (string filter in filters)
+                    _ = index.Query(filter);
+            }
+            indexed.Stop();
+
+            // Assert
+            TestContext.Out.WriteLine($"Predicate scan: {scan.Elapsed.TotalMilliseconds / iterations:N2} ms, Index: {indexed.Elapsed.TotalMilliseconds / iterations:N2} ms");
+            Assert.That(indexed.Elapsed, Is.LessThan(scan.Elapsed));
+        }
+    }
+}
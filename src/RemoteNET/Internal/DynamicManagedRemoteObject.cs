@@ -41,27 +41,36 @@ namespace RemoteNET.Internal
             {
                 ScubaDiver.API.ObjectOrRemoteAddress ooraKey = ManagedRemoteFunctionsInvokeHelper.CreateRemoteParameter(key);
                 ScubaDiver.API.ObjectOrRemoteAddress item = __ro.GetItem(ooraKey);
-                if (item.IsNull)
-                {
-                    return null;
-                }
-                else if (item.IsRemoteAddress)
-                {
-                    return __ra.GetRemoteObject(item).Dynamify();
-                }
-                else
-                {
-                    return PrimitivesEncoder.Decode(item.EncodedObject, item.Type);
-                }
+                return __DecodeItem(item);
             }
             set => throw new NotImplementedException();
         }
 
+        private object __DecodeItem(ScubaDiver.API.ObjectOrRemoteAddress item)
+        {
+            if (item.IsNull)
+            {
+                return null;
+            }
+            else if (item.IsRemoteAddress)
+            {
+                return __ra.GetRemoteObject(item).Dynamify();
+            }
+            else
+            {
+                return PrimitivesEncoder.Decode(item.EncodedObject, item.Type);
+            }
+        }
+
         public IEnumerator GetEnumerator()
         {
             if (!__members.Any(member => member.Name == nameof(GetEnumerator)))
                 throw new Exception($"No method called {nameof(GetEnumerator)} found. The remote object probably doesn't implement IEnumerable");
 
+            // Items are fetched a page at a time
+            if (__ro is ManagedRemoteObject managedRo)
+                return managedRo.GetPagedEnumerator(__DecodeItem);
+
             dynamic enumeratorDro = InvokeMethod<object>(nameof(GetEnumerator));
             return new DynamicRemoteEnumerator(enumeratorDro);
         }
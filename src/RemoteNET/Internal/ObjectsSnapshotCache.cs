@@ -0,0 +1,85 @@
+using System.Collections.Generic;
+using System.Linq;
+using ScubaDiver.API;
+using ScubaDiver.API.Interactions.Object;
+
+namespace RemoteNET.Internal
+{
+    /// <summary>
+    /// Field values of remote objects, read in bulk with /objects_snapshot.
+    /// Reads are served from here until the objects are snapshotted again or the diver reports a new GC epoch.
+    /// </summary>
+    internal class ObjectsSnapshotCache
+    {
+        private readonly Dictionary<ulong, ObjectsSnapshot.ObjectSnapshot> _snapshots = new Dictionary<ulong, ObjectsSnapshot.ObjectSnapshot>();
+        private readonly object _lock = new object();
+        private long? _gcEpoch;
+
+        /// <summary>
+        /// Stores the objects of a new snapshot.
+        /// If the GC epoch changed, snapshots of the previous epoch are dropped: Addresses of unpinned objects in them might be stale.
+        /// </summary>
+        /// <returns>True if the GC epoch changed</returns>
+        public bool Update(ObjectsSnapshot snapshot)
+        {
+            lock (_lock)
+            {
+                bool epochChanged = _gcEpoch.HasValue && _gcEpoch.Value != snapshot.GcEpoch;
+                if (epochChanged)
+                {
+                    _snapshots.Clear();
+                }
+                _gcEpoch = snapshot.GcEpoch;
+
+                foreach (ObjectsSnapshot.ObjectSnapshot objSnapshot in snapshot.Objects)
+                {
+                    if (objSnapshot.Error != null)
+                    {
+                        // Reads of this object go to the diver, where the error will show
+                        _snapshots.Remove(objSnapshot.Address);
+                        continue;
+                    }
+                    _snapshots[objSnapshot.Address] = objSnapshot;
+                }
+                return epochChanged;
+            }
+        }
+
+        public bool TryGetField(ulong address, string fieldName, out ObjectOrRemoteAddress value)
+        {
+            lock (_lock)
+            {
+                if (_snapshots.TryGetValue(address, out ObjectsSnapshot.ObjectSnapshot objSnapshot))
+                {
+                    return objSnapshot.Fields.TryGetValue(fieldName, out value);
+                }
+            }
+            value = null;
+            return false;
+        }
+
+        public List<(ulong address, string typeFullName)> GetSnapshottedObjects()
+        {
+            lock (_lock)
+            {
+                return _snapshots.Values.Select(objSnapshot => (objSnapshot.Address, objSnapshot.Type)).ToList();
+            }
+        }
+
+        public void Invalidate(ulong address)
+        {
+            lock (_lock)
+            {
+                _snapshots.Remove(address);
+            }
+        }
+
+        public void Clear()
+        {
+            lock (_lock)
+            {
+                _snapshots.Clear();
+            }
+        }
+    }
+}
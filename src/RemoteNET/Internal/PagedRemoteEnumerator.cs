@@ -0,0 +1,88 @@
+using System;
+using System.Collections;
+using System.Collections.Generic;
+using ScubaDiver.API;
+using ScubaDiver.API.Interactions.Object;
+
+namespace RemoteNET.Internal
+{
+    /// <summary>
+    /// Enumerates a remote collection a page at a time (/get_items) instead of a round-trip per item.
+    /// Items are only decoded (and remote objects only created) once they're reached. Pins of items which are never reached are
+    /// released when the enumerator is disposed.
+    /// </summary>
+    public class PagedRemoteEnumerator : IEnumerator, IDisposable
+    {
+        public const int DefaultPageSize = 256;
+
+        private readonly Func<long, int, ItemsRange> _getNextItems;
+        private readonly Action<long, List<ulong>> _closeCursor;
+        private readonly Func<ObjectOrRemoteAddress, object> _decode;
+        private readonly int _pageSize;
+
+        private readonly Queue<ObjectOrRemoteAddress> _page = new Queue<ObjectOrRemoteAddress>();
+        private long _cursor;
+        private bool _done;
+        private object _current;
+
+        /// <param name="getNextItems">Gets a page given the cursor (0 for the first page) and the page size</param>
+        /// <param name="closeCursor">Closes an enumeration which wasn't read to its end (0 if only its last page wasn't)
+        /// and releases the pins of the given unreached items</param>
+        /// <param name="decode">Turns an item into a primitive or a remote object</param>
+        public PagedRemoteEnumerator(Func<long, int, ItemsRange> getNextItems, Action<long, List<ulong>> closeCursor,
+            Func<ObjectOrRemoteAddress, object> decode, int pageSize = DefaultPageSize)
+        {
+            _getNextItems = getNextItems;
+            _closeCursor = closeCursor;
+            _decode = decode;
+            _pageSize = pageSize;
+        }
+
+        public object Current => _current;
+
+        public bool MoveNext()
+        {
+            if (_page.Count == 0 && !_done)
+            {
+                ItemsRange range = _getNextItems(_cursor, _pageSize);
+                foreach (ObjectOrRemoteAddress item in range.Items)
+                    _page.Enqueue(item);
+                _cursor = range.Cursor;
+                _done = range.Done;
+            }
+
+            if (_page.Count == 0)
+            {
+                _current = null;
+                return false;
+            }
+            _current = _decode(_page.Dequeue());
+            return true;
+        }
+
+        public void Reset()
+        {
+            Dispose();
+            _done = false;
+            _current = null;
+        }
+
+        public void Dispose()
+        {
+            List<ulong> unreached = new List<ulong>();
+            foreach (ObjectOrRemoteAddress item in _page)
+            {
+                if (item.IsRemoteAddress && !item.IsNull)
+                    unreached.Add(item.RemoteAddress);
+            }
+            _page.Clear();
+
+            long cursor = _cursor;
+            _cursor = 0;
+            _done = true;
+            if (cursor == 0 && unreached.Count == 0)
+                return;
+            _closeCursor(cursor, unreached);
+        }
+    }
+}
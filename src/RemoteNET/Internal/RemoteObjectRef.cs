@@ -1,8 +1,10 @@
 using System;
+using System.Collections.Generic;
 using System.Linq;
 using ScubaDiver.API;
 using ScubaDiver.API.Interactions;
 using ScubaDiver.API.Interactions.Dumps;
+using ScubaDiver.API.Interactions.Object;
 
 namespace RemoteNET.Internal
 {
@@ -139,5 +141,15 @@ namespace RemoteNET.Internal
         {
             return CreatingCommunicator.GetItem(this.Token, key);
         }
+
+        internal ItemsRange GetNextItems(long cursor, int count)
+        {
+            return CreatingCommunicator.GetNextItems(this.Token, cursor, count);
+        }
+
+        internal void CloseItemsCursor(long cursor, IEnumerable<ulong> unusedItems)
+        {
+            CreatingCommunicator.CloseItemsCursor(cursor, unusedItems);
+        }
     }
 }
\ No newline at end of file
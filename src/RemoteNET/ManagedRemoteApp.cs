@@ -47,6 +47,18 @@ namespace RemoteNET
                 return remoteObject;
             }
 
+            /// <summary>
+            /// Whether a remote object of this pinned address is still alive
+            /// </summary>
+            public bool Contains(ulong address)
+            {
+                lock (_lock)
+                {
+                    return _pinnedAddressesToRemoteObjects.TryGetValue(address, out WeakReference<ManagedRemoteObject> weakRef) &&
+                           weakRef.TryGetTarget(out _);
+                }
+            }
+
             public ManagedRemoteObject GetRemoteObject(ulong address, string typeName, int? hashcode = null)
             {
                 ManagedRemoteObject ro;
@@ -100,6 +112,8 @@ namespace RemoteNET
         private RemoteHookingManager _hookingManager;
         public override RemoteHookingManager HookingManager => _hookingManager;
 
+        internal ObjectsSnapshotCache SnapshotCache { get; } = new ObjectsSnapshotCache();
+
 
         public Process Process => _procWithDiver;
         ManagedRemoteActivator _activator;
@@ -219,11 +233,49 @@ namespace RemoteNET
         // Getting Remote Objects
         //
 
+        internal bool HasRemoteObject(ulong pinnedAddress) => _remoteObjects.Contains(pinnedAddress);
+
         public override ManagedRemoteObject GetRemoteObject(ulong remoteAddress, string typeName, int? hashCode = null)
         {
             return _remoteObjects.GetRemoteObject(remoteAddress, typeName, hashCode);
         }
 
+        //
+        // Objects Snapshots
+        //
+
+        /// <summary>
+        /// Reads all fields of the given objects in a single request. Until the snapshot is refreshed, reading their fields
+        /// returns the values from the snapshot instead of querying the remote app.
+        /// </summary>
+        public void SnapshotObjects(IEnumerable<ManagedRemoteObject> objects)
+        {
+            var targets = objects.Select(ro => (ro.RemoteToken, ro.RemoteTypeFullName)).ToList();
+            SnapshotCache.Update(_managedCommunicator.GetObjectsSnapshot(targets));
+        }
+
+        /// <summary>
+        /// Reads the fields of all snapshotted objects again
+        /// </summary>
+        public void RefreshSnapshots()
+        {
+            SnapshotCache.Update(_managedCommunicator.GetObjectsSnapshot(SnapshotCache.GetSnapshottedObjects()));
+        }
+
+        /// <summary>
+        /// Asks the remote app for its GC epoch and drops all snapshots if a GC happened since they were taken.
+        /// </summary>
+        /// <returns>True if the snapshots were dropped</returns>
+        public bool DropSnapshotsIfGcEpochChanged()
+        {
+            return SnapshotCache.Update(_managedCommunicator.GetObjectsSnapshot(Enumerable.Empty<(ulong, string)>()));
+        }
+
+        /// <summary>
+        /// Drops all snapshots. Following field reads query the remote app.
+        /// </summary>
+        public void ClearSnapshots() => SnapshotCache.Clear();
+
         //
         // Inject assemblies
         //
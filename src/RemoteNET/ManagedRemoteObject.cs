@@ -1,5 +1,6 @@
 using System;
 using System.Collections.Generic;
+using System.Linq;
 using System.Reflection;
 using RemoteNET.Common;
 using RemoteNET.Internal;
@@ -7,6 +8,7 @@ using ScubaDiver.API;
 using ScubaDiver.API.Hooking;
 using ScubaDiver.API.Interactions;
 using ScubaDiver.API.Interactions.Dumps;
+using ScubaDiver.API.Interactions.Object;
 
 namespace RemoteNET
 {
@@ -22,6 +24,9 @@ namespace RemoteNET
         private readonly Dictionary<Delegate, DiverCommunicator.LocalEventCallback> _eventCallbacksAndProxies;
 
         public override ulong RemoteToken => _ref.Token;
+        internal string RemoteTypeFullName => _ref.RemoteObjectInfo.Type;
+
+        private ObjectsSnapshotCache SnapshotCache => (_app as ManagedRemoteApp)?.SnapshotCache;
 
         internal ManagedRemoteObject(RemoteObjectRef reference, RemoteApp remoteApp)
         {
@@ -43,6 +48,7 @@ namespace RemoteNET
         public ObjectOrRemoteAddress SetField(string fieldName, ObjectOrRemoteAddress newValue)
         {
             InvocationResults invokeRes = _ref.SetField(fieldName, newValue);
+            SnapshotCache?.Invalidate(_ref.Token);
             return invokeRes.ReturnedObjectOrAddress;
 
         }
@@ -76,6 +82,8 @@ namespace RemoteNET
         {
             try
             {
+                if (_ref != null)
+                    SnapshotCache?.Invalidate(_ref.Token);
                 _ref?.RemoteRelease();
             }
             catch
@@ -92,6 +100,9 @@ namespace RemoteNET
 
         public ObjectOrRemoteAddress GetField(string name)
         {
+            if (SnapshotCache?.TryGetField(_ref.Token, name, out ObjectOrRemoteAddress snapshotValue) == true)
+                return snapshotValue;
+
             var res = _ref.GetField(name);
             return res.ReturnedObjectOrAddress;
         }
@@ -138,6 +149,19 @@ namespace RemoteNET
             return  _ref.GetItem(key);
         }
 
+        /// <summary>
+        /// Enumerates the remote collection a page at a time
+        /// </summary>
+        internal PagedRemoteEnumerator GetPagedEnumerator(Func<ObjectOrRemoteAddress, object> decode) =>
+            new PagedRemoteEnumerator(_ref.GetNextItems, CloseItemsCursor, decode);
+
+        private void CloseItemsCursor(long cursor, List<ulong> unreachedItems)
+        {
+            // Items might be objects this app already holds through other remote objects. Those pins are still in use.
+            ManagedRemoteApp app = _app as ManagedRemoteApp;
+            _ref.CloseItemsCursor(cursor, unreachedItems.Where(address => app == null || !app.HasRemoteObject(address)));
+        }
+
         public override RemoteObject Cast(Type t)
         {
             throw new NotImplementedException("Not implemented in Managed context");
@@ -0,0 +1,114 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Threading;
+using RemoteNET.Access;
+using RemoteNET.Utils;
+
+namespace RemoteNET;
+
+/// <summary>
+/// Holds connections to many target processes and runs queries on all of them at once.
+/// Targets are queried concurrently (up to <see cref="MaxParallelism"/> at a time) and each result is yielded as soon as its target responds,
+/// so one slow or hung process doesn't hold up the others.
+/// </summary>
+public class MultiRemoteAppsHub : IDisposable
+{
+    private readonly object _lock = new();
+    private readonly List<RemoteApp> _apps = new();
+
+    /// <summary>
+    /// How many targets are queried at the same time
+    /// </summary>
+    public int MaxParallelism { get; set; } = 8;
+
+    /// <summary>
+    /// How long to wait for each target before reporting it as timed out.
+    /// <see cref="System.Threading.Timeout.InfiniteTimeSpan"/> to wait forever.
+    /// </summary>
+    public TimeSpan Timeout { get; set; } = TimeSpan.FromSeconds(30);
+
+    public IReadOnlyList<RemoteApp> Apps
+    {
+        get
+        {
+            lock (_lock)
+            {
+                return _apps.ToList();
+            }
+        }
+    }
+
+    public void Add(RemoteApp app)
+    {
+        lock (_lock)
+        {
+            _apps.Add(app);
+        }
+    }
+
+    public bool Remove(RemoteApp app)
+    {
+        lock (_lock)
+        {
+            return _apps.Remove(app);
+        }
+    }
+
+    /// <summary>
+    /// Connects to all the processes concurrently. Connected apps are added to the hub.
+    /// Apps which connect after their target timed out, or after the enumeration stopped, are disposed.
+    /// </summary>
+    /// <returns>The outcome of every connection attempt, in the order they completed</returns>
+    public IEnumerable<FanOutResult<Process, RemoteApp>> Connect(IEnumerable<Process> targets, RuntimeType runtime, ConnectionConfig config = null)
+    {
+        FanOut<Process> fanOut = new FanOut<Process>(MaxParallelism, Timeout);
+        foreach (var result in fanOut.Run(targets.ToList(), (target, _) => RemoteAppFactory.Connect(target, runtime, config),
+                     onDiscarded: app => app?.Dispose()))
+        {
+            if (result.Succeeded && result.Value != null)
+                Add(result.Value);
+            yield return result;
+        }
+    }
+
+    /// <summary>
+    /// Runs a query on every app in the hub
+    /// </summary>
+    /// <returns>Each app's result, as soon as it's available</returns>
+    public IEnumerable<FanOutResult<RemoteApp, T>> Query<T>(Func<RemoteApp, T> query, CancellationToken cancellationToken = default)
+        => Query((app, _) => query(app), cancellationToken);
+
+    /// <summary>
+    /// Runs a query on every app in the hub.
+    /// The query's token is canceled when its app times out or when <paramref name="cancellationToken"/> is canceled.
+    /// </summary>
+    /// <returns>Each app's result, as soon as it's available</returns>
+    public IEnumerable<FanOutResult<RemoteApp, T>> Query<T>(Func<RemoteApp, CancellationToken, T> query, CancellationToken cancellationToken = default)
+    {
+        FanOut<RemoteApp> fanOut = new FanOut<RemoteApp>(MaxParallelism, Timeout);
+        return fanOut.Run(Apps, query, cancellationToken);
+    }
+
+    public void Dispose()
+    {
+        List<RemoteApp> apps;
+        lock (_lock)
+        {
+            apps = _apps.ToList();
+            _apps.Clear();
+        }
+        foreach (RemoteApp app in apps)
+        {
+            try
+            {
+                app.Dispose();
+            }
+            catch (Exception ex)
+            {
+                Logger.Debug($"[MultiRemoteAppsHub] Failed to dispose an app. Error: {ex.Message}");
+            }
+        }
+    }
+}
@@ -0,0 +1,185 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace RemoteNET.Utils
+{
+    /// <summary>
+    /// Outcome of running a query on one target of a <see cref="FanOut{TTarget}"/>
+    /// </summary>
+    public class FanOutResult<TTarget, TResult>
+    {
+        public TTarget Target { get; init; }
+        /// <summary>
+        /// Position of the target in the list the query ran on
+        /// </summary>
+        public int Index { get; init; }
+        public TResult Value { get; init; }
+        /// <summary>
+        /// What the query threw, if it did
+        /// </summary>
+        public Exception Error { get; init; }
+        /// <summary>
+        /// The target didn't respond in time. The query might still be running on it.
+        /// </summary>
+        public bool TimedOut { get; init; }
+        public TimeSpan Elapsed { get; init; }
+
+        public bool Succeeded => Error == null && !TimedOut;
+    }
+
+    /// <summary>
+    /// Runs the same query on many targets concurrently, with a bound on how many run at once and a timeout for each target.
+    /// Results are streamed in the order targets respond.
+    /// </summary>
+    public class FanOut<TTarget>
+    {
+        public int MaxParallelism { get; }
+        /// <summary>
+        /// How long to wait for each target. <see cref="System.Threading.Timeout.InfiniteTimeSpan"/> to wait forever.
+        /// </summary>
+        public TimeSpan Timeout { get; }
+
+        public FanOut(int maxParallelism, TimeSpan timeout)
+        {
+            if (maxParallelism < 1)
+                throw new ArgumentOutOfRangeException(nameof(maxParallelism), "At least one target must run at a time");
+            MaxParallelism = maxParallelism;
+            Timeout = timeout;
+        }
+
+        /// <summary>
+        /// Starts the query on all targets and yields each result as soon as its target responds.
+        /// Failures and timeouts are results too, they don't stop the other targets.
+        /// Stopping the enumeration early cancels the targets which didn't respond yet.
+        /// </summary>
+        /// <param name="query">Runs on a dedicated thread. Gets a token which is canceled on timeout or when the whole run is canceled.</param>
+        /// <param name="onDiscarded">Gets the values nobody receives: Of queries which returned after their target timed out
+        /// or the run was canceled, and of results left when the enumeration stopped early. Use it to dispose them.</param>
+        public IEnumerable<FanOutResult<TTarget, TResult>> Run<TResult>(IReadOnlyList<TTarget> targets,
+            Func<TTarget, CancellationToken, TResult> query, CancellationToken cancellationToken = default, Action<TResult> onDiscarded = null)
+        {
+            using CancellationTokenSource runCts = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+            using BlockingCollection<FanOutResult<TTarget, TResult>> results = new();
+            Task dispatcher = DispatchAsync(targets, query, onDiscarded, results, runCts.Token);
+            try
+            {
+                foreach (FanOutResult<TTarget, TResult> result in results.GetConsumingEnumerable(cancellationToken))
+                    yield return result;
+            }
+            finally
+            {
+                runCts.Cancel();
+                // Don't dispose the results while targets are still adding to them
+                dispatcher.Wait();
+                while (results.TryTake(out FanOutResult<TTarget, TResult> undelivered))
+                {
+                    if (undelivered.Succeeded)
+                        Discard(onDiscarded, undelivered.Value);
+                }
+            }
+        }
+
+        private static void Discard<TResult>(Action<TResult> onDiscarded, TResult value)
+        {
+            if (onDiscarded == null)
+                return;
+            try
+            {
+                onDiscarded(value);
+            }
+            catch (Exception ex)
+            {
+                Logger.Debug($"[FanOut] Failed to discard a result. Error: {ex.Message}");
+            }
+        }
+
+        private async Task DispatchAsync<TResult>(IReadOnlyList<TTarget> targets, Func<TTarget, CancellationToken, TResult> query,
+            Action<TResult> onDiscarded, BlockingCollection<FanOutResult<TTarget, TResult>> results, CancellationToken cancellationToken)
+        {
+            using SemaphoreSlim slots = new SemaphoreSlim(MaxParallelism);
+            List<Task> running = new List<Task>();
+            try
+            {
+                for (int i = 0; i < targets.Count; i++)
+                {
+                    await slots.WaitAsync(cancellationToken).ConfigureAwait(false);
+                    running.Add(RunOneAsync(targets[i], i, query, onDiscarded, results, slots, cancellationToken));
+                }
+            }
+            catch (OperationCanceledException)
+            {
+                // Targets which didn't start are skipped
+            }
+            finally
+            {
+                await Task.WhenAll(running).ConfigureAwait(false);
+                results.CompleteAdding();
+            }
+        }
+
+        private async Task RunOneAsync<TResult>(TTarget target, int index, Func<TTarget, CancellationToken, TResult> query,
+            Action<TResult> onDiscarded, BlockingCollection<FanOutResult<TTarget, TResult>> results, SemaphoreSlim slots, CancellationToken cancellationToken)
+        {
+            Stopwatch sw = Stopwatch.StartNew();
+            using CancellationTokenSource targetCts = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+            try
+            {
+                // Queries block on the target's responses, so each gets its own thread instead of a thread pool one
+                Task<TResult> call = Task.Factory.StartNew(() => query(target, targetCts.Token), CancellationToken.None,
+                    TaskCreationOptions.LongRunning, TaskScheduler.Default);
+                Task finished = await Task.WhenAny(call, Task.Delay(Timeout, targetCts.Token)).ConfigureAwait(false);
+
+                FanOutResult<TTarget, TResult> result;
+                if (finished != call)
+                {
+                    // Timed out or canceled. The query is told to stop but isn't waited for, whatever it still returns is discarded.
+                    targetCts.Cancel();
+                    _ = call.ContinueWith(t =>
+                    {
+                        if (t.IsFaulted)
+                            _ = t.Exception;
+                        else if (t.Status == TaskStatus.RanToCompletion)
+                            Discard(onDiscarded, t.Result);
+                    }, TaskScheduler.Default);
+                    result = new FanOutResult<TTarget, TResult>()
+                    {
+                        Target = target,
+                        Index = index,
+                        TimedOut = !cancellationToken.IsCancellationRequested,
+                        Error = cancellationToken.IsCancellationRequested ? new OperationCanceledException(cancellationToken) : null,
+                        Elapsed = sw.Elapsed
+                    };
+                }
+                else if (call.IsFaulted)
+                {
+                    result = new FanOutResult<TTarget, TResult>()
+                    {
+                        Target = target,
+                        Index = index,
+                        Error = call.Exception.InnerException,
+                        Elapsed = sw.Elapsed
+                    };
+                }
+                else
+                {
+                    result = new FanOutResult<TTarget, TResult>()
+                    {
+                        Target = target,
+                        Index = index,
+                        Value = call.Result,
+                        Elapsed = sw.Elapsed
+                    };
+                }
+                results.Add(result);
+            }
+            finally
+            {
+                slots.Release();
+            }
+        }
+    }
+}
@@ -0,0 +1,99 @@
+using ScubaDiver.API.Protocol.SimpleHttp;
+using System.Text;
+
+namespace ScubaDiver.API.Tests;
+
+[TestFixture]
+public class SimpleHttpFrameReaderTests
+{
+    /// <summary>
+    /// A stream which hands out at most 'chunkSize' bytes per read, to simulate TCP segmentation
+    /// </summary>
+    private class ChunkedStream : MemoryStream
+    {
+        private readonly int _chunkSize;
+        public ChunkedStream(byte[] data, int chunkSize) : base(data) => _chunkSize = chunkSize;
+        public override int Read(byte[] buffer, int offset, int count) => base.Read(buffer, offset, Math.Min(count, _chunkSize));
+        public override Task<int> ReadAsync(byte[] buffer, int offset, int count, CancellationToken cancellationToken) =>
+            Task.FromResult(Read(buffer, offset, count));
+    }
+
+    [Test]
+    public async Task ReadFrameAsync_TwoRequests_ReturnsEachFrame()
+    {
+        // Arrange
+        string httpRequest1 = "GET /first HTTP/1.1\r\nContent-Length: 8\r\n\r\nRequest1";
+        string httpRequest2 = "POST /second HTTP/1.1\r\ncontent-length: 8\r\n\r\nRequest2";
+        byte[] requestData = Encoding.ASCII.GetBytes(httpRequest1 + httpRequest2);
+        using SimpleHttpFrameReader reader = new SimpleHttpFrameReader(new MemoryStream(requestData));
+
+        // Act
+        byte[] frame1 = await reader.ReadFrameAsync(CancellationToken.None);
+        byte[] frame2 = await reader.ReadFrameAsync(CancellationToken.None);
+        byte[] frame3 = await reader.ReadFrameAsync(CancellationToken.None);
+
+        // Assert
+        Assert.That(Encoding.ASCII.GetString(frame1), Is.EqualTo(httpRequest1));
+        Assert.That(Encoding.ASCII.GetString(frame2), Is.EqualTo(httpRequest2));
+        Assert.That(frame3, Is.Null);
+    }
+
+    [TestCase(1)]
+    [TestCase(3)]
+    [TestCase(17)]
+    public async Task ReadFrameAsync_SegmentedStream_ParsesCorrectly(int chunkSize)
+    {
+        // Arrange
+        string httpRequest = "GET /example?requestId=5 HTTP/1.1\r\nContent-Length: 13\r\n\r\nHello, World!";
+        byte[] requestData = Encoding.ASCII.GetBytes(httpRequest + httpRequest);
+        using SimpleHttpFrameReader reader = new SimpleHttpFrameReader(new ChunkedStream(requestData, chunkSize));
+
+        // Act
+        byte[] frame1 = await reader.ReadFrameAsync(CancellationToken.None);
+        byte[] frame2 = await reader.ReadFrameAsync(CancellationToken.None);
+
+        // Assert
+        Assert.That(Encoding.ASCII.GetString(frame1), Is.EqualTo(httpRequest));
+        Assert.That(Encoding.ASCII.GetString(frame2), Is.EqualTo(httpRequest));
+        Assert.That(SimpleHttpEncoder.TryParseHttpRequest(frame1, out HttpRequestSummary summary), Is.GreaterThan(0));
+        Assert.That(summary.QueryString.Get("requestId"), Is.EqualTo("5"));
+        Assert.That(summary.BodyString, Is.EqualTo("Hello, World!"));
+    }
+
+    [Test]
+    public async Task ReadFrameAsync_BodyBiggerThanReceiveBuffer_ParsesCorrectly()
+    {
+        // Arrange
+        string body = new string('x', SimpleHttpFrameReader.ReceiveBufferSize * 3 + 7);
+        string httpRequest = $"POST /big HTTP/1.1\r\nContent-Length: {body.Length}\r\n\r\n{body}";
+        using SimpleHttpFrameReader reader = new SimpleHttpFrameReader(new MemoryStream(Encoding.ASCII.GetBytes(httpRequest)));
+
+        // Act
+        byte[] frame = await reader.ReadFrameAsync(CancellationToken.None);
+
+        // Assert
+        Assert.That(Encoding.ASCII.GetString(frame), Is.EqualTo(httpRequest));
+    }
+
+    [Test]
+    public void ReadFrameAsync_PartialRequestBody_Throws()
+    {
+        // Arrange
+        string partialRequest = "GET /partial HTTP/1.1\r\nContent-Length: 100\r\n\r\nPartial";
+        using SimpleHttpFrameReader reader = new SimpleHttpFrameReader(new MemoryStream(Encoding.ASCII.GetBytes(partialRequest)));
+
+        // Act & Assert
+        Assert.ThrowsAsync<IOException>(() => reader.ReadFrameAsync(CancellationToken.None));
+    }
+
+    [Test]
+    public void ReadFrameAsync_PartialRequestHeader_Throws()
+    {
+        // Arrange
+        string partialRequest = "GET /partial HTTP/1.1\r\nContent-Len";
+        using SimpleHttpFrameReader reader = new SimpleHttpFrameReader(new MemoryStream(Encoding.ASCII.GetBytes(partialRequest)));
+
+        // Act & Assert
+        Assert.ThrowsAsync<IOException>(() => reader.ReadFrameAsync(CancellationToken.None));
+    }
+}
@@ -1,4 +1,5 @@
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
@@ -32,6 +33,8 @@ namespace ScubaDiver.API
 
         private readonly Dictionary<int, Tuple<LocalHookCallback, MethodBase>> _tokensToHookCallbacks = new();
         private readonly Dictionary<LocalHookCallback, int> _hookCallbacksToTokens = new();
+        // Batched hooks only. <Token, Invocations the diver dropped so far>
+        private readonly ConcurrentDictionary<int, long> _droppedHookInvocations = new();
 
         DiverCommunicator _communicator;
 
@@ -175,10 +178,14 @@ namespace ScubaDiver.API
             {
                 body = HandleEventCallback(request);
             }
-            if (request.Url.AbsolutePath == "/invoke_hook_callback")
+            else if (request.Url.AbsolutePath == "/invoke_hook_callback")
             {
                 body = HandleHookCallback(request);
             }
+            else if (request.Url.AbsolutePath == "/invoke_hook_callbacks_batch")
+            {
+                body = HandleHookCallbacksBatch(request);
+            }
             else
             {
                 Console.WriteLine($"[WARN] Diver tried to trigger an unexpected path: {request.Url.AbsolutePath}");
@@ -285,6 +292,47 @@ namespace ScubaDiver.API
             return body;
         }
 
+        private string HandleHookCallbacksBatch(HttpListenerRequest httpRequest)
+        {
+            string body;
+            using (StreamReader sr = new(httpRequest.InputStream))
+            {
+                body = sr.ReadToEnd();
+            }
+            CallbackInvocationBatch batch = JsonConvert.DeserializeObject<CallbackInvocationBatch>(body, _withErrors);
+            if (!_tokensToHookCallbacks.TryGetValue(batch.Token, out var hookAndMethod))
+            {
+                Console.WriteLine($"[WARN] Diver tried to trigger a batched hook callback with unknown token value: {batch.Token}");
+                DiverError errResults = new("Unknown Token", String.Empty);
+                return JsonConvert.SerializeObject(errResults);
+            }
+            _droppedHookInvocations[batch.Token] = batch.DroppedCount;
+
+            var hook = hookAndMethod.Item1;
+            foreach (CallbackInvocationRequest invokeRequest in batch.Invocations)
+            {
+                HookContext hookContext = new(invokeRequest.StackTrace, invokeRequest.ThreadID);
+                ObjectOrRemoteAddress retValue = invokeRequest.RetValue;
+                ObjectOrRemoteAddress instance = invokeRequest.Parameters.FirstOrDefault();
+                ObjectOrRemoteAddress[] args = invokeRequest.Parameters.Skip(1).ToArray();
+
+                // The original already ran (or is running). Skipping it or changing the return value is ignored.
+                hook.Invoke(hookContext, instance, args, ref retValue);
+            }
+
+            return "{\"status\":\"OK\"}";
+        }
+
+        /// <summary>
+        /// Gets how many invocations of a batched hook the diver dropped because the callback couldn't keep up
+        /// </summary>
+        public long GetDroppedHookInvocations(LocalHookCallback callback)
+        {
+            if (!_hookCallbacksToTokens.TryGetValue(callback, out int token))
+                return 0;
+            return _droppedHookInvocations.TryGetValue(token, out long dropped) ? dropped : 0;
+        }
+
         public void EventSubscribe(LocalEventCallback callback, int token)
         {
             _tokensToEventHandlers[token] = callback;
@@ -317,6 +365,7 @@ namespace ScubaDiver.API
             {
                 _tokensToHookCallbacks.Remove(token);
                 _hookCallbacksToTokens.Remove(callback);
+                _droppedHookInvocations.TryRemove(token, out _);
                 return token;
             }
             else
@@ -16,7 +16,9 @@ using ScubaDiver.API.Hooking;
 using ScubaDiver.API.Interactions;
 using ScubaDiver.API.Interactions.Callbacks;
 using ScubaDiver.API.Interactions.Dumps;
+using ScubaDiver.API.Interactions.Memory;
 using ScubaDiver.API.Interactions.Object;
+using ScubaDiver.API.Interactions.Profiling;
 using ScubaDiver.API.Protocol;
 using ScubaDiver.API.Protocol.SimpleHttp;
 using ScubaDiver.API.Utils;
@@ -34,10 +36,16 @@ namespace ScubaDiver.API
         public int DiverPort { get; private set; }
 
         private int? _process_id = null;
+        // Keeps the lease on our pinned objects while we're registered but idle. Should tick well within the diver's lease duration.
+        public static readonly TimeSpan LeaseHeartbeatInterval = TimeSpan.FromSeconds(15);
+        private Timer _leaseHeartbeat;
         private CallbacksListener _listener;
         private object _httpClientLock = new object();
         private ConcurrentHttpClient? _httpClient;
         private int _timeout;
+        // Last type dump received for every /type request, by the dumped type's identity. Past MaxTypeDumps it starts over.
+        private const int MaxTypeDumps = 1024;
+        private readonly Dictionary<string, TypeDump> _typeDumps = new();
 
         public DiverCommunicator(string hostname, int diverPort, int timeout = -1)
         {
@@ -73,14 +81,45 @@ namespace ScubaDiver.API
             }
         }
 
-        private string SendRequest(string path, Dictionary<string, string> queryParams = null, string jsonBody = null)
+        private string SendRequest(string path, Dictionary<string, string> queryParams = null, string jsonBody = null) =>
+            SendRequest(path, CancellationToken.None, queryParams, jsonBody);
+
+        private string SendRequest(string path, CancellationToken cancellationToken, Dictionary<string, string> queryParams = null, string jsonBody = null)
+        {
+            HttpResponseSummary response = SendRequestRaw(path, cancellationToken, queryParams, jsonBody);
+            string body = Encoding.UTF8.GetString(response.Body);
+            ThrowIfDiverError(body);
+            return body;
+        }
+
+        /// <summary>
+        /// Sends a request to an endpoint answering with a binary body
+        /// </summary>
+        private byte[] SendBinaryRequest(string path, Dictionary<string, string> queryParams = null, string jsonBody = null)
+        {
+            HttpResponseSummary response = SendRequestRaw(path, CancellationToken.None, queryParams, jsonBody);
+            if (response.ContentType != HttpResponseSummary.BinaryMimeType)
+            {
+                // Failures are reported in JSON
+                string body = Encoding.UTF8.GetString(response.Body);
+                ThrowIfDiverError(body);
+                throw new Exception($"Expected a binary response from the diver, got: {body}");
+            }
+            return response.Body;
+        }
+
+        private HttpResponseSummary SendRequestRaw(string path, CancellationToken cancellationToken, Dictionary<string, string> queryParams, string jsonBody)
         {
             Init();
 
             queryParams ??= new();
+            // Identifies us to the diver, our traffic renews the lease on objects pinned for us
+            if (_process_id.HasValue && !queryParams.ContainsKey("client_id"))
+                queryParams["client_id"] = _process_id.Value.ToString();
 
             HttpRequestSummary reqSummary = HttpRequestSummary.FromJson(path, queryParams, jsonBody);
-            HttpResponseSummary response = _httpClient.Send(reqSummary);
+            HttpResponseSummary response = _httpClient.Send(reqSummary, cancellationToken);
+            cancellationToken.ThrowIfCancellationRequested();
 
             if (response == null)
             {
@@ -97,7 +136,11 @@ namespace ScubaDiver.API
                 }
             }
 
-            string body = Encoding.UTF8.GetString(response.Body);
+            return response;
+        }
+
+        private void ThrowIfDiverError(string body)
+        {
             if (body.StartsWith("{\"error\":", StringComparison.InvariantCultureIgnoreCase))
             {
                 // Diver sent back an error. We parse it here and throwing a 'proxied' exception
@@ -105,9 +148,6 @@ namespace ScubaDiver.API
                 if (errMessage != null)
                     throw new RemoteException(errMessage.Error, errMessage.StackTrace);
             }
-
-
-            return body;
         }
 
         public bool KillDiver()
@@ -145,7 +185,18 @@ namespace ScubaDiver.API
         /// </summary>
         /// <param name="typeFilter">TypeFullName filter of objects to get from the heap. Support leading/trailing wildcard (*). NULL returns all objects</param>
         /// <returns></returns>
-        public HeapDump DumpHeap(string typeFilter = null, bool dumpHashcodes = true)
+        public HeapDump DumpHeap(string typeFilter = null, bool dumpHashcodes = true) => DumpHeap(typeFilter, dumpHashcodes, CancellationToken.None);
+
+        /// <param name="cancellationToken">Cancels the heap scan in the diver. Throws <see cref="OperationCanceledException"/> when signaled.</param>
+        public HeapDump DumpHeap(string typeFilter, bool dumpHashcodes, CancellationToken cancellationToken) => DumpHeap(typeFilter, dumpHashcodes, true, cancellationToken);
+
+        /// <param name="gcCollect">
+        /// Whether the diver collects garbage before looking at the heap.
+        /// Without it, a .NET diver reuses the objects it found last time if no GC occurred since, which is much faster on large heaps
+        /// but misses objects allocated since.
+        /// </param>
+        /// <param name="cancellationToken">Cancels the heap scan in the diver. Throws <see cref="OperationCanceledException"/> when signaled.</param>
+        public HeapDump DumpHeap(string typeFilter, bool dumpHashcodes, bool gcCollect, CancellationToken cancellationToken)
         {
             Dictionary<string, string> queryParams = new();
             if (typeFilter != null)
@@ -153,7 +204,11 @@ namespace ScubaDiver.API
                 queryParams["type_filter"] = typeFilter;
             }
             queryParams["dump_hashcodes"] = dumpHashcodes.ToString();
-            string body = SendRequest("heap", queryParams);
+            if (!gcCollect)
+            {
+                queryParams["gc_collect"] = "false";
+            }
+            string body = SendRequest("heap", cancellationToken, queryParams);
             HeapDump heapDump = JsonConvert.DeserializeObject<HeapDump>(body);
             return heapDump;
         }
@@ -171,6 +226,9 @@ namespace ScubaDiver.API
         }
 
         public TypesDump DumpTypes(string typeFullNameFilter, out List<TypesDump.AssemblyLoadError> loadErrors, string importerModule = null)
+            => DumpTypes(typeFullNameFilter, out loadErrors, importerModule, CancellationToken.None);
+
+        public TypesDump DumpTypes(string typeFullNameFilter, out List<TypesDump.AssemblyLoadError> loadErrors, string importerModule, CancellationToken cancellationToken)
         {
             Dictionary<string, string> queryParams = new() { };
             queryParams["type_filter"] = typeFullNameFilter;
@@ -179,7 +237,7 @@ namespace ScubaDiver.API
                 queryParams["importer_module"] = importerModule;
             }
 
-            string body = SendRequest("types", queryParams);
+            string body = SendRequest("types", cancellationToken, queryParams);
             TypesDump? results = JsonConvert.DeserializeObject<TypesDump>(body, _withErrors);
             loadErrors = results?.LoadErrors ?? new List<TypesDump.AssemblyLoadError>();
 
@@ -196,12 +254,7 @@ namespace ScubaDiver.API
             {
                 dumpRequest.Assembly = assembly;
             }
-            var requestJsonBody = JsonConvert.SerializeObject(dumpRequest);
-
-            string body = SendRequest("type", null, requestJsonBody);
-            TypeDump? results = JsonConvert.DeserializeObject<TypeDump>(body, _withErrors);
-
-            return results;
+            return DumpType(dumpRequest, $"{assembly}!{type}");
         }
         public TypeDump DumpType(long methodTableAddress)
         {
@@ -209,11 +262,39 @@ namespace ScubaDiver.API
             {
                 MethodTableAddress = methodTableAddress
             };
+            return DumpType(dumpRequest, $"0x{methodTableAddress:x}");
+        }
+
+        /// <summary>
+        /// Dumps a type, sending the ETag of the last dump received for the same request.
+        /// If the diver says it's still current, that dump is returned without transferring it again.
+        /// </summary>
+        private TypeDump DumpType(TypeDumpRequest dumpRequest, string key)
+        {
+            TypeDump cached;
+            lock (_typeDumps)
+            {
+                _typeDumps.TryGetValue(key, out cached);
+            }
+            dumpRequest.IfNoneMatch = cached?.ETag;
             var requestJsonBody = JsonConvert.SerializeObject(dumpRequest);
 
             string body = SendRequest("type", null, requestJsonBody);
             TypeDump? results = JsonConvert.DeserializeObject<TypeDump>(body, _withErrors);
+            if (results == null)
+                return null;
+            if (results.NotModified && cached != null && results.ETag == cached.ETag)
+                return cached;
 
+            if (results.ETag != null)
+            {
+                lock (_typeDumps)
+                {
+                    if (_typeDumps.Count >= MaxTypeDumps && !_typeDumps.ContainsKey(key))
+                        _typeDumps.Clear();
+                    _typeDumps[key] = results;
+                }
+            }
             return results;
         }
 
@@ -256,6 +337,47 @@ namespace ScubaDiver.API
             return body.Contains("OK");
         }
 
+        /// <summary>
+        /// Pins many objects in a single request.
+        /// </summary>
+        /// <param name="objects">Addresses and full type names of the objects</param>
+        public PinResults PinObjects(IEnumerable<(ulong address, string typeFullName)> objects)
+        {
+            PinRequest request = new()
+            {
+                Objects = objects.Select(obj => new PinRequest.PinTarget()
+                {
+                    Address = obj.address,
+                    TypeFullName = obj.typeFullName
+                }).ToList()
+            };
+            var requestJsonBody = JsonConvert.SerializeObject(request);
+
+            var body = SendRequest("pin", null, requestJsonBody);
+            if (body.Contains("\"error\":"))
+            {
+                throw new Exception("Diver failed to pin objects. Error: " + body);
+            }
+            return JsonConvert.DeserializeObject<PinResults>(body);
+        }
+
+        /// <summary>
+        /// Unpins many objects in a single request.
+        /// </summary>
+        /// <returns>The addresses which weren't pinned</returns>
+        public List<ulong> UnpinObjects(IEnumerable<ulong> addresses)
+        {
+            UnpinRequest request = new() { Addresses = addresses.ToList() };
+            var requestJsonBody = JsonConvert.SerializeObject(request);
+
+            var body = SendRequest("unpin", null, requestJsonBody);
+            if (body.Contains("\"error\":"))
+            {
+                throw new Exception("Diver failed to unpin objects. Error: " + body);
+            }
+            return JsonConvert.DeserializeObject<UnpinResults>(body).NotPinned;
+        }
+
         public InvocationResults InvokeMethod(ulong targetAddr, string targetTypeFullName, string methodName,
             string[] genericArgsFullTypeNames,
             params ObjectOrRemoteAddress[] args)
@@ -300,6 +422,7 @@ namespace ScubaDiver.API
                     if (body.Contains("{\"status\":\"OK\"}"))
                     {
                         // Success
+                        _leaseHeartbeat ??= new Timer(_ => CheckAliveness(), null, LeaseHeartbeatInterval, LeaseHeartbeatInterval);
                         return true;
                     }
                     else if (body.Contains("{\"status\":\"reject"))
@@ -339,6 +462,8 @@ namespace ScubaDiver.API
             }
             finally
             {
+                _leaseHeartbeat?.Dispose();
+                _leaseHeartbeat = null;
                 _process_id = null;
             }
         }
@@ -369,6 +494,48 @@ namespace ScubaDiver.API
             }
         }
 
+        /// <summary>
+        /// Reads many ranges of the remote process' memory in a single request. Reading unmapped memory doesn't crash the target.
+        /// </summary>
+        /// <param name="ranges">Address and length of each range</param>
+        /// <param name="destination">Receives the data of all ranges, concatenated in order. Faulted ranges are zero-filled.</param>
+        /// <param name="succeeded">Receives whether each of the ranges was read</param>
+        /// <returns>Number of ranges that were read</returns>
+        public int ReadMemory(ReadOnlySpan<(ulong address, int length)> ranges, Span<byte> destination, Span<bool> succeeded)
+        {
+            if (succeeded.Length < ranges.Length)
+                throw new ArgumentException("Not enough room for the status of every range", nameof(succeeded));
+
+            ReadMemoryRequest request = new()
+            {
+                Addresses = new ulong[ranges.Length],
+                Lengths = new int[ranges.Length]
+            };
+            long totalLength = 0;
+            for (int i = 0; i < ranges.Length; i++)
+            {
+                request.Addresses[i] = ranges[i].address;
+                request.Lengths[i] = ranges[i].length;
+                totalLength += ranges[i].length;
+            }
+            if (destination.Length < totalLength)
+                throw new ArgumentException($"Destination is too small. Ranges total {totalLength} bytes", nameof(destination));
+
+            byte[] body = SendBinaryRequest("read_memory", null, JsonConvert.SerializeObject(request));
+            if (body.Length != ranges.Length + totalLength)
+                throw new Exception($"Diver returned {body.Length} bytes for {ranges.Length} ranges of {totalLength} bytes");
+
+            int readCount = 0;
+            for (int i = 0; i < ranges.Length; i++)
+            {
+                succeeded[i] = body[i] == (byte)ReadMemoryRequest.RangeStatus.Read;
+                if (succeeded[i])
+                    readCount++;
+            }
+            new ReadOnlySpan<byte>(body, ranges.Length, (int)totalLength).CopyTo(destination);
+            return readCount;
+        }
+
         public ObjectOrRemoteAddress GetItem(ulong token, ObjectOrRemoteAddress key)
         {
             IndexedItemAccessRequest indexedItemAccess = new()
@@ -390,6 +557,155 @@ namespace ScubaDiver.API
 
         }
 
+        /// <summary>
+        /// Gets a slice of a remote array or IList in a single request
+        /// </summary>
+        public ItemsRange GetItems(ulong token, int start, int count) => GetItemsRange(new ItemsRangeRequest()
+        {
+            CollectionAddress = token,
+            Start = start,
+            Count = count
+        });
+
+        /// <summary>
+        /// Gets the next page of a remote IEnumerable's items
+        /// </summary>
+        /// <param name="cursor">0 to start a new enumeration, otherwise the <see cref="ItemsRange.Cursor"/> of the previous page</param>
+        public ItemsRange GetNextItems(ulong token, long cursor, int count) => GetItemsRange(new ItemsRangeRequest()
+        {
+            CollectionAddress = token,
+            Enumerate = true,
+            Cursor = cursor,
+            Count = count
+        });
+
+        /// <summary>
+        /// Ends an enumeration which wasn't read to its end and releases the pins of items which were never used
+        /// </summary>
+        /// <param name="cursor">0 if the enumeration already ended on the diver's side</param>
+        public void CloseItemsCursor(long cursor, IEnumerable<ulong> unusedItems = null)
+        {
+            ItemsRangeRequest request = new()
+            {
+                Cursor = cursor,
+                CloseCursor = true,
+                UnusedItems = unusedItems?.ToList()
+            };
+            var body = SendRequest("get_items", null, JsonConvert.SerializeObject(request));
+            if (body.Contains("\"error\":"))
+            {
+                throw new Exception("Diver failed to close enumeration cursor. Error: " + body);
+            }
+        }
+
+        private ItemsRange GetItemsRange(ItemsRangeRequest request)
+        {
+            var body = SendRequest("get_items", null, JsonConvert.SerializeObject(request));
+            if (body.Contains("\"error\":"))
+            {
+                throw new Exception("Diver failed to dump items of remote collection object. Error: " + body);
+            }
+            return JsonConvert.DeserializeObject<ItemsRange>(body);
+        }
+
+        /// <summary>
+        /// Reads the fields of many objects in a single request.
+        /// </summary>
+        /// <param name="objects">Addresses and full type names of the objects. None to only get the current GC epoch.</param>
+        public ObjectsSnapshot GetObjectsSnapshot(IEnumerable<(ulong address, string typeFullName)> objects)
+        {
+            ObjectsSnapshotRequest request = new()
+            {
+                Objects = objects.Select(obj => new ObjectsSnapshotRequest.SnapshotTarget()
+                {
+                    Address = obj.address,
+                    TypeFullName = obj.typeFullName
+                }).ToList()
+            };
+            var requestJsonBody = JsonConvert.SerializeObject(request);
+
+            var body = SendRequest("objects_snapshot", null, requestJsonBody);
+            if (body.Contains("\"error\":"))
+            {
+                throw new Exception("Diver failed to snapshot objects. Error: " + body);
+            }
+            return JsonConvert.DeserializeObject<ObjectsSnapshot>(body);
+        }
+
+        /// <summary>
+        /// Finds the pointers into any of the target ranges in the target's memory, in a single scan (Unmanaged diver only).
+        /// </summary>
+        /// <param name="targets">Start and length of each target range. A length of 0 only matches pointers to the exact address.</param>
+        /// <param name="cancellationToken">Cancels the scan in the diver. Throws <see cref="OperationCanceledException"/> when signaled.</param>
+        public ReferencesDump FindReferencesTo(IEnumerable<(ulong address, ulong length)> targets,
+            int maxOwnerDistance = ReferencesToRequest.DefaultMaxOwnerDistance,
+            int maxResults = ReferencesToRequest.DefaultMaxResults,
+            CancellationToken cancellationToken = default)
+        {
+            byte[] maskBytes = new byte[sizeof(ulong)];
+            new Random().NextBytes(maskBytes);
+            ulong xorMask = BitConverter.ToUInt64(maskBytes, 0);
+
+            List<(ulong address, ulong length)> targetsList = targets.ToList();
+            ReferencesToRequest request = new()
+            {
+                XoredAddresses = targetsList.Select(target => target.address ^ xorMask).ToArray(),
+                Lengths = targetsList.Select(target => target.length).ToArray(),
+                XorMask = xorMask,
+                MaxOwnerDistance = maxOwnerDistance,
+                MaxResults = maxResults
+            };
+
+            string body = SendRequest("references_to", cancellationToken, null, JsonConvert.SerializeObject(request));
+            if (body.Contains("\"error\":"))
+            {
+                throw new Exception("Diver failed to scan for references. Error: " + body);
+            }
+            return JsonConvert.DeserializeObject<ReferencesDump>(body);
+        }
+
+        /// <summary>
+        /// Follows pointer fields from the roots into objects of known types, in a single traversal done by the diver (Unmanaged diver only).
+        /// Requires the objects' modules to be hooked by /gc first, that's where object sizes come from.
+        /// </summary>
+        /// <param name="typeFilters">Only objects whose full type name matches one of these are followed. All are followed if null or empty.</param>
+        /// <param name="cancellationToken">Cancels the traversal in the diver. Throws <see cref="OperationCanceledException"/> when signaled.</param>
+        public ObjectGraphDump WalkObjectGraph(IEnumerable<ulong> roots, int maxDepth = WalkRequest.DefaultMaxDepth,
+            IEnumerable<string> typeFilters = null, int maxNodes = WalkRequest.DefaultMaxNodes,
+            CancellationToken cancellationToken = default)
+        {
+            WalkRequest request = new()
+            {
+                Roots = roots.ToList(),
+                MaxDepth = maxDepth,
+                TypeFilters = typeFilters?.ToList() ?? new List<string>(),
+                MaxNodes = maxNodes
+            };
+
+            string body = SendRequest("walk", cancellationToken, null, JsonConvert.SerializeObject(request));
+            if (body.Contains("\"error\":"))
+            {
+                throw new Exception("Diver failed to walk the object graph. Error: " + body);
+            }
+            return JsonConvert.DeserializeObject<ObjectGraphDump>(body);
+        }
+
+        /// <summary>
+        /// Writes the target's memory and modules to a snapshot file on the target's machine, for offline analysis (Unmanaged diver only).
+        /// </summary>
+        /// <param name="path">Path of the snapshot file on the target's machine. Overwritten if it exists.</param>
+        /// <param name="cancellationToken">Cancels the snapshot in the diver. Throws <see cref="OperationCanceledException"/> when signaled.</param>
+        public MemorySnapshotResults TakeMemorySnapshot(string path, CancellationToken cancellationToken = default)
+        {
+            Dictionary<string, string> queryParams = new() { { "path", path } };
+            string body = SendRequest("snapshot", cancellationToken, queryParams);
+            if (body.Contains("\"error\":"))
+            {
+                throw new Exception("Diver failed to take a memory snapshot. Error: " + body);
+            }
+            return JsonConvert.DeserializeObject<MemorySnapshotResults>(body);
+        }
+
         public InvocationResults InvokeStaticMethod(string targetTypeFullName, string methodName,
             params ObjectOrRemoteAddress[] args) =>
             InvokeStaticMethod(targetTypeFullName, methodName, null, args);
@@ -418,6 +734,19 @@ namespace ScubaDiver.API
             return resJson.Contains("\"ok\"");
         }
 
+        /// <summary>
+        /// Progress of the offensive GC's module analysis. Modules hooked with <see cref="StartOffensiveGC"/> and modules analyzed in the background.
+        /// </summary>
+        public ModuleAnalysisDump GetOffensiveGCStatus()
+        {
+            string body = SendRequest("gc_status");
+            if (body.Contains("\"error\":"))
+            {
+                throw new Exception("Diver failed to report the offensive GC's status. Error: " + body);
+            }
+            return JsonConvert.DeserializeObject<ModuleAnalysisDump>(body);
+        }
+
         public InvocationResults SetField(ulong targetAddr, string targetTypeFullName, string fieldName, ObjectOrRemoteAddress newValue)
         {
             FieldSetRequest invocReq = new()
@@ -491,7 +820,13 @@ namespace ScubaDiver.API
             }
         }
 
-        public bool HookMethod(MethodBase methodBase, HarmonyPatchPosition pos, LocalHookCallback callback, List<string> parametersTypeFullNames = null, ulong instanceAddress = 0)
+        /// <param name="deliveryMode">
+        /// <see cref="HookDeliveryMode.Batched"/> for observe-only hooks on hot methods. The hooked thread doesn't wait for
+        /// <paramref name="callback"/>, which is invoked later (on the callbacks listener's thread) and can't skip the original.
+        /// </param>
+        /// <param name="batchCapacity">Batched mode only: Invocations the diver keeps pending before dropping. 0 for the default.</param>
+        public bool HookMethod(MethodBase methodBase, HarmonyPatchPosition pos, LocalHookCallback callback, List<string> parametersTypeFullNames = null, ulong instanceAddress = 0,
+            HookDeliveryMode deliveryMode = HookDeliveryMode.Synchronous, int batchCapacity = 0)
         {
             if (!_listener.IsOpen)
             {
@@ -506,7 +841,9 @@ namespace ScubaDiver.API
                 MethodName = methodBase.Name,
                 HookPosition = pos.ToString(),
                 ParametersTypeFullNames = parametersTypeFullNames,
-                InstanceAddress = instanceAddress
+                InstanceAddress = instanceAddress,
+                DeliveryMode = deliveryMode,
+                BatchCapacity = batchCapacity
             };
 
             var requestJsonBody = JsonConvert.SerializeObject(req);
@@ -522,6 +859,11 @@ namespace ScubaDiver.API
             // Getting back the token tells us the hook was registered successfully.
             return true;
         }
+        /// <summary>
+        /// Gets how many invocations of a <see cref="HookDeliveryMode.Batched"/> hook were dropped by the diver
+        /// </summary>
+        public long GetDroppedHookInvocations(LocalHookCallback callback) => _listener.GetDroppedHookInvocations(callback);
+
         public void UnhookMethod(LocalHookCallback callback)
         {
             int token = _listener.HookUnsubscribe(callback);
@@ -542,6 +884,59 @@ namespace ScubaDiver.API
             }
         }
 
+        /// <summary>
+        /// Starts counting calls of a method and measuring their latency. Everything is aggregated inside the target,
+        /// use <see cref="GetProfileReport"/> to fetch the results.
+        /// </summary>
+        /// <param name="bucketByInstance">Aggregate every instance ('this') the method is called on separately</param>
+        /// <returns>Token of the profiled method</returns>
+        public int ProfileMethod(MethodBase methodBase, List<string> parametersTypeFullNames = null, bool bucketByInstance = false)
+        {
+            ProfileMethodRequest req = new()
+            {
+                TypeFullName = methodBase.DeclaringType.FullName,
+                MethodName = methodBase.Name,
+                ParametersTypeFullNames = parametersTypeFullNames ?? methodBase.GetParameters().Select(p => p.ParameterType.FullName).ToList(),
+                BucketByInstance = bucketByInstance
+            };
+
+            var requestJsonBody = JsonConvert.SerializeObject(req);
+
+            var resJson = SendRequest("profile_method", null, requestJsonBody);
+            if (resJson.Contains("\"error\":"))
+            {
+                throw new Exception("Profile Method failed. Error from Diver: " + resJson);
+            }
+            EventRegistrationResults regRes = JsonConvert.DeserializeObject<EventRegistrationResults>(resJson);
+            return regRes.Token;
+        }
+
+        /// <param name="reset">Start counting from scratch after this report</param>
+        public ProfileReport GetProfileReport(int token, bool reset = false)
+        {
+            Dictionary<string, string> queryParams = new()
+            {
+                ["token"] = token.ToString(),
+                ["reset"] = reset.ToString().ToLower()
+            };
+            string body = SendRequest("profile_report", queryParams);
+            return JsonConvert.DeserializeObject<ProfileReport>(body, _withErrors);
+        }
+
+        /// <returns>Final report of the profiled method</returns>
+        public ProfileReport UnprofileMethod(int token)
+        {
+            Dictionary<string, string> queryParams = new()
+            {
+                ["token"] = token.ToString()
+            };
+            string body = SendRequest("unprofile_method", queryParams);
+            return JsonConvert.DeserializeObject<ProfileReport>(body, _withErrors);
+        }
+
+        /// <returns>The diver's request counters, latency histograms and gauges in the Prometheus text format</returns>
+        public string GetMetrics() => SendRequest("metrics");
+
         public delegate (bool voidReturnType, ObjectOrRemoteAddress res) LocalEventCallback(ObjectOrRemoteAddress[] args, ObjectOrRemoteAddress retVal);
 
         public bool RegisterCustomFunction(RegisterCustomFunctionRequest request)
@@ -572,6 +967,7 @@ namespace ScubaDiver.API
 
         public void Dispose()
         {
+            _leaseHeartbeat?.Dispose();
             if (_httpClient != null)
             {
                 try
@@ -0,0 +1,16 @@
+namespace ScubaDiver.API.Hooking
+{
+    public enum HookDeliveryMode
+    {
+        /// <summary>
+        /// The hooked thread waits for the client's callback, which may skip the original or replace the return value
+        /// </summary>
+        Synchronous,
+        /// <summary>
+        /// Observe-only. Invocations are queued in the diver and delivered to the client in batches from a background thread.
+        /// The hooked thread never waits, but the callback can't skip the original or change the return value.
+        /// Invocations are dropped (and counted) if the client can't keep up.
+        /// </summary>
+        Batched
+    }
+}
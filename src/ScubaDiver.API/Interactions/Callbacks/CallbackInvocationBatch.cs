@@ -0,0 +1,22 @@
+using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Callbacks
+{
+    /// <summary>
+    /// Invocations of a hook in <see cref="HookDeliveryMode.Batched"/> mode, delivered together
+    /// </summary>
+    public class CallbackInvocationBatch
+    {
+        public int Token { get; set; }
+        /// <summary>
+        /// Total amount of invocations dropped so far (since the hook was registered) because the hook's ring was full
+        /// </summary>
+        public long DroppedCount { get; set; }
+        public List<CallbackInvocationRequest> Invocations { get; set; }
+
+        public CallbackInvocationBatch()
+        {
+            Invocations = new();
+        }
+    }
+}
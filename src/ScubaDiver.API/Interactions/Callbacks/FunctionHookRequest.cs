@@ -1,5 +1,6 @@
 ﻿using System.Collections.Generic;
 using System.Diagnostics.Contracts;
+using ScubaDiver.API.Hooking;
 
 namespace ScubaDiver.API.Interactions.Callbacks
 {
@@ -18,6 +19,13 @@ namespace ScubaDiver.API.Interactions.Callbacks
         /// </summary>
         public ulong InstanceAddress { get; set; }
 
+        public HookDeliveryMode DeliveryMode { get; set; }
+
+        /// <summary>
+        /// Batched delivery only: How many pending invocations the diver keeps before dropping new ones. 0 means the default.
+        /// </summary>
+        public int BatchCapacity { get; set; }
+
     }
 
 }
\ No newline at end of file
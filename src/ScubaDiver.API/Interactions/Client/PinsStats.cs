@@ -0,0 +1,23 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Client
+{
+    /// <summary>
+    /// Objects the diver keeps pinned on behalf of each client. Part of the /gc_stats response.
+    /// </summary>
+    public class PinsStats
+    {
+        public class ClientPins
+        {
+            public int ClientId { get; set; }
+            public int PinnedCount { get; set; }
+            public ulong PinnedBytes { get; set; }
+        }
+
+        /// <summary>
+        /// Clients stop holding their pins once they unregister or stay silent for this long
+        /// </summary>
+        public double LeaseDurationSeconds { get; set; }
+        public List<ClientPins> Clients { get; set; } = new();
+    }
+}
@@ -0,0 +1,55 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Dumps
+{
+    public enum ModuleAnalysisStage
+    {
+        /// <summary>
+        /// Waiting for a background worker
+        /// </summary>
+        Queued,
+        ReadingExports,
+        Undecorating,
+        /// <summary>
+        /// Finding the ctors, dtors, __autoclassinit2 functions and 'operator new's to hook
+        /// </summary>
+        Classifying,
+        /// <summary>
+        /// Ready to be hooked
+        /// </summary>
+        Analyzed,
+        Hooking,
+        Hooked,
+        Failed
+    }
+
+    /// <summary>
+    /// Progress of the offensive GC's module analysis. Response of /gc_status.
+    /// </summary>
+    public class ModuleAnalysisDump
+    {
+        public class Module
+        {
+            public string Name { get; set; }
+            public ModuleAnalysisStage Stage { get; set; }
+            /// <summary>
+            /// Whether the module was picked up by the background analysis, rather than requested
+            /// </summary>
+            public bool Background { get; set; }
+            public double ReadExportsMilliseconds { get; set; }
+            public double UndecorateMilliseconds { get; set; }
+            public double ClassifyMilliseconds { get; set; }
+            public double HookMilliseconds { get; set; }
+            /// <summary>
+            /// Why the module <see cref="ModuleAnalysisStage.Failed"/>
+            /// </summary>
+            public string Error { get; set; }
+        }
+
+        /// <summary>
+        /// Modules still waiting for a background worker
+        /// </summary>
+        public int Queued { get; set; }
+        public List<Module> Modules { get; set; } = new();
+    }
+}
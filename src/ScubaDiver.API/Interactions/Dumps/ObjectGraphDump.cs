@@ -0,0 +1,54 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Dumps
+{
+    /// <summary>
+    /// Object graph found by /walk. Nodes and types are referred to by their index so the dump stays small.
+    /// </summary>
+    public class ObjectGraphDump
+    {
+        public class Node
+        {
+            public ulong Address { get; set; }
+            /// <summary>
+            /// Index into <see cref="Types"/>, or -1 for roots which don't start with a known vftable
+            /// </summary>
+            public int Type { get; set; }
+            /// <summary>
+            /// Known size of the object, 0 if unknown (its fields weren't followed)
+            /// </summary>
+            public ulong Size { get; set; }
+            public int Depth { get; set; }
+        }
+
+        public class Edge
+        {
+            /// <summary>
+            /// Index of the node holding the pointer
+            /// </summary>
+            public int From { get; set; }
+            /// <summary>
+            /// Offset of the pointer field in the node
+            /// </summary>
+            public ulong Offset { get; set; }
+            /// <summary>
+            /// Index of the node pointed to
+            /// </summary>
+            public int To { get; set; }
+        }
+
+        /// <summary>
+        /// Full type names ("module!type")
+        /// </summary>
+        public List<string> Types { get; set; } = new();
+        /// <summary>
+        /// Nodes, roots first
+        /// </summary>
+        public List<Node> Nodes { get; set; } = new();
+        public List<Edge> Edges { get; set; } = new();
+        /// <summary>
+        /// True if objects were left out because of the request's MaxNodes
+        /// </summary>
+        public bool Truncated { get; set; }
+    }
+}
@@ -0,0 +1,35 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Dumps
+{
+    public class ReferencesDump
+    {
+        public class Reference
+        {
+            /// <summary>
+            /// Where the pointer is stored
+            /// </summary>
+            public ulong Address { get; set; }
+            /// <summary>
+            /// Index of the request's target the pointer points into
+            /// </summary>
+            public int TargetIndex { get; set; }
+            public ulong RegionBase { get; set; }
+            public ulong RegionSize { get; set; }
+            /// <summary>
+            /// Address of the object holding the pointer, if a known vftable precedes it. 0 otherwise.
+            /// </summary>
+            public ulong OwnerAddress { get; set; }
+            /// <summary>
+            /// Full type name ("module!type") of the object holding the pointer, if one was found
+            /// </summary>
+            public string OwnerType { get; set; }
+        }
+
+        public List<Reference> References { get; set; } = new();
+        /// <summary>
+        /// True if scanning stopped at the request's MaxResults
+        /// </summary>
+        public bool Truncated { get; set; }
+    }
+}
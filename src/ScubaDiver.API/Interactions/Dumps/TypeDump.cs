@@ -259,5 +259,14 @@ namespace ScubaDiver.API.Interactions.Dumps
         public List<TypeField> Fields { get; set; }
         public List<TypeEvent> Events { get; set; }
         public List<TypeProperty> Properties { get; set; }
+
+        /// <summary>
+        /// Identifies this version of the dump. Send it back in <see cref="TypeDumpRequest.IfNoneMatch"/> to skip receiving it again.
+        /// </summary>
+        public string ETag { get; set; }
+        /// <summary>
+        /// Set when the dump matched <see cref="TypeDumpRequest.IfNoneMatch"/>. Only <see cref="ETag"/> is set alongside it.
+        /// </summary>
+        public bool NotModified { get; set; }
     }
 }
\ No newline at end of file
@@ -8,6 +8,10 @@
         public string Assembly { get; set; }
         public string TypeFullName { get; set; }
         public long MethodTableAddress { get; set; }
+        /// <summary>
+        /// ETag of a dump the client already has. If it's still current, a <see cref="TypeDump.NotModified"/> dump is returned instead.
+        /// </summary>
+        public string IfNoneMatch { get; set; }
 
     }
 
@@ -0,0 +1,23 @@
+﻿namespace ScubaDiver.API.Interactions.Memory
+{
+    /// <summary>
+    /// What /snapshot wrote to the snapshot file
+    /// </summary>
+    public class MemorySnapshotResults
+    {
+        /// <summary>
+        /// Path of the snapshot file on the target's machine
+        /// </summary>
+        public string Path { get; set; }
+        public int Modules { get; set; }
+        public int Regions { get; set; }
+        /// <summary>
+        /// Size of the captured memory
+        /// </summary>
+        public ulong MemoryBytes { get; set; }
+        /// <summary>
+        /// Size of the snapshot file, after compression
+        /// </summary>
+        public long FileBytes { get; set; }
+    }
+}
@@ -0,0 +1,26 @@
+﻿namespace ScubaDiver.API.Interactions.Memory
+{
+    /// <summary>
+    /// Ranges to read with /read_memory. The i-th range starts at Addresses[i] and is Lengths[i] bytes long.
+    /// <para>
+    /// The binary response holds a status byte per range (see <see cref="RangeStatus"/>) followed by the
+    /// data of all ranges, concatenated in request order. Faulted ranges are zero-filled.
+    /// </para>
+    /// </summary>
+    public class ReadMemoryRequest
+    {
+        public enum RangeStatus : byte
+        {
+            Read = 0,
+            Faulted = 1
+        }
+
+        /// <summary>
+        /// Upper limit of the total length of the ranges of a single request
+        /// </summary>
+        public const int MaxTotalLength = 64 * 1024 * 1024;
+
+        public ulong[] Addresses { get; set; }
+        public int[] Lengths { get; set; }
+    }
+}
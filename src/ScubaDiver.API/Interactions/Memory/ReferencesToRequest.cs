@@ -0,0 +1,29 @@
+﻿namespace ScubaDiver.API.Interactions.Memory
+{
+    /// <summary>
+    /// Target ranges to find pointers into with /references_to. The i-th target starts at (XoredAddresses[i] ^ XorMask)
+    /// and is Lengths[i] bytes long, so interior pointers are found too. A length of 0 only matches the exact address.
+    /// <para>
+    /// Addresses are xored so the diver's copy of the request doesn't show up as a reference to its own targets.
+    /// </para>
+    /// </summary>
+    public class ReferencesToRequest
+    {
+        public const int DefaultMaxOwnerDistance = 0x400;
+        public const int DefaultMaxResults = 10_000;
+
+        public ulong[] XoredAddresses { get; set; }
+        public ulong[] Lengths { get; set; }
+        public ulong XorMask { get; set; }
+
+        /// <summary>
+        /// How many bytes before each reference are searched for a vftable of the object holding it
+        /// </summary>
+        public int MaxOwnerDistance { get; set; } = DefaultMaxOwnerDistance;
+
+        /// <summary>
+        /// Scanning stops after this many references
+        /// </summary>
+        public int MaxResults { get; set; } = DefaultMaxResults;
+    }
+}
@@ -0,0 +1,32 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Memory
+{
+    /// <summary>
+    /// Roots of an object graph traversal done by /walk (Unmanaged diver only).
+    /// The traversal follows pointer fields inside each object's known size into objects which start with a known vftable.
+    /// </summary>
+    public class WalkRequest
+    {
+        public const int DefaultMaxDepth = 3;
+        public const int DefaultMaxNodes = 10_000;
+
+        public List<ulong> Roots { get; set; } = new();
+
+        /// <summary>
+        /// How many pointers away from the roots the traversal goes
+        /// </summary>
+        public int MaxDepth { get; set; } = DefaultMaxDepth;
+
+        /// <summary>
+        /// Only objects whose full type name ("module!type") matches one of these "simple filters" are followed.
+        /// All objects are followed if empty.
+        /// </summary>
+        public List<string> TypeFilters { get; set; } = new();
+
+        /// <summary>
+        /// The traversal stops adding objects after this many
+        /// </summary>
+        public int MaxNodes { get; set; } = DefaultMaxNodes;
+    }
+}
@@ -0,0 +1,51 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Object
+{
+    /// <summary>
+    /// Many items of a remote collection with a single /get_items request.
+    /// Arrays and lists are sliced by <see cref="Start"/> and <see cref="Count"/>. Any other collection is enumerated with a cursor, a page at a time.
+    /// </summary>
+    public class ItemsRangeRequest
+    {
+        public ulong CollectionAddress { get; set; }
+        public int Start { get; set; }
+        public int Count { get; set; }
+        /// <summary>
+        /// Enumerates the collection instead of slicing it
+        /// </summary>
+        public bool Enumerate { get; set; }
+        /// <summary>
+        /// Cursor returned by a previous request to continue its enumeration. 0 opens a new one.
+        /// </summary>
+        public long Cursor { get; set; }
+        /// <summary>
+        /// Closes <see cref="Cursor"/> (if not 0) instead of reading from it
+        /// </summary>
+        public bool CloseCursor { get; set; }
+        /// <summary>
+        /// With <see cref="CloseCursor"/>: Pinned items of earlier pages which the client never used. Their pins are released.
+        /// </summary>
+        public List<ulong> UnusedItems { get; set; }
+    }
+
+    public class ItemsRange
+    {
+        /// <summary>
+        /// Primitives are encoded inline. Other items are pinned for the requesting client.
+        /// </summary>
+        public List<ObjectOrRemoteAddress> Items { get; set; } = new();
+        /// <summary>
+        /// Length of the sliced collection. -1 for enumerations.
+        /// </summary>
+        public int TotalCount { get; set; } = -1;
+        /// <summary>
+        /// Cursor to continue the enumeration with, 0 once it's done
+        /// </summary>
+        public long Cursor { get; set; }
+        /// <summary>
+        /// No items are left after these
+        /// </summary>
+        public bool Done { get; set; }
+    }
+}
@@ -0,0 +1,30 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Object
+{
+    /// <summary>
+    /// Field values of many remote objects, read in a single request
+    /// </summary>
+    public class ObjectsSnapshot
+    {
+        public class ObjectSnapshot
+        {
+            public ulong Address { get; set; }
+            public string Type { get; set; }
+            /// <summary>
+            /// Field name to value, for primitive and null fields. Fields referencing other objects
+            /// (and fields that failed to read) are left out.
+            /// </summary>
+            public Dictionary<string, ObjectOrRemoteAddress> Fields { get; set; } = new();
+            public string Error { get; set; }
+        }
+
+        /// <summary>
+        /// Number of GCs the target has gone through when the snapshot was taken.
+        /// Unpinned objects might have moved (and their addresses are stale) once this changes.
+        /// </summary>
+        public long GcEpoch { get; set; }
+
+        public List<ObjectSnapshot> Objects { get; set; } = new();
+    }
+}
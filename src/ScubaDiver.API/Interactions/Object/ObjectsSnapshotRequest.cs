@@ -0,0 +1,21 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Object
+{
+    public class ObjectsSnapshotRequest
+    {
+        public class SnapshotTarget
+        {
+            public ulong Address { get; set; }
+            /// <summary>
+            /// Only used when <see cref="Address"/> isn't a pinned address
+            /// </summary>
+            public string TypeFullName { get; set; }
+        }
+
+        /// <summary>
+        /// Objects to snapshot. An empty list only queries the current GC epoch.
+        /// </summary>
+        public List<SnapshotTarget> Objects { get; set; } = new();
+    }
+}
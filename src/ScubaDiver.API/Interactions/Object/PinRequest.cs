@@ -0,0 +1,39 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Object
+{
+    /// <summary>
+    /// Objects to pin with a single /pin request
+    /// </summary>
+    public class PinRequest
+    {
+        public class PinTarget
+        {
+            public ulong Address { get; set; }
+            /// <summary>
+            /// Only used when <see cref="Address"/> isn't a pinned address
+            /// </summary>
+            public string TypeFullName { get; set; }
+        }
+
+        public List<PinTarget> Objects { get; set; } = new();
+    }
+
+    public class PinResults
+    {
+        public class PinResult
+        {
+            /// <summary>
+            /// Address given in the request
+            /// </summary>
+            public ulong Address { get; set; }
+            public ulong PinnedAddress { get; set; }
+            public string Error { get; set; }
+        }
+
+        /// <summary>
+        /// Result for every object of the request, in order
+        /// </summary>
+        public List<PinResult> Objects { get; set; } = new();
+    }
+}
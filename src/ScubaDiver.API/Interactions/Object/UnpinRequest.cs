@@ -0,0 +1,20 @@
+﻿using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Object
+{
+    /// <summary>
+    /// Pinned addresses to unpin with a single /unpin request
+    /// </summary>
+    public class UnpinRequest
+    {
+        public List<ulong> Addresses { get; set; } = new();
+    }
+
+    public class UnpinResults
+    {
+        /// <summary>
+        /// Addresses of the request which weren't pinned
+        /// </summary>
+        public List<ulong> NotPinned { get; set; } = new();
+    }
+}
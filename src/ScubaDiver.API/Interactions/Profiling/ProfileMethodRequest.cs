@@ -0,0 +1,16 @@
+using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Profiling
+{
+    public class ProfileMethodRequest
+    {
+        public string TypeFullName { get; set; }
+        public string MethodName { get; set; }
+        public List<string> ParametersTypeFullNames { get; set; }
+
+        /// <summary>
+        /// Keep a separate histogram for every instance ('this') the method is called on
+        /// </summary>
+        public bool BucketByInstance { get; set; }
+    }
+}
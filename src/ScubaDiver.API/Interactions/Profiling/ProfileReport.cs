@@ -0,0 +1,49 @@
+using System.Collections.Generic;
+
+namespace ScubaDiver.API.Interactions.Profiling
+{
+    public class ProfileReport
+    {
+        public int Token { get; set; }
+        public string TypeFullName { get; set; }
+        public string MethodName { get; set; }
+        /// <summary>
+        /// Time since profiling started
+        /// </summary>
+        public double ElapsedSeconds { get; set; }
+        public long TotalCalls { get; set; }
+        public Dictionary<int, long> CallsByThread { get; set; }
+        /// <summary>
+        /// Calls nested too deep in the profiled method to be timed. Not part of <see cref="TotalCalls"/>.
+        /// </summary>
+        public long UntimedCalls { get; set; }
+        public ProfileBucket AllInstances { get; set; }
+        /// <summary>
+        /// Only filled when profiling with <see cref="ProfileMethodRequest.BucketByInstance"/>. Most called first.
+        /// </summary>
+        public List<ProfileBucket> Instances { get; set; }
+
+        public ProfileReport()
+        {
+            CallsByThread = new();
+            Instances = new();
+        }
+    }
+
+    public class ProfileBucket
+    {
+        /// <summary>
+        /// Address (or identity hash, for unpinned managed objects) of the instance.
+        /// <see cref="ulong.MaxValue"/> aggregates the instances beyond the diver's buckets limit.
+        /// </summary>
+        public ulong InstanceAddress { get; set; }
+        public long Calls { get; set; }
+        public double MeanNs { get; set; }
+        public long MinNs { get; set; }
+        public long MaxNs { get; set; }
+        public long P50Ns { get; set; }
+        public long P90Ns { get; set; }
+        public long P99Ns { get; set; }
+        public long P999Ns { get; set; }
+    }
+}
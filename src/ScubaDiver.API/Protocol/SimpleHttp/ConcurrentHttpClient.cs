@@ -1,5 +1,6 @@
 using System;
 using System.Collections.Concurrent;
+using System.Collections.Specialized;
 using System.Net.Sockets;
 using System.Threading;
 using System.Threading.Tasks;
@@ -100,7 +101,14 @@ namespace ScubaDiver.API.Protocol.SimpleHttp
             }
         }
 
-        public HttpResponseSummary Send(HttpRequestSummary request)
+        public HttpResponseSummary Send(HttpRequestSummary request) => Send(request, CancellationToken.None);
+
+        /// <summary>
+        /// Sends a request and waits for its response.
+        /// If <paramref name="cancellationToken"/> is signaled, the diver is asked to cancel the request.
+        /// We still wait for the diver's answer (which should be a quick "cancelled" error) so the connection stays in sync.
+        /// </summary>
+        public HttpResponseSummary Send(HttpRequestSummary request, CancellationToken cancellationToken)
         {
             if (!_readerReady.WaitOne(TimeSpan.FromSeconds(10)))
                 throw new Exception("Reader didn't start in 10 seconds.");
@@ -116,13 +124,34 @@ namespace ScubaDiver.API.Protocol.SimpleHttp
             _requests.Add(request);
 
             // Wait for response
-            are.WaitOne();
+            using (cancellationToken.Register(() => SendCancellation(myId)))
+            {
+                are.WaitOne();
+            }
             if (!_responses.TryRemove(myId, out HttpResponseSummary val))
                 throw new Exception("AutoResetEvent was signaled but a response wasn't found in the responses dict.");
 
             return val;
         }
 
+        private void SendCancellation(string targetRequestId)
+        {
+            NameValueCollection queryString = new NameValueCollection { ["target_request_id"] = targetRequestId };
+            HttpRequestSummary cancelRequest = HttpRequestSummary.FromJson("/cancel_request", queryString, null);
+            // Not blocking the thread which signaled the token
+            Task.Run(() =>
+            {
+                try
+                {
+                    Send(cancelRequest);
+                }
+                catch
+                {
+                    // Connection is gone. Nothing to cancel.
+                }
+            });
+        }
+
         public void Dispose()
         {
             try { _readerCancellationTokenSource.Cancel(); } catch { }
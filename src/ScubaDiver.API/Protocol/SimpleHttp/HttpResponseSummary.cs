@@ -15,6 +15,9 @@ namespace ScubaDiver.API.Protocol.SimpleHttp
         public string BodyString => Encoding.UTF8.GetString(Body);
 
         public const string JsonMimeType = "application/json";
+        public const string BinaryMimeType = "application/octet-stream";
+        // Prometheus text exposition format
+        public const string TextMimeType = "text/plain; version=0.0.4; charset=utf-8";
 
         public string RequestId
         {
@@ -40,6 +43,28 @@ namespace ScubaDiver.API.Protocol.SimpleHttp
             return result;
         }
 
+        public static HttpResponseSummary FromBinary(HttpStatusCode statusCode, byte[] body, Dictionary<string, string>? otherHeaders = null)
+        {
+            return new HttpResponseSummary()
+            {
+                StatusCode = statusCode,
+                ContentType = HttpResponseSummary.BinaryMimeType,
+                Body = body ?? Array.Empty<byte>(),
+                OtherHeaders = otherHeaders ?? new Dictionary<string, string>()
+            };
+        }
+
+        public static HttpResponseSummary FromText(HttpStatusCode statusCode, string text, Dictionary<string, string>? otherHeaders = null)
+        {
+            return new HttpResponseSummary()
+            {
+                StatusCode = statusCode,
+                ContentType = HttpResponseSummary.TextMimeType,
+                Body = string.IsNullOrEmpty(text) ? Array.Empty<byte>() : Encoding.UTF8.GetBytes(text),
+                OtherHeaders = otherHeaders ?? new Dictionary<string, string>()
+            };
+        }
+
         public override string ToString()
         {
             return $"[Status = {StatusCode} ({(int)(StatusCode)})] Body = {(Body?.Any()==true ? BodyString : "EMPTY")}";
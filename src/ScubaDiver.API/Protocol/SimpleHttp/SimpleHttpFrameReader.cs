@@ -0,0 +1,195 @@
+using System;
+using System.Collections.Concurrent;
+using System.IO;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace ScubaDiver.API.Protocol.SimpleHttp
+{
+    /// <summary>
+    /// Reads whole SimpleHttp messages (headers + body) from a stream.
+    /// Unlike <see cref="SimpleHttpProtocolParser.ReadHttpMessageFromStream"/>, this reader doesn't go byte-by-byte
+    /// and doesn't block a thread while waiting for data. Incoming bytes land in a receive buffer which is rented
+    /// from a shared pool and reused for every message on the connection.
+    /// </summary>
+    public class SimpleHttpFrameReader : IDisposable
+    {
+        public const int ReceiveBufferSize = 64 * 1024;
+        private const int MaxPooledBuffers = 64;
+        private static readonly ConcurrentBag<byte[]> _buffersPool = new ConcurrentBag<byte[]>();
+
+        private static readonly byte[] ContentLengthHeader = Encoding.ASCII.GetBytes("Content-Length:");
+
+        private readonly Stream _stream;
+        private byte[] _buffer;
+        // Unconsumed data lives in _buffer[_start.._end)
+        private int _start;
+        private int _end;
+        // How far (from _start) we already searched for the headers terminator
+        private int _scanned;
+
+        public SimpleHttpFrameReader(Stream stream)
+        {
+            _stream = stream;
+            _buffer = RentBuffer();
+        }
+
+        /// <returns>
+        /// The raw bytes of the next message, or null if the stream ended cleanly between two messages.
+        /// </returns>
+        /// <exception cref="IOException">The stream ended in the middle of a message</exception>
+        public async Task<byte[]> ReadFrameAsync(CancellationToken token)
+        {
+            int headersLength;
+            while ((headersLength = FindHeadersEnd()) == -1)
+            {
+                if (!await FillAsync(token).ConfigureAwait(false))
+                {
+                    if (_start == _end)
+                        return null;
+                    throw new IOException("Unexpected end of stream while reading message header.");
+                }
+            }
+
+            int contentLength = ParseContentLength(_buffer, _start, headersLength);
+            byte[] frame = new byte[headersLength + contentLength];
+
+            // Whatever we already buffered goes first, the rest of the body is read directly into the frame.
+            int buffered = Math.Min(_end - _start, frame.Length);
+            Buffer.BlockCopy(_buffer, _start, frame, 0, buffered);
+            Consume(buffered);
+
+            int read = buffered;
+            while (read < frame.Length)
+            {
+                int bytesReadThisTime = await _stream.ReadAsync(frame, read, frame.Length - read, token).ConfigureAwait(false);
+                if (bytesReadThisTime == 0)
+                    throw new IOException("Unexpected end of stream while reading message body.");
+                read += bytesReadThisTime;
+            }
+
+            return frame;
+        }
+
+        private void Consume(int count)
+        {
+            _start += count;
+            _scanned = 0;
+            if (_start == _end)
+            {
+                _start = 0;
+                _end = 0;
+            }
+        }
+
+        /// <returns>Length of the headers (including the terminating empty line) or -1 if not received yet</returns>
+        private int FindHeadersEnd()
+        {
+            int from = _start + Math.Max(0, _scanned - 3);
+            for (int i = from; i + 3 < _end; i++)
+            {
+                if (_buffer[i] == '\r' && _buffer[i + 1] == '\n' && _buffer[i + 2] == '\r' && _buffer[i + 3] == '\n')
+                    return i + 4 - _start;
+            }
+            _scanned = _end - _start;
+            return -1;
+        }
+
+        /// <returns>False if the stream ended</returns>
+        private async Task<bool> FillAsync(CancellationToken token)
+        {
+            if (_end == _buffer.Length)
+            {
+                if (_start > 0)
+                {
+                    // Move leftovers to the beginning of the buffer
+                    Buffer.BlockCopy(_buffer, _start, _buffer, 0, _end - _start);
+                    _end -= _start;
+                    _start = 0;
+                }
+                else
+                {
+                    // A single header block is bigger than our buffer. Rare enough to just grow it.
+                    byte[] bigger = new byte[_buffer.Length * 2];
+                    Buffer.BlockCopy(_buffer, 0, bigger, 0, _end);
+                    ReturnBuffer(_buffer);
+                    _buffer = bigger;
+                }
+            }
+
+            int bytesRead = await _stream.ReadAsync(_buffer, _end, _buffer.Length - _end, token).ConfigureAwait(false);
+            if (bytesRead == 0)
+                return false;
+            _end += bytesRead;
+            return true;
+        }
+
+        public static int ParseContentLength(byte[] data, int offset, int headersLength)
+        {
+            int headersEnd = offset + headersLength;
+            for (int i = offset; i + ContentLengthHeader.Length <= headersEnd; i++)
+            {
+                // Only look at the start of header lines
+                if (i != offset && data[i - 1] != '\n')
+                    continue;
+                if (!MatchesIgnoreCase(data, i, ContentLengthHeader))
+                    continue;
+
+                int value = 0;
+                bool anyDigits = false;
+                for (int j = i + ContentLengthHeader.Length; j < headersEnd && data[j] != '\r'; j++)
+                {
+                    byte b = data[j];
+                    if (b == ' ' || b == '\t')
+                        continue;
+                    if (b < '0' || b > '9')
+                        throw new IOException("Invalid Content-Length header value.");
+                    value = checked(value * 10 + (b - '0'));
+                    anyDigits = true;
+                }
+
+                if (!anyDigits)
+                    throw new IOException("Empty Content-Length header value.");
+                return value;
+            }
+
+            // No Content-Length, no body.
+            return 0;
+        }
+
+        private static bool MatchesIgnoreCase(byte[] data, int offset, byte[] pattern)
+        {
+            for (int i = 0; i < pattern.Length; i++)
+            {
+                byte a = data[offset + i];
+                byte b = pattern[i];
+                if (a == b)
+                    continue;
+                // ASCII case folding
+                if ((a | 0x20) != (b | 0x20) || (b | 0x20) < 'a' || (b | 0x20) > 'z')
+                    return false;
+            }
+            return true;
+        }
+
+        private static byte[] RentBuffer()
+        {
+            return _buffersPool.TryTake(out byte[] buffer) ? buffer : new byte[ReceiveBufferSize];
+        }
+
+        private static void ReturnBuffer(byte[] buffer)
+        {
+            if (buffer == null || buffer.Length != ReceiveBufferSize || _buffersPool.Count >= MaxPooledBuffers)
+                return;
+            _buffersPool.Add(buffer);
+        }
+
+        public void Dispose()
+        {
+            byte[] buffer = _buffer;
+            _buffer = null;
+            ReturnBuffer(buffer);
+        }
+    }
+}
@@ -109,6 +109,11 @@ namespace ScubaDiver.API
                 RetValue = retValue,
                 Parameters = args.ToList()
             };
+            return InvokeHookCallback(invocReq);
+        }
+
+        public HookResponse InvokeHookCallback(CallbackInvocationRequest invocReq)
+        {
             var requestJsonBody = JsonConvert.SerializeObject(invocReq);
 
             var resJson = SendRequest("invoke_hook_callback", null, requestJsonBody);
@@ -121,5 +126,14 @@ namespace ScubaDiver.API
             HookResponse res = JsonConvert.DeserializeObject<HookResponse>(resJson, _withErrors);
             return res;
         }
+
+        /// <returns>True if the client accepted the batch</returns>
+        public bool InvokeHookCallbacksBatch(CallbackInvocationBatch batch)
+        {
+            var requestJsonBody = JsonConvert.SerializeObject(batch);
+
+            var resJson = SendRequest("invoke_hook_callbacks_batch", null, requestJsonBody);
+            return !resJson.Contains("\"error\":");
+        }
     }
 }
@@ -1,11 +1,17 @@
 ﻿using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Linq;
+using System.Linq.Expressions;
 
 namespace ScubaDiver.API.Utils
 {
     public static class PrimitivesEncoder
     {
+        // Decoding runs for every primitive argument of every request, so the lookups are only done once per type
+        private static readonly ConcurrentDictionary<string, Type> _typesByName = new();
+        private static readonly ConcurrentDictionary<Type, Func<string, object>> _parsers = new();
+
         /// <summary>
         /// Encodes a primitive or array of primitives 
         /// </summary>
@@ -111,8 +117,8 @@ namespace ScubaDiver.API.Utils
 
             if (resultType.IsPrimitiveEtc())
             {
-                var parseMethod = resultType.GetMethod("Parse", new Type[1] { typeof(string) });
-                return parseMethod.Invoke(null, new object[] { toDecode });
+                Func<string, object> parse = _parsers.GetOrAdd(resultType, CreateParser);
+                return parse(toDecode);
             }
 
             if (resultType.IsArray)
@@ -171,11 +177,32 @@ namespace ScubaDiver.API.Utils
             // NOTE: I'm allowing this decode to be estricted to the current domain (Instead of searching in all domains)
             // because I want to believe only primitive types will be handed here and those
             // should all be available in all domains. (hopefully)
-            Type t = AppDomain.CurrentDomain.GetType(fullTypeName);
+            if (!_typesByName.TryGetValue(fullTypeName, out Type t))
+            {
+                t = AppDomain.CurrentDomain.GetType(fullTypeName);
+                if (t != null)
+                    _typesByName[fullTypeName] = t;
+            }
             if (t != null)
                 return Decode(toDecode, t);
 
             throw new Exception($"Could not resolve type name \"{fullTypeName}\" in the current AppDomain");
         }
+
+        private static Func<string, object> CreateParser(Type primitiveType)
+        {
+            var parseMethod = primitiveType.GetMethod("Parse", new Type[1] { typeof(string) });
+            try
+            {
+                // s => (object)T.Parse(s)
+                var encoded = Expression.Parameter(typeof(string), "encoded");
+                var body = Expression.Convert(Expression.Call(parseMethod, encoded), typeof(object));
+                return Expression.Lambda<Func<string, object>>(body, encoded).Compile();
+            }
+            catch
+            {
+                return encoded => parseMethod.Invoke(null, new object[] { encoded });
+            }
+        }
     }
 }
@@ -0,0 +1,143 @@
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.Linq;
+using ScubaDiver.API.Utils;
+using ScubaDiver.Rtti;
+using ScubaDiver.Snapshots;
+
+namespace ScubaDiver.SnapshotAnalyzer;
+
+/// <summary>
+/// Analyzes a memory snapshot taken with the MSVC diver's /snapshot endpoint, away from the target's machine
+/// </summary>
+public class Program
+{
+    private const string Usage =
+        "Usage: ScubaDiver.SnapshotAnalyzer <snapshot> info\n" +
+        "       ScubaDiver.SnapshotAnalyzer <snapshot> types [type filter]\n" +
+        "       ScubaDiver.SnapshotAnalyzer <snapshot> instances [type filter]\n" +
+        "       ScubaDiver.SnapshotAnalyzer <snapshot> refs <address>[:length]... [--owner-distance N] [--max N]\n" +
+        "Type filters match full type names (module!namespace::name) and may contain '*' wildcards.";
+
+    public static int Main(string[] args)
+    {
+        if (args.Length < 2 || args.Contains("-h"))
+        {
+            Console.WriteLine(Usage);
+            return args.Contains("-h") ? 0 : 1;
+        }
+
+        using MemorySnapshot snapshot = new MemorySnapshot(args[0]);
+        SnapshotAnalysis analysis = new SnapshotAnalysis(snapshot);
+        string[] commandArgs = args.Skip(2).ToArray();
+        switch (args[1])
+        {
+            case "info":
+                PrintInfo(snapshot);
+                return 0;
+            case "types":
+                PrintTypes(analysis, commandArgs.FirstOrDefault());
+                return 0;
+            case "instances":
+                PrintInstances(analysis, commandArgs.FirstOrDefault());
+                return 0;
+            case "refs":
+                return PrintReferences(analysis, commandArgs);
+            default:
+                Console.WriteLine(Usage);
+                return 1;
+        }
+    }
+
+    private static void PrintInfo(MemorySnapshot snapshot)
+    {
+        ulong memoryBytes = 0;
+        foreach (SnapshotRegion region in snapshot.Regions)
+            memoryBytes += region.Size;
+        int unreadableChunks = snapshot.Chunks.Count(chunk => chunk.Flags.HasFlag(SnapshotChunkFlags.Unreadable));
+
+        Console.WriteLine($"Pointer size: {snapshot.PointerSize}");
+        Console.WriteLine($"Regions: {snapshot.Regions.Count} ({memoryBytes} bytes)");
+        Console.WriteLine($"Chunks: {snapshot.Chunks.Count} of up to {snapshot.ChunkSize} bytes ({unreadableChunks} unreadable)");
+        Console.WriteLine($"Modules: {snapshot.Modules.Count}");
+        foreach (RichModuleInfo module in snapshot.Modules)
+            Console.Write(module);
+    }
+
+    private static List<FirstClassTypeInfo> DiscoverTypes(SnapshotAnalysis analysis, string typeFilter)
+    {
+        Predicate<string> typeNameFilter = Filter.CreatePredicate(typeFilter);
+        return analysis.DiscoverTypes()
+            .SelectMany(kvp => kvp.Value)
+            .OfType<FirstClassTypeInfo>()
+            .Where(type => typeNameFilter(type.FullTypeName))
+            .ToList();
+    }
+
+    private static void PrintTypes(SnapshotAnalysis analysis, string typeFilter)
+    {
+        foreach (FirstClassTypeInfo type in DiscoverTypes(analysis, typeFilter).OrderBy(type => type.FullTypeName))
+            Console.WriteLine($"0x{type.VftableAddress:x16} {type.FullTypeName}");
+    }
+
+    private static void PrintInstances(SnapshotAnalysis analysis, string typeFilter)
+    {
+        Dictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> instances = analysis.ScanInstances(DiscoverTypes(analysis, typeFilter));
+        foreach (KeyValuePair<FirstClassTypeInfo, IReadOnlyCollection<ulong>> kvp in instances.Where(kvp => kvp.Value.Count > 0)
+                     .OrderByDescending(kvp => kvp.Value.Count))
+        {
+            Console.WriteLine($"{kvp.Value.Count,10} {kvp.Key.FullTypeName}");
+            foreach (ulong address in kvp.Value.OrderBy(address => address))
+                Console.WriteLine($"           0x{address:x16}");
+        }
+    }
+
+    private static int PrintReferences(SnapshotAnalysis analysis, string[] args)
+    {
+        int maxOwnerDistance = 0x400;
+        int maxHits = 10_000;
+        List<(ulong address, ulong length)> targets = new();
+        for (int i = 0; i < args.Length; i++)
+        {
+            if (args[i] == "--owner-distance" && i + 1 < args.Length)
+                maxOwnerDistance = (int)ParseNumber(args[++i]);
+            else if (args[i] == "--max" && i + 1 < args.Length)
+                maxHits = (int)ParseNumber(args[++i]);
+            else
+            {
+                string[] parts = args[i].Split(':');
+                targets.Add((ParseNumber(parts[0]), parts.Length > 1 ? ParseNumber(parts[1]) : 0));
+            }
+        }
+        if (targets.Count == 0)
+        {
+            Console.WriteLine(Usage);
+            return 1;
+        }
+
+        Dictionary<nuint, FirstClassTypeInfo> xoredVftableToType = new();
+        foreach (FirstClassTypeInfo type in DiscoverTypes(analysis, null))
+            xoredVftableToType.TryAdd(type.XoredVftableAddress, type);
+
+        List<ReferenceHit> hits = analysis.ScanReferences(
+            targets.Select(target => target.address).ToArray(),
+            targets.Select(target => target.length).ToArray(),
+            new HashSet<nuint>(xoredVftableToType.Keys), maxOwnerDistance, maxHits, out bool truncated);
+        foreach (ReferenceHit hit in hits)
+        {
+            string owner = hit.OwnerAddress != 0 && xoredVftableToType.TryGetValue(hit.XoredOwnerVftable, out FirstClassTypeInfo ownerType)
+                ? $" in 0x{hit.OwnerAddress:x16} {ownerType.FullTypeName}"
+                : "";
+            Console.WriteLine($"0x{hit.Address:x16} -> 0x{targets[hit.TargetIndex].address:x16}{owner}");
+        }
+        if (truncated)
+            Console.WriteLine($"(Stopped after {maxHits} references)");
+        return 0;
+    }
+
+    private static ulong ParseNumber(string text) =>
+        text.StartsWith("0x", StringComparison.OrdinalIgnoreCase)
+            ? ulong.Parse(text.Substring(2), NumberStyles.HexNumber)
+            : ulong.Parse(text);
+}
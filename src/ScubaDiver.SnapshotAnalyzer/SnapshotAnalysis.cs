@@ -0,0 +1,85 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using ScubaDiver.Rtti;
+using ScubaDiver.Snapshots;
+
+namespace ScubaDiver.SnapshotAnalyzer;
+
+/// <summary>
+/// Runs the diver's type discovery, vftable scan and reference scan against a snapshot instead of a live process
+/// </summary>
+public class SnapshotAnalysis
+{
+    private readonly MemorySnapshot _snapshot;
+
+    public SnapshotAnalysis(MemorySnapshot snapshot)
+    {
+        _snapshot = snapshot;
+    }
+
+    /// <summary>
+    /// Finds the First-Class types of every module, like Trickster does in the live process
+    /// </summary>
+    public Dictionary<RichModuleInfo, List<TypeInfo>> DiscoverTypes(Predicate<string> moduleNameFilter = null)
+    {
+        bool is32Bit = _snapshot.PointerSize == 4;
+        ConcurrentDictionary<RichModuleInfo, List<TypeInfo>> types = new();
+        Parallel.ForEach(_snapshot.Modules.Where(module => moduleNameFilter?.Invoke(module.ModuleInfo.Name) ?? true), module =>
+        {
+            try
+            {
+                SnapshotModuleMemory memory = _snapshot.LoadModule(module);
+                types[module] = RttiTypeDiscovery.ScanModule(ref memory, module, is32Bit, RttiNameUndecorator.Undecorate);
+            }
+            catch (Exception ex)
+            {
+                Console.Error.WriteLine($"[SnapshotAnalysis] Failed to scan module {module.ModuleInfo.Name}: {ex.Message}");
+                types[module] = new List<TypeInfo>();
+            }
+        });
+        return new Dictionary<RichModuleInfo, List<TypeInfo>>(types);
+    }
+
+    /// <summary>
+    /// Finds instances of the given types by their vftables, like MemoryScanner does in the live process
+    /// </summary>
+    public unsafe Dictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> ScanInstances(IEnumerable<FirstClassTypeInfo> typeInfos,
+        CancellationToken cancellationToken = default)
+    {
+        Dictionary<nuint, FirstClassTypeInfo> xoredVftableToType = new();
+        foreach (FirstClassTypeInfo typeInfo in typeInfos)
+            xoredVftableToType.TryAdd(typeInfo.XoredVftableAddress, typeInfo);
+
+        ConcurrentDictionary<ulong, ConcurrentBag<ulong>> results = new();
+        foreach (nuint xoredVftable in xoredVftableToType.Keys)
+            results[xoredVftable] = new ConcurrentBag<ulong>();
+
+        _snapshot.ForEachChunk(0, (region, bufferAddress, buffer, scanStart, size) =>
+            VftablePointerScan.ScanBuffer(bufferAddress, buffer, size, _snapshot.PointerSize, FirstClassTypeInfo.XorMask,
+                results, cancellationToken),
+            cancellationToken);
+
+        return results.ToDictionary(kvp => xoredVftableToType[(nuint)kvp.Key], kvp => (IReadOnlyCollection<ulong>)kvp.Value);
+    }
+
+    /// <summary>
+    /// Finds pointers into any of the target ranges, like MemoryScanner does in the live process.
+    /// Pointers near the start of a chunk still find their owners in the previous chunk.
+    /// </summary>
+    /// <param name="lengths">Length of each target range. 0 is treated as 1 (pointers to the exact address).</param>
+    /// <param name="knownXoredVftables">Vftables (xored with <see cref="FirstClassTypeInfo.XorMask"/>) which mark the start of an owning object</param>
+    public unsafe List<ReferenceHit> ScanReferences(ulong[] targets, ulong[] lengths, IReadOnlySet<nuint> knownXoredVftables,
+        int maxOwnerDistance, int maxHits, out bool truncated, CancellationToken cancellationToken = default)
+    {
+        // Nothing here is scanned live, so targets don't need to be hidden from the scan
+        ReferenceScan scan = new ReferenceScan(targets, lengths, 0, knownXoredVftables, _snapshot.PointerSize, maxOwnerDistance, maxHits);
+        _snapshot.ForEachChunk(maxOwnerDistance, (region, bufferAddress, buffer, scanStart, size) =>
+            scan.ScanBuffer(bufferAddress, buffer, scanStart, size, region.BaseAddress, region.Size, cancellationToken),
+            cancellationToken);
+        return scan.GetHits(address => false, out truncated);
+    }
+}
@@ -5,11 +5,15 @@ using System.Diagnostics;
 using System.Linq;
 using System.Net;
 using System.Reflection;
+using System.Text;
 using ScubaDiver.API;
+using ScubaDiver.API.Hooking;
 using System.Threading;
 using ScubaDiver.API.Interactions;
 using ScubaDiver.API.Interactions.Callbacks;
 using ScubaDiver.API.Interactions.Client;
+using ScubaDiver.API.Interactions.Memory;
+using ScubaDiver.API.Interactions.Profiling;
 using ScubaDiver.API.Utils;
 using ScubaDiver.Hooking;
 using Exception = System.Exception;
@@ -21,20 +25,55 @@ namespace ScubaDiver
         // Clients Tracking
         public object _registeredPidsLock = new();
         public List<int> _registeredPids = new();
+        // Registered pids whose clients identify themselves (send 'client_id') and keep a lease.
+        // Only these are dropped when their lease expires, older clients never send the heartbeat.
+        private readonly HashSet<int> _leasedPids = new();
+
+        // Pin Leases
+        public static readonly TimeSpan PinLeaseDuration = TimeSpan.FromMinutes(1);
+        private static readonly TimeSpan LeasesReaperInterval = TimeSpan.FromSeconds(10);
+        protected readonly PinLeases _pinLeases = new(PinLeaseDuration);
+        private Timer _leasesReaper;
+        // Enumerations read a page at a time by /get_items. Abandoned ones are closed by the leases reaper.
+        protected readonly EnumerationCursors _itemCursors = new(PinLeaseDuration);
+        // Client which sent the request handled by the current thread, if it identified itself
+        [ThreadStatic]
+        private static int? _currentClientId;
 
         // HTTP Responses fields
         protected readonly Dictionary<string, Func<ScubaDiverMessage, string>> _responseBodyCreators;
+        // Endpoints answering with a binary body. Failures are still reported with a JSON error.
+        protected readonly Dictionary<string, Func<ScubaDiverMessage, byte[]>> _binaryResponseBodyCreators;
+        // Endpoints answering with plain text
+        protected readonly Dictionary<string, Func<ScubaDiverMessage, string>> _textResponseBodyCreators;
         private IRequestsListener _listener;
+        private readonly RequestsScheduler _scheduler;
+        // Endpoints which might run for a long while. Those are executed on the bulk lane of the scheduler.
+        protected readonly HashSet<string> _bulkEndpoints = new()
+        {
+            "/heap",
+            "/types",
+            "/inject_assembly",
+            "/inject_dll",
+        };
 
         // Hooks Tracking
         protected bool _monitorEndpoints = true;
         private int _nextAvailableCallbackToken;
         protected readonly ConcurrentDictionary<int, RegisteredManagedMethodHookInfo> _remoteHooks;
         protected readonly HookingCenter _hookingCenter;
+        private readonly BatchedHookDispatcher _batchedHooks;
+        private readonly ConcurrentDictionary<int, MethodProfiler> _profilers = new();
+
+        // Metrics
+        protected readonly DiverMetrics _metrics = new();
+        // Requests to endpoints which don't exist are all counted under this label
+        private const string UnknownEndpoint = "unknown";
 
         public DiverBase(IRequestsListener listener)
         {
             _listener = listener;
+            _scheduler = new RequestsScheduler(GetType().Name, HandleDispatchedRequest, endpoint => _bulkEndpoints.Contains(endpoint));
             _hookingCenter = new HookingCenter();
             _responseBodyCreators = new Dictionary<string, Func<ScubaDiverMessage, string>>()
             {
@@ -45,6 +84,7 @@ namespace ScubaDiver
                 {"/unregister_client", MakeUnregisterClientResponse},
                 {"/help", MakeHelpResponse},
                 {"/launch_debugger", MakeLaunchDebuggerResponse},
+                {"/cancel_request", MakeCancelRequestResponse},
                 // DLL Injection
                 {"/inject_assembly", MakeInjectAssemblyResponse},
                 {"/inject_dll", MakeInjectDllResponse},
@@ -59,20 +99,42 @@ namespace ScubaDiver
                 {"/invoke", MakeInvokeResponse},
                 {"/get_field", MakeGetFieldResponse},
                 {"/set_field", MakeSetFieldResponse},
+                {"/pin", MakePinResponse},
                 {"/unpin", MakeUnpinResponse},
                 {"/get_item", MakeArrayItemResponse},
+                {"/get_items", MakeArrayItemsResponse},
+                {"/objects_snapshot", MakeObjectsSnapshotResponse},
                 // Hooking
                 {"/hook_method", MakeHookMethodResponse},
                 {"/unhook_method", MakeUnhookMethodResponse},
+                // Profiling
+                {"/profile_method", MakeProfileMethodResponse},
+                {"/profile_report", MakeProfileReportResponse},
+                {"/unprofile_method", MakeUnprofileMethodResponse},
                 // Custom Functions
                 {"/register_custom_function", MakeRegisterCustomFunctionResponse},
             };
+            _binaryResponseBodyCreators = new Dictionary<string, Func<ScubaDiverMessage, byte[]>>()
+            {
+                // Raw Memory
+                {"/read_memory", MakeReadMemoryResponse},
+            };
+            _textResponseBodyCreators = new Dictionary<string, Func<ScubaDiverMessage, string>>()
+            {
+                // Monitoring
+                {"/metrics", MakeMetricsResponse},
+            };
             _remoteHooks = new ConcurrentDictionary<int, RegisteredManagedMethodHookInfo>();
+            _batchedHooks = new BatchedHookDispatcher(
+                (token, invocation, pinned) => EncodeHookInvocation(token, string.Empty, invocation.ThreadId, invocation.RetValue, invocation.Parameters, pinned),
+                (clientId, address) => _pinLeases.Add(clientId, address),
+                ReleaseUnheldPins);
+            RegisterMetricsGauges();
         }
 
         private string MakeHelpResponse(ScubaDiverMessage arg)
         {
-            var possibleCommands = _responseBodyCreators.Keys.ToList();
+            var possibleCommands = _responseBodyCreators.Keys.Concat(_binaryResponseBodyCreators.Keys).Concat(_textResponseBodyCreators.Keys).ToList();
             possibleCommands.Sort();
             return JsonConvert.SerializeObject(possibleCommands);
         }
@@ -80,7 +142,8 @@ namespace ScubaDiver
         public virtual void Start()
         {
             Logger.Debug("[DiverBase] Start() -- entering");
-            _listener.RequestReceived += HandleDispatchedRequest;
+            _listener.RequestReceived += ScheduleRequest;
+            _leasesReaper = new Timer(_ => ReapExpiredLeases(), null, LeasesReaperInterval, LeasesReaperInterval);
             _listener.Start();
             Logger.Debug("[DiverBase] Start() -- returning");
         }
@@ -101,6 +164,7 @@ namespace ScubaDiver
                     {
                         Logger.Debug($"[DiverBase] Dead Callback client at {endpoint} (Token = {registeredMethodHookInfo.Key}) DROPPED!");
                         _remoteHooks.TryRemove(registeredMethodHookInfo.Key, out _);
+                        _batchedHooks.Unregister(registeredMethodHookInfo.Key);
                     }
                 }
             }
@@ -155,7 +219,9 @@ namespace ScubaDiver
 
         #region HTTP Dispatching
 
-        private void HandleDispatchedRequest(object obj, ScubaDiverMessage request)
+        private void ScheduleRequest(object obj, ScubaDiverMessage request) => _scheduler.Schedule(request);
+
+        private void HandleDispatchedRequest(ScubaDiverMessage request)
         {
             // Check if the "debug" query parameter is set. If so, launch the debugger
             if (request.QueryString.Get("debug") == "1")
@@ -164,26 +230,86 @@ namespace ScubaDiver
                 Debugger.Launch();
             }
 
-            Stopwatch sw = Stopwatch.StartNew();
-            string body;
-            if (_responseBodyCreators.TryGetValue(request.UrlAbsolutePath, out var respBodyGenerator))
+            int? clientId = null;
+            if (int.TryParse(request.QueryString.Get("client_id"), out int parsedClientId))
             {
-                try
-                {
+                clientId = parsedClientId;
+                _pinLeases.Renew(parsedClientId);
+            }
+
+            _currentClientId = clientId;
+            try
+            {
+                HandleDispatchedRequestCore(request);
+            }
+            finally
+            {
+                _currentClientId = null;
+            }
+        }
+
+        private void HandleDispatchedRequestCore(ScubaDiverMessage request)
+        {
+            long handlerStart = Stopwatch.GetTimestamp();
+            string path = request.UrlAbsolutePath;
+            bool isBinary = _binaryResponseBodyCreators.TryGetValue(path, out var binaryBodyGenerator);
+            bool isText = _textResponseBodyCreators.TryGetValue(path, out var textBodyGenerator);
+            bool isJson = _responseBodyCreators.TryGetValue(path, out var respBodyGenerator);
+            EndpointMetrics metrics = _metrics.ForEndpoint(isBinary || isText || isJson ? path : UnknownEndpoint);
+            if (request.ScheduledTimestamp != 0)
+                metrics.QueueTime.Record(handlerStart - request.ScheduledTimestamp);
+
+            string body = null;
+            byte[] binaryBody = null;
+            bool failed = false;
+            try
+            {
+                // Don't bother starting requests which were cancelled while queued
+                request.CancellationToken.ThrowIfCancellationRequested();
+                if (isBinary)
+                    binaryBody = binaryBodyGenerator(request);
+                else if (isText)
+                    body = textBodyGenerator(request);
+                else if (isJson)
                     body = respBodyGenerator(request);
-                }
-                catch (Exception ex)
+                else
                 {
-                    body = QuickError(ex);
+                    body = QuickError("Unknown Command");
+                    failed = true;
                 }
             }
-            else
+            catch (OperationCanceledException)
+            {
+                body = QuickError("Request was cancelled");
+                failed = true;
+            }
+            catch (Exception ex)
             {
-                body = QuickError("Unknown Command");
+                body = QuickError(ex);
+                failed = true;
             }
-            sw.Stop();
+            long handlerEnd = Stopwatch.GetTimestamp();
+            metrics.HandlerTime.Record(handlerEnd - handlerStart);
 
-            request.ResponseSender(body);
+            // Errors are always sent as JSON
+            long bytesOut;
+            if (isBinary && !failed)
+            {
+                bytesOut = binaryBody?.Length ?? 0;
+                request.BinaryResponseSender(binaryBody);
+            }
+            else if (isText && !failed && request.TextResponseSender != null)
+            {
+                bytesOut = Encoding.UTF8.GetByteCount(body);
+                request.TextResponseSender(body);
+            }
+            else
+            {
+                bytesOut = body == null ? 0 : Encoding.UTF8.GetByteCount(body);
+                request.ResponseSender(body);
+            }
+            metrics.SerializationTime.Record(Stopwatch.GetTimestamp() - handlerEnd);
+            metrics.RecordResponse(bytesOut, failed);
         }
         #endregion
 
@@ -231,6 +357,7 @@ namespace ScubaDiver
             {
                 // Unregister from HookingCenter (it will handle Harmony unhooking if needed)
                 _hookingCenter.UnregisterHookAndUninstall(rmhi.UniqueHookId, token);
+                _batchedHooks.Unregister(token);
                 return "{\"status\":\"OK\"}";
             }
 
@@ -271,26 +398,51 @@ namespace ScubaDiver
 
             // Preparing a proxy method that Harmony will invoke
             // Note: Instance filtering is handled by HookingCenter, not here
-            HarmonyWrapper.HookCallback patchCallback = (object obj, object[] args, ref object retValue) =>
+            HarmonyWrapper.HookCallback patchCallback;
+            if (req.DeliveryMode == HookDeliveryMode.Batched)
             {
-                object[] parameters = new object[args.Length + 1];
-                parameters[0] = obj;
-                Array.Copy(args, 0, parameters, 1, args.Length);
+                _batchedHooks.Register(token, endpoint, req.BatchCapacity, _currentClientId);
+                patchCallback = (object obj, object[] args, ref object retValue) =>
+                {
+                    object[] parameters = new object[args.Length + 1];
+                    parameters[0] = obj;
+                    Array.Copy(args, 0, parameters, 1, args.Length);
+
+                    // Observe-only: Queue the invocation for the delivery thread and let the original run.
+                    // The delivery thread encodes (and pins) the objects. Not collecting a stack trace, it's the most
+                    // expensive part of an invocation.
+                    _batchedHooks.TryEnqueue(token, new BatchedHookDispatcher.PendingInvocation()
+                    {
+                        ThreadId = Thread.CurrentThread.ManagedThreadId,
+                        RetValue = retValue,
+                        Parameters = parameters
+                    });
+                    return true;
+                };
+            }
+            else
+            {
+                patchCallback = (object obj, object[] args, ref object retValue) =>
+                {
+                    object[] parameters = new object[args.Length + 1];
+                    parameters[0] = obj;
+                    Array.Copy(args, 0, parameters, 1, args.Length);
 
-                // Shift control to remote hook (Other process)
-                HookResponse res = InvokeHookCallback(endpoint, token, new StackTrace().ToString(), retValue, parameters: parameters);
+                    // Shift control to remote hook (Other process)
+                    HookResponse res = InvokeHookCallback(endpoint, token, new StackTrace().ToString(), retValue, parameters: parameters);
 
-                // Remote hook returned, examine it's return value.
-                bool skipOriginal = res.SkipOriginal;
-                if (res.ReturnValue != null)
-                {
-                    retValue = ResolveHookReturnValue(res.ReturnValue);
-                }
+                    // Remote hook returned, examine it's return value.
+                    bool skipOriginal = res.SkipOriginal;
+                    if (res.ReturnValue != null)
+                    {
+                        retValue = ResolveHookReturnValue(res.ReturnValue);
+                    }
 
-                // Silly mix up...
-                bool callOriginal = !skipOriginal;
-                return callOriginal;
-            };
+                    // Silly mix up...
+                    bool callOriginal = !skipOriginal;
+                    return callOriginal;
+                };
+            }
 
             Logger.Debug($"[DiverBase] Hooking function {req.MethodName}...");
             
@@ -311,6 +463,7 @@ namespace ScubaDiver
                 // Hooking failed so we cleanup the Hook Info we inserted beforehand 
                 _remoteHooks.TryRemove(token, out _);
                 _hookingCenter.UnregisterHookAndUninstall(uniqueHookId, token);
+                _batchedHooks.Unregister(token);
 
                 Logger.Debug($"[DiverBase] Failed to hook func {req.MethodName}. Exception: {ex}");
                 return QuickError($"Failed insert the hook for the function. HarmonyWrapper.AddHook failed. Exception: {ex}", ex);
@@ -330,6 +483,96 @@ namespace ScubaDiver
             return JsonConvert.SerializeObject(erResults);
         }
 
+        protected string MakeProfileMethodResponse(ScubaDiverMessage arg)
+        {
+            Logger.Debug("[DiverBase] Got Profile Method request!");
+            if (string.IsNullOrEmpty(arg.Body))
+                return QuickError("Missing body");
+
+            var request = JsonConvert.DeserializeObject<ProfileMethodRequest>(arg.Body);
+            if (request == null)
+                return QuickError("Failed to deserialize body");
+
+            FunctionHookRequest ToHookRequest(HarmonyPatchPosition pos) => new()
+            {
+                TypeFullName = request.TypeFullName,
+                MethodName = request.MethodName,
+                ParametersTypeFullNames = request.ParametersTypeFullNames,
+                HookPosition = pos.ToString()
+            };
+            FunctionHookRequest prefixRequest = ToHookRequest(HarmonyPatchPosition.Prefix);
+            FunctionHookRequest finalizerRequest = ToHookRequest(HarmonyPatchPosition.Finalizer);
+
+            int token = AssignCallbackToken();
+            MethodProfiler profiler = new(token, request.TypeFullName, request.MethodName, request.BucketByInstance, ResolveInstanceAddress)
+            {
+                PrefixHookId = GenerateHookId(prefixRequest),
+                FinalizerHookId = GenerateHookId(finalizerRequest)
+            };
+
+            try
+            {
+                // Prefix first. A finalizer without a matching prefix is ignored.
+                _hookingCenter.RegisterHookAndInstall(profiler.PrefixHookId, 0, profiler.Prefix, token,
+                    unifiedCallback => HookFunction(prefixRequest, unifiedCallback), ResolveInstanceAddress);
+                _hookingCenter.RegisterHookAndInstall(profiler.FinalizerHookId, 0, profiler.Finalizer, token,
+                    unifiedCallback => HookFunction(finalizerRequest, unifiedCallback), ResolveInstanceAddress);
+            }
+            catch (Exception ex)
+            {
+                _hookingCenter.UnregisterHookAndUninstall(profiler.FinalizerHookId, token);
+                _hookingCenter.UnregisterHookAndUninstall(profiler.PrefixHookId, token);
+
+                Logger.Debug($"[DiverBase] Failed to profile func {request.MethodName}. Exception: {ex}");
+                return QuickError($"Failed insert the profiling hooks for the function. Exception: {ex}", ex);
+            }
+
+            _profilers[token] = profiler;
+            Logger.Debug($"[DiverBase] Profiling func {request.MethodName}. Token: {token}");
+
+            EventRegistrationResults erResults = new() { Token = token };
+            return JsonConvert.SerializeObject(erResults);
+        }
+
+        protected string MakeProfileReportResponse(ScubaDiverMessage arg)
+        {
+            string tokenStr = arg.QueryString.Get("token");
+            if (tokenStr == null || !int.TryParse(tokenStr, out int token))
+                return QuickError("Missing parameter 'token'");
+            bool reset = arg.QueryString.Get("reset") == "true";
+
+            if (!_profilers.TryGetValue(token, out MethodProfiler profiler))
+                return QuickError("Unknown token for profiled method");
+
+            return JsonConvert.SerializeObject(profiler.GetReport(reset));
+        }
+
+        protected string MakeUnprofileMethodResponse(ScubaDiverMessage arg)
+        {
+            string tokenStr = arg.QueryString.Get("token");
+            if (tokenStr == null || !int.TryParse(tokenStr, out int token))
+                return QuickError("Missing parameter 'token'");
+
+            if (!_profilers.TryRemove(token, out MethodProfiler profiler))
+                return QuickError("Unknown token for profiled method");
+
+            _hookingCenter.UnregisterHookAndUninstall(profiler.FinalizerHookId, token);
+            _hookingCenter.UnregisterHookAndUninstall(profiler.PrefixHookId, token);
+            // Last report, so nothing gathered since the previous one is lost
+            return JsonConvert.SerializeObject(profiler.GetReport(reset: false));
+        }
+
+        protected byte[] MakeReadMemoryResponse(ScubaDiverMessage arg)
+        {
+            if (string.IsNullOrEmpty(arg.Body))
+                throw new ArgumentException("Missing body");
+            ReadMemoryRequest request = JsonConvert.DeserializeObject<ReadMemoryRequest>(arg.Body);
+            if (request?.Addresses == null || request.Lengths == null)
+                throw new ArgumentException("Failed to deserialize body");
+
+            return SafeMemoryReader.ReadRanges(request.Addresses, request.Lengths);
+        }
+
         private string GenerateHookId(FunctionHookRequest req)
         {
             string paramsList = string.Join(";", req.ParametersTypeFullNames ?? new List<string>());
@@ -346,6 +589,12 @@ namespace ScubaDiver
 
         protected abstract ObjectOrRemoteAddress InvokeEventCallback(IPEndPoint callbacksEndpoint, int token, string stackTrace, object retValue, params object[] parameters);
         protected abstract HookResponse InvokeHookCallback(IPEndPoint callbacksEndpoint, int token, string stackTrace, object retValue, params object[] parameters);
+        /// <summary>
+        /// Converts the hooked method's arguments to what's sent to the client (pinning objects as needed)
+        /// </summary>
+        /// <param name="threadId">Managed ID of the thread which called the hooked method</param>
+        /// <param name="pinned">If not null, receives the addresses pinned for this invocation</param>
+        protected abstract CallbackInvocationRequest EncodeHookInvocation(int token, string stackTrace, int threadId, object retValue, object[] parameters, List<ulong> pinned = null);
 
 
 
@@ -358,6 +607,155 @@ namespace ScubaDiver
 
         #endregion
 
+        #region Cancellation Handler
+
+        private string MakeCancelRequestResponse(ScubaDiverMessage arg)
+        {
+            string targetRequestId = arg.QueryString.Get("target_request_id");
+            if (string.IsNullOrWhiteSpace(targetRequestId))
+            {
+                return QuickError("Missing parameter 'target_request_id'");
+            }
+
+            // Request IDs are only unique within a connection, so only requests sent on the same connection can be cancelled.
+            bool found = _scheduler.Cancel(arg.ConnectionId, targetRequestId);
+            return found ? "{\"status\":\"OK\"}" : "{\"status\":\"Request not found\"}";
+        }
+
+        #endregion
+
+        #region Metrics
+
+        /// <summary>
+        /// Types whose dumps are cached, for /metrics
+        /// </summary>
+        protected virtual int CachedTypesCount => 0;
+
+        private void RegisterMetricsGauges()
+        {
+            _metrics.AddGauge("diver_pinned_objects", "Objects pinned on behalf of clients", () => _pinLeases.PinnedCount);
+            _metrics.AddGauge("diver_hooks_installed", "Method hooks registered by clients", () => _remoteHooks.Count);
+            _metrics.AddGauge("diver_profilers_installed", "Methods being profiled", () => _profilers.Count);
+            _metrics.AddGauge("diver_cached_types", "Type dumps held in the cache", () => CachedTypesCount);
+            _metrics.AddGauge("diver_enumeration_cursors", "Open /get_items cursors", () => _itemCursors.Count);
+            _metrics.AddGauge("diver_requests_queued", "Requests waiting for a worker, by lane", () => new[]
+            {
+                (DiverMetrics.Label("lane", "interactive"), (double)_scheduler.InteractiveQueuedCount),
+                (DiverMetrics.Label("lane", "bulk"), (double)_scheduler.BulkQueuedCount),
+            });
+            _metrics.AddGauge("diver_registered_clients", "Clients registered with the diver", () =>
+            {
+                lock (_registeredPidsLock)
+                {
+                    return _registeredPids.Count;
+                }
+            });
+        }
+
+        private string MakeMetricsResponse(ScubaDiverMessage arg) => _metrics.Export();
+
+        #endregion
+
+        #region Pin Leases
+
+        /// <summary>
+        /// Makes the client of the current request a holder of a pinned address.
+        /// Once all of its holders are gone the address is unpinned with <see cref="UnpinLeasedAddresses"/>.
+        /// </summary>
+        protected void LeasePin(ulong pinnedAddress)
+        {
+            if (_currentClientId.HasValue)
+                _pinLeases.Add(_currentClientId.Value, pinnedAddress);
+        }
+
+        /// <summary>
+        /// Unpins addresses which no client holds anymore
+        /// </summary>
+        protected abstract void UnpinLeasedAddresses(List<ulong> pinnedAddresses);
+
+        /// <summary>
+        /// Releases the current request's client's pins of objects it received but never used.
+        /// Objects still held by other clients stay pinned. Without a client ID only objects nobody holds are unpinned.
+        /// </summary>
+        protected void ReleaseUnusedPins(IEnumerable<ulong> pinnedAddresses)
+        {
+            List<ulong> toUnpin = new();
+            foreach (ulong address in pinnedAddresses)
+            {
+                bool unheld = _currentClientId.HasValue
+                    ? _pinLeases.Remove(_currentClientId.Value, address)
+                    : !_pinLeases.IsHeld(address);
+                if (unheld)
+                    toUnpin.Add(address);
+            }
+            if (toUnpin.Count > 0)
+                UnpinLeasedAddresses(toUnpin);
+        }
+
+        /// <summary>
+        /// Unpins the addresses no client holds. Used for pins taken outside of a client's request.
+        /// </summary>
+        private void ReleaseUnheldPins(List<ulong> pinnedAddresses)
+        {
+            List<ulong> toUnpin = pinnedAddresses.Where(address => !_pinLeases.IsHeld(address)).ToList();
+            if (toUnpin.Count > 0)
+                UnpinLeasedAddresses(toUnpin);
+        }
+
+        private void ReleaseClientPins(int clientId)
+        {
+            List<ulong> released = _pinLeases.Release(clientId);
+            if (released.Count == 0)
+                return;
+            Logger.Debug($"[DiverBase] Unpinning {released.Count} objects held by client {clientId}");
+            UnpinLeasedAddresses(released);
+        }
+
+        private void ReapExpiredLeases()
+        {
+            // Runs on a timer thread, exceptions here would take the target down
+            try
+            {
+                foreach (int clientId in _pinLeases.GetExpiredClients())
+                {
+                    Logger.Debug($"[DiverBase] Lease of client {clientId} expired");
+                    lock (_registeredPidsLock)
+                    {
+                        // Several clients in one process share the lease, all of them are gone
+                        if (_leasedPids.Remove(clientId))
+                            _registeredPids.RemoveAll(pid => pid == clientId);
+                    }
+                    ReleaseClientPins(clientId);
+                }
+
+                int closedCursors = _itemCursors.CloseIdle();
+                if (closedCursors > 0)
+                    Logger.Debug($"[DiverBase] Closed {closedCursors} idle enumeration cursors");
+            }
+            catch (Exception ex)
+            {
+                Logger.Debug("[DiverBase] Failed to reap expired leases. Exception: " + ex);
+            }
+        }
+
+        /// <param name="sizeOf">Size of the object pinned at an address</param>
+        protected PinsStats GetPinsStats(Func<ulong, ulong> sizeOf)
+        {
+            PinsStats stats = new() { LeaseDurationSeconds = _pinLeases.LeaseDuration.TotalSeconds };
+            foreach (KeyValuePair<int, (int count, ulong bytes)> kvp in _pinLeases.GetStats(sizeOf))
+            {
+                stats.Clients.Add(new PinsStats.ClientPins()
+                {
+                    ClientId = kvp.Key,
+                    PinnedCount = kvp.Value.count,
+                    PinnedBytes = kvp.Value.bytes
+                });
+            }
+            return stats;
+        }
+
+        #endregion
+
         #region Client Registration Handlers
         private string MakeRegisterClientResponse(ScubaDiverMessage arg)
         {
@@ -369,6 +767,9 @@ namespace ScubaDiver
             lock (_registeredPidsLock)
             {
                 _registeredPids.Add(pid);
+                // The request already started the lease if it carried 'client_id'. Clients without one aren't leased.
+                if (_currentClientId == pid)
+                    _leasedPids.Add(pid);
             }
             Logger.Debug("[DiverBase] New client registered. ID = " + pid);
             return "{\"status\":\"OK\"}";
@@ -382,12 +783,19 @@ namespace ScubaDiver
             }
             bool removed;
             int remaining;
+            bool stillRegistered;
             lock (_registeredPidsLock)
             {
                 removed = _registeredPids.Remove(pid);
                 remaining = _registeredPids.Count;
+                stillRegistered = _registeredPids.Contains(pid);
+                if (!stillRegistered)
+                    _leasedPids.Remove(pid);
             }
             Logger.Debug("[DiverBase] Client unregistered. ID = " + pid);
+            // Several clients in the same process share a lease
+            if (!stillRegistered)
+                ReleaseClientPins(pid);
 
             UnregisterClientResponse ucResponse = new()
             {
@@ -427,7 +835,10 @@ namespace ScubaDiver
         protected abstract string MakeGetFieldResponse(ScubaDiverMessage arg);
         protected abstract string MakeSetFieldResponse(ScubaDiverMessage arg);
         protected abstract string MakeArrayItemResponse(ScubaDiverMessage arg);
+        protected abstract string MakeArrayItemsResponse(ScubaDiverMessage arg);
+        protected abstract string MakePinResponse(ScubaDiverMessage arg);
         protected abstract string MakeUnpinResponse(ScubaDiverMessage arg);
+        protected abstract string MakeObjectsSnapshotResponse(ScubaDiverMessage arg);
         protected abstract string MakeRegisterCustomFunctionResponse(ScubaDiverMessage arg);
 
         private string MakeDieResponse(ScubaDiverMessage req)
@@ -451,9 +862,12 @@ namespace ScubaDiver
 
         public virtual void Dispose()
         {
+            _leasesReaper?.Dispose();
             _listener.Stop();
-            _listener.RequestReceived -= HandleDispatchedRequest;
+            _listener.RequestReceived -= ScheduleRequest;
             _listener.Dispose();
+            _scheduler.Dispose();
+            _batchedHooks.Dispose();
         }
 
         public void WaitForExit() => _listener.WaitForExit();
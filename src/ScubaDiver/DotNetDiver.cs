@@ -32,6 +32,22 @@ namespace ScubaDiver
         private ClrRuntime _runtime = null;
         // Address to Object converter
         private readonly Converter<object> _converter = new();
+        // Resolved members and compiled invokers for /invoke, /get_field, /set_field and /create_object
+        private readonly ReflectionInvokersCache _invokers = new();
+        // Serialized /type responses. Loading assemblies might change how type names resolve so it clears the cache.
+        private readonly TypeDumpCache _typeDumps = new();
+        protected override int CachedTypesCount => _typeDumps.Count;
+        // Names of every loaded assembly's types, for /types queries. Types of dynamic assemblies can change so those aren't kept.
+        private readonly ConcurrentDictionary<Assembly, AssemblyTypesIndex> _assemblyTypes = new();
+        // Heap objects by type for /heap. Rebuilt from a new snapshot once a GC occurs.
+        private ClrHeapIndex _heapIndex;
+
+        private class AssemblyTypesIndex
+        {
+            // Types are indexed by both their full name and their name
+            public readonly TypeNameIndex<Type> Types = new();
+            public ReflectionTypeLoadException LoadError;
+        }
 
 
         // Callbacks Endpoint of the Controller process
@@ -46,11 +62,15 @@ namespace ScubaDiver
         {
             _responseBodyCreators.Add("/event_subscribe", MakeEventSubscribeResponse);
             _responseBodyCreators.Add("/event_unsubscribe", MakeEventUnsubscribeResponse);
+            _responseBodyCreators.Add("/gc_stats", MakeGcStatsResponse);
 
             _remoteEventHandler = new ConcurrentDictionary<int, RegisteredEventHandlerInfo>();
             _unifiedAppDomain = new UnifiedAppDomain(this);
+            AppDomain.CurrentDomain.AssemblyLoad += OnAssemblyLoad;
         }
 
+        private void OnAssemblyLoad(object sender, AssemblyLoadEventArgs args) => _typeDumps.Invalidate();
+
         private Task endpointsMonitor;
 
         public override void Start()
@@ -270,8 +290,7 @@ namespace ScubaDiver
                         "Hash Code fallback was NOT activated\"}");
                 }
 
-                Predicate<string> typeFilter = (string type) => type.Contains(lastKnownClrObj.Type.Name);
-                (bool anyErrors, List<HeapDump.HeapObject> objects) = GetHeapObjects(typeFilter, true);
+                (bool anyErrors, List<HeapDump.HeapObject> objects) = GetHeapObjects(lastKnownClrObj.Type.Name, true);
                 if (anyErrors)
                 {
                     throw new Exception(
@@ -341,76 +360,79 @@ namespace ScubaDiver
 
         #endregion
 
-        public (bool anyErrors, List<HeapDump.HeapObject> objects) GetHeapObjects(Predicate<string> filter, bool dumpHashcodes)
+        /// <param name="typeFilter">A "simple filter" (see <see cref="Filter"/>) of type names</param>
+        /// <param name="forceGcCollect">
+        /// Whether to collect garbage before looking at the heap.
+        /// Without it, the objects are taken from the heap index if no GC occurred since it was built.
+        /// </param>
+        public (bool anyErrors, List<HeapDump.HeapObject> objects) GetHeapObjects(string typeFilter, bool dumpHashcodes, bool forceGcCollect = true, CancellationToken cancellationToken = default)
         {
             List<HeapDump.HeapObject> objects = new();
             bool anyErrors = false;
             // Trying several times to dump all candidates
             for (int i = 0; i < 10; i++)
             {
+                cancellationToken.ThrowIfCancellationRequested();
                 Logger.Debug($"Trying to dump heap objects. Try #{i + 1}");
                 // Clearing leftovers from last trial
                 objects.Clear();
                 anyErrors = false;
 
-                GC.Collect();
-                RefreshRuntime();
-                lock (_clrMdLock)
+                if (forceGcCollect)
+                    GC.Collect();
+                // A failed trial means objects moved, so the index is rebuilt even if the collection counts didn't catch up yet
+                ClrHeapIndex heapIndex = GetHeapIndex(forceRebuild: i > 0, cancellationToken);
+                foreach (ClrHeapIndex.TypeInstances typeInstances in heapIndex.Query(typeFilter))
                 {
-                    foreach (ClrObject clrObj in _runtime.Heap.EnumerateObjects())
+                    foreach (ClrHeapIndex.Instance clrObj in typeInstances.Instances)
                     {
-                        if (clrObj.IsFree)
-                            continue;
+                        cancellationToken.ThrowIfCancellationRequested();
+                        int hashCode = 0;
 
-                        string objType = clrObj.Type?.Name ?? "Unknown";
-                        if (filter(objType))
+                        if (dumpHashcodes)
                         {
-                            ulong mt = clrObj.Type.MethodTable;
-                            int hashCode = 0;
-
-                            if (dumpHashcodes)
+                            object instance = null;
+                            try
+                            {
+                                instance = _converter.ConvertFromIntPtr(clrObj.Address, clrObj.MethodTable);
+                            }
+                            catch (Exception)
                             {
-                                object instance = null;
-                                try
-                                {
-                                    instance = _converter.ConvertFromIntPtr(clrObj.Address, mt);
-                                }
-                                catch (Exception)
-                                {
-                                    // Exiting heap enumeration and signaling that this trial has failed.
-                                    anyErrors = true;
-                                    break;
-                                }
-
-                                // We got the object in our hands so we haven't spotted a GC collection or anything else scary
-                                // now getting the hashcode which is itself a challenge since 
-                                // objects might (very rudely) throw exceptions on this call.
-                                // I'm looking at you, System.Reflection.Emit.SignatureHelper
-                                //
-                                // We don't REALLY care if we don't get a has code. It just means those objects would
-                                // be a bit more hard to grab later.
-                                try
-                                {
-                                    hashCode = instance.GetHashCode();
-                                }
-                                catch
-                                {
-                                    // TODO: Maybe we need a boolean in HeapObject to indicate we couldn't get the hashcode...
-                                    hashCode = 0;
-                                }
+                                // Exiting heap enumeration and signaling that this trial has failed.
+                                anyErrors = true;
+                                break;
                             }
 
-                            objects.Add(new HeapDump.HeapObject()
+                            // We got the object in our hands so we haven't spotted a GC collection or anything else scary
+                            // now getting the hashcode which is itself a challenge since 
+                            // objects might (very rudely) throw exceptions on this call.
+                            // I'm looking at you, System.Reflection.Emit.SignatureHelper
+                            //
+                            // We don't REALLY care if we don't get a has code. It just means those objects would
+                            // be a bit more hard to grab later.
+                            try
+                            {
+                                hashCode = instance.GetHashCode();
+                            }
+                            catch
                             {
-                                Address = clrObj.Address,
-                                Type = objType,
-                                HashCode = hashCode,
-                                // No need to mask the Method Table in the .NET diver
-                                XoredMethodTable = clrObj.Type.MethodTable,
-                                XorMask = 0
-                            });
+                                // TODO: Maybe we need a boolean in HeapObject to indicate we couldn't get the hashcode...
+                                hashCode = 0;
+                            }
                         }
+
+                        objects.Add(new HeapDump.HeapObject()
+                        {
+                            Address = clrObj.Address,
+                            Type = typeInstances.TypeName,
+                            HashCode = hashCode,
+                            // No need to mask the Method Table in the .NET diver
+                            XoredMethodTable = clrObj.MethodTable,
+                            XorMask = 0
+                        });
                     }
+                    if (anyErrors)
+                        break;
                 }
                 if (!anyErrors)
                 {
@@ -426,6 +448,27 @@ namespace ScubaDiver
             return (anyErrors, objects);
         }
 
+        private ClrHeapIndex GetHeapIndex(bool forceRebuild, CancellationToken cancellationToken)
+        {
+            lock (_clrMdLock)
+            {
+                if (!forceRebuild && _heapIndex != null && _heapIndex.IsCurrent)
+                    return _heapIndex;
+            }
+
+            // Counting before the snapshot is taken so a GC during the build leaves the index stale rather than wrong
+            int[] collectionCounts = ClrHeapIndex.GetCollectionCounts();
+            RefreshRuntime();
+            lock (_clrMdLock)
+            {
+                Stopwatch sw = Stopwatch.StartNew();
+                _heapIndex = ClrHeapIndex.Build(_runtime.Heap, collectionCounts, cancellationToken);
+                _metrics.RecordScan("heap_index", sw.Elapsed);
+                Logger.Debug($"[DotNetDiver] Indexed {_heapIndex.ObjectsCount} heap objects in {sw.ElapsedMilliseconds} ms");
+                return _heapIndex;
+            }
+        }
+
 
         #region Ping Handler
 
@@ -470,8 +513,6 @@ namespace ScubaDiver
             string typeFilter = req.QueryString.Get("type_filter");
 
             Predicate<string> assemblyFilterPredicate = Filter.CreatePredicate(assemblyFilter);
-            Predicate<string> typeFilterPredicate = Filter.CreatePredicate(typeFilter);
-
 
             // Try exact match assembly 
             var allAssembliesInApp = _unifiedAppDomain.GetAssemblies();
@@ -487,36 +528,34 @@ namespace ScubaDiver
             List<TypesDump.AssemblyLoadError> loadErrors = new List<TypesDump.AssemblyLoadError>();
             foreach (Assembly matchingAssembly in matchingAssemblies)
             {
-                IEnumerable<Type> assemblyTypes;
+                req.CancellationToken.ThrowIfCancellationRequested();
+                AssemblyTypesIndex assemblyTypes;
                 try
                 {
-                    assemblyTypes = matchingAssembly.GetTypes();
+                    assemblyTypes = GetAssemblyTypes(matchingAssembly);
                 }
-                catch (ReflectionTypeLoadException ex)
+                catch (Exception ex)
                 {
-                    assemblyTypes = ex.Types.Where(type => type != null);
                     loadErrors.Add(new TypesDump.AssemblyLoadError
                     {
                         Assembly = matchingAssembly.GetName().Name,
                         Error = CreateDiverError(ex)
                     });
+                    continue;
                 }
-                catch (Exception ex)
+
+                if (assemblyTypes.LoadError != null)
                 {
                     loadErrors.Add(new TypesDump.AssemblyLoadError
                     {
                         Assembly = matchingAssembly.GetName().Name,
-                        Error = CreateDiverError(ex)
+                        Error = CreateDiverError(assemblyTypes.LoadError)
                     });
-                    continue;
                 }
 
-                foreach (Type type in assemblyTypes)
+                // Types matching by both their full name and their name are only listed once
+                foreach (Type type in assemblyTypes.Types.Query(typeFilter).Distinct())
                 {
-                    // TODO: Is checking both FullName and Name overkill?
-                    if (!typeFilterPredicate(type.FullName) && !typeFilterPredicate(type.Name))
-                        continue;
-
                     string assembly = matchingAssembly.GetName().Name;
                     string fullTypeName = type.FullName;
                     ulong? methodTable = null; // Not yet supported in DotNetDiver
@@ -532,6 +571,35 @@ namespace ScubaDiver
 
             return JsonConvert.SerializeObject(dump);
         }
+
+        private AssemblyTypesIndex GetAssemblyTypes(Assembly assembly)
+        {
+            if (_assemblyTypes.TryGetValue(assembly, out AssemblyTypesIndex index))
+                return index;
+
+            index = new AssemblyTypesIndex();
+            IEnumerable<Type> types;
+            try
+            {
+                types = assembly.GetTypes();
+            }
+            catch (ReflectionTypeLoadException ex)
+            {
+                types = ex.Types.Where(type => type != null);
+                index.LoadError = ex;
+            }
+
+            foreach (Type type in types)
+            {
+                index.Types.Add(type.FullName, type);
+                index.Types.Add(type.Name, type);
+            }
+
+            if (!assembly.IsDynamic)
+                _assemblyTypes[assembly] = index;
+            return index;
+        }
+
         public string MakeTypeResponse(TypeDumpRequest dumpRequest)
         {
             string type = dumpRequest.TypeFullName;
@@ -541,6 +609,12 @@ namespace ScubaDiver
             }
 
             string assembly = dumpRequest.Assembly;
+            string json = _typeDumps.GetOrCreate($"{assembly}!{type}", () => DumpType(type, assembly), dumpRequest.IfNoneMatch);
+            return json ?? QuickError("Failed to find type in searched assemblies");
+        }
+
+        private TypeDump DumpType(string type, string assembly)
+        {
             //Logger.Debug($"[DotNetDiver] Trying to dump Type: {type}");
             if (assembly != null)
             {
@@ -591,13 +665,7 @@ namespace ScubaDiver
                 return td;
             }
 
-            if (resolvedType != null)
-            {
-                TypeDump recusiveTypeDump = ParseType(resolvedType);
-                return JsonConvert.SerializeObject(recusiveTypeDump);
-            }
-
-            return QuickError("Failed to find type in searched assemblies");
+            return ParseType(resolvedType);
         }
         protected override string MakeTypeResponse(ScubaDiverMessage req)
         {
@@ -619,18 +687,17 @@ namespace ScubaDiver
         }
         protected override string MakeHeapResponse(ScubaDiverMessage arg)
         {
-            // Since ClrMD works on copied memory (in the snapshot process), we must refresh it so it copies again
-            // the updated heap's state between invocations.
-            RefreshRuntime();
-
+            // Since ClrMD works on copied memory (in the snapshot process), the heap index takes a new snapshot
+            // whenever a GC might have changed the heap's state since the last one.
             string filter = arg.QueryString.Get("type_filter");
             string dumpHashcodesStr = arg.QueryString.Get("dump_hashcodes");
             bool dumpHashcodes = dumpHashcodesStr?.ToLower() == "true";
+            // Collecting by default: ClrMD might not "see" some objects otherwise. Opting out lets cached results be reused.
+            string gcCollectStr = arg.QueryString.Get("gc_collect");
+            bool gcCollect = gcCollectStr?.ToLower() != "false";
 
             // Default filter - no filter. Just return everything.
-            Predicate<string> matchesFilter = Filter.CreatePredicate(filter);
-
-            (bool anyErrors, List<HeapDump.HeapObject> objects) = GetHeapObjects(matchesFilter, dumpHashcodes);
+            (bool anyErrors, List<HeapDump.HeapObject> objects) = GetHeapObjects(filter, dumpHashcodes, gcCollect, arg.CancellationToken);
             if (anyErrors)
             {
                 return "{\"error\":\"All dumping trials failed because at least 1 " +
@@ -660,7 +727,7 @@ namespace ScubaDiver
 
             Action unhookMethod = (Action)(() =>
             {
-                HarmonyWrapper.Instance.UnhookAnyHookPosition(methodInfo);
+                HarmonyWrapper.Instance.RemoveHook(methodInfo, hookPosition);
             });
             return unhookMethod;
         }
@@ -805,7 +872,14 @@ namespace ScubaDiver
         protected override HookResponse InvokeHookCallback(IPEndPoint callbacksEndpoint, int token, string stackTrace, object retValue, params object[] parameters)
         {
             ReverseCommunicator reverseCommunicator = new(callbacksEndpoint);
+            CallbackInvocationRequest invocation = EncodeHookInvocation(token, stackTrace, Thread.CurrentThread.ManagedThreadId, retValue, parameters);
 
+            // Call callback at controller
+            return reverseCommunicator.InvokeHookCallback(invocation);
+        }
+
+        protected override CallbackInvocationRequest EncodeHookInvocation(int token, string stackTrace, int threadId, object retValue, object[] parameters, List<ulong> pinned = null)
+        {
             ObjectOrRemoteAddress[] remoteParams = new ObjectOrRemoteAddress[parameters.Length];
             for (int i = 0; i < parameters.Length; i++)
             {
@@ -825,6 +899,7 @@ namespace ScubaDiver
                     {
                         // Pin and mark for unpinning later
                         addr = _freezer.Pin(parameter);
+                        pinned?.Add(addr);
                     }
 
                     remoteParams[i] = ObjectOrRemoteAddress.FromToken(addr, parameter.GetType().FullName);
@@ -847,15 +922,19 @@ namespace ScubaDiver
                 {
                     // Pin and mark for unpinning later
                     addr = _freezer.Pin(retValue);
+                    pinned?.Add(addr);
                 }
                 remoteRetVal = ObjectOrRemoteAddress.FromToken(addr, retValue.GetType().FullName);
             }
 
-
-            // Call callback at controller
-            var response = reverseCommunicator.InvokeHookCallback(token, stackTrace, Thread.CurrentThread.ManagedThreadId, remoteRetVal, remoteParams);
-
-            return response;
+            return new CallbackInvocationRequest()
+            {
+                StackTrace = stackTrace,
+                Token = token,
+                ThreadID = threadId,
+                RetValue = remoteRetVal,
+                Parameters = remoteParams.ToList()
+            };
         }
 
         /// <summary>
@@ -950,6 +1029,10 @@ namespace ScubaDiver
             try
             {
                 (object instance, ulong pinnedAddress) = GetObject(objAddr, pinningRequested, typeName, hashCodeFallback ? userHashcode : null);
+                if (pinningRequested)
+                {
+                    LeasePin(pinnedAddress);
+                }
                 ObjectDump od = ObjectDumpFactory.Create(instance, objAddr, pinnedAddress);
                 return JsonConvert.SerializeObject(od);
             }
@@ -993,12 +1076,19 @@ namespace ScubaDiver
                 // No parameters.
             }
 
+            // Note that for 'null' arguments we don't know the type so we use a "Wild Card" type
+            Type[] argumentTypes = paramsList.Select(p => p?.GetType() ?? new WildCardType()).ToArray();
+            ReflectionInvokersCache.CachedConstructor ctor = _invokers.GetConstructor(t, argumentTypes);
+
             object createdObject;
             try
             {
                 object[] paramsArray = paramsList.ToArray();
                 HarmonyWrapper.Instance.AllowFrameworkThreadToTrigger(Thread.CurrentThread.ManagedThreadId);
-                createdObject = Activator.CreateInstance(t, paramsArray);
+                // No single matching constructor (e.g. structs without arguments) is left for the Activator to figure out
+                createdObject = ctor != null
+                    ? ctor.Invoke(paramsArray)
+                    : Activator.CreateInstance(t, paramsArray);
             }
             catch
             {
@@ -1026,7 +1116,7 @@ namespace ScubaDiver
             else
             {
                 // Pinning results
-                pinAddr = _freezer.Pin(createdObject);
+                pinAddr = PinForClient(createdObject);
                 res = ObjectOrRemoteAddress.FromToken(pinAddr, createdObject.GetType().FullName);
             }
 
@@ -1138,12 +1228,13 @@ namespace ScubaDiver
             Type[] genericArgumentTypes = request.GenericArgsTypeFullNames.Select(typeFullName => _unifiedAppDomain.ResolveType(typeFullName)).ToArray();
 
             // Search the method with the matching signature
-            var method = dumpedObjType.GetMethodRecursive(request.MethodName, genericArgumentTypes, argumentTypes);
-            if (method == null)
+            ReflectionInvokersCache.CachedMethod cachedMethod = _invokers.GetMethod(dumpedObjType, request.MethodName, genericArgumentTypes, argumentTypes);
+            if (cachedMethod == null)
             {
                 Logger.Debug($"[DotNetDiver] Failed to Resolved method {request.MethodName} in type {dumpedObjType.Name} :/");
                 return QuickError("Couldn't find method in type.");
             }
+            MethodInfo method = cachedMethod.Method;
 
             string argsSummary = string.Join(", ", argumentTypes.Select(arg => arg.Name));
 
@@ -1154,7 +1245,7 @@ namespace ScubaDiver
                 if (string.IsNullOrEmpty(argsSummary))
                     argsSummary = "No Arguments";
                 HarmonyWrapper.Instance.AllowFrameworkThreadToTrigger(Thread.CurrentThread.ManagedThreadId);
-                results = method.Invoke(instance, paramsList.ToArray());
+                results = cachedMethod.Invoke(instance, paramsList.ToArray());
             }
             catch (Exception e)
             {
@@ -1194,7 +1285,7 @@ namespace ScubaDiver
                     else
                     {
                         // Pinning results
-                        ulong resultsAddress = _freezer.Pin(results);
+                        ulong resultsAddress = PinForClient(results);
                         Type resultsType = results.GetType();
                         returnValue = ObjectOrRemoteAddress.FromToken(resultsAddress, resultsType.Name);
                     }
@@ -1237,13 +1328,17 @@ namespace ScubaDiver
                 {
                     dumpedObjType = _unifiedAppDomain.ResolveType(request.TypeFullName);
                 }
-                FieldInfo staticFieldInfo = dumpedObjType.GetField(request.FieldName);
-                if (!staticFieldInfo.IsStatic)
+                ReflectionInvokersCache.CachedField staticField = _invokers.GetField(dumpedObjType, request.FieldName);
+                if (staticField == null)
+                {
+                    return QuickError("Couldn't find field in type.");
+                }
+                if (!staticField.Field.IsStatic)
                 {
                     return QuickError("Trying to get field with a null target bu the field was not a static one");
                 }
 
-                results = staticFieldInfo.GetValue(null);
+                results = staticField.GetValue(null);
             }
             else
             {
@@ -1260,19 +1355,19 @@ namespace ScubaDiver
                 }
 
                 // Search the method with the matching signature
-                var fieldInfo = dumpedObjType.GetFieldRecursive(request.FieldName);
-                if (fieldInfo == null)
+                ReflectionInvokersCache.CachedField field = _invokers.GetField(dumpedObjType, request.FieldName);
+                if (field == null)
                 {
                     Debugger.Launch();
                     Logger.Debug($"[DotNetDiver] Failed to Resolved field :/");
                     return QuickError("Couldn't find field in type.");
                 }
 
-                Logger.Debug($"[DotNetDiver] Resolved field: {fieldInfo.Name}, Containing Type: {fieldInfo.DeclaringType}");
+                Logger.Debug($"[DotNetDiver] Resolved field: {field.Field.Name}, Containing Type: {field.Field.DeclaringType}");
 
                 try
                 {
-                    results = fieldInfo.GetValue(instance);
+                    results = field.GetValue(instance);
                 }
                 catch (Exception e)
                 {
@@ -1292,7 +1387,7 @@ namespace ScubaDiver
                 else
                 {
                     // Pinning results
-                    ulong resultsAddress = _freezer.Pin(results);
+                    ulong resultsAddress = PinForClient(results);
                     Type resultsType = results.GetType();
                     returnValue = ObjectOrRemoteAddress.FromToken(resultsAddress, resultsType.Name);
                 }
@@ -1374,23 +1469,23 @@ namespace ScubaDiver
             }
 
             // Search the method with the matching signature
-            var fieldInfo = dumpedObjType.GetFieldRecursive(request.FieldName);
-            if (fieldInfo == null)
+            ReflectionInvokersCache.CachedField field = _invokers.GetField(dumpedObjType, request.FieldName);
+            if (field == null)
             {
                 Debugger.Launch();
                 Logger.Debug($"[DotNetDiver] Failed to Resolved field :/");
                 return QuickError("Couldn't find field in type.");
             }
-            Logger.Debug($"[DotNetDiver] Resolved field: {fieldInfo.Name}, Containing Type: {fieldInfo.DeclaringType}");
+            Logger.Debug($"[DotNetDiver] Resolved field: {field.Field.Name}, Containing Type: {field.Field.DeclaringType}");
 
             object results = null;
             try
             {
                 object value = ParseParameterObject(request.Value);
-                fieldInfo.SetValue(instance, value);
+                field.SetValue(instance, value);
                 // Reading back value to return to caller. This is expected C# behaviour:
                 // int x = this.field_y = 3; // Makes both x and field_y equal 3.
-                results = fieldInfo.GetValue(instance);
+                results = field.GetValue(instance);
             }
             catch (Exception e)
             {
@@ -1409,7 +1504,7 @@ namespace ScubaDiver
                 else
                 {
                     // Pinning results
-                    ulong resultsAddress = _freezer.Pin(results);
+                    ulong resultsAddress = PinForClient(results);
                     Type resultsType = results.GetType();
                     returnValue = ObjectOrRemoteAddress.FromToken(resultsAddress, resultsType.Name);
                 }
@@ -1514,13 +1609,9 @@ namespace ScubaDiver
             }
             else
             {
-                // Non-primitive results must be pinned before returning their remote address
-                // TODO: If a RemoteObject is not created for this object later and the item is not automaticlly unfreezed it might leak.
-                if (!_freezer.TryGetPinningAddress(item, out ulong addr))
-                {
-                    // Item not pinned yet, let's do it.
-                    addr = _freezer.Pin(item);
-                }
+                // Non-primitive results must be pinned before returning their remote address.
+                // If a RemoteObject is never created for it, the pin goes away with the client's lease.
+                ulong addr = PinForClient(item);
 
                 res = ObjectOrRemoteAddress.FromToken(addr, item.GetType().FullName);
             }
@@ -1535,8 +1626,174 @@ namespace ScubaDiver
 
             return JsonConvert.SerializeObject(invokeRes);
         }
+        protected override string MakeArrayItemsResponse(ScubaDiverMessage arg)
+        {
+            string body = arg.Body;
+            if (string.IsNullOrEmpty(body))
+                return QuickError("Missing body");
+            ItemsRangeRequest request = JsonConvert.DeserializeObject<ItemsRangeRequest>(body);
+            if (request == null)
+                return QuickError("Failed to deserialize body");
+
+            if (request.CloseCursor)
+            {
+                if (request.Cursor != 0)
+                    _itemCursors.Close(request.Cursor);
+                if (request.UnusedItems != null)
+                    ReleaseUnusedPins(request.UnusedItems);
+                return "{\"status\":\"OK\"}";
+            }
+            if (request.Start < 0 || request.Count < 0)
+                return QuickError("Start and count can't be negative");
+
+            List<object> items = new();
+            ItemsRange range = new();
+            if (request.Enumerate)
+            {
+                long cursor = request.Cursor;
+                if (cursor == 0)
+                {
+                    if (!_freezer.TryGetPinnedObject(request.CollectionAddress, out object pinnedObj))
+                        return QuickError("Object at given address wasn't pinned");
+                    if (pinnedObj is not IEnumerable enumerable)
+                        return QuickError("Object isn't an IEnumerable");
+                    cursor = _itemCursors.Open(enumerable.GetEnumerator());
+                }
+                if (!_itemCursors.TryRead(cursor, request.Count, items, out bool done))
+                    return QuickError("Cursor wasn't found. It might have expired or been closed.");
+                range.Cursor = done ? 0 : cursor;
+                range.Done = done;
+            }
+            else
+            {
+                if (!_freezer.TryGetPinnedObject(request.CollectionAddress, out object pinnedObj))
+                    return QuickError("Object at given address wasn't pinned");
+
+                // Only collections with random access are sliced. Others would have to be enumerated from the start for every slice.
+                if (pinnedObj is Array asArray && asArray.Rank == 1)
+                {
+                    range.TotalCount = asArray.Length;
+                    for (int i = request.Start; i < asArray.Length && items.Count < request.Count; i++)
+                        items.Add(asArray.GetValue(i));
+                }
+                else if (pinnedObj is IList asList)
+                {
+                    range.TotalCount = asList.Count;
+                    for (int i = request.Start; i < range.TotalCount && items.Count < request.Count; i++)
+                        items.Add(asList[i]);
+                }
+                else
+                {
+                    return QuickError("Only single-dimensional arrays and ILists can be sliced. Enumerate other collections.");
+                }
+                range.Done = request.Start + items.Count >= range.TotalCount;
+            }
+
+            // Non-primitive items are pinned together so each bucket of the freezer is only re-frozen once
+            List<object> toPin = new();
+            List<int> toPinIndices = new();
+            for (int i = 0; i < items.Count; i++)
+            {
+                object item = items[i];
+                if (item == null)
+                {
+                    range.Items.Add(ObjectOrRemoteAddress.Null);
+                }
+                else if (item.GetType().IsPrimitiveEtc())
+                {
+                    range.Items.Add(ObjectOrRemoteAddress.FromObj(item));
+                }
+                else
+                {
+                    range.Items.Add(null);
+                    toPin.Add(item);
+                    toPinIndices.Add(i);
+                }
+            }
+            ulong[] pinnedAddresses = _freezer.PinMany(toPin);
+            for (int i = 0; i < pinnedAddresses.Length; i++)
+            {
+                // Items the client never uses are handed back when it closes the enumeration (ItemsRangeRequest.UnusedItems)
+                LeasePin(pinnedAddresses[i]);
+                range.Items[toPinIndices[i]] = ObjectOrRemoteAddress.FromToken(pinnedAddresses[i], toPin[i].GetType().FullName);
+            }
+
+            return JsonConvert.SerializeObject(range);
+        }
+
+        protected override string MakePinResponse(ScubaDiverMessage arg)
+        {
+            string body = arg.Body;
+            if (string.IsNullOrEmpty(body))
+            {
+                return QuickError("Missing body");
+            }
+            PinRequest request = JsonConvert.DeserializeObject<PinRequest>(body);
+            if (request?.Objects == null)
+            {
+                return QuickError("Failed to deserialize body");
+            }
+            Logger.Debug($"[DotNetDiver] Got /pin request for {request.Objects.Count} objects");
+
+            // Unpinned objects are looked up in the heap, a single refresh serves all of them
+            if (request.Objects.Any(target => !_freezer.TryGetPinnedObject(target.Address, out _)))
+            {
+                RefreshRuntime();
+            }
+
+            PinResults results = new();
+            List<object> toPin = new();
+            List<PinResults.PinResult> pinnedResults = new();
+            foreach (PinRequest.PinTarget target in request.Objects)
+            {
+                PinResults.PinResult result = new() { Address = target.Address };
+                results.Objects.Add(result);
+                try
+                {
+                    if (!_freezer.TryGetPinnedObject(target.Address, out object instance))
+                    {
+                        instance = GetUnpinnedObjectFromLastRuntime(target.Address, target.TypeFullName);
+                    }
+                    toPin.Add(instance);
+                    pinnedResults.Add(result);
+                }
+                catch (Exception e)
+                {
+                    result.Error = e.Message;
+                }
+            }
+
+            // All objects are pinned together so each bucket of the freezer is only re-frozen once
+            ulong[] pinnedAddresses = _freezer.PinMany(toPin);
+            for (int i = 0; i < pinnedAddresses.Length; i++)
+            {
+                pinnedResults[i].PinnedAddress = pinnedAddresses[i];
+                LeasePin(pinnedAddresses[i]);
+            }
+
+            return JsonConvert.SerializeObject(results);
+        }
+
         protected override string MakeUnpinResponse(ScubaDiverMessage arg)
         {
+            // Bulk unpinning
+            if (!string.IsNullOrEmpty(arg.Body))
+            {
+                UnpinRequest request = JsonConvert.DeserializeObject<UnpinRequest>(arg.Body);
+                if (request?.Addresses == null)
+                {
+                    return QuickError("Failed to deserialize body");
+                }
+                Logger.Debug($"[DotNetDiver] Got /unpin request for {request.Addresses.Count} objects");
+
+                UnpinResults results = new() { NotPinned = _freezer.UnpinMany(request.Addresses) };
+                foreach (ulong address in request.Addresses)
+                {
+                    _pinLeases.Forget(address);
+                }
+                return JsonConvert.SerializeObject(results);
+            }
+
             string objAddrStr = arg.QueryString.Get("address");
             if (objAddrStr == null || !ulong.TryParse(objAddrStr, out var objAddr))
             {
@@ -1548,6 +1805,7 @@ namespace ScubaDiver
             {
                 // Found pinned object!
                 _freezer.Unpin(objAddr);
+                _pinLeases.Forget(objAddr);
                 return "{\"status\":\"OK\"}";
             }
             else
@@ -1557,6 +1815,115 @@ namespace ScubaDiver
             }
         }
 
+        /// <summary>
+        /// Pins an object, or gets its existing pinning address, on behalf of the client of the current request
+        /// </summary>
+        private ulong PinForClient(object o)
+        {
+            ulong addr = _freezer.Pin(o);
+            LeasePin(addr);
+            return addr;
+        }
+
+        protected override void UnpinLeasedAddresses(List<ulong> pinnedAddresses) => _freezer.UnpinMany(pinnedAddresses);
+
+        protected string MakeGcStatsResponse(ScubaDiverMessage req)
+        {
+            // Objects pinned since the last snapshot must be in it to be measured. Pinned objects don't move after that.
+            RefreshRuntime();
+
+            Dictionary<string, object> output = new Dictionary<string, object>();
+            output["CollectionCounts"] = ClrHeapIndex.GetCollectionCounts();
+            output["TotalMemory"] = GC.GetTotalMemory(false);
+            output["Pins"] = GetPinsStats(address =>
+            {
+                lock (_clrMdLock)
+                {
+                    return _runtime.Heap.GetObject(address).Size;
+                }
+            });
+            return JsonConvert.SerializeObject(output);
+        }
+
+        protected override string MakeObjectsSnapshotResponse(ScubaDiverMessage arg)
+        {
+            string body = arg.Body;
+            if (string.IsNullOrEmpty(body))
+            {
+                return QuickError("Missing body");
+            }
+            ObjectsSnapshotRequest request = JsonConvert.DeserializeObject<ObjectsSnapshotRequest>(body);
+            if (request?.Objects == null)
+            {
+                return QuickError("Failed to deserialize body");
+            }
+            Logger.Debug($"[DotNetDiver] Got /objects_snapshot request for {request.Objects.Count} objects");
+
+            // Every GC, of any generation, counts as a gen 0 collection.
+            // Taken before reading so a GC happening midway shows up as a new epoch on the next snapshot.
+            ObjectsSnapshot snapshot = new() { GcEpoch = GC.CollectionCount(0) };
+
+            // Unpinned objects are looked up in the heap, a single refresh serves all of them
+            if (request.Objects.Any(target => !_freezer.TryGetPinnedObject(target.Address, out _)))
+            {
+                RefreshRuntime();
+            }
+
+            foreach (ObjectsSnapshotRequest.SnapshotTarget target in request.Objects)
+            {
+                try
+                {
+                    if (!_freezer.TryGetPinnedObject(target.Address, out object instance))
+                    {
+                        instance = GetUnpinnedObjectFromLastRuntime(target.Address, target.TypeFullName);
+                    }
+                    snapshot.Objects.Add(ObjectDumpFactory.CreateSnapshot(instance, target.Address));
+                }
+                catch (Exception e)
+                {
+                    snapshot.Objects.Add(new ObjectsSnapshot.ObjectSnapshot()
+                    {
+                        Address = target.Address,
+                        Type = target.TypeFullName,
+                        Error = e.Message
+                    });
+                }
+            }
+
+            return JsonConvert.SerializeObject(snapshot);
+        }
+
+        /// <summary>
+        /// Like <see cref="GetObject"/> without refreshing the runtime or falling back to hash codes.
+        /// </summary>
+        private object GetUnpinnedObjectFromLastRuntime(ulong objAddr, string typeName)
+        {
+            ClrObject clrObj;
+            lock (_clrMdLock)
+            {
+                clrObj = _runtime.Heap.GetObject(objAddr);
+            }
+            if (clrObj.Type == null || clrObj.Type.Name != typeName)
+            {
+                throw new Exception("Object moved since last refresh. 'address' now points at an invalid address.");
+            }
+
+            object instance;
+            try
+            {
+                instance = _converter.ConvertFromIntPtr(clrObj.Address, clrObj.Type.MethodTable);
+            }
+            catch (ArgumentException)
+            {
+                throw new Exception("Method Table value mismatched");
+            }
+            if (instance.GetType().FullName != typeName)
+            {
+                throw new Exception("A GC collection occurred between checking the CLR MD and the object retrieval.");
+            }
+            return instance;
+        }
+
         protected override string MakeRegisterCustomFunctionResponse(ScubaDiverMessage arg)
         {
             // Custom function registration is not supported for managed (.NET) targets
@@ -1573,6 +1940,7 @@ namespace ScubaDiver
         public override void Dispose()
         {
             base.Dispose();
+            AppDomain.CurrentDomain.AssemblyLoad -= OnAssemblyLoad;
 
             Logger.Debug("[DotNetDiver] Stopping Callback Endpoints Monitor");
             _monitorEndpoints = false;
@@ -20,6 +20,13 @@ public static class DetoursMethodGenerator
         public TypeInfo DeclaringClass { get; set; }
         public List<HarmonyWrapper.HookCallback> PreHooks { get; set; }
         public List<HarmonyWrapper.HookCallback> PostHooks { get; set; }
+        /// <summary>
+        /// Run after the post hooks, and also when the original function throws
+        /// </summary>
+        public List<HarmonyWrapper.HookCallback> FinalizerHooks { get; set; }
+
+        public IEnumerable<HarmonyWrapper.HookCallback> AllHooks => PreHooks.Concat(PostHooks).Concat(FinalizerHooks);
+        public bool HasHooks => PreHooks.Count > 0 || PostHooks.Count > 0 || FinalizerHooks.Count > 0;
 
         public UndecoratedFunction Target { get; set; }
         public MethodInfo GenerateMethodInfo { get; set; }
@@ -39,6 +46,7 @@ public static class DetoursMethodGenerator
             Name = name;
             PreHooks = new List<HarmonyWrapper.HookCallback>();
             PostHooks = new List<HarmonyWrapper.HookCallback>();
+            FinalizerHooks = new List<HarmonyWrapper.HookCallback>();
         }
 
         public T GetRealMethod<T>() where T : Delegate
@@ -65,7 +73,7 @@ public static class DetoursMethodGenerator
         if (!TryGetMethod(generatedMethodName, out var detouredFuncInfo))
             return;
 
-        if (detouredFuncInfo.PreHooks.Count > 0 || detouredFuncInfo.PostHooks.Count > 0)
+        if (detouredFuncInfo.HasHooks)
             throw new Exception(
                 $"DetouredFuncInfo to remove still had one or more hooks. Func Name: {detouredFuncInfo.Name} Class: {detouredFuncInfo.DeclaringClass}");
 
@@ -203,20 +211,32 @@ public static class DetoursMethodGenerator
             }
         }
 
-        // Call prefix hook
         object tempRetValue = 0;
-        bool skipOriginal = RunPatchInPosition(HarmonyPatchPosition.Prefix, tramp, castedArgs, ref tempRetValue);
-        if (!skipOriginal)
+        try
         {
-            tempRetValue = 0;
+            // Call prefix hook
+            bool skipOriginal = RunPatchInPosition(HarmonyPatchPosition.Prefix, tramp, castedArgs, ref tempRetValue);
+            if (!skipOriginal)
+            {
+                tempRetValue = 0;
 
-            // Call original method
-            Delegate realMethod = DelegateStore.Real[tramp.GenerateMethodInfo];
-            tempRetValue = realMethod.DynamicInvoke(args);
-        }
+                // Call original method
+                Delegate realMethod = DelegateStore.Real[tramp.GenerateMethodInfo];
+                tempRetValue = realMethod.DynamicInvoke(args);
+            }
 
-        // Call postfix hook
-        RunPatchInPosition(HarmonyPatchPosition.Postfix, tramp, castedArgs, ref tempRetValue);
+            // Call postfix hook
+            RunPatchInPosition(HarmonyPatchPosition.Postfix, tramp, castedArgs, ref tempRetValue);
+        }
+        finally
+        {
+            // Call finalizer hooks, even if the original threw
+            if (tramp.FinalizerHooks.Count > 0)
+            {
+                object finalizerRetValue = tempRetValue;
+                RunPatchInPosition(HarmonyPatchPosition.Finalizer, tramp, castedArgs, ref finalizerRetValue);
+            }
+        }
 
         nuint finalRetVal = 0;
         if (tempRetValue is nuint nuintVal2)
@@ -318,6 +338,12 @@ public static class DetoursMethodGenerator
                 };
             }
         }
+        else if (position == HarmonyPatchPosition.Finalizer)
+        {
+            // Finalizers only observe the call, the return value is already decided
+            foreach (HarmonyWrapper.HookCallback finalizerHook in hookedFunc.FinalizerHooks)
+                finalizerHook.Invoke(self, argsToForward, ref newRetVal);
+        }
         else
         {
             throw new Exception($"Unexpected hook position fired. Pos: {position} , Method: {hookedFunc.Name}");
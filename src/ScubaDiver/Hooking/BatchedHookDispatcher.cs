@@ -0,0 +1,256 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Net;
+using System.Threading;
+using ScubaDiver.API;
+using ScubaDiver.API.Interactions.Callbacks;
+
+namespace ScubaDiver.Hooking
+{
+    /// <summary>
+    /// Delivers invocations of hooks in <see cref="ScubaDiver.API.Hooking.HookDeliveryMode.Batched"/> mode.
+    /// Hooked threads only enqueue the invocation's objects to the hook's ring. A single background thread drains the rings,
+    /// encodes the invocations (pinning objects as needed) and sends them to the clients in batches.
+    /// </summary>
+    /// <remarks>
+    /// Objects pinned for a delivered batch are leased to the client which placed the hook. For clients which didn't identify
+    /// themselves the hook holds them until it's removed. Pins of batches which failed to deliver are released right away.
+    /// Released objects stay pinned while another hook or a client still holds them.
+    /// </remarks>
+    public class BatchedHookDispatcher : IDisposable
+    {
+        public const int DefaultCapacity = 4096;
+        public const int MaxBatchSize = 256;
+        private static readonly TimeSpan FlushInterval = TimeSpan.FromMilliseconds(20);
+
+        /// <summary>
+        /// An invocation as seen by the hooked thread. Its objects are kept alive by the ring, not pinned.
+        /// </summary>
+        public class PendingInvocation
+        {
+            public int ThreadId;
+            public object RetValue;
+            public object[] Parameters;
+        }
+
+        /// <summary>
+        /// Encodes a pending invocation. Addresses pinned while encoding it are added to <paramref name="pinned"/>.
+        /// </summary>
+        public delegate CallbackInvocationRequest InvocationEncoder(int token, PendingInvocation invocation, List<ulong> pinned);
+
+        private class Subscription
+        {
+            public int Token;
+            public int? ClientId;
+            public ReverseCommunicator Communicator;
+            public HookInvocationRing<PendingInvocation> Ring;
+            // Pins of delivered invocations, when there's no client to lease them to. Guarded by the subscription.
+            public readonly List<ulong> HeldPins = new();
+            public bool Removed;
+        }
+
+        private readonly ConcurrentDictionary<int, Subscription> _subscriptions = new();
+        private readonly InvocationEncoder _encode;
+        private readonly Action<int, ulong> _leasePin;
+        private readonly Action<List<ulong>> _unpin;
+        private readonly ManualResetEvent _stop = new(false);
+        private readonly object _threadLock = new();
+        private Thread _thread;
+
+        /// <param name="leasePin">Makes a client a holder of a pinned address</param>
+        /// <param name="unpin">Unpins addresses pinned by <paramref name="encode"/> which no client holds</param>
+        public BatchedHookDispatcher(InvocationEncoder encode, Action<int, ulong> leasePin, Action<List<ulong>> unpin)
+        {
+            _encode = encode;
+            _leasePin = leasePin;
+            _unpin = unpin;
+        }
+
+        /// <param name="clientId">Client which placed the hook, if it identified itself</param>
+        public void Register(int token, IPEndPoint endpoint, int capacity, int? clientId)
+        {
+            _subscriptions[token] = new Subscription()
+            {
+                Token = token,
+                ClientId = clientId,
+                Communicator = new ReverseCommunicator(endpoint),
+                Ring = new HookInvocationRing<PendingInvocation>(capacity > 0 ? capacity : DefaultCapacity)
+            };
+
+            lock (_threadLock)
+            {
+                if (_thread != null)
+                    return;
+                _thread = new Thread(DeliveryLoop)
+                {
+                    IsBackground = true,
+                    Name = "Batched Hooks Delivery"
+                };
+                _thread.Start();
+            }
+        }
+
+        /// <summary>
+        /// Stops delivering the hook's invocations and unpins the objects it held
+        /// </summary>
+        public void Unregister(int token)
+        {
+            if (!_subscriptions.TryRemove(token, out Subscription subscription))
+                return;
+
+            List<ulong> held;
+            lock (subscription)
+            {
+                subscription.Removed = true;
+                held = new List<ulong>(subscription.HeldPins);
+                subscription.HeldPins.Clear();
+            }
+            ReleasePins(held);
+        }
+
+        /// <summary>
+        /// Called from the hooked thread. Never blocks and never pins.
+        /// </summary>
+        /// <returns>False if the invocation was dropped</returns>
+        public bool TryEnqueue(int token, PendingInvocation invocation)
+        {
+            if (!_subscriptions.TryGetValue(token, out Subscription subscription))
+                return false;
+            return subscription.Ring.TryEnqueue(invocation);
+        }
+
+        private void DeliveryLoop()
+        {
+            // Sending the batches runs framework code (sockets, JSON). Hooks should not trigger on this thread.
+            HarmonyWrapper.Instance.RegisterFrameworkThread(Thread.CurrentThread.ManagedThreadId);
+            try
+            {
+                List<PendingInvocation> drained = new();
+                while (!_stop.WaitOne(FlushInterval))
+                {
+                    foreach (Subscription subscription in _subscriptions.Values)
+                    {
+                        Flush(subscription, drained);
+                    }
+                }
+            }
+            finally
+            {
+                HarmonyWrapper.Instance.UnregisterFrameworkThread(Thread.CurrentThread.ManagedThreadId);
+            }
+        }
+
+        private void Flush(Subscription subscription, List<PendingInvocation> drained)
+        {
+            while (true)
+            {
+                drained.Clear();
+                if (subscription.Ring.DrainTo(drained, MaxBatchSize) == 0)
+                    return;
+
+                List<ulong> pinned = new();
+                List<CallbackInvocationRequest> invocations = new(drained.Count);
+                foreach (PendingInvocation pending in drained)
+                {
+                    try
+                    {
+                        invocations.Add(_encode(subscription.Token, pending, pinned));
+                    }
+                    catch (Exception ex)
+                    {
+                        Logger.Debug($"[BatchedHookDispatcher] Failed to encode invocation of token {subscription.Token}. Exception: {ex.Message}");
+                        subscription.Ring.AddDropped(1);
+                    }
+                }
+                // Not keeping the objects alive any longer than needed
+                drained.Clear();
+                if (invocations.Count == 0)
+                    continue;
+
+                CallbackInvocationBatch batch = new()
+                {
+                    Token = subscription.Token,
+                    Invocations = invocations
+                };
+                // Read last so the count includes drops which happened while draining
+                batch.DroppedCount = subscription.Ring.DroppedCount;
+
+                bool delivered;
+                try
+                {
+                    delivered = subscription.Communicator.InvokeHookCallbacksBatch(batch);
+                }
+                catch (Exception ex)
+                {
+                    Logger.Debug($"[BatchedHookDispatcher] Failed to deliver batch of token {subscription.Token}. Exception: {ex.Message}");
+                    delivered = false;
+                }
+
+                if (!delivered)
+                {
+                    // Not retrying. A dead client is cleaned up by the endpoints monitor.
+                    // The client never saw these objects, so nobody will unpin them.
+                    subscription.Ring.AddDropped(batch.Invocations.Count);
+                    ReleasePins(pinned);
+                    return;
+                }
+                KeepPins(subscription, pinned);
+            }
+        }
+
+        private void KeepPins(Subscription subscription, List<ulong> pinned)
+        {
+            if (pinned.Count == 0)
+                return;
+
+            if (subscription.ClientId.HasValue)
+            {
+                foreach (ulong address in pinned)
+                    _leasePin(subscription.ClientId.Value, address);
+                return;
+            }
+
+            lock (subscription)
+            {
+                if (!subscription.Removed)
+                {
+                    subscription.HeldPins.AddRange(pinned);
+                    return;
+                }
+            }
+            // Unhooked while this batch was on its way
+            ReleasePins(pinned);
+        }
+
+        /// <summary>
+        /// Releases pins the dispatcher took. The same object may have been delivered by another hook since,
+        /// so addresses other hooks still hold are skipped. Client leases are checked by <see cref="_unpin"/>.
+        /// </summary>
+        private void ReleasePins(List<ulong> pinned)
+        {
+            if (pinned.Count == 0)
+                return;
+
+            HashSet<ulong> toRelease = new(pinned);
+            foreach (Subscription other in _subscriptions.Values)
+            {
+                lock (other)
+                {
+                    toRelease.ExceptWith(other.HeldPins);
+                }
+            }
+            if (toRelease.Count > 0)
+                _unpin(new List<ulong>(toRelease));
+        }
+
+        public void Dispose()
+        {
+            _stop.Set();
+            lock (_threadLock)
+            {
+                _thread?.Join(TimeSpan.FromMilliseconds(200));
+            }
+        }
+    }
+}
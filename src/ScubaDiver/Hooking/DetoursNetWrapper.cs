@@ -1,6 +1,9 @@
 using System;
 using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Linq;
 using System.Reflection;
+using System.Runtime.InteropServices;
 using DetoursNet;
 using ScubaDiver.API.Hooking;
 using TypeInfo = ScubaDiver.Rtti.TypeInfo;
@@ -14,6 +17,30 @@ public class DetoursNetWrapper
 
     private ConcurrentDictionary<UndecoratedFunction, MethodInfo> _methodsToGenMethods = new ConcurrentDictionary<UndecoratedFunction, MethodInfo>();
 
+    /// <summary>
+    /// Native `this` filter stub placed between a detoured function and its generated method.
+    /// Calls on instances no hook is interested in jump straight to the original function, never entering managed code.
+    /// </summary>
+    private class ThisFilterStub
+    {
+        public IntPtr Entry { get; set; }
+        /// <summary>
+        /// Info of the function's current detour, or null while the function isn't hooked
+        /// </summary>
+        public DetoursMethodGenerator.DetouredFuncInfo Tramp { get; set; }
+        /// <summary>
+        /// Instance filter the stub's addresses were last computed with
+        /// </summary>
+        public Func<HarmonyWrapper.HookCallback, ulong[]> GetInstanceFilter { get; set; }
+    }
+
+    /// <summary>
+    /// Stubs are never freed (a hooked thread might be running one), so there's one per function,
+    /// reused whenever the function is hooked again.
+    /// </summary>
+    private ConcurrentDictionary<UndecoratedFunction, ThisFilterStub> _thisFilterStubs = new ConcurrentDictionary<UndecoratedFunction, ThisFilterStub>();
+    private readonly object _thisFiltersLock = new object();
+
     public bool AddHook(TypeInfo typeInfo, UndecoratedFunction methodToHook, HarmonyWrapper.HookCallback realCallback, HarmonyPatchPosition hookPosition)
     {
         if (methodToHook.NumArgs == null)
@@ -32,6 +59,8 @@ public class DetoursNetWrapper
                 tramp.PostHooks.Add(realCallback);
                 break;
             case HarmonyPatchPosition.Finalizer:
+                tramp.FinalizerHooks.Add(realCallback);
+                break;
             default:
                 throw new ArgumentOutOfRangeException(nameof(hookPosition), hookPosition, null);
         }
@@ -45,8 +74,14 @@ public class DetoursNetWrapper
             }
 
             // Method was already hooked and with the rgith Generated Method Info
-            // We just updated the pre/post properties
-            // So nothing else to do here!
+            // We just updated the pre/post properties, so only the `this` filter needs to learn about the new hook
+            if (_thisFilterStubs.TryGetValue(methodToHook, out ThisFilterStub existingStub))
+            {
+                lock (_thisFiltersLock)
+                {
+                    UpdateStubFilter(existingStub);
+                }
+            }
             return true;
         }
 
@@ -54,24 +89,112 @@ public class DetoursNetWrapper
         // Keep memo aside about it
         _methodsToGenMethods[methodToHook] = tramp.GenerateMethodInfo;
 
+        // Detour into the `this` filter stub, if possible, which forwards to the generated method.
+        ThisFilterStub stub = TryGetThisFilterStub(methodToHook, tramp);
+        Delegate detour = stub != null
+            ? Marshal.GetDelegateForFunctionPointer(stub.Entry, tramp.DelegateType)
+            : tramp.GeneratedDelegate;
 
         // First, try to hook with module name + export name (won't work for internal methods)
         bool success = Loader.HookMethod(typeInfo.ModuleName, methodToHook.DecoratedName,
             tramp.DelegateType,
             tramp.GenerateMethodInfo,
-            tramp.GeneratedDelegate);
-        if (success)
-            return true;
+            detour);
+        if (!success)
+        {
+            // Fallback, Try directly with pointers
+            Console.WriteLine($"[DetoursNetWrapper] Hooking with LoadLibrary + GetProcAddress failed, trying direct pointers. Target: {methodToHook.Module.Name}!{methodToHook.UndecoratedFullName}");
+            IntPtr module = new IntPtr((long)methodToHook.Module.BaseAddress);
+            IntPtr targetFunc = new IntPtr((long)methodToHook.Address);
+            success = Loader.HookMethod(module, targetFunc, tramp.DelegateType, tramp.GenerateMethodInfo, detour);
+        }
 
-        // Fallback, Try directly with pointers
-        Console.WriteLine($"[DetoursNetWrapper] Hooking with LoadLibrary + GetProcAddress failed, trying direct pointers. Target: {methodToHook.Module.Name}!{methodToHook.UndecoratedFullName}");
-        IntPtr module = new IntPtr((long)methodToHook.Module.BaseAddress);
-        IntPtr targetFunc = new IntPtr((long)methodToHook.Address);
-        success = Loader.HookMethod(module, targetFunc, tramp.DelegateType, tramp.GenerateMethodInfo, tramp.GeneratedDelegate);
+        if (stub != null && success)
+        {
+            // Only now is there an original to send misses to. Until the hooks' instances are set, the stub lets everything through.
+            IntPtr original = Marshal.GetFunctionPointerForDelegate(DelegateStore.GetReal(tramp.GenerateMethodInfo));
+            MsvcOffensiveGcHelper.SetThisFilterMissTarget(stub.Entry, original);
+            lock (_thisFiltersLock)
+            {
+                stub.Tramp = tramp;
+                stub.GetInstanceFilter = null;
+            }
+        }
 
         return success;
     }
 
+    private ThisFilterStub TryGetThisFilterStub(UndecoratedFunction methodToHook, DetoursMethodGenerator.DetouredFuncInfo tramp)
+    {
+        // Static functions have no `this` to filter by
+        if (methodToHook is UndecoratedExportedFunc { IsStatic: true })
+            return null;
+
+        IntPtr onHit = Marshal.GetFunctionPointerForDelegate(tramp.GeneratedDelegate);
+        if (_thisFilterStubs.TryGetValue(methodToHook, out ThisFilterStub existing))
+        {
+            // Hooked before. Its stub is still around, so point it at the new generated method.
+            MsvcOffensiveGcHelper.ReuseThisFilterStub(existing.Entry, onHit);
+            return existing;
+        }
+
+        IntPtr entry = MsvcOffensiveGcHelper.TryCreateThisFilterStub(onHit);
+        if (entry == IntPtr.Zero)
+            return null;
+        ThisFilterStub stub = new ThisFilterStub { Entry = entry };
+        _thisFilterStubs[methodToHook] = stub;
+        return stub;
+    }
+
+    /// <summary>
+    /// Updates the `this` filters of the functions hooked with <paramref name="callback"/>.
+    /// A function's filter lets through the union of the instances of all of its hooks.
+    /// </summary>
+    /// <param name="callback">A hook callback whose instances changed</param>
+    /// <param name="getInstanceFilter">Gets the instances a hook callback is interested in, or null for all of them</param>
+    public void RefreshInstanceFilter(HarmonyWrapper.HookCallback callback, Func<HarmonyWrapper.HookCallback, ulong[]> getInstanceFilter)
+    {
+        lock (_thisFiltersLock)
+        {
+            foreach (ThisFilterStub stub in _thisFilterStubs.Values)
+            {
+                DetoursMethodGenerator.DetouredFuncInfo tramp = stub.Tramp;
+                if (tramp == null || !tramp.AllHooks.Contains(callback))
+                    continue;
+
+                stub.GetInstanceFilter = getInstanceFilter;
+                UpdateStubFilter(stub);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Sets a stub's addresses to the union of the instances of its function's hooks.
+    /// Stubs whose filter was never refreshed stay in pass-all mode.
+    /// </summary>
+    private static void UpdateStubFilter(ThisFilterStub stub)
+    {
+        DetoursMethodGenerator.DetouredFuncInfo tramp = stub.Tramp;
+        if (tramp == null || stub.GetInstanceFilter == null)
+            return;
+
+        HashSet<ulong> addresses = new HashSet<ulong>();
+        bool passAll = false;
+        foreach (HarmonyWrapper.HookCallback hook in tramp.AllHooks)
+        {
+            ulong[] instances = stub.GetInstanceFilter(hook);
+            if (instances == null)
+            {
+                passAll = true;
+                break;
+            }
+            addresses.UnionWith(instances);
+        }
+
+        ulong[] filter = addresses.ToArray();
+        MsvcOffensiveGcHelper.SetThisFilterAddresses(stub.Entry, filter, filter.Length, passAll ? 1 : 0);
+    }
+
     public bool RemoveHook(UndecoratedFunction methodToUnhook, HarmonyWrapper.HookCallback callback)
     {
         IntPtr module = new IntPtr((long)methodToUnhook.Module.BaseAddress);
@@ -87,19 +210,40 @@ public class DetoursNetWrapper
 
         bool removed = funcInfo.PreHooks.Remove(callback);
         removed = removed || funcInfo.PostHooks.Remove(callback);
+        removed = removed || funcInfo.FinalizerHooks.Remove(callback);
         if (!removed)
         {
             throw new ArgumentException(
-                $"Trying to unhook a hook that doesn't match neither the pre nor post hooks. Func: {methodToUnhook.UndecoratedName}");
+                $"Trying to unhook a hook that doesn't match any of the pre, post or finalizer hooks. Func: {methodToUnhook.UndecoratedName}");
         }
 
+        _thisFilterStubs.TryGetValue(methodToUnhook, out ThisFilterStub stub);
+
         // Check if the hook is retired
-        if (funcInfo.PostHooks.Count == 0 && funcInfo.PreHooks.Count == 0)
+        if (!funcInfo.HasHooks)
         {
             DetoursMethodGenerator.Remove(key);
             _methodsToGenMethods.TryRemove(methodToUnhook, out _);
+            if (stub != null)
+            {
+                // The stub is kept for when the function is hooked again
+                lock (_thisFiltersLock)
+                {
+                    stub.Tramp = null;
+                    stub.GetInstanceFilter = null;
+                }
+            }
             return Loader.UnHookMethod(module, targetFunc, genMethodInfo);
         }
+
+        // The removed hook's instances (or its pass-all) no longer belong in the filter
+        if (stub != null)
+        {
+            lock (_thisFiltersLock)
+            {
+                UpdateStubFilter(stub);
+            }
+        }
         return true;
     }
 
@@ -63,6 +63,16 @@ namespace ScubaDiver.Hooking
         /// </summary>
         private static readonly ConcurrentDictionary<string, HookCallback> _actualHooks = new();
 
+        /// <summary>
+        /// Unique IDs of hooked methods, per <see cref="HarmonyPatchPosition"/>. Building them is too slow for every hooked call.
+        /// </summary>
+        private static readonly ConcurrentDictionary<MethodBase, string>[] _uniqueIdsCache =
+        {
+            new(), // Prefix
+            new(), // Postfix
+            new(), // Finalizer
+        };
+
         private HarmonyWrapper()
         {
             _harmony = new Harmony("xx.yy.zz");
@@ -128,8 +138,7 @@ namespace ScubaDiver.Hooking
             //
             // Save a side the patch callback to invoke when the target is called
             //
-            string argsStr = string.Join(";", target.GetParameters().Select(pi => pi.ParameterType.FullName));
-            string uniqueId = target.DeclaringType.FullName + ":" + argsStr + ":"+ target.Name + ":" + pos;
+            string uniqueId = GetUniqueId(target, pos);
             if (_actualHooks.ContainsKey(uniqueId))
             {
                 Logger.Debug($"Hook already exists under (not so) unique ID: {uniqueId}");
@@ -223,6 +232,8 @@ namespace ScubaDiver.Hooking
                 case HarmonyPatchPosition.Postfix:
                     return _unifiedPostfixHooks[functionSignatureSummary];
                 case HarmonyPatchPosition.Finalizer:
+                    // Finalizers don't get the arguments, one hook fits all signatures
+                    return typeof(HarmonyWrapper).GetMethod(nameof(UnifiedHook_Finalizer), (BindingFlags)0xffff);
                 default:
                     throw new ArgumentOutOfRangeException(nameof(pos), pos, null);
             }
@@ -253,21 +264,47 @@ namespace ScubaDiver.Hooking
 
         public void UnhookAnyHookPosition(MethodBase target)
         {
-            foreach (HarmonyPatchPosition pos in new[] { HarmonyPatchPosition.Prefix, HarmonyPatchPosition.Postfix })
+            foreach (HarmonyPatchPosition pos in new[] { HarmonyPatchPosition.Prefix, HarmonyPatchPosition.Postfix, HarmonyPatchPosition.Finalizer })
             {
-                string argsStr = string.Join(";", target.GetParameters().Select(pi => pi.ParameterType.FullName));
-                string uniqueId = target.DeclaringType.FullName + ":" + argsStr + ":" + target.Name + ":" + pos;
-                if (_singlePrefixHooks.TryGetValue(uniqueId, out MethodInfo spHook))
-                {
-                    _harmony.Unpatch(target, spHook);
-                }
+                RemoveHook(target, pos);
+            }
+        }
 
-                _singlePrefixHooks.Remove(uniqueId);
-                _actualHooks.TryRemove(uniqueId, out _);
+        /// <summary>
+        /// Removes the hook of a single position. Hooks in other positions of the same method keep working.
+        /// </summary>
+        public void RemoveHook(MethodBase target, HarmonyPatchPosition pos)
+        {
+            string uniqueId = GetUniqueId(target, pos);
+            if (_singlePrefixHooks.TryGetValue(uniqueId, out MethodInfo spHook))
+            {
+                _harmony.Unpatch(target, spHook);
+            }
+
+            _singlePrefixHooks.Remove(uniqueId);
+            _actualHooks.TryRemove(uniqueId, out _);
+
+            // The recursion guard is shared by all positions
+            bool hookedInOtherPosition = new[] { HarmonyPatchPosition.Prefix, HarmonyPatchPosition.Postfix, HarmonyPatchPosition.Finalizer }
+                .Any(otherPos => otherPos != pos && _actualHooks.ContainsKey(GetUniqueId(target, otherPos)));
+            if (!hookedInOtherPosition)
+            {
                 _locksDict.Remove(target);
             }
         }
 
+        private static string GetUniqueId(MethodBase target, HarmonyPatchPosition pos)
+        {
+            ConcurrentDictionary<MethodBase, string> cache = _uniqueIdsCache[(int)pos];
+            if (cache.TryGetValue(target, out string uniqueId))
+                return uniqueId;
+
+            string argsStr = string.Join(";", target.GetParameters().Select(pi => pi.ParameterType.FullName));
+            uniqueId = target.DeclaringType.FullName + ":" + argsStr + ":" + target.Name + ":" + pos;
+            cache[target] = uniqueId;
+            return uniqueId;
+        }
+
         private static bool SinglePrefixHookNoReturn(MethodBase __originalMethod, object __instance,
             params object[] args)
         {
@@ -293,6 +330,12 @@ namespace ScubaDiver.Hooking
             SingleHook(__originalMethod, HarmonyPatchPosition.Postfix, ref __result, __instance, args);
         }
 
+        private static void SingleFinalizerHook(MethodBase __originalMethod, object __instance)
+        {
+            object __result = null;
+            SingleHook(__originalMethod, HarmonyPatchPosition.Finalizer, ref __result, __instance);
+        }
+
         private static bool SingleHook(MethodBase __originalMethod, HarmonyPatchPosition pos, ref object __result, object __instance, params object[] args)
         {
             SmartLocksDict<MethodBase>.AcquireResults res = _locksDict.Acquire(__originalMethod);
@@ -308,8 +351,7 @@ namespace ScubaDiver.Hooking
 
             try
             {
-                string argsStr = string.Join(";", __originalMethod.GetParameters().Select(pi => pi.ParameterType.FullName));
-                string uniqueId = __originalMethod.DeclaringType.FullName + ":" + argsStr + ":" + __originalMethod.Name + ":" + pos;
+                string uniqueId = GetUniqueId(__originalMethod, pos);
                 if (_actualHooks.TryGetValue(uniqueId, out HookCallback funcHook))
                 {
                     // Return value will determine wether the original method will be called or not.
@@ -391,6 +433,9 @@ namespace ScubaDiver.Hooking
         private static void UnifiedHook_Postfix_1111111111(MethodBase __originalMethod, object __instance, object __0, object __1, object __2, object __3, object __4, object __5, object __6, object __7, object __8, object __9, ref object __result) => SinglePostfixHook(__originalMethod, ref __result, __instance, __0, __1, __2, __3, __4, __5, __6, __7, __8, __9);
         private static void UnifiedHook_Postfix_1111111111_NoReturn(MethodBase __originalMethod, object __instance, object __0, object __1, object __2, object __3, object __4, object __5, object __6, object __7, object __8, object __9) => SinglePostfixHookNoReturn(__originalMethod, __instance, __0, __1, __2, __3, __4, __5, __6, __7, __8, __9);
 
+        // Runs after the postfixes, and also when the original throws (which is rethrown after it)
+        private static void UnifiedHook_Finalizer(MethodBase __originalMethod, object __instance) => SingleFinalizerHook(__originalMethod, __instance);
+
 
 
         // ReSharper restore InconsistentNaming
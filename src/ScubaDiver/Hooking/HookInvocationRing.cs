@@ -0,0 +1,117 @@
+using System;
+using System.Collections.Generic;
+using System.Threading;
+
+namespace ScubaDiver.Hooking
+{
+    /// <summary>
+    /// Bounded lock-free queue of a batched hook's pending invocations.
+    /// Any number of hooked threads may enqueue concurrently, a single delivery thread dequeues.
+    /// When the ring is full new invocations are dropped (and counted) instead of blocking the hooked thread.
+    /// </summary>
+    /// <remarks>
+    /// Every cell carries a sequence number telling producers and the consumer whose turn it is to use it
+    /// (see Dmitry Vyukov's bounded MPMC queue), so the hot path is a single CAS on the enqueue position.
+    /// </remarks>
+    public class HookInvocationRing<T> where T : class
+    {
+        private struct Cell
+        {
+            public long Sequence;
+            public T Item;
+        }
+
+        private readonly Cell[] _cells;
+        private readonly long _mask;
+        private long _enqueuePosition;
+        private long _dequeuePosition;
+        private long _droppedCount;
+
+        public int Capacity => _cells.Length;
+        public long DroppedCount => Volatile.Read(ref _droppedCount);
+        public int Count => (int)Math.Max(0, Volatile.Read(ref _enqueuePosition) - Volatile.Read(ref _dequeuePosition));
+
+        /// <param name="capacity">Minimal capacity. Rounded up to a power of 2.</param>
+        public HookInvocationRing(int capacity)
+        {
+            if (capacity <= 0)
+                throw new ArgumentOutOfRangeException(nameof(capacity));
+
+            int size = 1;
+            while (size < capacity)
+                size <<= 1;
+
+            _cells = new Cell[size];
+            _mask = size - 1;
+            for (int i = 0; i < size; i++)
+                _cells[i].Sequence = i;
+        }
+
+        /// <returns>False if the ring was full and the item was dropped</returns>
+        public bool TryEnqueue(T item)
+        {
+            long position = Volatile.Read(ref _enqueuePosition);
+            while (true)
+            {
+                long index = position & _mask;
+                long sequence = Volatile.Read(ref _cells[index].Sequence);
+                long diff = sequence - position;
+                if (diff == 0)
+                {
+                    // The cell is free, try to claim it
+                    if (Interlocked.CompareExchange(ref _enqueuePosition, position + 1, position) == position)
+                    {
+                        _cells[index].Item = item;
+                        Volatile.Write(ref _cells[index].Sequence, position + 1);
+                        return true;
+                    }
+                    position = Volatile.Read(ref _enqueuePosition);
+                }
+                else if (diff < 0)
+                {
+                    // The consumer didn't free this cell yet - we're full
+                    Interlocked.Increment(ref _droppedCount);
+                    return false;
+                }
+                else
+                {
+                    // Another producer claimed this position
+                    position = Volatile.Read(ref _enqueuePosition);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Counts items which were dropped after leaving the ring (e.g., their delivery failed)
+        /// </summary>
+        public void AddDropped(long count) => Interlocked.Add(ref _droppedCount, count);
+
+        /// <summary>
+        /// Moves up to <paramref name="maxCount"/> items, in order, to <paramref name="output"/>.
+        /// Must only be called from a single thread at a time.
+        /// </summary>
+        /// <returns>Number of items moved</returns>
+        public int DrainTo(List<T> output, int maxCount)
+        {
+            int moved = 0;
+            while (moved < maxCount)
+            {
+                long position = _dequeuePosition;
+                long index = position & _mask;
+                long sequence = Volatile.Read(ref _cells[index].Sequence);
+                if (sequence != position + 1)
+                {
+                    // Empty, or a producer claimed the cell but didn't finish writing it yet
+                    break;
+                }
+
+                output.Add(_cells[index].Item);
+                _cells[index].Item = null;
+                Volatile.Write(ref _dequeuePosition, position + 1);
+                Volatile.Write(ref _cells[index].Sequence, position + _mask + 1);
+                moved++;
+            }
+            return moved;
+        }
+    }
+}
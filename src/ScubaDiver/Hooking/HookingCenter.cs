@@ -1,6 +1,7 @@
 using System;
 using System.Collections.Concurrent;
 using System.Collections.Generic;
+using System.Linq;
 using System.Reflection;
 
 namespace ScubaDiver.Hooking
@@ -22,6 +23,50 @@ namespace ScubaDiver.Hooking
             public int Token { get; set; }
         }
 
+        /// <summary>
+        /// Immutable snapshot of a hook's registrations, arranged for the hooked calls.
+        /// Rebuilt (copy-on-write) whenever a registration is added or removed.
+        /// </summary>
+        private class DispatchTable
+        {
+            public static readonly DispatchTable Empty = new(new HookRegistration[0], new Dictionary<ulong, HookRegistration[]>());
+
+            /// <summary>
+            /// Registrations for all instances
+            /// </summary>
+            public readonly HookRegistration[] Global;
+            /// <summary>
+            /// Instance address to the registrations of that specific instance. Never modified after construction.
+            /// </summary>
+            public readonly Dictionary<ulong, HookRegistration[]> ByInstance;
+            public readonly bool IsEmpty;
+
+            public DispatchTable(HookRegistration[] global, Dictionary<ulong, HookRegistration[]> byInstance)
+            {
+                Global = global;
+                ByInstance = byInstance;
+                IsEmpty = global.Length == 0 && byInstance.Count == 0;
+            }
+
+            public static DispatchTable Build(IEnumerable<HookRegistration> registrations)
+            {
+                List<HookRegistration> global = new();
+                Dictionary<ulong, List<HookRegistration>> byInstance = new();
+                foreach (HookRegistration registration in registrations.OrderBy(r => r.Token))
+                {
+                    if (registration.InstanceAddress == 0)
+                    {
+                        global.Add(registration);
+                        continue;
+                    }
+                    if (!byInstance.TryGetValue(registration.InstanceAddress, out List<HookRegistration> list))
+                        byInstance[registration.InstanceAddress] = list = new List<HookRegistration>();
+                    list.Add(registration);
+                }
+                return new DispatchTable(global.ToArray(), byInstance.ToDictionary(kvp => kvp.Key, kvp => kvp.Value.ToArray()));
+            }
+        }
+
         /// <summary>
         /// Information about a Harmony hook installation
         /// </summary>
@@ -29,6 +74,11 @@ namespace ScubaDiver.Hooking
         {
             public Action UnhookAction { get; set; }
             public ConcurrentDictionary<int, HookRegistration> Registrations { get; set; }
+            public HarmonyWrapper.HookCallback UnifiedCallback { get; set; }
+            /// <summary>
+            /// Read by the hooked calls without locking. Replaced (under the hook's lock) on every change of <see cref="Registrations"/>.
+            /// </summary>
+            public volatile DispatchTable Dispatch = DispatchTable.Empty;
         }
 
         /// <summary>
@@ -42,10 +92,22 @@ namespace ScubaDiver.Hooking
         /// </summary>
         private readonly ConcurrentDictionary<string, object> _hookLocks;
 
+        /// <summary>
+        /// Installed unified callbacks to the info of their hook
+        /// </summary>
+        private readonly ConcurrentDictionary<HarmonyWrapper.HookCallback, HarmonyHookInfo> _unifiedCallbacks;
+
+        /// <summary>
+        /// Raised (under the hook's lock) after the registrations of an installed unified callback changed.
+        /// Hookers that filter instances before the callback (see <see cref="GetInstanceFilter"/>) refresh their filters here.
+        /// </summary>
+        public event Action<HarmonyWrapper.HookCallback> DispatchChanged;
+
         public HookingCenter()
         {
             _harmonyHooks = new ConcurrentDictionary<string, HarmonyHookInfo>();
             _hookLocks = new ConcurrentDictionary<string, object>();
+            _unifiedCallbacks = new ConcurrentDictionary<HarmonyWrapper.HookCallback, HarmonyHookInfo>();
         }
 
         /// <summary>
@@ -79,18 +141,22 @@ namespace ScubaDiver.Hooking
                     OriginalCallback = callback,
                     Token = token
                 };
+                hookInfo.Dispatch = DispatchTable.Build(hookInfo.Registrations.Values);
                 
                 // Check if we need to install the Harmony hook
                 bool isFirstHook = hookInfo.Registrations.Count == 1;
                 if (isFirstHook)
                 {
                     // First hook for this method - install the actual Harmony hook
-                    HarmonyWrapper.HookCallback unifiedCallback = CreateUnifiedCallback(uniqueHookId, instanceResolver);
+                    HarmonyWrapper.HookCallback unifiedCallback = CreateUnifiedCallback(uniqueHookId, hookInfo, instanceResolver);
                     hookInfo.UnhookAction = hookInstaller(unifiedCallback);
-                    return true;
+                    hookInfo.UnifiedCallback = unifiedCallback;
+                    _unifiedCallbacks[unifiedCallback] = hookInfo;
                 }
-                
-                return false;
+
+                if (hookInfo.UnifiedCallback != null)
+                    DispatchChanged?.Invoke(hookInfo.UnifiedCallback);
+                return isFirstHook;
             }
         }
 
@@ -110,6 +176,8 @@ namespace ScubaDiver.Hooking
             lock (hookLock)
             {
                 bool removed = hookInfo.Registrations.TryRemove(token, out _);
+                if (removed)
+                    hookInfo.Dispatch = DispatchTable.Build(hookInfo.Registrations.Values);
                 
                 if (removed && hookInfo.Registrations.IsEmpty)
                 {
@@ -117,6 +185,12 @@ namespace ScubaDiver.Hooking
                     hookInfo.UnhookAction?.Invoke();
                     _harmonyHooks.TryRemove(uniqueHookId, out _);
                     _hookLocks.TryRemove(uniqueHookId, out _);
+                    if (hookInfo.UnifiedCallback != null)
+                        _unifiedCallbacks.TryRemove(hookInfo.UnifiedCallback, out _);
+                }
+                else if (removed && hookInfo.UnifiedCallback != null)
+                {
+                    DispatchChanged?.Invoke(hookInfo.UnifiedCallback);
                 }
                 
                 return removed;
@@ -125,54 +199,54 @@ namespace ScubaDiver.Hooking
 
         /// <summary>
         /// Creates a unified callback that dispatches to instance-specific callbacks.
-        /// This wraps the individual callbacks to filter by instance.
+        /// The callback holds the hook's info directly and only reads its current <see cref="DispatchTable"/>,
+        /// so a call costs the same no matter how many instances are registered. The instance is only resolved
+        /// if some registration is instance-specific.
         /// </summary>
         /// <param name="uniqueHookId">Unique identifier for the method hook</param>
+        /// <param name="hookInfo">Info of the hook whose registrations are dispatched</param>
         /// <param name="instanceResolver">Function to resolve an object to its address</param>
         /// <returns>A callback that handles instance filtering</returns>
-        private HarmonyWrapper.HookCallback CreateUnifiedCallback(string uniqueHookId, Func<object, ulong> instanceResolver)
+        private HarmonyWrapper.HookCallback CreateUnifiedCallback(string uniqueHookId, HarmonyHookInfo hookInfo, Func<object, ulong> instanceResolver)
         {
             return (object instance, object[] args, ref object retValue) =>
             {
-                if (!_harmonyHooks.TryGetValue(uniqueHookId, out HarmonyHookInfo hookInfo) || hookInfo.Registrations.IsEmpty)
+                DispatchTable dispatch = hookInfo.Dispatch;
+                if (dispatch.IsEmpty)
                 {
-                    // This should ideally not happen since we only create unified callbacks when hooks exist
-                    // If it does, it means hooks were removed between callback creation and invocation
-                    Logger.Debug($"[HookingCenter] Warning: Unified callback invoked for {uniqueHookId} but no registrations found");
+                    // Hooks were removed between callback creation and invocation
                     return true;
                 }
 
-                // Resolve the instance address
-                ulong instanceAddress = 0;
-                if (instance != null && instanceResolver != null)
+                // Invoke all matching callbacks. If any callback says skip original, we skip it.
+                bool callOriginal = true;
+                HookRegistration[] global = dispatch.Global;
+                for (int i = 0; i < global.Length; i++)
                 {
-                    try
-                    {
-                        instanceAddress = instanceResolver(instance);
-                    }
-                    catch (Exception ex)
-                    {
-                        // Log the exception for debugging but continue with address 0
-                        Logger.Debug($"[HookingCenter] Failed to resolve instance address for {uniqueHookId}: {ex.Message}");
-                        instanceAddress = 0;
-                    }
+                    callOriginal &= global[i].OriginalCallback(instance, args, ref retValue);
                 }
 
-                // Invoke all matching callbacks
-                bool callOriginal = true;
+                if (dispatch.ByInstance.Count == 0 || instance == null || instanceResolver == null)
+                    return callOriginal;
 
-                foreach (KeyValuePair<int, HookRegistration> kvp in hookInfo.Registrations)
+                // Resolve the instance address
+                ulong instanceAddress;
+                try
+                {
+                    instanceAddress = instanceResolver(instance);
+                }
+                catch (Exception ex)
                 {
-                    var registration = kvp.Value;
-                    // Check if this callback matches
-                    bool shouldInvoke = registration.InstanceAddress == 0 || // Global hook (all instances)
-                                       registration.InstanceAddress == instanceAddress; // Instance-specific match
+                    // Log the exception for debugging. No instance-specific callback can match.
+                    Logger.Debug($"[HookingCenter] Failed to resolve instance address for {uniqueHookId}: {ex.Message}");
+                    return callOriginal;
+                }
 
-                    if (shouldInvoke)
+                if (dispatch.ByInstance.TryGetValue(instanceAddress, out HookRegistration[] matches))
+                {
+                    for (int i = 0; i < matches.Length; i++)
                     {
-                        bool thisCallOriginal = registration.OriginalCallback(instance, args, ref retValue);
-                        // If any callback says skip original, we skip it
-                        callOriginal = callOriginal && thisCallOriginal;
+                        callOriginal &= matches[i].OriginalCallback(instance, args, ref retValue);
                     }
                 }
 
@@ -180,6 +254,22 @@ namespace ScubaDiver.Hooking
             };
         }
 
+        /// <summary>
+        /// Gets the instances a unified callback currently has registrations for.
+        /// Calls on any other instance would not invoke a single registered callback.
+        /// </summary>
+        /// <returns>The instances' addresses, or null if the callback is unknown or some registration is for all instances</returns>
+        public ulong[] GetInstanceFilter(HarmonyWrapper.HookCallback unifiedCallback)
+        {
+            if (!_unifiedCallbacks.TryGetValue(unifiedCallback, out HarmonyHookInfo hookInfo))
+                return null;
+
+            DispatchTable dispatch = hookInfo.Dispatch;
+            if (dispatch.Global.Length != 0)
+                return null;
+            return dispatch.ByInstance.Keys.ToArray();
+        }
+
         /// <summary>
         /// Checks if there are any hooks registered for a specific method
         /// </summary>
@@ -0,0 +1,131 @@
+using System;
+using System.Threading;
+
+namespace ScubaDiver.Hooking
+{
+    /// <summary>
+    /// HDR-style latency histogram with log-linear buckets: Every power of 2 range is split into 32 linear sub-buckets,
+    /// so any recorded value is reported with at most ~3% relative error while the whole range (1ns to ~18 minutes)
+    /// fits in a fixed array of ~1200 counters.
+    /// Recording is meant to be done by a single thread. Reading from other threads is allowed (counts might be slightly stale).
+    /// </summary>
+    public class LatencyHistogram
+    {
+        private const int SubBucketBits = 5;
+        private const int SubBucketHalfCount = 1 << SubBucketBits; // 32
+        private const int SubBucketCount = SubBucketHalfCount * 2; // 64
+        private const int MaxMagnitude = 40;
+        public const long MaxTrackableValue = (1L << MaxMagnitude) - 1;
+        private static readonly int BucketsCount = IndexOf(MaxTrackableValue) + 1;
+
+        private readonly long[] _counts = new long[BucketsCount];
+        private long _totalCount;
+        private long _sum;
+        private long _min = long.MaxValue;
+        private long _max;
+
+        public long TotalCount => Volatile.Read(ref _totalCount);
+        public long Sum => Volatile.Read(ref _sum);
+        public long Min => TotalCount == 0 ? 0 : Volatile.Read(ref _min);
+        public long Max => Volatile.Read(ref _max);
+        public double Mean => TotalCount == 0 ? 0 : (double)Sum / TotalCount;
+
+        public void Record(long value)
+        {
+            if (value < 0)
+                value = 0;
+            else if (value > MaxTrackableValue)
+                value = MaxTrackableValue;
+
+            _counts[IndexOf(value)]++;
+            _sum += value;
+            if (value < _min)
+                _min = value;
+            if (value > _max)
+                _max = value;
+            Volatile.Write(ref _totalCount, _totalCount + 1);
+        }
+
+        /// <summary>
+        /// Adds the counts of <paramref name="other"/> to this histogram
+        /// </summary>
+        public void Add(LatencyHistogram other)
+        {
+            long otherCount = other.TotalCount;
+            if (otherCount == 0)
+                return;
+
+            for (int i = 0; i < BucketsCount; i++)
+                _counts[i] += Volatile.Read(ref other._counts[i]);
+            _totalCount += otherCount;
+            _sum += other.Sum;
+            _min = Math.Min(_min, other.Min);
+            _max = Math.Max(_max, other.Max);
+        }
+
+        public void Reset()
+        {
+            Array.Clear(_counts, 0, _counts.Length);
+            _sum = 0;
+            _min = long.MaxValue;
+            _max = 0;
+            Volatile.Write(ref _totalCount, 0);
+        }
+
+        /// <param name="percentile">0 to 100</param>
+        /// <returns>A value (the middle of its bucket) which <paramref name="percentile"/>% of the recorded values are lower or equal to</returns>
+        public long GetValueAtPercentile(double percentile)
+        {
+            long total = 0;
+            for (int i = 0; i < BucketsCount; i++)
+                total += _counts[i];
+            if (total == 0)
+                return 0;
+
+            long countAtPercentile = Math.Max(1, (long)Math.Ceiling(Math.Min(percentile, 100) / 100 * total));
+            long seen = 0;
+            for (int i = 0; i < BucketsCount; i++)
+            {
+                seen += _counts[i];
+                if (seen >= countAtPercentile)
+                    return Math.Min(MiddleValueOf(i), Max);
+            }
+            return Max;
+        }
+
+        private static int IndexOf(long value)
+        {
+            if (value < SubBucketCount)
+                return (int)value;
+
+            // Keep the 6 most significant bits. The top one is always set so it's really 32 sub-buckets per power of 2.
+            int shift = Log2(value) - SubBucketBits;
+            int subBucket = (int)(value >> shift);
+            return SubBucketCount + (shift - 1) * SubBucketHalfCount + (subBucket - SubBucketHalfCount);
+        }
+
+        private static long MiddleValueOf(int index)
+        {
+            if (index < SubBucketCount)
+                return index;
+
+            int offset = index - SubBucketCount;
+            int shift = offset / SubBucketHalfCount + 1;
+            long subBucket = offset % SubBucketHalfCount + SubBucketHalfCount;
+            long lowest = subBucket << shift;
+            return lowest + (1L << shift) / 2;
+        }
+
+        private static int Log2(long value)
+        {
+            int log = 0;
+            if ((value >> 32) != 0) { value >>= 32; log += 32; }
+            if ((value >> 16) != 0) { value >>= 16; log += 16; }
+            if ((value >> 8) != 0) { value >>= 8; log += 8; }
+            if ((value >> 4) != 0) { value >>= 4; log += 4; }
+            if ((value >> 2) != 0) { value >>= 2; log += 2; }
+            if ((value >> 1) != 0) { log += 1; }
+            return log;
+        }
+    }
+}
@@ -0,0 +1,221 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Threading;
+using ScubaDiver.API.Interactions.Profiling;
+
+namespace ScubaDiver.Hooking
+{
+    /// <summary>
+    /// Aggregates calls of a single profiled method inside the target.
+    /// A prefix hook timestamps the call and a finalizer hook records its latency. Finalizers also run when the call throws,
+    /// so every timestamp is popped by its own call. Every thread records to its own
+    /// counters and histograms so the hooked threads never contend. Reports merge them on demand.
+    /// </summary>
+    public class MethodProfiler
+    {
+        // Bounds the memory of instance bucketing. Calls of any further instance are aggregated in the 'Other' bucket.
+        public const int MaxInstanceBuckets = 256;
+        public const ulong OtherInstancesBucket = ulong.MaxValue;
+        // Calls nested deeper than this aren't timed
+        private const int MaxCallDepth = 128;
+
+        private static readonly double NanosecondsPerTick = 1_000_000_000.0 / Stopwatch.Frequency;
+
+        private class ThreadState
+        {
+            public readonly int ThreadId = Thread.CurrentThread.ManagedThreadId;
+            public readonly long[] StartTimestamps = new long[MaxCallDepth];
+            public int Depth;
+            // Calls past MaxCallDepth that are still running. Their finalizers are skipped.
+            public int OverflowDepth;
+            public long Calls;
+            public long UntimedCalls;
+            // The profiler's generation this thread's counters belong to. Older counters were reset by a report.
+            public volatile int Generation;
+            // Only bucketing adds entries, under the lock, so reports can enumerate it safely
+            public readonly object BucketsLock = new();
+            public readonly Dictionary<ulong, LatencyHistogram> Buckets = new();
+            public readonly LatencyHistogram AllInstances = new();
+        }
+
+        // Not disposed when profiling stops: A hooked call might still be running the prefix/finalizer
+        private readonly ThreadLocal<ThreadState> _threads = new(() => new ThreadState(), trackAllValues: true);
+        private readonly Func<object, ulong> _instanceResolver;
+        private readonly long _startTimestamp = Stopwatch.GetTimestamp();
+        private volatile int _generation;
+
+        public int Token { get; }
+        public string TypeFullName { get; }
+        public string MethodName { get; }
+        public bool BucketByInstance { get; }
+
+        /// <summary>
+        /// Unique hook IDs (of the prefix and finalizer) registered in the <see cref="HookingCenter"/>
+        /// </summary>
+        public string PrefixHookId { get; set; }
+        public string FinalizerHookId { get; set; }
+
+        public MethodProfiler(int token, string typeFullName, string methodName, bool bucketByInstance, Func<object, ulong> instanceResolver)
+        {
+            Token = token;
+            TypeFullName = typeFullName;
+            MethodName = methodName;
+            BucketByInstance = bucketByInstance;
+            _instanceResolver = instanceResolver;
+        }
+
+        public bool Prefix(object instance, object[] args, ref object retValue)
+        {
+            ThreadState state = _threads.Value;
+            if (state.Depth == MaxCallDepth)
+            {
+                state.OverflowDepth++;
+                state.UntimedCalls++;
+                return true;
+            }
+            state.StartTimestamps[state.Depth++] = Stopwatch.GetTimestamp();
+            return true;
+        }
+
+        public bool Finalizer(object instance, object[] args, ref object retValue)
+        {
+            long now = Stopwatch.GetTimestamp();
+            ThreadState state = _threads.Value;
+            if (state.OverflowDepth != 0)
+            {
+                state.OverflowDepth--;
+                return true;
+            }
+            if (state.Depth == 0)
+            {
+                // Profiling started while this call was already running
+                return true;
+            }
+            long elapsedNs = (long)((now - state.StartTimestamps[--state.Depth]) * NanosecondsPerTick);
+
+            int generation = _generation;
+            if (state.Generation != generation)
+            {
+                ResetThread(state, generation);
+            }
+
+            state.Calls++;
+            if (BucketByInstance)
+            {
+                ulong address = ResolveInstance(instance);
+                if (!state.Buckets.TryGetValue(address, out LatencyHistogram histogram))
+                    histogram = AddBucket(state, address);
+                histogram.Record(elapsedNs);
+            }
+            else
+            {
+                state.AllInstances.Record(elapsedNs);
+            }
+            return true;
+        }
+
+        private static LatencyHistogram AddBucket(ThreadState state, ulong address)
+        {
+            if (state.Buckets.Count >= MaxInstanceBuckets)
+                address = OtherInstancesBucket;
+            lock (state.BucketsLock)
+            {
+                if (!state.Buckets.TryGetValue(address, out LatencyHistogram histogram))
+                    state.Buckets[address] = histogram = new LatencyHistogram();
+                return histogram;
+            }
+        }
+
+        private ulong ResolveInstance(object instance)
+        {
+            if (instance == null || _instanceResolver == null)
+                return 0;
+            try
+            {
+                return _instanceResolver(instance);
+            }
+            catch
+            {
+                return 0;
+            }
+        }
+
+        private static void ResetThread(ThreadState state, int generation)
+        {
+            state.Calls = 0;
+            state.UntimedCalls = 0;
+            state.AllInstances.Reset();
+            lock (state.BucketsLock)
+            {
+                state.Buckets.Clear();
+            }
+            // Only published once cleared, so reports never take the old counters for the new generation's
+            state.Generation = generation;
+        }
+
+        /// <param name="reset">Start counting from scratch after this report. Threads clear their counters on their next call,
+        /// until then later reports leave them out.</param>
+        public ProfileReport GetReport(bool reset)
+        {
+            ProfileReport report = new()
+            {
+                Token = Token,
+                TypeFullName = TypeFullName,
+                MethodName = MethodName,
+                ElapsedSeconds = (Stopwatch.GetTimestamp() - _startTimestamp) / (double)Stopwatch.Frequency
+            };
+
+            LatencyHistogram allInstances = new();
+            Dictionary<ulong, LatencyHistogram> merged = new();
+            int generation = _generation;
+            foreach (ThreadState state in _threads.Values)
+            {
+                // Not called since the last reset
+                if (state.Generation != generation)
+                    continue;
+
+                long calls = Volatile.Read(ref state.Calls);
+                if (calls != 0)
+                    report.CallsByThread[state.ThreadId] = calls;
+                report.UntimedCalls += Volatile.Read(ref state.UntimedCalls);
+
+                allInstances.Add(state.AllInstances);
+                lock (state.BucketsLock)
+                {
+                    foreach (KeyValuePair<ulong, LatencyHistogram> bucket in state.Buckets)
+                    {
+                        if (!merged.TryGetValue(bucket.Key, out LatencyHistogram histogram))
+                            merged[bucket.Key] = histogram = new LatencyHistogram();
+                        histogram.Add(bucket.Value);
+                        allInstances.Add(bucket.Value);
+                    }
+                }
+            }
+
+            if (reset)
+                Interlocked.Increment(ref _generation);
+
+            report.TotalCalls = allInstances.TotalCount;
+            report.AllInstances = ToBucket(0, allInstances);
+            report.Instances = merged.Select(kvp => ToBucket(kvp.Key, kvp.Value))
+                .OrderByDescending(bucket => bucket.Calls)
+                .ToList();
+            return report;
+        }
+
+        private static ProfileBucket ToBucket(ulong address, LatencyHistogram histogram) => new()
+        {
+            InstanceAddress = address,
+            Calls = histogram.TotalCount,
+            MeanNs = histogram.Mean,
+            MinNs = histogram.Min,
+            MaxNs = histogram.Max,
+            P50Ns = histogram.GetValueAtPercentile(50),
+            P90Ns = histogram.GetValueAtPercentile(90),
+            P99Ns = histogram.GetValueAtPercentile(99),
+            P999Ns = histogram.GetValueAtPercentile(99.9),
+        };
+    }
+}
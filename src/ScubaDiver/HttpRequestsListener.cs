@@ -28,9 +28,13 @@ public static class RnetRequestsListenerFactory
 
 public class RnetReverseRequestsListener : IRequestsListener
 {
+    // Lifeboat multiplexes all of its clients over a small pool of connections to us
+    public const int ConnectionsCount = 4;
+    private const int MaxInFlightRequestsPerConnection = 64;
+
     private readonly ManualResetEvent _bootstrapStayAlive = new(true);
     private int _port;
-    private TcpClient _bootstrapClient;
+    private TcpClient[] _bootstrapClients;
     private Task _bootstrapTask = null;
 
     public event EventHandler<ScubaDiverMessage> RequestReceived;
@@ -43,22 +47,30 @@ public class RnetReverseRequestsListener : IRequestsListener
     public void Start()
     {
         _bootstrapStayAlive.Set();
-        _bootstrapClient = new TcpClient();
         var ipe = new IPEndPoint(IPAddress.Parse("127.0.0.1"), _port);
-        _bootstrapClient.Connect(ipe);
-        _bootstrapTask = Task.Run(BootstrapDispatcher);
+        _bootstrapClients = new TcpClient[ConnectionsCount];
+        Task[] dispatchers = new Task[ConnectionsCount];
+        for (int i = 0; i < ConnectionsCount; i++)
+        {
+            TcpClient client = new TcpClient() { NoDelay = true };
+            client.Connect(ipe);
+            _bootstrapClients[i] = client;
+            dispatchers[i] = Task.Run(() => BootstrapDispatcher(client));
+        }
+        _bootstrapTask = Task.WhenAll(dispatchers);
     }
 
     public void Stop()
     {
-        _bootstrapClient.Close();
+        foreach (TcpClient client in _bootstrapClients ?? Array.Empty<TcpClient>())
+        {
+            client.Close();
+        }
         _bootstrapStayAlive.Reset();
     }
 
-    private void BootstrapDispatcher()
+    private async Task BootstrapDispatcher(TcpClient client)
     {
-        var client = _bootstrapClient;
-
         // Introduce ourselves to the proxy
         HttpRequestSummary intro =
             HttpRequestSummary.FromJson("/proxy_intro", new NameValueCollection(), "{\"role\":\"diver\"}");
@@ -71,34 +83,10 @@ public class RnetReverseRequestsListener : IRequestsListener
         string listeningUrl = $"http://127.0.0.1:{_port}/";
         Logger.Debug($"[RnetReverseRequestsListener] Connected. Proxy should be available at: {listeningUrl}");
 
-        Dispatcher(client);
-    }
-
-    private void Dispatcher(TcpClient client)
-    {
-        NetworkStream networkStream = client.GetStream();
-        while (_bootstrapStayAlive.WaitOne(TimeSpan.FromMilliseconds(100)) && client.Connected)
-        {
-            HttpRequestSummary request = SimpleHttpProtocolParser.ReadRequest(networkStream, CancellationToken.None);
-            if (request == null)
-                continue;
-
-            void RespondFunc(string body)
-            {
-                Dictionary<string, string> headers = new Dictionary<string, string>();
-                string requestId = request.QueryString.Get("requestId");
-                if (!string.IsNullOrWhiteSpace(requestId))
-                    headers["requestId"] = requestId;
-
-                var resp = HttpResponseSummary.FromJson(HttpStatusCode.OK, body, headers);
-                SimpleHttpProtocolParser.WriteResponse(networkStream, resp);
-            }
-
-            ScubaDiverMessage req =
-                new ScubaDiverMessage(request.QueryString, request.Url, request.BodyString, RespondFunc);
-
-            Task.Run(() => RequestReceived?.Invoke(this, req));
-        }
+        using RnetConnection connection = new RnetConnection(client, MaxInFlightRequestsPerConnection);
+        await connection.RunAsync(
+            () => _bootstrapStayAlive.WaitOne(0),
+            req => RequestReceived?.Invoke(this, req)).ConfigureAwait(false);
     }
 
     public void WaitForExit()
@@ -125,6 +113,8 @@ public class RnetReverseRequestsListener : IRequestsListener
 
 public class RnetRequestsListener : IRequestsListener
 {
+    private const int MaxInFlightRequestsPerConnection = 32;
+
     private readonly ManualResetEvent _stayAlive = new(true);
     private TcpListener _listener;
     private Task _task = null;
@@ -147,53 +137,46 @@ public class RnetRequestsListener : IRequestsListener
 
     public void Stop()
     {
-        _listener.Stop();
+        // Resetting first so the accept loop knows the listener's failure is intentional
         _stayAlive.Reset();
+        _listener.Stop();
     }
-    private void Dispatcher()
+
+    private async Task Dispatcher()
     {
-        // Using a timeout we can make sure not to block if the
-        // 'stayAlive' state changes to "reset" (which means we should die)
-        while (_stayAlive.WaitOne(TimeSpan.FromMilliseconds(100)))
+        while (_stayAlive.WaitOne(0))
         {
+            TcpClient client;
             try
             {
-                TcpClient client = _listener.AcceptTcpClient();
-                Task.Run(() => HandleTcpClient(client));
+                client = await _listener.AcceptTcpClientAsync().ConfigureAwait(false);
             }
             catch (SocketException)
             {
                 continue;
             }
+            catch (Exception ex) when (ex is ObjectDisposedException || ex is InvalidOperationException)
+            {
+                // Listener was stopped
+                break;
+            }
+
+            _ = HandleTcpClient(client);
         }
     }
 
-    private void HandleTcpClient(TcpClient client)
+    private async Task HandleTcpClient(TcpClient client)
     {
-        while (_stayAlive.WaitOne(TimeSpan.FromMilliseconds(100)) && client.Connected)
+        try
         {
-            var request = SimpleHttpProtocolParser.ReadRequest(client.GetStream(), CancellationToken.None);
-            if (request == null)
-            {
-                // Connection closed
-                return;
-            }
-
-            void RespondFunc(string body)
-            {
-                Dictionary<string, string> headers = new Dictionary<string, string>();
-                string requestId = request.QueryString.Get("requestId");
-                if (!string.IsNullOrWhiteSpace(requestId))
-                    headers["requestId"] = requestId;
-
-                var resp = HttpResponseSummary.FromJson(HttpStatusCode.OK, body, headers);
-                SimpleHttpProtocolParser.WriteResponse(client.GetStream(), resp);
-            }
-
-            ScubaDiverMessage req =
-                new ScubaDiverMessage(request.QueryString, request.Url, request.BodyString, RespondFunc);
-
-            Task.Run(() => RequestReceived?.Invoke(this, req));
+            using RnetConnection connection = new RnetConnection(client, MaxInFlightRequestsPerConnection);
+            await connection.RunAsync(
+                () => _stayAlive.WaitOne(0),
+                req => RequestReceived?.Invoke(this, req)).ConfigureAwait(false);
+        }
+        catch (Exception ex)
+        {
+            Logger.Debug($"[RnetRequestsListener] Connection handler faulted. Exception: {ex}");
         }
     }
 
@@ -347,20 +330,24 @@ public class HttpRequestsListener : IRequestsListener
             body = sr.ReadToEnd();
         }
 
-        Action<string> responseSender = body =>
+        void SendBuffer(byte[] buffer, string contentType)
         {
-            byte[] buffer = Encoding.UTF8.GetBytes(body);
             // Get a response stream and write the response to it.
             response.ContentLength64 = buffer.Length;
-            response.ContentType = "application/json";
+            response.ContentType = contentType;
             Stream output = response.OutputStream;
             output.Write(buffer, 0, buffer.Length);
             // You must close the output stream.
             output.Close();
-        };
+        }
+        Action<string> responseSender = body => SendBuffer(Encoding.UTF8.GetBytes(body), "application/json");
         Dictionary<string, string> dict = req.QueryString.AllKeys.ToDictionary(key => key, key => req.QueryString.Get(key));
 
-        return new ScubaDiverMessage(dict, req.Url.AbsolutePath, body, responseSender);
+        return new ScubaDiverMessage(dict, req.Url.AbsolutePath, body, responseSender)
+        {
+            BinaryResponseSender = buffer => SendBuffer(buffer, "application/octet-stream"),
+            TextResponseSender = text => SendBuffer(Encoding.UTF8.GetBytes(text), HttpResponseSummary.TextMimeType)
+        };
     }
 
     public void Dispose()
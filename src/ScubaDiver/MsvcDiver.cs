@@ -3,10 +3,12 @@ using ScubaDiver.API.Hooking;
 using ScubaDiver.API.Interactions;
 using ScubaDiver.API.Interactions.Callbacks;
 using ScubaDiver.API.Interactions.Dumps;
+using ScubaDiver.API.Interactions.Memory;
 using ScubaDiver.API.Utils;
 using ScubaDiver.Hooking;
 using ScubaDiver.Rtti;
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Diagnostics;
 using System.IO;
@@ -23,12 +25,31 @@ namespace ScubaDiver
         private MsvcTypesManager _typesManager = null;
         private MsvcOffensiveGC _offensiveGC = null;
         private MsvcFrozenItemsCollection _freezer = null;
+        private ModuleAnalysisPipeline<ModuleHookPlan> _moduleAnalysis = null;
+        private readonly NativeCallStubCache _nativeInvokers = new();
+        // Serialized /type responses. Cleared whenever the modules are scanned again, which is how new modules are picked up.
+        private readonly TypeDumpCache _typeDumps = new();
+
+        protected override int CachedTypesCount => _typeDumps.Count;
 
         public MsvcDiver(IRequestsListener listener) : base(listener)
         {
             _responseBodyCreators["/gc"] = MakeGcHookModuleResponse;
             _responseBodyCreators["/gc_stats"] = MakeGcStatsResponse;
+            _responseBodyCreators["/gc_status"] = MakeGcStatusResponse;
+            _responseBodyCreators["/references_to"] = MakeReferencesToResponse;
+            _responseBodyCreators["/snapshot"] = MakeSnapshotResponse;
+            _responseBodyCreators["/walk"] = MakeWalkResponse;
+            // Hooking a module's allocation functions means analyzing all of its types first
+            _bulkEndpoints.Add("/gc");
+            _bulkEndpoints.Add("/references_to");
+            _bulkEndpoints.Add("/snapshot");
+            _bulkEndpoints.Add("/walk");
             _typesManager = new MsvcTypesManager();
+            _typesManager.ModulesScanned += _typeDumps.Invalidate;
+            // Detoured functions filter `this` natively, so calls on instances no hook is interested in skip managed code
+            _hookingCenter.DispatchChanged += unifiedCallback =>
+                DetoursNetWrapper.Instance.RefreshInstanceFilter(unifiedCallback, _hookingCenter.GetInstanceFilter);
         }
 
         public override void Start()
@@ -55,33 +76,110 @@ namespace ScubaDiver
             {
                 _offensiveGC = new MsvcOffensiveGC();
                 _freezer = new MsvcFrozenItemsCollection(_offensiveGC);
+                _moduleAnalysis = new ModuleAnalysisPipeline<ModuleHookPlan>(
+                    _typesManager.LoadExports,
+                    moduleName => _typesManager.GetUndecoratedModules(name => name == moduleName).FirstOrDefault()
+                        ?? throw new Exception($"Module '{moduleName}' was not found"),
+                    _offensiveGC.Classify,
+                    // Leave some cores to the target
+                    Environment.ProcessorCount / 2);
+                _typesManager.Refreshed += EnqueueModuleAnalysis;
+            }
+
+            Dictionary<ModuleInfo, int> modulesTypesCount = _typesManager.GetModulesTypesCount();
+            List<string> moduleNames = modulesTypesCount.Keys.Select(module => module.Name).Where(name => moduleNameFilter(name)).Distinct().ToList();
+            if (moduleNames.Count == 0)
+            {
+                // Might be a new module, this refreshes the modules
+                moduleNames = _typesManager.GetUndecoratedModules(moduleNameFilter).Select(module => module.Name).ToList();
+                modulesTypesCount = _typesManager.GetModulesTypesCount();
             }
 
-            List<UndecoratedModule> undecoratedModules = _typesManager.GetUndecoratedModules(moduleNameFilter);
             try
             {
-                _offensiveGC.HookModules(undecoratedModules);
-                foreach (UndecoratedModule module in undecoratedModules)
+                // Only the raw exports are searched for 'free' functions, so other modules don't have to be undecorated first
+                Dictionary<string, Dictionary<ModuleInfo, NtApiDotNet.Win32.DllExport>> exportedFreeFuncs =
+                    MsvcOffensiveGC.FindExportedFreeFuncs(modulesTypesCount.Keys, _typesManager.ExportsMaster);
+                _moduleAnalysis.Hook(moduleNames, plan =>
                 {
-                    _offensiveGC.HookAllFreeFuncs(module, _typesManager.GetUndecoratedModules());
-                }
+                    _offensiveGC.Hook(plan);
+                    _offensiveGC.HookAllFreeFuncs(plan.Module, exportedFreeFuncs);
+                }, req.CancellationToken);
             }
-            catch (Exception e)
+            catch (Exception e) when (e is not OperationCanceledException)
             {
                 Logger.Debug($"[{nameof(MsvcDiver)}] {nameof(MakeGcHookModuleResponse)} Exception: " + e);
             }
 
+            // Analyze the rest in the background, so hooking them later is quick
+            EnqueueModuleAnalysis();
             return "{\"status\":\"ok\"}";
         }
+
+        /// <summary>
+        /// Queues all modules for background analysis. Modules with more types are more likely to be hooked, so they go first.
+        /// </summary>
+        private void EnqueueModuleAnalysis()
+        {
+            _moduleAnalysis.EnqueueBackground(_typesManager.GetModulesTypesCount()
+                .Select(kvp => (kvp.Key.Name, -kvp.Value)));
+        }
+
+        protected string MakeGcStatusResponse(ScubaDiverMessage req)
+        {
+            if (_moduleAnalysis == null)
+                return QuickError("The offensive GC isn't attached to any module. Use /gc first.");
+            return JsonConvert.SerializeObject(_moduleAnalysis.GetStatus());
+        }
         protected string MakeGcStatsResponse(ScubaDiverMessage req)
         {
+            IReadOnlyDictionary<string, nuint> classSizes = _offensiveGC.ClassSizes;
+            IReadOnlyDictionary<nuint, nuint> addressesSizes = _offensiveGC.AddressesSizes;
             Dictionary<string, object> output = new Dictionary<string, object>();
             output["ClassInstances"] = _offensiveGC.ClassInstances;
-            output["ClassSizes"] = _offensiveGC.ClassSizes;
-            output["AddressesSizes"] = _offensiveGC.AddressesSizes;
+            output["ClassSizes"] = classSizes;
+            output["AddressesSizes"] = addressesSizes;
+            output["Pins"] = GetPinsStats(address => GetPinnedObjectSize(address, addressesSizes, classSizes));
             return JsonConvert.SerializeObject(output);
         }
 
+        /// <summary>
+        /// Size of a pinned object by its allocation or, for allocations that are no longer tracked, by its type
+        /// </summary>
+        private ulong GetPinnedObjectSize(ulong objAddress, IReadOnlyDictionary<nuint, nuint> addressesSizes,
+            IReadOnlyDictionary<string, nuint> classSizes)
+        {
+            if (addressesSizes.TryGetValue((nuint)objAddress, out nuint allocationSize))
+                return allocationSize;
+
+            // Pinned objects aren't freed so their vftable can be read
+            nuint vftable = (nuint)Marshal.ReadIntPtr(new IntPtr((long)objAddress));
+            string typeName = _typesManager.GetType(vftable)?.TypeInfo.FullTypeName;
+            return GetKnownObjectSize(objAddress, typeName, addressesSizes, classSizes);
+        }
+
+        /// <summary>
+        /// Size of an object by its allocation or by its type, as seen by the offensive GC.
+        /// Otherwise, read from the heap's metadata. 0 if the object isn't a heap allocation.
+        /// </summary>
+        private static ulong GetKnownObjectSize(ulong objAddress, string typeName, IReadOnlyDictionary<nuint, nuint> addressesSizes,
+            IReadOnlyDictionary<string, nuint> classSizes)
+        {
+            if (addressesSizes.TryGetValue((nuint)objAddress, out nuint allocationSize))
+                return allocationSize;
+            if (typeName != null && classSizes.TryGetValue(typeName, out nuint classSize))
+                return classSize;
+            return MsvcOffensiveGC.QueryObjectSize(objAddress);
+        }
+
+        protected override void UnpinLeasedAddresses(List<ulong> pinnedAddresses)
+        {
+            foreach (ulong pinnedAddress in pinnedAddresses)
+            {
+                _freezer?.Unpin(pinnedAddress);
+            }
+        }
+
         private List<SafeHandle> _injectedDlls = new();
         private IEqualityComparer<string> TypesComparer = new ParameterNamesComparer();
 
@@ -213,7 +311,14 @@ namespace ScubaDiver
         protected override HookResponse InvokeHookCallback(IPEndPoint callbacksEndpoint, int token, string stackTrace, object retValue, params object[] parameters)
         {
             ReverseCommunicator reverseCommunicator = new(callbacksEndpoint);
+            CallbackInvocationRequest invocation = EncodeHookInvocation(token, stackTrace, Thread.CurrentThread.ManagedThreadId, retValue, parameters);
 
+            // Call callback at controller
+            return reverseCommunicator.InvokeHookCallback(invocation);
+        }
+
+        protected override CallbackInvocationRequest EncodeHookInvocation(int token, string stackTrace, int threadId, object retValue, object[] parameters, List<ulong> pinned = null)
+        {
             ObjectOrRemoteAddress[] remoteParams = new ObjectOrRemoteAddress[parameters.Length];
             for (int i = 0; i < parameters.Length; i++)
             {
@@ -272,11 +377,14 @@ namespace ScubaDiver
                 throw new Exception($"Unexpected non native argument to hooked method. Type: {retValue.GetType().FullName}");
             }
 
-
-            // Call callback at controller
-            HookResponse hookCallbackResults = reverseCommunicator.InvokeHookCallback(token, stackTrace, Thread.CurrentThread.ManagedThreadId, retValueOora, remoteParams);
-
-            return hookCallbackResults;
+            return new CallbackInvocationRequest()
+            {
+                StackTrace = stackTrace,
+                Token = token,
+                ThreadID = threadId,
+                RetValue = retValueOora,
+                Parameters = remoteParams.ToList()
+            };
         }
 
         public override object ResolveHookReturnValue(ObjectOrRemoteAddress oora)
@@ -298,7 +406,6 @@ namespace ScubaDiver
                 return QuickError("Missing parameter 'type_filter'. Try this: /types?type_filter=*");
             ParseFullTypeName(typeFilter, out var assemblyFilter, out typeFilter);
 
-            Predicate<string> typeFilterPredicate = Filter.CreatePredicate(typeFilter);
             Predicate<string> moduleFilterPredicate = Filter.CreatePredicate(assemblyFilter);
             MsvcModuleFilter msvcModuleFilter = new MsvcModuleFilter()
             {
@@ -306,7 +413,7 @@ namespace ScubaDiver
                 ImportingModule = importerModule
             };
 
-            IReadOnlyList<MsvcTypeStub> matchingTypes = _typesManager.GetTypes(msvcModuleFilter, typeFilterPredicate);
+            IReadOnlyList<MsvcTypeStub> matchingTypes = _typesManager.GetTypes(msvcModuleFilter, typeFilter, req.CancellationToken);
 
             List<TypesDump.TypeIdentifiers> types = new();
             foreach (MsvcTypeStub typeStub in matchingTypes)
@@ -370,20 +477,19 @@ namespace ScubaDiver
                 };
             }
 
-            TypeDump dump;
+            string json;
             if (request.MethodTableAddress != 0)
             {
-                dump = GetTypeDump((nuint)request.MethodTableAddress);
+                json = _typeDumps.GetOrCreate($"0x{request.MethodTableAddress:x}",
+                    () => GetTypeDump((nuint)request.MethodTableAddress), request.IfNoneMatch);
             }
             else
             {
-                dump = GetRttiType(request.TypeFullName, request.Assembly);
+                json = _typeDumps.GetOrCreate($"{request.Assembly}!{request.TypeFullName}",
+                    () => GetRttiType(request.TypeFullName, request.Assembly), request.IfNoneMatch);
             }
 
-            if (dump != null)
-                return JsonConvert.SerializeObject(dump);
-
-            return QuickError("Failed to find type in searched assemblies");
+            return json ?? QuickError("Failed to find type in searched assemblies");
         }
 
         private TypeDump GetTypeDump(nuint methodTableAddress)
@@ -397,8 +503,7 @@ namespace ScubaDiver
         private TypeDump GetTypeDump(string rawAssemblyFilter, string rawTypeFilter)
         {
             Predicate<string> moduleNameFilter = Filter.CreatePredicate(rawAssemblyFilter);
-            Predicate<string> typeFilter = Filter.CreatePredicate(rawTypeFilter);
-            MsvcType matchingType = _typesManager.GetType(moduleNameFilter, typeFilter)?.Upgrade();
+            MsvcType matchingType = _typesManager.GetType(moduleNameFilter, rawTypeFilter)?.Upgrade();
             if (matchingType == null)
                 return null;
             return TypeDumpFactory.ConvertMsvcTypeToTypeDump(matchingType);
@@ -430,17 +535,20 @@ namespace ScubaDiver
             string rawFilter = arg.QueryString.Get("type_filter");
             ParseFullTypeName(rawFilter, out var rawAssemblyFilter, out var rawTypeFilter);
 
-            Predicate<string> typeFilter = Filter.CreatePredicate(rawTypeFilter);
             Predicate<string> moduleNameFilter = Filter.CreatePredicate(rawAssemblyFilter);
-            IEnumerable<MsvcTypeStub> matchingType = _typesManager.GetTypes(moduleNameFilter, typeFilter);
+            IEnumerable<MsvcTypeStub> matchingType = _typesManager.GetTypes(moduleNameFilter, rawTypeFilter, arg.CancellationToken);
 
             //
             // Heap Search using Trickster
             //
             HeapDump output = new HeapDump();
             Logger.Debug($"[{DateTime.Now}] Starting Trickster Scan for class instances.");
-            Dictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> hits = _typesManager.Scan(matchingType);
+            Stopwatch scanSw = Stopwatch.StartNew();
+            Dictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> hits = _typesManager.Scan(matchingType, arg.CancellationToken);
+            _metrics.RecordScan("instances", scanSw.Elapsed);
             Logger.Debug($"[{DateTime.Now}] Trickster Scan finished with {hits.SelectMany(kvp => kvp.Value).Count()} results");
+            // Found instances are a chance to learn their classes' sizes
+            MsvcOffensiveGC.InferClassSizes(hits);
             foreach (var typeInstancesKvp in hits)
             {
                 FirstClassTypeInfo typeInfo = typeInstancesKvp.Key;
@@ -460,6 +568,7 @@ namespace ScubaDiver
             // Heap & Search using Offensive GC (if enabled)
             if (_offensiveGC != null)
             {
+                Predicate<string> typeFilter = Filter.CreatePredicate(rawTypeFilter);
                 foreach (var kvp in _offensiveGC.ClassInstances.Where(kvp => moduleNameFilter(kvp.Key)))
                 {
                     string module = kvp.Key;
@@ -482,6 +591,92 @@ namespace ScubaDiver
             return JsonConvert.SerializeObject(output);
         }
 
+        protected unsafe string MakeWalkResponse(ScubaDiverMessage arg)
+        {
+            if (string.IsNullOrEmpty(arg.Body))
+                return QuickError("Missing body");
+            WalkRequest request = JsonConvert.DeserializeObject<WalkRequest>(arg.Body);
+            if (request?.Roots == null)
+                return QuickError("Failed to deserialize body");
+            // Sizes the offensive GC didn't see are read from the heap
+            IReadOnlyDictionary<string, nuint> classSizes = _offensiveGC?.ClassSizes ?? new Dictionary<string, nuint>();
+            IReadOnlyDictionary<nuint, nuint> addressesSizes = _offensiveGC?.AddressesSizes ?? new Dictionary<nuint, nuint>();
+            HashSet<nuint> knownXoredVftables = _typesManager.GetKnownXoredVftables();
+            // Resolving a vftable's type isn't thread safe, and it's only done once per vftable
+            ConcurrentDictionary<nuint, string> vftablesTypes = new();
+            object resolveLock = new();
+            string Identify(ulong address)
+            {
+                nuint vftable;
+                if (!SafeMemoryReader.TryRead(address, (byte*)&vftable, sizeof(nuint)))
+                    return null;
+                if (!knownXoredVftables.Contains(vftable ^ FirstClassTypeInfo.XorMask))
+                    return null;
+                return vftablesTypes.GetOrAdd(vftable, knownVftable =>
+                {
+                    lock (resolveLock)
+                        return _typesManager.GetType(knownVftable)?.TypeInfo.FullTypeName;
+                });
+            }
+
+            List<Predicate<string>> typeFilters = request.TypeFilters?.Select(Filter.CreatePredicate).ToList() ?? new();
+            Predicate<string> typeFilter = typeFilters.Count == 0
+                ? _ => true
+                : typeName => typeFilters.Any(filter => filter(typeName));
+
+            ObjectGraphWalker walker = new ObjectGraphWalker(sizeof(nuint), SafeMemoryReader.TryRead, Identify,
+                (address, typeName) => GetKnownObjectSize(address, typeName, addressesSizes, classSizes));
+            ObjectGraphDump graph = walker.Walk(request.Roots, request.MaxDepth, typeFilter, request.MaxNodes, arg.CancellationToken);
+            Logger.Debug($"[{DateTime.Now}] Walk from {request.Roots.Count} roots found {graph.Nodes.Count} objects and {graph.Edges.Count} pointers");
+            return JsonConvert.SerializeObject(graph);
+        }
+
+        protected string MakeSnapshotResponse(ScubaDiverMessage arg)
+        {
+            string path = arg.QueryString.Get("path");
+            if (string.IsNullOrEmpty(path))
+                return QuickError("Missing parameter 'path'");
+
+            Logger.Debug($"[{DateTime.Now}] Starting memory snapshot to {path}");
+            MemorySnapshotResults results = _typesManager.WriteSnapshot(path, arg.CancellationToken);
+            Logger.Debug($"[{DateTime.Now}] Memory snapshot finished. {results.Regions} regions, {results.MemoryBytes} bytes compressed to {results.FileBytes} bytes");
+            return JsonConvert.SerializeObject(results);
+        }
+
+        protected string MakeReferencesToResponse(ScubaDiverMessage arg)
+        {
+            if (string.IsNullOrEmpty(arg.Body))
+                return QuickError("Missing body");
+            ReferencesToRequest request = JsonConvert.DeserializeObject<ReferencesToRequest>(arg.Body);
+            if (request?.XoredAddresses == null || request.Lengths == null)
+                return QuickError("Failed to deserialize body");
+            if (request.XoredAddresses.Length != request.Lengths.Length)
+                return QuickError("Every target requires a length");
+
+            Logger.Debug($"[{DateTime.Now}] Starting scan for references to {request.XoredAddresses.Length} targets.");
+            Stopwatch scanSw = Stopwatch.StartNew();
+            List<(ReferenceHit hit, MsvcTypeStub ownerType)> hits = _typesManager.ScanReferences(
+                request.XoredAddresses, request.Lengths, request.XorMask,
+                request.MaxOwnerDistance, request.MaxResults, out bool truncated, arg.CancellationToken);
+            _metrics.RecordScan("references", scanSw.Elapsed);
+            Logger.Debug($"[{DateTime.Now}] References scan finished with {hits.Count} results");
+
+            ReferencesDump output = new ReferencesDump() { Truncated = truncated };
+            foreach ((ReferenceHit hit, MsvcTypeStub ownerType) in hits)
+            {
+                output.References.Add(new ReferencesDump.Reference()
+                {
+                    Address = hit.Address,
+                    TargetIndex = hit.TargetIndex,
+                    RegionBase = hit.RegionBase,
+                    RegionSize = hit.RegionSize,
+                    OwnerAddress = ownerType != null ? hit.OwnerAddress : 0,
+                    OwnerType = ownerType?.TypeInfo.FullTypeName
+                });
+            }
+            return JsonConvert.SerializeObject(output);
+        }
+
         private static void ParseFullTypeName(string rawFilter, out string rawAssemblyFilter, out string rawTypeFilter)
         {
             rawAssemblyFilter = "*";
@@ -528,6 +723,10 @@ namespace ScubaDiver
                 // Check if the object is already frozen
                 if (_freezer.IsFrozen(objAddr))
                 {
+                    if (pinningRequested)
+                    {
+                        LeasePin(objAddr);
+                    }
                     ObjectDump alreadyFrozenObjDump = new ObjectDump()
                     {
                         Type = fullTypeName,
@@ -546,9 +745,8 @@ namespace ScubaDiver
                 {
                     // Search by name instead
                     ParseFullTypeName(fullTypeName, out string assemblyFilter, out string typeFilter);
-                    Predicate<string> typeFilterPredicate = Filter.CreatePredicate(typeFilter);
                     Predicate<string> moduleFilterPredicate = Filter.CreatePredicate(assemblyFilter);
-                    matchingType = _typesManager.GetType(moduleFilterPredicate, typeFilterPredicate)?.Upgrade();
+                    matchingType = _typesManager.GetType(moduleFilterPredicate, typeFilter)?.Upgrade();
                     if (matchingType == null)
                     {
                         throw new Exception("Failed to resolve RTTI type by neither name not vftable value.");
@@ -560,6 +758,7 @@ namespace ScubaDiver
                 if (pinningRequested)
                 {
                     pinningAddress = _freezer.Pin(objAddr);
+                    LeasePin(pinningAddress);
                 }
 
                 ObjectDump od = new ObjectDump()
@@ -690,8 +889,8 @@ namespace ScubaDiver
                 ? typeof(void)
                 : typeof(nuint);
             int floatsBitmap = NativeDelegatesFactory.GetFloatsBitmap(method.ArgTypes, p => p == "float" || p == "double");
-            var delegateType = NativeDelegatesFactory.GetDelegateType(retType, method.NumArgs.Value, floatsBitmap);
-            var methodPtr = Marshal.GetDelegateForFunctionPointer(new IntPtr((long)targetMethod.Address), delegateType);
+            NativeCallSignature signature = new((ulong)targetMethod.Address, CallingConvention.Winapi, method.NumArgs.Value, floatsBitmap, retType);
+            NativeCallStubCache.NativeInvoker invoker = _nativeInvokers.GetOrCreate(signature);
 
             //
             // Prepare parameters
@@ -744,7 +943,7 @@ namespace ScubaDiver
             double? resultsDouble = null;
             try
             {
-                object resultsObj = methodPtr.DynamicInvoke(invocationArgs);
+                object resultsObj = invoker(invocationArgs);
                 if (resultsObj is double)
                 {
                     resultsDouble = (double)resultsObj;
@@ -775,7 +974,7 @@ namespace ScubaDiver
                     ParseFullTypeName(normalizedRetType, out var retTypeAssemblyFilter, out var retTypeFilter);
                     Predicate<string> moduleNameFilter = Filter.CreatePredicate(retTypeAssemblyFilter);
                     Predicate<string> typeNameFilter = Filter.CreatePredicate(retTypeFilter);
-                    returnTypeDump = _typesManager.GetType(moduleNameFilter, typeNameFilter);
+                    returnTypeDump = _typesManager.GetType(moduleNameFilter, retTypeFilter);
                     if (returnTypeDump == null)
                     {
                         // Retry with "importing module filter" (Will only help if we found TOO MANY results, and not zero)
@@ -784,7 +983,7 @@ namespace ScubaDiver
                             NamePredicate = moduleNameFilter,
                             ImportingModule = msvcType.Module.Name
                         };
-                        returnTypeDump = _typesManager.GetType(moduleFilter, typeNameFilter);
+                        returnTypeDump = _typesManager.GetType(moduleFilter, retTypeFilter);
                         if (returnTypeDump == null)
                         {
                             // Maybe it's just our current type
@@ -887,11 +1086,26 @@ namespace ScubaDiver
             return QuickError("Not Implemented");
         }
 
+        protected override string MakeArrayItemsResponse(ScubaDiverMessage arg)
+        {
+            return QuickError("Not Implemented");
+        }
+
+        protected override string MakePinResponse(ScubaDiverMessage arg)
+        {
+            return QuickError("Not Implemented");
+        }
+
         protected override string MakeUnpinResponse(ScubaDiverMessage arg)
         {
             return QuickError("Not Implemented");
         }
 
+        protected override string MakeObjectsSnapshotResponse(ScubaDiverMessage arg)
+        {
+            return QuickError("Not Implemented");
+        }
+
         protected override string MakeRegisterCustomFunctionResponse(ScubaDiverMessage arg)
         {
             string body = arg.Body;
@@ -9,6 +9,7 @@ using ScubaDiver.Rtti;
 using System.Collections.Concurrent;
 using NtApiDotNet.Win32;
 using Windows.Win32;
+using System.Threading.Tasks;
 
 namespace ScubaDiver
 {
@@ -39,23 +40,25 @@ namespace ScubaDiver
 
     internal static class FreeFinder
     {
-        public static Dictionary<ModuleInfo, DllExport> Find(List<UndecoratedModule> modules, string name)
+        /// <summary>
+        /// Searches the raw export tables, so modules don't have to be undecorated just to find their 'free' functions
+        /// </summary>
+        public static Dictionary<ModuleInfo, DllExport> Find(IEnumerable<ModuleInfo> modules, IReadOnlyExportsMaster exportsMaster, string name)
         {
-            void ProcessSingleModule(UndecoratedModule module,
+            void ProcessSingleModule(ModuleInfo module,
                 Dictionary<ModuleInfo, DllExport> workingDict)
             {
-                if (!module.TryGetRegularTypelessFunc(name, out List<NtApiDotNet.Win32.DllExport> methodGroup))
+                DllExport firstPtr = exportsMaster.GetExports(module).FirstOrDefault(export => export.Name == name);
+                if (firstPtr == null)
                     return;
 
-                var firstPtr = methodGroup.Single();
-
-                workingDict[module.ModuleInfo] = firstPtr;
+                workingDict[module] = firstPtr;
                 // TODO: Am I missing matches if there are multiple exports called 'free'?
                 return;
             }
 
             Dictionary<ModuleInfo, DllExport> res = new();
-            foreach (UndecoratedModule module in modules)
+            foreach (ModuleInfo module in modules)
             {
                 ProcessSingleModule(module, res);
             }
@@ -63,6 +66,18 @@ namespace ScubaDiver
         }
     }
 
+    /// <summary>
+    /// Functions of a single module the offensive GC hooks. Finding them only reads the module, so plans of different modules can be made in parallel.
+    /// </summary>
+    internal class ModuleHookPlan
+    {
+        public UndecoratedModule Module { get; init; }
+        public Dictionary<TypeInfo, UndecoratedFunction> InitMethods { get; init; }
+        public Dictionary<TypeInfo, List<UndecoratedFunction>> Ctors { get; init; }
+        public Dictionary<TypeInfo, List<UndecoratedFunction>> Dtors { get; init; }
+        public Dictionary<string, List<UndecoratedFunction>> NewOperators { get; init; }
+    }
+
 
     internal class MsvcOffensiveGC
     {
@@ -119,33 +134,82 @@ namespace ScubaDiver
         {
             modules = modules.Where(m => !_alreadyHookedModules.Contains(m)).ToList();
 
-            Dictionary<TypeInfo, UndecoratedFunction> initMethods = GetAutoClassInit2Funcs(modules);
-            Dictionary<TypeInfo, List<UndecoratedFunction>> ctors = GetCtors(modules);
-            Dictionary<TypeInfo, List<UndecoratedFunction>> dtors = GetDtors(modules);
-            Dictionary<string, List<UndecoratedFunction>> newOperators = GetNewOperators(modules);
+            ModuleHookPlan[] plans = new ModuleHookPlan[modules.Count];
+            Parallel.For(0, modules.Count, i => plans[i] = Classify(modules[i]));
+            foreach (ModuleHookPlan plan in plans)
+            {
+                Hook(plan);
+            }
+        }
+
+        /// <summary>
+        /// Finds the module's __autoclassinit2 functions, ctors, dtors and 'operator new's. Doesn't hook anything.
+        /// </summary>
+        public ModuleHookPlan Classify(UndecoratedModule module)
+        {
+            return new ModuleHookPlan()
+            {
+                Module = module,
+                InitMethods = GetAutoClassInit2Funcs(module),
+                Ctors = GetCtors(module),
+                Dtors = GetDtors(module),
+                NewOperators = GetNewOperators(module)
+            };
+        }
+
+        /// <summary>
+        /// Hooks the functions found by <see cref="Classify"/>. Hooks are installed one module at a time.
+        /// </summary>
+        public void Hook(ModuleHookPlan plan)
+        {
+            if (_alreadyHookedModules.Contains(plan.Module))
+                return;
 
-            HookAutoClassInit2Funcs(initMethods);
-            HookCtors(ctors);
-            HookDtors(dtors);
-            HookNewOperators(newOperators);
+            HookAutoClassInit2Funcs(plan.InitMethods);
+            HookCtors(plan.Ctors);
+            HookDtors(plan.Dtors);
+            // Sizes are read from the heap when the helper can, so allocations don't have to be watched
+            if (!HeapSizesSupported)
+                HookNewOperators(plan.NewOperators);
 
-            _alreadyHookedModules.AddRange(modules);
+            _alreadyHookedModules.Add(plan.Module);
         }
 
-        public void HookAllFreeFuncs(UndecoratedModule targetUndecoratedModule, List<UndecoratedModule> allModules)
+        /// <summary>
+        /// Finds the exported 'free' functions of all modules, by name. Pass the result to <see cref="HookAllFreeFuncs"/>.
+        /// </summary>
+        public static Dictionary<string, Dictionary<ModuleInfo, DllExport>> FindExportedFreeFuncs(IEnumerable<ModuleInfo> allModules,
+            IReadOnlyExportsMaster exportsMaster)
         {
-            // Make sure our C++ Helper is loaded before accessing anything from the `MsvcOffensiveGcHelper` class
-            // otherwise the loading the P/Invoke methods will fail on "Failed to load DLL".
+            List<ModuleInfo> modules = allModules.ToList();
+            Dictionary<string, Dictionary<ModuleInfo, DllExport>> res = new();
+            foreach (string funcName in new[] { "free", "_free", "_free_dbg" })
             {
-                System.Reflection.Assembly assm = typeof(MsvcOffensiveGC).Assembly;
-                string assmDir = System.IO.Path.GetDirectoryName(assm.Location);
-                string helperPath = System.IO.Path.Combine(assmDir, "MsvcOffensiveGcHelper.dll");
-                FreeLibrarySafeHandle res = PInvoke.LoadLibrary(helperPath);
-                if (res.IsInvalid)
-                {
-                    throw new Exception($"LoadLibrary failed for {helperPath}");
-                }
+                res[funcName] = GetAllExportedFreeFuncs(modules, exportsMaster, funcName);
+            }
+            return res;
+        }
+
+        /// <summary>
+        /// Loads our C++ helper from next to ScubaDiver.
+        /// It must be loaded before accessing anything from the `MsvcOffensiveGcHelper` class,
+        /// otherwise loading the P/Invoke methods will fail on "Failed to load DLL".
+        /// </summary>
+        public static void LoadHelper()
+        {
+            System.Reflection.Assembly assm = typeof(MsvcOffensiveGC).Assembly;
+            string assmDir = System.IO.Path.GetDirectoryName(assm.Location);
+            string helperPath = System.IO.Path.Combine(assmDir, "MsvcOffensiveGcHelper.dll");
+            FreeLibrarySafeHandle res = PInvoke.LoadLibrary(helperPath);
+            if (res.IsInvalid)
+            {
+                throw new Exception($"LoadLibrary failed for {helperPath}");
             }
+        }
+
+        public void HookAllFreeFuncs(UndecoratedModule targetUndecoratedModule, Dictionary<string, Dictionary<ModuleInfo, DllExport>> exportedFreeFuncs)
+        {
+            LoadHelper();
 
             // Strategy:
             // --------
@@ -157,7 +221,7 @@ namespace ScubaDiver
             ModuleInfo targetModule = targetUndecoratedModule.ModuleInfo;
             foreach (string funcName in new[] { "free", "_free", "_free_dbg" })
             {
-                Dictionary<ModuleInfo, DllExport> modulesToExportedFreeFuncs = GetAllExportedFreeFuncs(allModules, funcName);
+                Dictionary<ModuleInfo, DllExport> modulesToExportedFreeFuncs = exportedFreeFuncs[funcName];
                 foreach (DllExport freeFunc in modulesToExportedFreeFuncs.Values)
                 {
                     // Ask the C++ Helper to func a proxy function to the given "free" function.
@@ -180,9 +244,9 @@ namespace ScubaDiver
             }
         }
 
-        private static Dictionary<ModuleInfo, DllExport> GetAllExportedFreeFuncs(List<UndecoratedModule> allModules, string funcName)
+        private static Dictionary<ModuleInfo, DllExport> GetAllExportedFreeFuncs(List<ModuleInfo> allModules, IReadOnlyExportsMaster exportsMaster, string funcName)
         {
-            Dictionary<ModuleInfo, DllExport> freeExportedFunctions = FreeFinder.Find(allModules, funcName);
+            Dictionary<ModuleInfo, DllExport> freeExportedFunctions = FreeFinder.Find(allModules, exportsMaster, funcName);
             if (freeExportedFunctions.Count == 0)
             {
                 //Logger.Debug($"[{nameof(MsvcOffensiveGC)}] WARNING! '{funcName}' was not found.");
@@ -194,7 +258,7 @@ namespace ScubaDiver
             return freeExportedFunctions;
         }
 
-        private Dictionary<string, List<UndecoratedFunction>> GetNewOperators(List<UndecoratedModule> modules)
+        private Dictionary<string, List<UndecoratedFunction>> GetNewOperators(UndecoratedModule module)
         {
             void ProcessSingleModule(UndecoratedModule module,
                 Dictionary<string, List<UndecoratedFunction>> workingDict)
@@ -228,14 +292,11 @@ namespace ScubaDiver
             }
 
             Dictionary<string, List<UndecoratedFunction>> res = new();
-            foreach (UndecoratedModule module in modules)
-            {
-                ProcessSingleModule(module, res);
-            }
+            ProcessSingleModule(module, res);
 
             return res;
         }
-        private Dictionary<TypeInfo, List<UndecoratedFunction>> GetCtors(List<UndecoratedModule> modules)
+        private Dictionary<TypeInfo, List<UndecoratedFunction>> GetCtors(UndecoratedModule module)
         {
             string GetCtorName(TypeInfo type)
             {
@@ -263,14 +324,11 @@ namespace ScubaDiver
             }
 
             Dictionary<TypeInfo, List<UndecoratedFunction>> res = new();
-            foreach (UndecoratedModule module in modules)
-            {
-                ProcessSingleModule(module, res);
-            }
+            ProcessSingleModule(module, res);
 
             return res;
         }
-        private Dictionary<TypeInfo, List<UndecoratedFunction>> GetDtors(List<UndecoratedModule> modules)
+        private Dictionary<TypeInfo, List<UndecoratedFunction>> GetDtors(UndecoratedModule module)
         {
             string GetDtorName(TypeInfo type)
             {
@@ -298,14 +356,11 @@ namespace ScubaDiver
             }
 
             Dictionary<TypeInfo, List<UndecoratedFunction>> res = new();
-            foreach (UndecoratedModule module in modules)
-            {
-                ProcessSingleModule(module, res);
-            }
+            ProcessSingleModule(module, res);
 
             return res;
         }
-        private Dictionary<TypeInfo, UndecoratedFunction> GetAutoClassInit2Funcs(List<UndecoratedModule> modules)
+        private Dictionary<TypeInfo, UndecoratedFunction> GetAutoClassInit2Funcs(UndecoratedModule module)
         {
             void ProcessSingleModule(UndecoratedModule module,
                 Dictionary<TypeInfo, UndecoratedFunction> workingDict)
@@ -328,10 +383,7 @@ namespace ScubaDiver
             }
 
             Dictionary<TypeInfo, UndecoratedFunction> res = new();
-            foreach (UndecoratedModule module in modules)
-            {
-                ProcessSingleModule(module, res);
-            }
+            ProcessSingleModule(module, res);
 
             return res;
         }
@@ -428,6 +480,7 @@ namespace ScubaDiver
                 // Logger.Debug($"[UnifiedCtor] self.TypeInfo.Name: {self.TypeInfo.Name}, Addr: 0x{self.Address:x16}");
                 RegisterClass(self.Address, self.TypeInfo.ModuleName, self.TypeInfo.Name);
                 TryMatchClassToSize(self.Address, self.TypeInfo.FullTypeName);
+                TryInferClassSize(self);
             }
             else
             {
@@ -627,6 +680,124 @@ namespace ScubaDiver
             }
         }
 
+        // +--------------------------------+
+        // | Class Sizes From Heap Metadata |
+        // +--------------------------------+
+
+        // Instances which aren't heap allocated (stack, globals, members of other objects) can't be measured.
+        // Classes are given up on after this many of those.
+        private const int MaxFailedSizeQueries = 8;
+        private static readonly ConcurrentDictionary<string, int> _failedSizeQueries = new();
+
+        private static readonly Lazy<bool> _heapSizesSupported = new(() =>
+        {
+            try
+            {
+                LoadHelper();
+            }
+            catch (Exception ex)
+            {
+                Logger.Debug($"[{nameof(MsvcOffensiveGC)}] Can't read sizes from the heap: {ex.Message}");
+                return false;
+            }
+            return MsvcOffensiveGcHelper.TryQueryObjectSizes(Array.Empty<ulong>(), Array.Empty<ulong>()) != null;
+        });
+
+        /// <summary>
+        /// Whether the helper can read object sizes from the heap's metadata
+        /// </summary>
+        public static bool HeapSizesSupported => _heapSizesSupported.Value;
+
+        /// <summary>
+        /// Size of the heap allocation at an address, or 0 if it's not a heap allocation
+        /// </summary>
+        public static ulong QueryObjectSize(ulong address)
+        {
+            if (!HeapSizesSupported)
+                return 0;
+            // The object's vftable is read by the helper
+            return MsvcOffensiveGcHelper.TryQueryObjectSizes(new[] { address }, null)?[0] ?? 0;
+        }
+
+        /// <summary>
+        /// Reads the sizes of classes whose sizes are still unknown from the heap allocations of their instances.
+        /// A few instances are asked for per class, in one batch.
+        /// </summary>
+        /// <returns>How many class sizes were found</returns>
+        public static int InferClassSizes(IReadOnlyDictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> instances, int maxInstancesPerClass = 3)
+        {
+            if (!HeapSizesSupported)
+                return 0;
+
+            List<ulong> addresses = new List<ulong>();
+            List<ulong> vftables = new List<ulong>();
+            List<string> typeNames = new List<string>();
+            lock (_classSizesLock)
+            {
+                foreach (var kvp in instances)
+                {
+                    if (_classSizes.ContainsKey(kvp.Key.FullTypeName))
+                        continue;
+                    foreach (ulong address in kvp.Value.Take(maxInstancesPerClass))
+                    {
+                        addresses.Add(address);
+                        vftables.Add(kvp.Key.VftableAddress);
+                        typeNames.Add(kvp.Key.FullTypeName);
+                    }
+                }
+            }
+            if (addresses.Count == 0)
+                return 0;
+
+            ulong[] sizes = MsvcOffensiveGcHelper.TryQueryObjectSizes(addresses.ToArray(), vftables.ToArray());
+            if (sizes == null)
+                return 0;
+
+            int found = 0;
+            lock (_classSizesLock)
+            {
+                for (int i = 0; i < sizes.Length; i++)
+                {
+                    if (sizes[i] == 0 || _classSizes.ContainsKey(typeNames[i]))
+                        continue;
+                    _classSizes[typeNames[i]] = (nuint)sizes[i];
+                    found++;
+                }
+            }
+            Logger.Debug($"[{nameof(MsvcOffensiveGC)}] Read {found} class sizes from the heap, asked for {addresses.Count} objects");
+            return found;
+        }
+
+        /// <summary>
+        /// Reads the size of a newly constructed object's class from its heap allocation, if the class size is still unknown
+        /// </summary>
+        private static void TryInferClassSize(NativeObject self)
+        {
+            string fullTypeName = self.TypeInfo.FullTypeName;
+            lock (_classSizesLock)
+            {
+                if (_classSizes.ContainsKey(fullTypeName))
+                    return;
+            }
+            if (_failedSizeQueries.TryGetValue(fullTypeName, out int failures) && failures >= MaxFailedSizeQueries)
+                return;
+            if (!HeapSizesSupported)
+                return;
+
+            // Ctors are hooked before they run, so the vftable isn't in the object yet
+            ulong vftable = self.TypeInfo is FirstClassTypeInfo firstClassType ? firstClassType.VftableAddress : 0;
+            ulong[] sizes = MsvcOffensiveGcHelper.TryQueryObjectSizes(new ulong[] { self.Address }, new ulong[] { vftable });
+            if (sizes == null || sizes[0] == 0)
+            {
+                _failedSizeQueries.AddOrUpdate(fullTypeName, 1, (_, count) => count + 1);
+                return;
+            }
+            lock (_classSizesLock)
+            {
+                _classSizes.TryAdd(fullTypeName, (nuint)sizes[0]);
+            }
+        }
+
         private static ConcurrentDictionary<ulong, Action<ulong, TypeInfo>> _frozenObjectsToDtorUpdateActions = new();
 
         // Pinning
@@ -1,16 +1,22 @@
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Linq;
 using NtApiDotNet.Win32;
 
 namespace ScubaDiver;
 
+/// <summary>
+/// Caches modules' exports and imports. Modules may be processed from several threads at once.
+/// </summary>
 public class ExportsMaster : IReadOnlyExportsMaster
 {
-    private Dictionary<string, List<DllExport>> _exportsCache = new();
-    private Dictionary<string, List<DllImport>> _importsCache = new();
+    // Exports are stored last, they mark a module as loaded
+    private ConcurrentDictionary<string, List<DllExport>> _exportsCache = new();
+    private ConcurrentDictionary<string, List<DllImport>> _importsCache = new();
 
-    private Dictionary<Rtti.ModuleInfo, List<UndecoratedSymbol>> _undecExportsCache = new();
-    private Dictionary<Rtti.ModuleInfo, List<DllExport>> _leftoverExportsCache = new();
+    // Undecorated exports are stored last, they mark a module as processed
+    private ConcurrentDictionary<Rtti.ModuleInfo, List<UndecoratedSymbol>> _undecExportsCache = new();
+    private ConcurrentDictionary<Rtti.ModuleInfo, List<DllExport>> _leftoverExportsCache = new();
 
 
     public void LoadExportsImports(string moduleName)
@@ -20,8 +26,8 @@ public class ExportsMaster : IReadOnlyExportsMaster
             try
             {
                 var lib = SafeLoadLibraryHandle.GetModuleHandle(moduleName);
-                _exportsCache[moduleName] = lib.Exports.ToList();
                 _importsCache[moduleName] = lib.Imports.ToList();
+                _exportsCache[moduleName] = lib.Exports.ToList();
 
             }
             catch (NtApiDotNet.Win32.SafeWin32Exception ex)
@@ -29,8 +35,8 @@ public class ExportsMaster : IReadOnlyExportsMaster
                 if (ex.Message == "The specified module could not be found.")
                 {
                     // fuck it
-                    _exportsCache[moduleName] = new List<DllExport>();
                     _importsCache[moduleName] = new List<DllImport>();
+                    _exportsCache[moduleName] = new List<DllExport>();
                 }
                 else
                 {
@@ -93,8 +99,8 @@ public class ExportsMaster : IReadOnlyExportsMaster
             else
                 leftoverExports.Add(export);
         }
-        _undecExportsCache[modInfo] = undecoratedExports.ToList();
         _leftoverExportsCache[modInfo] = leftoverExports.ToList();
+        _undecExportsCache[modInfo] = undecoratedExports.ToList();
     }
 
     /// <summary>
@@ -7,6 +7,7 @@ using Windows.Win32.Foundation;
 using Windows.Win32.System.Threading;
 using Windows.Win32.System.Memory;
 using System.Collections.Generic;
+using System.Threading;
 using System.Threading.Tasks;
 using System.Runtime.InteropServices;
 using System.Security.Cryptography;
@@ -54,17 +55,28 @@ namespace ScubaDiver
             return list.ToArray();
         }
 
-        public IDictionary<ulong, IReadOnlyCollection<ulong>> ScanRegions(IEnumerable<nuint> xoredVftables, nuint xorMask)
+        public bool Is32Bit => _is32Bit;
+
+        /// <summary>
+        /// Committed, readable regions of the process
+        /// </summary>
+        public MemoryRegionInfo[] GetRegions() => ScanRegionInfoCore();
+
+        public bool TryRead(ulong address, nuint size, void* buffer) =>
+            PInvoke.ReadProcessMemory(_processHandle, (void*)address, buffer, size);
+
+        public IDictionary<ulong, IReadOnlyCollection<ulong>> ScanRegions(IEnumerable<nuint> xoredVftables, nuint xorMask, CancellationToken cancellationToken = default)
         {
             // Get regions
             MemoryRegionInfo[] scannedRegions = ScanRegionInfoCore();
+            cancellationToken.ThrowIfCancellationRequested();
 
             // Scan regions
-            IDictionary<ulong, IReadOnlyCollection<ulong>> res = ScanRegionsCore2(scannedRegions, xoredVftables, xorMask);
+            IDictionary<ulong, IReadOnlyCollection<ulong>> res = ScanRegionsCore2(scannedRegions, xoredVftables, xorMask, cancellationToken);
             return res;
         }
 
-        private IDictionary<ulong, IReadOnlyCollection<ulong>> ScanRegionsCore2(MemoryRegionInfo[] regionInfoArray, IEnumerable<nuint> xoredVftables, nuint xorMask)
+        private IDictionary<ulong, IReadOnlyCollection<ulong>> ScanRegionsCore2(MemoryRegionInfo[] regionInfoArray, IEnumerable<nuint> xoredVftables, nuint xorMask, CancellationToken cancellationToken)
         {
             ConcurrentDictionary<ulong, ConcurrentBag<ulong>> results = new();
 
@@ -73,42 +85,26 @@ namespace ScubaDiver
                 results[(ulong)xoredVFtable] = new ConcurrentBag<ulong>();
             }
 
-            Parallel.For(0, regionInfoArray.Length, i =>
+            // Throws OperationCanceledException once the token is signaled and the running regions bail out
+            ParallelOptions options = new ParallelOptions() { CancellationToken = cancellationToken };
+            Parallel.For(0, regionInfoArray.Length, options, i =>
             {
                 MemoryRegionInfo regionInfo = regionInfoArray[i];
                 void* baseAddress = regionInfo.BaseAddress;
                 nuint size = regionInfo.Size;
                 void* pointer = NativeMemory.AllocZeroed(size, 1);
-                PInvoke.ReadProcessMemory(_processHandle, baseAddress, pointer, size);
-
-                byte* start = (byte*)pointer;
-                byte* end = start + size;
-                if (_is32Bit)
+                try
                 {
-                    for (byte* a = start; a < end; a += 4)
-                    {
-                        ulong suspect = *(uint*)a;
-                        if (!results.TryGetValue(suspect ^ xorMask, out var bag))
-                            continue;
-                        ulong result = (ulong)baseAddress + (ulong)(a - start);
-                        bag.Add(result);
-                    }
+                    PInvoke.ReadProcessMemory(_processHandle, baseAddress, pointer, size);
+                    VftablePointerScan.ScanBuffer((ulong)baseAddress, (byte*)pointer, size, _is32Bit ? 4 : 8, xorMask, results, cancellationToken);
                 }
-                else
+                finally
                 {
-                    for (byte* a = start; a < end; a += 8)
-                    {
-                        ulong suspect = *(ulong*)a;
-                        if (!results.TryGetValue(suspect ^ xorMask, out var bag))
-                            continue;
-                        ulong result = (ulong)baseAddress + (ulong)(a - start);
-                        bag.Add(result);
-                    }
+                    CryptographicOperations.ZeroMemory(new Span<byte>((byte*)pointer, (int)size));
+                    NativeMemory.Free(pointer);
                 }
-
-                CryptographicOperations.ZeroMemory(new Span<byte>((byte*)pointer, (int)size));
-                NativeMemory.Free(pointer);
             });
+            cancellationToken.ThrowIfCancellationRequested();
 
             Dictionary<ulong, IReadOnlyCollection<ulong>> results2 =
                 results.ToDictionary(
@@ -117,13 +113,71 @@ namespace ScubaDiver
             return results2;
         }
 
+        /// <summary>
+        /// Scans the process memory for pointers into any of the target ranges, in a single parallel pass over all regions.
+        /// See <see cref="ReferenceScan"/> for how targets are kept out of the scanner's own memory.
+        /// </summary>
+        /// <param name="xoredTargets">Start of each target range, xored with <paramref name="xorMask"/></param>
+        /// <param name="lengths">Length of each target range. 0 is treated as 1 (pointers to the exact address).</param>
+        /// <param name="knownXoredVftables">Vftables (xored with <see cref="FirstClassTypeInfo.XorMask"/>) which mark the start of an owning object</param>
+        /// <param name="maxOwnerDistance">How many bytes before a hit are searched for a vftable</param>
+        /// <param name="maxHits">Scanning stops once this many hits were found</param>
+        public List<ReferenceHit> ScanReferences(ulong[] xoredTargets, ulong[] lengths, ulong xorMask,
+            IReadOnlySet<nuint> knownXoredVftables, int maxOwnerDistance, int maxHits, out bool truncated,
+            CancellationToken cancellationToken = default)
+        {
+            ReferenceScan scan = new ReferenceScan(xoredTargets, lengths, xorMask, knownXoredVftables, _is32Bit ? 4 : 8,
+                maxOwnerDistance, maxHits);
+
+            MemoryRegionInfo[] regions = ScanRegionInfoCore();
+            cancellationToken.ThrowIfCancellationRequested();
+
+            // Our own read buffers hold copies of every pointer they scanned, hits inside them are dropped at the end
+            ConcurrentBag<MemoryRegionInfo> scratchBuffers = new();
+
+            ParallelOptions options = new ParallelOptions() { CancellationToken = cancellationToken };
+            Parallel.For(0, regions.Length, options,
+                () => new MemoryRegionInfo(null, 0),
+                (i, loopState, buffer) =>
+                {
+                    MemoryRegionInfo regionInfo = regions[i];
+                    nuint size = regionInfo.Size;
+                    if (buffer.Size < size)
+                    {
+                        if (buffer.BaseAddress != null)
+                            NativeMemory.Free(buffer.BaseAddress);
+                        buffer = new MemoryRegionInfo(NativeMemory.Alloc(size), size);
+                        scratchBuffers.Add(buffer);
+                    }
+
+                    if (!PInvoke.ReadProcessMemory(_processHandle, regionInfo.BaseAddress, buffer.BaseAddress, size))
+                        return buffer;
+
+                    scan.ScanBuffer((ulong)regionInfo.BaseAddress, (byte*)buffer.BaseAddress, 0, size,
+                        (ulong)regionInfo.BaseAddress, size, cancellationToken);
+                    return buffer;
+                },
+                buffer =>
+                {
+                    if (buffer.BaseAddress != null)
+                    {
+                        CryptographicOperations.ZeroMemory(new Span<byte>(buffer.BaseAddress, (int)buffer.Size));
+                        NativeMemory.Free(buffer.BaseAddress);
+                    }
+                });
+            cancellationToken.ThrowIfCancellationRequested();
+
+            MemoryRegionInfo[] scratch = scratchBuffers.ToArray();
+            return scan.GetHits(address => scratch.Any(buffer => address - (ulong)buffer.BaseAddress < buffer.Size), out truncated);
+        }
+
         /// <summary>
         /// Scan the process memory for vftables to spot instances of First-Class types.
         /// </summary>
         /// <param name="memScanner"></param>
         /// <param name="typeInfos"></param>
         /// <returns></returns>
-        public Dictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> Scan(IEnumerable<FirstClassTypeInfo> typeInfos)
+        public Dictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> Scan(IEnumerable<FirstClassTypeInfo> typeInfos, CancellationToken cancellationToken = default)
         {
             Dictionary<nuint, FirstClassTypeInfo> xoredVftableToType = new();
             foreach (FirstClassTypeInfo typeInfo in typeInfos)
@@ -136,7 +190,7 @@ namespace ScubaDiver
 
             // Maps xored vftables to instances
             IDictionary<ulong, IReadOnlyCollection<ulong>> xoredVftablesToInstances =
-                    ScanRegions(xoredVftableToType.Keys, FirstClassTypeInfo.XorMask);
+                    ScanRegions(xoredVftableToType.Keys, FirstClassTypeInfo.XorMask, cancellationToken);
 
             Dictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> res = new();
             foreach (var kvp in xoredVftablesToInstances)
@@ -0,0 +1,271 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using ScubaDiver.API.Interactions.Dumps;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Prepares modules for hooking in stages: Read exports, undecorate, classify and install hooks.
+    /// All stages but the last only read the module, so modules go through them in parallel. Hooks are installed one module at a time.
+    /// Modules can also be queued for background analysis, so hooking them later only has to install the hooks.
+    /// </summary>
+    /// <typeparam name="TPlan">What classifying a module produces and installing its hooks consumes</typeparam>
+    public class ModuleAnalysisPipeline<TPlan>
+    {
+        private class Progress
+        {
+            private readonly Stopwatch _stopwatch = new();
+            private readonly Dictionary<ModuleAnalysisStage, double> _milliseconds = new();
+            private ModuleAnalysisStage _stage;
+            private bool _background;
+            private string _error;
+
+            public Progress(ModuleAnalysisStage stage, bool background)
+            {
+                _stage = stage;
+                _background = background;
+            }
+
+            public ModuleAnalysisStage Stage
+            {
+                get
+                {
+                    lock (_stopwatch)
+                    {
+                        return _stage;
+                    }
+                }
+            }
+
+            /// <summary>
+            /// Ends the current stage and starts timing the next one
+            /// </summary>
+            public void Advance(ModuleAnalysisStage next, bool? background = null)
+            {
+                lock (_stopwatch)
+                {
+                    if (_stopwatch.IsRunning)
+                        _milliseconds[_stage] = _milliseconds.GetValueOrDefault(_stage) + _stopwatch.Elapsed.TotalMilliseconds;
+                    _stage = next;
+                    _background = background ?? _background;
+                    _error = null;
+                    _stopwatch.Reset();
+                    if (next != ModuleAnalysisStage.Analyzed && next != ModuleAnalysisStage.Hooked)
+                        _stopwatch.Start();
+                }
+            }
+
+            public void Fail(Exception ex)
+            {
+                lock (_stopwatch)
+                {
+                    Advance(ModuleAnalysisStage.Failed);
+                    _stopwatch.Stop();
+                    _error = ex.Message;
+                }
+            }
+
+            public ModuleAnalysisDump.Module ToDump(string moduleName)
+            {
+                lock (_stopwatch)
+                {
+                    // The current stage counts up to now
+                    double GetMilliseconds(ModuleAnalysisStage stage) => _milliseconds.GetValueOrDefault(stage) +
+                        (stage == _stage && _stopwatch.IsRunning ? _stopwatch.Elapsed.TotalMilliseconds : 0);
+
+                    return new ModuleAnalysisDump.Module()
+                    {
+                        Name = moduleName,
+                        Stage = _stage,
+                        Background = _background,
+                        ReadExportsMilliseconds = GetMilliseconds(ModuleAnalysisStage.ReadingExports),
+                        UndecorateMilliseconds = GetMilliseconds(ModuleAnalysisStage.Undecorating),
+                        ClassifyMilliseconds = GetMilliseconds(ModuleAnalysisStage.Classifying),
+                        HookMilliseconds = GetMilliseconds(ModuleAnalysisStage.Hooking),
+                        Error = _error
+                    };
+                }
+            }
+        }
+
+        private readonly Action<string> _readExports;
+        private readonly Func<string, UndecoratedModule> _undecorate;
+        private readonly Func<UndecoratedModule, TPlan> _classify;
+        private readonly int _backgroundWorkers;
+
+        private readonly ConcurrentDictionary<string, Progress> _progress = new();
+        // Lazy entries make sure each module is only analyzed once, even when it's requested while a background worker is on it
+        private readonly ConcurrentDictionary<string, Lazy<TPlan>> _plans = new();
+        private readonly object _hookLock = new();
+
+        private readonly object _queueLock = new();
+        private readonly PriorityQueue<string, int> _queue = new();
+        private int _runningWorkers;
+
+        /// <param name="backgroundWorkers">How many modules are analyzed in the background at once</param>
+        public ModuleAnalysisPipeline(Action<string> readExports, Func<string, UndecoratedModule> undecorate,
+            Func<UndecoratedModule, TPlan> classify, int backgroundWorkers)
+        {
+            _readExports = readExports;
+            _undecorate = undecorate;
+            _classify = classify;
+            _backgroundWorkers = Math.Max(1, backgroundWorkers);
+        }
+
+        /// <summary>
+        /// Runs the module through all stages but hooking, or waits for the run already in progress
+        /// </summary>
+        public TPlan Analyze(string moduleName) => Analyze(moduleName, background: false);
+
+        private TPlan Analyze(string moduleName, bool background)
+        {
+            Lazy<TPlan> lazyPlan = _plans.GetOrAdd(moduleName, name => new Lazy<TPlan>(() => RunStages(name, background)));
+            try
+            {
+                return lazyPlan.Value;
+            }
+            catch
+            {
+                // Don't cache failures, the next request tries again
+                _plans.TryRemove(new KeyValuePair<string, Lazy<TPlan>>(moduleName, lazyPlan));
+                throw;
+            }
+        }
+
+        private TPlan RunStages(string moduleName, bool background)
+        {
+            Progress progress = _progress.GetOrAdd(moduleName, _ => new Progress(ModuleAnalysisStage.Queued, background));
+            try
+            {
+                progress.Advance(ModuleAnalysisStage.ReadingExports, background);
+                _readExports(moduleName);
+                progress.Advance(ModuleAnalysisStage.Undecorating);
+                UndecoratedModule module = _undecorate(moduleName);
+                progress.Advance(ModuleAnalysisStage.Classifying);
+                TPlan plan = _classify(module);
+                progress.Advance(ModuleAnalysisStage.Analyzed);
+                return plan;
+            }
+            catch (Exception ex)
+            {
+                progress.Fail(ex);
+                throw;
+            }
+        }
+
+        /// <summary>
+        /// Analyzes the modules in parallel, then installs their hooks in order.
+        /// Modules which are already hooked are skipped. Modules which fail are skipped too, their errors are reported by <see cref="GetStatus"/>.
+        /// </summary>
+        public void Hook(IReadOnlyList<string> moduleNames, Action<TPlan> install, CancellationToken cancellationToken = default)
+        {
+            TPlan[] plans = new TPlan[moduleNames.Count];
+            bool[] analyzed = new bool[moduleNames.Count];
+            ParallelOptions options = new ParallelOptions() { CancellationToken = cancellationToken };
+            Parallel.For(0, moduleNames.Count, options, i =>
+            {
+                try
+                {
+                    plans[i] = Analyze(moduleNames[i]);
+                    analyzed[i] = true;
+                }
+                catch (Exception ex)
+                {
+                    Logger.Debug($"[{nameof(ModuleAnalysisPipeline<TPlan>)}] Failed to analyze {moduleNames[i]}: {ex}");
+                }
+            });
+
+            lock (_hookLock)
+            {
+                for (int i = 0; i < moduleNames.Count; i++)
+                {
+                    cancellationToken.ThrowIfCancellationRequested();
+                    if (!analyzed[i])
+                        continue;
+                    Progress progress = _progress[moduleNames[i]];
+                    if (progress.Stage == ModuleAnalysisStage.Hooked)
+                        continue;
+
+                    progress.Advance(ModuleAnalysisStage.Hooking);
+                    try
+                    {
+                        install(plans[i]);
+                        progress.Advance(ModuleAnalysisStage.Hooked);
+                    }
+                    catch (Exception ex)
+                    {
+                        Logger.Debug($"[{nameof(ModuleAnalysisPipeline<TPlan>)}] Failed to hook {moduleNames[i]}: {ex}");
+                        progress.Fail(ex);
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Queues modules for the background workers. Lower priorities are analyzed first.
+        /// Modules which were already queued, requested or analyzed are ignored.
+        /// </summary>
+        public void EnqueueBackground(IEnumerable<(string moduleName, int priority)> modules)
+        {
+            lock (_queueLock)
+            {
+                foreach ((string moduleName, int priority) in modules)
+                {
+                    if (!_progress.TryAdd(moduleName, new Progress(ModuleAnalysisStage.Queued, background: true)))
+                        continue;
+                    _queue.Enqueue(moduleName, priority);
+                }
+
+                while (_runningWorkers < _backgroundWorkers && _runningWorkers < _queue.Count)
+                {
+                    _runningWorkers++;
+                    Task.Run(BackgroundWorker);
+                }
+            }
+        }
+
+        private void BackgroundWorker()
+        {
+            while (true)
+            {
+                string moduleName;
+                lock (_queueLock)
+                {
+                    if (!_queue.TryDequeue(out moduleName, out _))
+                    {
+                        _runningWorkers--;
+                        return;
+                    }
+                }
+
+                try
+                {
+                    // Modules which were requested in the meantime are already analyzed
+                    Analyze(moduleName, background: true);
+                }
+                catch (Exception ex)
+                {
+                    Logger.Debug($"[{nameof(ModuleAnalysisPipeline<TPlan>)}] Background analysis of {moduleName} failed: {ex.Message}");
+                }
+            }
+        }
+
+        public ModuleAnalysisDump GetStatus()
+        {
+            ModuleAnalysisDump dump = new ModuleAnalysisDump();
+            foreach (KeyValuePair<string, Progress> kvp in _progress.OrderBy(kvp => kvp.Key))
+            {
+                ModuleAnalysisDump.Module module = kvp.Value.ToDump(kvp.Key);
+                if (module.Stage == ModuleAnalysisStage.Queued)
+                    dump.Queued++;
+                dump.Modules.Add(module);
+            }
+            return dump;
+        }
+    }
+}
@@ -15,6 +15,58 @@ public static class MsvcOffensiveGcHelper
     [DllImport("MsvcOffensiveGcHelper.dll", EntryPoint = "?AllocateHookForModule@@YAHPEAX@Z", CallingConvention = CallingConvention.Cdecl)]
     public static extern int AllocateHookForModule(IntPtr originalFreeFunction);
 
+    // Import the `this` filter stubs functions (see ThisFilter.h). These are exported unmangled.
+    [DllImport("MsvcOffensiveGcHelper.dll", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr CreateThisFilterStub(IntPtr onHit);
+
+    [DllImport("MsvcOffensiveGcHelper.dll", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void ReuseThisFilterStub(IntPtr stub, IntPtr onHit);
+
+    [DllImport("MsvcOffensiveGcHelper.dll", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void SetThisFilterMissTarget(IntPtr stub, IntPtr onMiss);
+
+    [DllImport("MsvcOffensiveGcHelper.dll", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void SetThisFilterAddresses(IntPtr stub, ulong[] addresses, int count, int passAll);
+
+    /// <summary>
+    /// Creates a stub which only forwards calls to <paramref name="onHit"/> if their `this` is in the stub's address set.
+    /// </summary>
+    /// <returns>The stub's entry point, or IntPtr.Zero if stubs aren't supported (x86, missing helper DLL)</returns>
+    public static IntPtr TryCreateThisFilterStub(IntPtr onHit)
+    {
+        try
+        {
+            return CreateThisFilterStub(onHit);
+        }
+        catch (Exception ex) when (ex is DllNotFoundException || ex is EntryPointNotFoundException)
+        {
+            return IntPtr.Zero;
+        }
+    }
+
+    // Import the object sizes query (see HeapMetadata.h). Exported unmangled.
+    [DllImport("MsvcOffensiveGcHelper.dll", CallingConvention = CallingConvention.Cdecl)]
+    public static extern int QueryObjectSizes(ulong[] addresses, ulong[] vftables, int count, [Out] ulong[] sizes);
+
+    /// <summary>
+    /// Reads the allocation sizes of objects from the heap's metadata. Sizes are cached by vftable in the helper.
+    /// </summary>
+    /// <param name="vftables">Vftables of the objects, 0 for objects that shouldn't be cached. If null, the objects' first pointers are used.</param>
+    /// <returns>The sizes, 0 where unknown, or null if the helper doesn't support size queries</returns>
+    public static ulong[] TryQueryObjectSizes(ulong[] addresses, ulong[] vftables)
+    {
+        ulong[] sizes = new ulong[addresses.Length];
+        try
+        {
+            QueryObjectSizes(addresses, vftables, addresses.Length, sizes);
+            return sizes;
+        }
+        catch (Exception ex) when (ex is DllNotFoundException || ex is EntryPointNotFoundException)
+        {
+            return null;
+        }
+    }
+
     // Load the DLL once and cache the handle
     private static Windows.Win32.FreeLibrarySafeHandle hModule = Windows.Win32.PInvoke.LoadLibrary("MsvcOffensiveGcHelper.dll");
 
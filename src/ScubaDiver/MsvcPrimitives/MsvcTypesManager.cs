@@ -1,10 +1,13 @@
 ﻿using NtApiDotNet.Win32;
+using ScubaDiver.API.Interactions.Memory;
 using ScubaDiver.API.Utils;
 using ScubaDiver.Rtti;
+using ScubaDiver.Snapshots;
 using System;
 using System.Collections.Generic;
 using System.Diagnostics.CodeAnalysis;
 using System.Globalization;
+using System.IO;
 using System.Linq;
 using System.Reflection;
 using System.Threading;
@@ -303,6 +306,36 @@ namespace ScubaDiver
         }
         public List<UndecoratedModule> GetUndecoratedModules(Predicate<string> moduleNameFilter) => GetUndecoratedModules(new MsvcModuleFilter() { NamePredicate = moduleNameFilter });
 
+        /// <summary>
+        /// Number of First-Class types in each module. Doesn't undecorate any module.
+        /// </summary>
+        public Dictionary<ModuleInfo, int> GetModulesTypesCount()
+        {
+            return _tricksterWrapper.GetDecoratedTypes().ToDictionary(kvp => kvp.Key.ModuleInfo, kvp => kvp.Value.Count);
+        }
+
+        /// <summary>
+        /// Reads (and caches) the module's exports and imports tables
+        /// </summary>
+        public void LoadExports(string moduleName) => _tricksterWrapper.ExportsMaster.LoadExportsImports(moduleName);
+
+        internal IReadOnlyExportsMaster ExportsMaster => _exportsMaster;
+
+        /// <summary>
+        /// Raised after the modules were scanned again
+        /// </summary>
+        public event Action Refreshed;
+
+        /// <summary>
+        /// Raised after every scan of the modules, including the ones forced by module filters that matched nothing.
+        /// Unlike <see cref="Refreshed"/>, handlers run under the scanner's lock so they should only be cheap, lock-free work.
+        /// </summary>
+        public event Action ModulesScanned
+        {
+            add => _tricksterWrapper.ModulesScanned += value;
+            remove => _tricksterWrapper.ModulesScanned -= value;
+        }
+
         internal void RefreshIfNeeded()
         {
             if (_tricksterWrapper.RefreshRequired())
@@ -314,6 +347,7 @@ namespace ScubaDiver
                 {
                     _allKnownXoredVftableAddresses.Clear();
                 }
+                Refreshed?.Invoke();
             }
         }
         
@@ -370,8 +404,34 @@ namespace ScubaDiver
             }
         }
 
+        /// <summary>
+        /// A copy of all known vftable addresses (xored with <see cref="FirstClassTypeInfo.XorMask"/>), safe to use from any thread
+        /// </summary>
+        public HashSet<nuint> GetKnownXoredVftables()
+        {
+            EnsureVftableCachePopulated();
+            lock (_getTypesLock)
+            {
+                return new HashSet<nuint>(_allKnownXoredVftableAddresses);
+            }
+        }
+
         private object _getTypesLock = new object();
-        public IReadOnlyList<MsvcTypeStub> GetTypes(MsvcModuleFilter moduleFilter, Predicate<string> typeFilter)
+        public IReadOnlyList<MsvcTypeStub> GetTypes(MsvcModuleFilter moduleFilter, Predicate<string> typeFilter, CancellationToken cancellationToken = default)
+        {
+            if (typeFilter == null)
+                return GetTypesCore(moduleFilter, module => module.Types, cancellationToken);
+            return GetTypesCore(moduleFilter, module => module.Types.Where(type => typeFilter(type.NamespaceAndName)), cancellationToken);
+        }
+
+        /// <summary>
+        /// Gets the types matching a "simple filter" (see <see cref="Filter"/>).
+        /// Unlike the predicate overload, this one resolves the filter with the modules' type name indexes.
+        /// </summary>
+        public IReadOnlyList<MsvcTypeStub> GetTypes(MsvcModuleFilter moduleFilter, string rawTypeFilter, CancellationToken cancellationToken = default)
+            => GetTypesCore(moduleFilter, module => module.FindTypes(rawTypeFilter), cancellationToken);
+
+        private IReadOnlyList<MsvcTypeStub> GetTypesCore(MsvcModuleFilter moduleFilter, Func<UndecoratedModule, IEnumerable<Rtti.TypeInfo>> selectTypes, CancellationToken cancellationToken)
         {
             List<MsvcTypeStub> output = new List<MsvcTypeStub>();
             lock (_getTypesLock)
@@ -385,16 +445,13 @@ namespace ScubaDiver
                 // PHASE 2: Now create stubs (which may lazy-call CreateType → AnalyzeVftable)
                 // At this point, the cache has ALL vftables from all modules
                 moduleFilter ??= new MsvcModuleFilter();
-                typeFilter ??= (s) => true;
                 List<UndecoratedModule> modules = GetUndecoratedModules(moduleFilter);
                 
                 foreach (UndecoratedModule undecoratedModule in modules)
                 {
-                    foreach (Rtti.TypeInfo type in undecoratedModule.Types)
+                    cancellationToken.ThrowIfCancellationRequested();
+                    foreach (Rtti.TypeInfo type in selectTypes(undecoratedModule))
                     {
-                        if (!typeFilter(type.NamespaceAndName))
-                            continue;
-
                         MsvcTypeStub t = GetOrCreateTypeStub(undecoratedModule.RichModule, type);
                         output.Add(t);
                     }
@@ -403,13 +460,17 @@ namespace ScubaDiver
             return output;
         }
 
-        public IReadOnlyList<MsvcTypeStub> GetTypes(Predicate<string> moduleNameFilter, Predicate<string> typeFilter) 
-                    => GetTypes(new MsvcModuleFilter() { NamePredicate = moduleNameFilter }, typeFilter).ToList();
+        public IReadOnlyList<MsvcTypeStub> GetTypes(Predicate<string> moduleNameFilter, Predicate<string> typeFilter, CancellationToken cancellationToken = default) 
+                    => GetTypes(new MsvcModuleFilter() { NamePredicate = moduleNameFilter }, typeFilter, cancellationToken).ToList();
+        public IReadOnlyList<MsvcTypeStub> GetTypes(Predicate<string> moduleNameFilter, string rawTypeFilter, CancellationToken cancellationToken = default)
+                    => GetTypes(new MsvcModuleFilter() { NamePredicate = moduleNameFilter }, rawTypeFilter, cancellationToken);
+
 
+        public MsvcTypeStub GetType(MsvcModuleFilter moduleFilter, Predicate<string> typeFilter) => SingleOrNull(GetTypes(moduleFilter, typeFilter));
+        public MsvcTypeStub GetType(MsvcModuleFilter moduleFilter, string rawTypeFilter) => SingleOrNull(GetTypes(moduleFilter, rawTypeFilter));
 
-        public MsvcTypeStub GetType(MsvcModuleFilter moduleFilter, Predicate<string> typeFilter)
+        private static MsvcTypeStub SingleOrNull(IEnumerable<MsvcTypeStub> lazyMatches)
         {
-            IEnumerable<MsvcTypeStub> lazyMatches = GetTypes(moduleFilter, typeFilter);
             // Assert we only have one match without throwing an exception or parsing needlessly the third, forth,...
             MsvcTypeStub[] firstMatches = lazyMatches.Take(2).ToArray();
             if (firstMatches.Length == 1)
@@ -418,7 +479,9 @@ namespace ScubaDiver
         }
 
         public MsvcTypeStub GetType(Predicate<string> moduleNameFilter, Predicate<string> typeFilter) => GetType(new MsvcModuleFilter() { NamePredicate = moduleNameFilter }, typeFilter);
-        public MsvcTypeStub GetType(string moduleName, string typeName) => GetType((s) => s == moduleName, (s) => s == typeName);
+        public MsvcTypeStub GetType(Predicate<string> moduleNameFilter, string rawTypeFilter) => GetType(new MsvcModuleFilter() { NamePredicate = moduleNameFilter }, rawTypeFilter);
+        public MsvcTypeStub GetType(string moduleName, string typeName)
+            => SingleOrNull(GetTypesCore(new MsvcModuleFilter() { NamePredicate = (s) => s == moduleName }, module => module.FindTypesByExactName(typeName), default));
 
         public MsvcTypeStub GetType(nuint vftable)
         {
@@ -629,10 +692,10 @@ namespace ScubaDiver
         }
 
         //TODO: Move me
-        public Dictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> Scan(IEnumerable<MsvcTypeStub> types)
+        public Dictionary<FirstClassTypeInfo, IReadOnlyCollection<ulong>> Scan(IEnumerable<MsvcTypeStub> types, CancellationToken cancellationToken = default)
         {
             IEnumerable<FirstClassTypeInfo> allClassesToScanFor = types.Select(t => t.TypeInfo).OfType<FirstClassTypeInfo>();
-            var rawMatches = _memoryScanner.Scan(allClassesToScanFor);
+            var rawMatches = _memoryScanner.Scan(allClassesToScanFor, cancellationToken);
 
             // Filtering out the matches which are just exports (not instances)
             return rawMatches.ToDictionary(
@@ -648,6 +711,60 @@ namespace ScubaDiver
             }
         }
 
+        /// <summary>
+        /// Scans the process memory for pointers into the target ranges (see <see cref="MemoryScanner.ScanReferences"/>).
+        /// Each hit is returned with the type of the vftable preceding it, if any.
+        /// </summary>
+        public List<(ReferenceHit hit, MsvcTypeStub ownerType)> ScanReferences(ulong[] xoredTargets, ulong[] lengths, ulong xorMask,
+            int maxOwnerDistance, int maxHits, out bool truncated, CancellationToken cancellationToken = default)
+        {
+            HashSet<nuint> knownXoredVftables = GetKnownXoredVftables();
+            List<ReferenceHit> hits = _memoryScanner.ScanReferences(xoredTargets, lengths, xorMask, knownXoredVftables,
+                maxOwnerDistance, maxHits, out truncated, cancellationToken);
+            return hits.Select(hit => (hit, hit.OwnerAddress != 0 ? GetType(hit.XoredOwnerVftable ^ FirstClassTypeInfo.XorMask) : null))
+                .ToList();
+        }
+
+        /// <summary>
+        /// Writes all committed memory and the scanned modules to a snapshot file, for offline analysis.
+        /// Regions are streamed one chunk at a time. A partially written file is deleted.
+        /// </summary>
+        public unsafe MemorySnapshotResults WriteSnapshot(string path, CancellationToken cancellationToken = default)
+        {
+            RefreshIfNeeded();
+            List<RichModuleInfo> modules = _tricksterWrapper.GetDecoratedTypes().Keys.ToList();
+            MemoryRegionInfo[] regions = _memoryScanner.GetRegions();
+
+            try
+            {
+                using FileStream file = new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.None);
+                using MemorySnapshotWriter writer = new MemorySnapshotWriter(file, _memoryScanner.Is32Bit ? 4 : 8);
+                foreach (RichModuleInfo module in modules)
+                    writer.AddModule(module);
+                foreach (MemoryRegionInfo region in regions)
+                {
+                    writer.WriteRegion((ulong)region.BaseAddress, region.Size,
+                        (address, count, buffer) => _memoryScanner.TryRead(address, (nuint)count, buffer), cancellationToken);
+                }
+                writer.Finish();
+
+                return new MemorySnapshotResults()
+                {
+                    Path = path,
+                    Modules = modules.Count,
+                    Regions = writer.RegionsCount,
+                    MemoryBytes = writer.MemoryBytes,
+                    FileBytes = writer.BytesWritten
+                };
+            }
+            catch
+            {
+                if (File.Exists(path))
+                    File.Delete(path);
+                throw;
+            }
+        }
+
         /// <summary>
         /// Registers a custom function on a type
         /// </summary>
@@ -664,8 +781,7 @@ namespace ScubaDiver
             {
                 // Get the parent type
                 Predicate<string> moduleFilter = Filter.CreatePredicate(parentAssembly);
-                Predicate<string> typeFilter = Filter.CreatePredicate(parentTypeFullName);
-                MsvcTypeStub typeStub = GetType(moduleFilter, typeFilter);
+                MsvcTypeStub typeStub = GetType(moduleFilter, parentTypeFullName);
                 if (typeStub == null)
                     return false;
 
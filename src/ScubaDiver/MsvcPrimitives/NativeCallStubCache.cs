@@ -0,0 +1,74 @@
+using System;
+using System.Linq;
+using System.Linq.Expressions;
+using System.Reflection;
+using System.Runtime.InteropServices;
+
+namespace ScubaDiver;
+
+/// <summary>
+/// Signature of a native function, as far as calling it is concerned
+/// </summary>
+public readonly record struct NativeCallSignature(ulong Address, CallingConvention CallingConvention, int NumArgs, int FloatsBitmap, Type ReturnType);
+
+/// <summary>
+/// Ready-to-call invokers of native functions.
+/// Creating the marshalling delegate of a function (and invoking it with <see cref="Delegate.DynamicInvoke"/>) costs far more
+/// than the native call itself. Repeated invocations of the same function reuse an invoker compiled on first use.
+/// </summary>
+public class NativeCallStubCache
+{
+    /// <param name="args">Boxed <see cref="nuint"/>s and <see cref="double"/>s, matching the signature's floats bitmap</param>
+    /// <returns>Boxed return value, null for void functions</returns>
+    public delegate object NativeInvoker(object[] args);
+
+    public const int DefaultCapacity = 1024;
+
+    private readonly LRUCache<NativeCallSignature, NativeInvoker> _invokers;
+    private readonly object _lock = new();
+
+    public NativeCallStubCache(int capacity = DefaultCapacity)
+    {
+        _invokers = new LRUCache<NativeCallSignature, NativeInvoker>(capacity);
+    }
+
+    public NativeInvoker GetOrCreate(NativeCallSignature signature)
+    {
+        lock (_lock)
+        {
+            if (_invokers.TryGetValue(signature, false, out NativeInvoker invoker))
+                return invoker;
+        }
+
+        // Compiling outside the lock. Racing requests for the same function might both compile, last one is kept.
+        NativeInvoker created = CreateInvoker(signature);
+        lock (_lock)
+        {
+            _invokers.AddOrUpdate(signature, created);
+        }
+        return created;
+    }
+
+    public static NativeInvoker CreateInvoker(NativeCallSignature signature)
+    {
+        if (signature.CallingConvention != CallingConvention.Winapi)
+            throw new NotSupportedException($"Calling convention {signature.CallingConvention} is not supported for native invocations");
+
+        Type delegateType = NativeDelegatesFactory.GetDelegateType(signature.ReturnType, signature.NumArgs, signature.FloatsBitmap);
+        if (delegateType == null)
+            throw new NotSupportedException($"No native delegate for {signature.NumArgs} args with floats bitmap 0x{signature.FloatsBitmap:x}");
+        Delegate target = Marshal.GetDelegateForFunctionPointer(new IntPtr((long)signature.Address), delegateType);
+
+        // args => (object)target.Invoke((nuint)args[0], (double)args[1], ...)
+        MethodInfo invoke = delegateType.GetMethod("Invoke");
+        ParameterExpression args = Expression.Parameter(typeof(object[]), "args");
+        Expression[] callArgs = invoke.GetParameters()
+            .Select((parameter, i) => (Expression)Expression.Convert(Expression.ArrayIndex(args, Expression.Constant(i)), parameter.ParameterType))
+            .ToArray();
+        Expression call = Expression.Call(Expression.Constant(target, delegateType), invoke, callArgs);
+        Expression body = invoke.ReturnType == typeof(void)
+            ? Expression.Block(call, Expression.Constant(null))
+            : Expression.Convert(call, typeof(object));
+        return Expression.Lambda<NativeInvoker>(body, args).Compile();
+    }
+}
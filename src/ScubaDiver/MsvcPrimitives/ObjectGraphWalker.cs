@@ -0,0 +1,163 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Threading;
+using System.Threading.Tasks;
+using ScubaDiver.API.Interactions.Dumps;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Traverses native object graphs: From each object, pointer fields inside its known size are followed into other objects.
+    /// The graph is walked a depth at a time. Objects of the same depth are expanded in parallel, then merged in order so results are stable.
+    /// </summary>
+    public unsafe class ObjectGraphWalker
+    {
+        /// <returns>False if the memory couldn't be read</returns>
+        public delegate bool MemoryReader(ulong address, byte* destination, int length);
+
+        /// <summary>
+        /// Fields beyond this many bytes into an object aren't followed
+        /// </summary>
+        public const int MaxObjectSize = 64 * 1024;
+
+        private readonly int _pointerSize;
+        private readonly MemoryReader _read;
+        private readonly Func<ulong, string> _identify;
+        private readonly Func<ulong, string, ulong> _sizeOf;
+
+        /// <param name="identify">Full type name of the object at an address, or null if no object of a known type starts there</param>
+        /// <param name="sizeOf">Known size of an object given its address and type, or 0 if unknown</param>
+        public ObjectGraphWalker(int pointerSize, MemoryReader read, Func<ulong, string> identify, Func<ulong, string, ulong> sizeOf)
+        {
+            _pointerSize = pointerSize;
+            _read = read;
+            _identify = identify;
+            _sizeOf = sizeOf;
+        }
+
+        private struct Field
+        {
+            public ulong Offset;
+            public ulong Target;
+            public string TargetType;
+        }
+
+        /// <param name="typeFilter">Only objects of matching types are followed</param>
+        public ObjectGraphDump Walk(IReadOnlyList<ulong> roots, int maxDepth, Predicate<string> typeFilter, int maxNodes,
+            CancellationToken cancellationToken = default)
+        {
+            ObjectGraphDump dump = new ObjectGraphDump();
+            Dictionary<string, int> typeIndices = new Dictionary<string, int>();
+            Dictionary<ulong, int> nodeIndices = new Dictionary<ulong, int>();
+            // Objects are identified once, no matter how many fields point to them
+            ConcurrentDictionary<ulong, string> identified = new ConcurrentDictionary<ulong, string>();
+
+            List<int> frontier = new List<int>();
+            foreach (ulong root in roots)
+            {
+                if (nodeIndices.ContainsKey(root))
+                    continue;
+                if (dump.Nodes.Count >= maxNodes)
+                {
+                    dump.Truncated = true;
+                    break;
+                }
+                frontier.Add(AddNode(root, identified.GetOrAdd(root, _identify), 0));
+            }
+
+            for (int depth = 0; depth < maxDepth && frontier.Count > 0; depth++)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+
+                // Expand the whole depth in parallel
+                List<Field>[] fields = new List<Field>[frontier.Count];
+                ParallelOptions options = new ParallelOptions() { CancellationToken = cancellationToken };
+                Parallel.For(0, frontier.Count, options,
+                    () => new byte[MaxObjectSize],
+                    (i, loopState, buffer) =>
+                    {
+                        ObjectGraphDump.Node node = dump.Nodes[frontier[i]];
+                        fields[i] = node.Size > 0 ? GetFields(node.Address, node.Size, buffer, typeFilter, identified) : null;
+                        return buffer;
+                    },
+                    buffer => { });
+
+                // Merge in order
+                List<int> nextFrontier = new List<int>();
+                for (int i = 0; i < frontier.Count; i++)
+                {
+                    if (fields[i] == null)
+                        continue;
+                    foreach (Field field in fields[i])
+                    {
+                        if (!nodeIndices.TryGetValue(field.Target, out int target))
+                        {
+                            if (dump.Nodes.Count >= maxNodes)
+                            {
+                                dump.Truncated = true;
+                                continue;
+                            }
+                            target = AddNode(field.Target, field.TargetType, depth + 1);
+                            nextFrontier.Add(target);
+                        }
+                        dump.Edges.Add(new ObjectGraphDump.Edge() { From = frontier[i], Offset = field.Offset, To = target });
+                    }
+                }
+                frontier = nextFrontier;
+            }
+            return dump;
+
+            int AddNode(ulong address, string typeName, int depth)
+            {
+                int typeIndex = -1;
+                if (typeName != null && !typeIndices.TryGetValue(typeName, out typeIndex))
+                {
+                    typeIndex = dump.Types.Count;
+                    typeIndices[typeName] = typeIndex;
+                    dump.Types.Add(typeName);
+                }
+                int index = dump.Nodes.Count;
+                dump.Nodes.Add(new ObjectGraphDump.Node()
+                {
+                    Address = address,
+                    Type = typeIndex,
+                    Size = typeName != null ? _sizeOf(address, typeName) : 0,
+                    Depth = depth
+                });
+                nodeIndices[address] = index;
+                return index;
+            }
+        }
+
+        /// <summary>
+        /// Pointer fields of an object which point to objects of known (and matching) types.
+        /// The first field is skipped, it's the object's own vftable.
+        /// </summary>
+        private List<Field> GetFields(ulong address, ulong size, byte[] buffer, Predicate<string> typeFilter,
+            ConcurrentDictionary<ulong, string> identified)
+        {
+            int length = (int)Math.Min(size, (ulong)buffer.Length);
+            length -= length % _pointerSize;
+            List<Field> fields = new List<Field>();
+            fixed (byte* start = buffer)
+            {
+                if (!_read(address, start, length))
+                    return fields;
+
+                for (int offset = _pointerSize; offset < length; offset += _pointerSize)
+                {
+                    ulong value = _pointerSize == 4 ? *(uint*)(start + offset) : *(ulong*)(start + offset);
+                    // Objects are at least pointer-aligned
+                    if (value == 0 || value % (ulong)_pointerSize != 0)
+                        continue;
+                    string typeName = identified.GetOrAdd(value, _identify);
+                    if (typeName == null || !typeFilter(typeName))
+                        continue;
+                    fields.Add(new Field() { Offset = (ulong)offset, Target = value, TargetType = typeName });
+                }
+            }
+            return fields;
+        }
+    }
+}
@@ -0,0 +1,228 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading;
+using ScubaDiver.Rtti;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Finds instances by the xored vftables stored at their start.
+    /// Works on buffers of memory so live scans (<see cref="MemoryScanner"/>) and snapshot scans share it.
+    /// </summary>
+    public static unsafe class VftablePointerScan
+    {
+        // How many bytes are scanned between checks of the cancellation token
+        public const int CancellationCheckInterval = 1024 * 1024;
+
+        /// <param name="bufferAddress">Address the buffer's memory was read from</param>
+        /// <param name="results">Bags of the instances of every xored vftable. Matches are added to them.</param>
+        public static void ScanBuffer(ulong bufferAddress, byte* start, nuint size, int pointerSize, ulong xorMask,
+            ConcurrentDictionary<ulong, ConcurrentBag<ulong>> results, CancellationToken cancellationToken)
+        {
+            byte* end = start + size;
+            for (byte* chunkStart = start; chunkStart < end; chunkStart += CancellationCheckInterval)
+            {
+                if (cancellationToken.IsCancellationRequested)
+                    return;
+
+                byte* chunkEnd = (ulong)(end - chunkStart) > CancellationCheckInterval ? chunkStart + CancellationCheckInterval : end;
+                if (pointerSize == 4)
+                {
+                    for (byte* a = chunkStart; a < chunkEnd; a += 4)
+                    {
+                        ulong suspect = *(uint*)a;
+                        if (!results.TryGetValue(suspect ^ xorMask, out var bag))
+                            continue;
+                        ulong result = bufferAddress + (ulong)(a - start);
+                        bag.Add(result);
+                    }
+                }
+                else
+                {
+                    for (byte* a = chunkStart; a < chunkEnd; a += 8)
+                    {
+                        ulong suspect = *(ulong*)a;
+                        if (!results.TryGetValue(suspect ^ xorMask, out var bag))
+                            continue;
+                        ulong result = bufferAddress + (ulong)(a - start);
+                        bag.Add(result);
+                    }
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Looks for pointers into any of a set of target ranges, one buffer of memory at a time.
+    /// <para>
+    /// Target addresses never appear as-is in the scan's own memory, so a scan of the live process doesn't report itself:
+    /// They arrive xored and are kept biased by a random offset. Pointer values are compared in the same biased form.
+    /// </para>
+    /// Buffers may be scanned concurrently.
+    /// </summary>
+    public unsafe class ReferenceScan
+    {
+        private readonly ulong _bias;
+        private readonly int _count;
+        private readonly ulong[] _biasedStarts;
+        private readonly int[] _targetIndices;
+        private readonly ulong[] _spans;
+        private readonly ulong[] _maxBiasedEnds;
+        private readonly ulong _biasedMin;
+        private readonly ulong _coveringSpan;
+
+        private readonly IReadOnlySet<nuint> _knownXoredVftables;
+        private readonly int _pointerSize;
+        private readonly int _maxOwnerSteps;
+        private readonly int _maxHits;
+
+        private readonly ConcurrentBag<ReferenceHit> _hits = new();
+        private int _hitsCount;
+
+        public bool IsFull => Volatile.Read(ref _hitsCount) >= _maxHits;
+
+        /// <param name="xoredTargets">Start of each target range, xored with <paramref name="xorMask"/></param>
+        /// <param name="lengths">Length of each target range. 0 is treated as 1 (pointers to the exact address).</param>
+        /// <param name="knownXoredVftables">Vftables (xored with <see cref="FirstClassTypeInfo.XorMask"/>) which mark the start of an owning object</param>
+        /// <param name="maxOwnerDistance">How many bytes before a hit are searched for a vftable</param>
+        /// <param name="maxHits">Scanning stops once this many hits were found</param>
+        public ReferenceScan(ulong[] xoredTargets, ulong[] lengths, ulong xorMask, IReadOnlySet<nuint> knownXoredVftables,
+            int pointerSize, int maxOwnerDistance, int maxHits)
+        {
+            if (xoredTargets.Length != lengths.Length)
+                throw new ArgumentException("Every target requires a length");
+
+            // Biasing by less than 2^62 can't wrap around addresses, so biased targets sort like the real ones
+            _bias = (ulong)Random.Shared.NextInt64(1L << 40, 1L << 62);
+            _count = xoredTargets.Length;
+            _biasedStarts = new ulong[_count];
+            _targetIndices = new int[_count];
+            for (int i = 0; i < _count; i++)
+            {
+                _biasedStarts[i] = (xoredTargets[i] ^ xorMask) + _bias;
+                _targetIndices[i] = i;
+            }
+            Array.Sort(_biasedStarts, _targetIndices);
+            _spans = new ulong[_count];
+            for (int i = 0; i < _count; i++)
+                _spans[i] = Math.Max(lengths[_targetIndices[i]], 1);
+
+            // Quick rejection of most pointer values: The span covering all targets
+            _biasedMin = _count > 0 ? _biasedStarts[0] : 0;
+            // Targets might overlap, so the widest reach of any target up to each index is kept
+            _maxBiasedEnds = new ulong[_count];
+            for (int i = 0; i < _count; i++)
+            {
+                ulong biasedEnd = _biasedStarts[i] + _spans[i];
+                _maxBiasedEnds[i] = i > 0 ? Math.Max(_maxBiasedEnds[i - 1], biasedEnd) : biasedEnd;
+                _coveringSpan = _maxBiasedEnds[i] - _biasedMin;
+            }
+
+            _knownXoredVftables = knownXoredVftables;
+            _pointerSize = pointerSize;
+            _maxOwnerSteps = Math.Max(maxOwnerDistance, 0) / pointerSize;
+            _maxHits = maxHits;
+        }
+
+        /// <summary>
+        /// Scans the pointers in a buffer, from <paramref name="scanStart"/> on.
+        /// Bytes before <paramref name="scanStart"/> are only searched for owners, so buffers can overlap the end of the previous one.
+        /// </summary>
+        /// <param name="bufferAddress">Address the buffer's memory was read from</param>
+        public void ScanBuffer(ulong bufferAddress, byte* buffer, nuint scanStart, nuint size, ulong regionBase, ulong regionSize,
+            CancellationToken cancellationToken)
+        {
+            int pointerSize = _pointerSize;
+            byte* start = buffer + scanStart;
+            byte* end = buffer + size - (pointerSize - 1);
+            for (byte* chunkStart = start; chunkStart < end; chunkStart += VftablePointerScan.CancellationCheckInterval)
+            {
+                if (cancellationToken.IsCancellationRequested || IsFull)
+                    return;
+
+                byte* chunkEnd = (ulong)(end - chunkStart) > VftablePointerScan.CancellationCheckInterval
+                    ? chunkStart + VftablePointerScan.CancellationCheckInterval
+                    : end;
+                for (byte* a = chunkStart; a < chunkEnd; a += pointerSize)
+                {
+                    ulong biasedSuspect = (pointerSize == 4 ? *(uint*)a : *(ulong*)a) + _bias;
+                    if (biasedSuspect - _biasedMin >= _coveringSpan)
+                        continue;
+
+                    // Last target starting at or before the suspect, then back through the ones that might still reach it
+                    int lo = 0;
+                    int hi = _count - 1;
+                    while (lo < hi)
+                    {
+                        int mid = (lo + hi + 1) / 2;
+                        if (_biasedStarts[mid] <= biasedSuspect)
+                            lo = mid;
+                        else
+                            hi = mid - 1;
+                    }
+                    for (int t = lo; t >= 0 && _maxBiasedEnds[t] > biasedSuspect; t--)
+                    {
+                        if (biasedSuspect - _biasedStarts[t] >= _spans[t])
+                            continue;
+
+                        ulong offset = (ulong)(a - buffer);
+                        ReferenceHit hit = new ReferenceHit()
+                        {
+                            Address = bufferAddress + offset,
+                            TargetIndex = _targetIndices[t],
+                            RegionBase = regionBase,
+                            RegionSize = regionSize
+                        };
+                        for (int step = 1; step <= _maxOwnerSteps && offset >= (ulong)(step * pointerSize); step++)
+                        {
+                            byte* candidate = a - step * pointerSize;
+                            nuint xoredCandidate = (pointerSize == 4 ? *(uint*)candidate : (nuint)(*(ulong*)candidate)) ^ FirstClassTypeInfo.XorMask;
+                            if (!_knownXoredVftables.Contains(xoredCandidate))
+                                continue;
+                            hit.OwnerAddress = hit.Address - (ulong)(step * pointerSize);
+                            hit.XoredOwnerVftable = xoredCandidate;
+                            break;
+                        }
+                        _hits.Add(hit);
+                        Interlocked.Increment(ref _hitsCount);
+                    }
+                }
+            }
+        }
+
+        /// <param name="isExcluded">Drops hits by their address</param>
+        /// <returns>Up to maxHits hits, by address</returns>
+        public List<ReferenceHit> GetHits(Func<ulong, bool> isExcluded, out bool truncated)
+        {
+            List<ReferenceHit> output = _hits
+                .Where(hit => !isExcluded(hit.Address))
+                .OrderBy(hit => hit.Address)
+                .ToList();
+            truncated = IsFull;
+            if (output.Count > _maxHits)
+                output.RemoveRange(_maxHits, output.Count - _maxHits);
+            return output;
+        }
+    }
+
+    public struct ReferenceHit
+    {
+        /// <summary>
+        /// Where the pointer is stored
+        /// </summary>
+        public ulong Address;
+        /// <summary>
+        /// Index of the target range the pointer points into
+        /// </summary>
+        public int TargetIndex;
+        public ulong RegionBase;
+        public ulong RegionSize;
+        /// <summary>
+        /// Address of the nearest vftable before the pointer, or 0 if none was found
+        /// </summary>
+        public ulong OwnerAddress;
+        public nuint XoredOwnerVftable;
+    }
+}
@@ -0,0 +1,309 @@
+using System;
+using System.Collections.Generic;
+using System.Text;
+
+namespace ScubaDiver.Rtti;
+
+/// <summary>
+/// Undecorates the class symbols of RTTI type descriptors ("?name@namespace@@") without DbgHelp, so snapshots can be analyzed anywhere.
+/// Output follows DbgHelp's name-only style, e.g. "std::vector&lt;int,class std::allocator&lt;int&gt; &gt;".
+/// Only the encodings found in type names are supported: Namespaces, templates, back-references, primitive/class/pointer arguments and integers.
+/// </summary>
+public static class RttiNameUndecorator
+{
+    private const int MaxBackReferences = 10;
+
+    /// <returns>The full class name, or null if the symbol isn't a (supported) class symbol</returns>
+    public static string Undecorate(string symbol)
+    {
+        if (symbol == null || symbol.Length < 2 || symbol[0] != '?')
+            return null;
+        try
+        {
+            Parser parser = new Parser(symbol, 1);
+            string name = parser.ParseQualifiedName(new List<string>());
+            return parser.AtEnd ? name : null;
+        }
+        catch (FormatException)
+        {
+            return null;
+        }
+    }
+
+    private class Parser
+    {
+        private readonly string _symbol;
+        private int _position;
+
+        public bool AtEnd => _position == _symbol.Length;
+
+        public Parser(string symbol, int position)
+        {
+            _symbol = symbol;
+            _position = position;
+        }
+
+        private char Peek() => _position < _symbol.Length ? _symbol[_position] : throw new FormatException("Unexpected end of symbol");
+
+        private char Next()
+        {
+            char c = Peek();
+            _position++;
+            return c;
+        }
+
+        private void Expect(char expected)
+        {
+            if (Next() != expected)
+                throw new FormatException($"Expected '{expected}' at {_position - 1}");
+        }
+
+        private static void Remember(List<string> names, string name)
+        {
+            if (names.Count < MaxBackReferences && !names.Contains(name))
+                names.Add(name);
+        }
+
+        /// <summary>
+        /// Name fragments, innermost first, terminated by '@'
+        /// </summary>
+        public string ParseQualifiedName(List<string> names)
+        {
+            List<string> fragments = new List<string>();
+            while (Peek() != '@')
+                fragments.Add(ParseNameFragment(names));
+            _position++;
+            if (fragments.Count == 0)
+                throw new FormatException("Empty name");
+
+            fragments.Reverse();
+            return string.Join("::", fragments);
+        }
+
+        private string ParseNameFragment(List<string> names)
+        {
+            char c = Peek();
+            if (char.IsDigit(c))
+            {
+                _position++;
+                int index = c - '0';
+                if (index >= names.Count)
+                    throw new FormatException($"Back-reference {index} to an unknown name");
+                return names[index];
+            }
+
+            if (c == '?')
+            {
+                _position++;
+                char kind = Next();
+                if (kind == '$')
+                {
+                    string template = ParseTemplate();
+                    Remember(names, template);
+                    return template;
+                }
+                if (kind == 'A')
+                {
+                    // "?A0x1234abcd@"
+                    ParseSimpleName();
+                    const string anonymous = "`anonymous namespace'";
+                    Remember(names, anonymous);
+                    return anonymous;
+                }
+                throw new FormatException($"Unsupported special name '?{kind}'");
+            }
+
+            string simple = ParseSimpleName();
+            Remember(names, simple);
+            return simple;
+        }
+
+        private string ParseSimpleName()
+        {
+            int start = _position;
+            while (Peek() != '@')
+            {
+                char c = _symbol[_position];
+                if (c < 0x20 || c > 0x7e)
+                    throw new FormatException("Non-printable character in name");
+                _position++;
+            }
+            if (_position == start)
+                throw new FormatException("Empty name");
+            _position++;
+            return _symbol.Substring(start, _position - 1 - start);
+        }
+
+        private string ParseTemplate()
+        {
+            string name = ParseSimpleName();
+            // Template arguments have their own back-references, starting with the template's name
+            List<string> names = new List<string>() { name };
+            List<string> types = new List<string>();
+            List<string> arguments = new List<string>();
+            while (Peek() != '@')
+            {
+                string argument = ParseTemplateArgument(names, types);
+                if (argument != null)
+                    arguments.Add(argument);
+            }
+            _position++;
+
+            StringBuilder sb = new StringBuilder(name).Append('<').Append(string.Join(",", arguments));
+            // DbgHelp keeps ">>" apart
+            if (sb[sb.Length - 1] == '>')
+                sb.Append(' ');
+            return sb.Append('>').ToString();
+        }
+
+        /// <returns>The argument, or null for arguments which don't show (empty packs)</returns>
+        private string ParseTemplateArgument(List<string> names, List<string> types)
+        {
+            if (Peek() != '$')
+                return ParseType(names, types);
+
+            _position++;
+            char kind = Next();
+            if (kind == '0')
+                return ParseNumber().ToString();
+            if (kind == '$')
+            {
+                char inner = Peek();
+                if (inner == 'V' || inner == 'Z')
+                {
+                    _position++;
+                    return null;
+                }
+                // "$$Q" rvalue references and friends are parsed as types
+                _position -= 2;
+                return ParseType(names, types);
+            }
+            throw new FormatException($"Unsupported template argument '${kind}'");
+        }
+
+        private long ParseNumber()
+        {
+            bool negative = Peek() == '?';
+            if (negative)
+                _position++;
+
+            long value;
+            char c = Next();
+            if (char.IsDigit(c))
+            {
+                value = c - '0' + 1;
+            }
+            else
+            {
+                value = 0;
+                while (c != '@')
+                {
+                    if (c < 'A' || c > 'P')
+                        throw new FormatException("Bad number encoding");
+                    value = value * 16 + (c - 'A');
+                    c = Next();
+                }
+            }
+            return negative ? -value : value;
+        }
+
+        private string ParseType(List<string> names, List<string> types)
+        {
+            int start = _position;
+            char c = Next();
+            if (char.IsDigit(c))
+            {
+                int index = c - '0';
+                if (index >= types.Count)
+                    throw new FormatException($"Back-reference {index} to an unknown type");
+                return types[index];
+            }
+
+            string type = c switch
+            {
+                'C' => "signed char",
+                'D' => "char",
+                'E' => "unsigned char",
+                'F' => "short",
+                'G' => "unsigned short",
+                'H' => "int",
+                'I' => "unsigned int",
+                'J' => "long",
+                'K' => "unsigned long",
+                'M' => "float",
+                'N' => "double",
+                'O' => "long double",
+                'X' => "void",
+                '_' => ParseExtendedType(),
+                'V' => "class " + ParseQualifiedName(names),
+                'U' => "struct " + ParseQualifiedName(names),
+                'T' => "union " + ParseQualifiedName(names),
+                'W' => ParseEnum(names),
+                'P' or 'Q' or 'R' or 'S' or 'A' => ParseIndirection(c, names, types),
+                '$' => ParseRvalueReference(names, types),
+                _ => throw new FormatException($"Unsupported type '{c}'")
+            };
+
+            // Only types longer than a single character can be referenced back
+            if (_position - start > 1 && types.Count < MaxBackReferences)
+                types.Add(type);
+            return type;
+        }
+
+        private string ParseExtendedType() => Next() switch
+        {
+            'J' => "__int64",
+            'K' => "unsigned __int64",
+            'N' => "bool",
+            'Q' => "char8_t",
+            'S' => "char16_t",
+            'U' => "char32_t",
+            'W' => "wchar_t",
+            char c => throw new FormatException($"Unsupported type '_{c}'")
+        };
+
+        private string ParseEnum(List<string> names)
+        {
+            // Enums are always encoded as "W4" nowadays
+            Expect('4');
+            return "enum " + ParseQualifiedName(names);
+        }
+
+        private string ParseIndirection(char kind, List<string> names, List<string> types)
+        {
+            string symbol = kind == 'A' ? "&" : "*";
+            string pointerQualifier = kind switch
+            {
+                'Q' => " const",
+                'R' => " volatile",
+                'S' => " const volatile",
+                _ => ""
+            };
+            return ParsePointee(symbol, pointerQualifier, names, types);
+        }
+
+        private string ParseRvalueReference(List<string> names, List<string> types)
+        {
+            Expect('$');
+            Expect('Q');
+            return ParsePointee("&&", "", names, types);
+        }
+
+        private string ParsePointee(string symbol, string pointerQualifier, List<string> names, List<string> types)
+        {
+            bool ptr64 = Peek() == 'E';
+            if (ptr64)
+                _position++;
+            string pointeeQualifier = Next() switch
+            {
+                'A' => "",
+                'B' => " const",
+                'C' => " volatile",
+                'D' => " const volatile",
+                char c => throw new FormatException($"Unsupported pointee qualifier '{c}'")
+            };
+            string pointee = ParseType(names, types);
+            return $"{pointee}{pointeeQualifier} {symbol}{(ptr64 ? " __ptr64" : "")}{pointerQualifier}";
+        }
+    }
+}
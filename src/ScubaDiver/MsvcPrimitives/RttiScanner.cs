@@ -8,7 +8,7 @@ using Windows.Win32.Foundation;
 
 namespace ScubaDiver.Rtti;
 
-public unsafe struct RttiScanner : IDisposable
+public unsafe struct RttiScanner : IDisposable, IRttiMemory
 {
     private nuint _baseAddress;
     private nuint _size;
@@ -94,22 +94,8 @@ public unsafe struct RttiScanner : IDisposable
 
     public string GetClassName64(ulong address, IReadOnlyList<ModuleSection> sections)
     {
-        if (!TryRead(address - 0x08, out ulong object_locator)) return null;
-
-        // January 2025: Trying to optimize this
-        //bool IsInSection(ModuleSection section) => object_locator >= section.BaseAddress && object_locator <= section.BaseAddress + section.Size;
-        //bool isInOutOfTheSection = sections.Any(IsInSection);
-        //if (!isInOutOfTheSection)
-        //    return null;
-
-        if (!TryRead(object_locator + 0x14, out ulong base_offset)) return null;
-        ulong base_address = object_locator - base_offset;
-        if (!TryRead(object_locator + 0x0C, out uint type_descriptor_offset)) return null;
-        ulong class_name = base_address + type_descriptor_offset + 0x10 + 0x04;
-        byte* buffer = stackalloc byte[BUFFER_SIZE];
-        buffer[0] = (byte)'?';
-        if (!TryRead(class_name, BUFFER_SIZE - 1, buffer + 1)) return null;
-        return UnDecorateSymbolNameWrapper(buffer);
+        string classSymbol = RttiTypeDiscovery.GetClassSymbol64(ref this, address);
+        return classSymbol != null ? UnDecorateSymbolNameWrapper(classSymbol) : null;
     }
 
     private static object _dbgHelpLock = new object();
@@ -122,29 +108,19 @@ public unsafe struct RttiScanner : IDisposable
             return len != 0 ? Encoding.UTF8.GetString(target, (int)len) : null;
         }
     }
-    public static string UnDecorateSymbolNameWrapper(string buffer)
+    public static string UnDecorateSymbolNameWrapper(string buffer, uint flags = 0x1800)
     {
         lock (_dbgHelpLock)
         {
             byte* target = stackalloc byte[BUFFER_SIZE];
-            uint len = PInvoke.UnDecorateSymbolName(buffer, new PSTR(target), BUFFER_SIZE, 0x1800);
+            uint len = PInvoke.UnDecorateSymbolName(buffer, new PSTR(target), BUFFER_SIZE, flags);
             return len != 0 ? Encoding.UTF8.GetString(target, (int)len) : null;
         }
     }
 
     public string GetClassName32(ulong address, IReadOnlyList<ModuleSection> sections)
     {
-        if (!TryRead(address - 0x04, out uint object_locator)) return null;
-        if (!TryRead(object_locator + 0x06, out uint type_descriptor)) return null;
-        ulong class_name = type_descriptor + 0x0C + 0x03;
-        byte* buffer = stackalloc byte[BUFFER_SIZE];
-        buffer[0] = (byte)'?';
-        if (!TryRead(class_name, BUFFER_SIZE - 1, buffer + 1)) return null;
-        lock (_dbgHelpLock)
-        {
-            byte* target = stackalloc byte[BUFFER_SIZE];
-            uint len = PInvoke.UnDecorateSymbolName(new PCSTR(buffer), new PSTR(target), BUFFER_SIZE, 0x1000);
-            return len != 0 ? Encoding.UTF8.GetString(target, (int)len) : null;
-        }
+        string classSymbol = RttiTypeDiscovery.GetClassSymbol32(ref this, address);
+        return classSymbol != null ? UnDecorateSymbolNameWrapper(classSymbol, 0x1000) : null;
     }
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+using System;
+using System.Collections.Generic;
+using System.Text;
+
+namespace ScubaDiver.Rtti;
+
+/// <summary>
+/// Memory the RTTI discovery reads from. Implemented over a live process (<see cref="RttiScanner"/>) and over snapshots.
+/// </summary>
+public unsafe interface IRttiMemory
+{
+    bool TryRead(ulong address, int count, void* buffer);
+}
+
+/// <summary>
+/// Finds First-Class types by looking for vftables in a module's data sections.
+/// Independent of where the memory comes from, so live scans and offline (snapshot) scans find the same types.
+/// </summary>
+public static unsafe class RttiTypeDiscovery
+{
+    private const int BufferSize = 256;
+
+    /// <summary>
+    /// Reads the name of the type whose vftable might be at the given address (64-bit layout).
+    /// The name is returned as the symbol "?name@namespace@@" which undecorates to the full class name.
+    /// </summary>
+    /// <returns>The symbol or null if the address doesn't look like a vftable</returns>
+    public static string GetClassSymbol64<TMemory>(ref TMemory memory, ulong address) where TMemory : struct, IRttiMemory
+    {
+        ulong objectLocator;
+        if (!memory.TryRead(address - 0x08, sizeof(ulong), &objectLocator)) return null;
+        ulong baseOffset;
+        if (!memory.TryRead(objectLocator + 0x14, sizeof(ulong), &baseOffset)) return null;
+        ulong baseAddress = objectLocator - baseOffset;
+        uint typeDescriptorOffset;
+        if (!memory.TryRead(objectLocator + 0x0C, sizeof(uint), &typeDescriptorOffset)) return null;
+
+        byte* buffer = stackalloc byte[BufferSize];
+        if (!memory.TryRead(baseAddress + typeDescriptorOffset + 0x10, BufferSize, buffer)) return null;
+        // Type descriptor names are decorated like ".?AVname@namespace@@". Anything else is a false positive.
+        if (buffer[0] != '.' || buffer[1] != '?' || buffer[2] != 'A')
+            return null;
+        return ToSymbol(buffer + 4, BufferSize - 4);
+    }
+
+    /// <summary>
+    /// Reads the name of the type whose vftable might be at the given address (32-bit layout).
+    /// The name is returned as the symbol "?name@namespace@@" which undecorates to the full class name.
+    /// </summary>
+    /// <returns>The symbol or null if the address doesn't look like a vftable</returns>
+    public static string GetClassSymbol32<TMemory>(ref TMemory memory, ulong address) where TMemory : struct, IRttiMemory
+    {
+        uint objectLocator;
+        if (!memory.TryRead(address - 0x04, sizeof(uint), &objectLocator)) return null;
+        uint typeDescriptor;
+        if (!memory.TryRead(objectLocator + 0x06, sizeof(uint), &typeDescriptor)) return null;
+
+        byte* buffer = stackalloc byte[BufferSize];
+        if (!memory.TryRead((ulong)typeDescriptor + 0x0C + 0x03, BufferSize - 1, buffer)) return null;
+        return ToSymbol(buffer, BufferSize - 1);
+    }
+
+    private static string ToSymbol(byte* name, int maxLength)
+    {
+        int length = 0;
+        while (length < maxLength && name[length] != 0)
+            length++;
+        return "?" + Encoding.ASCII.GetString(name, length);
+    }
+
+    /// <summary>
+    /// Sections which might hold vftables
+    /// </summary>
+    public static bool IsRttiSection(ModuleSection section) =>
+        section.Name.ToUpper().Contains("DATA") || section.Name.ToUpper().Contains("RTTI");
+
+    /// <summary>
+    /// Scans the data sections of a module for vftables
+    /// </summary>
+    /// <param name="memory">Memory holding at least the module's sections</param>
+    /// <param name="undecorate">Turns a class symbol (see <see cref="GetClassSymbol64{TMemory}"/>) into the full class name, or null if it can't</param>
+    /// <returns>The found types. Empty if the module has no RTTI.</returns>
+    public static List<TypeInfo> ScanModule<TMemory>(ref TMemory memory, RichModuleInfo richModule, bool is32Bit,
+        Func<string, string> undecorate) where TMemory : struct, IRttiMemory
+    {
+        bool typeInfoSeenInModule = false;
+        List<TypeInfo> allModuleTypes = new();
+        foreach (ModuleSection section in richModule.GetSections(IsRttiSection))
+        {
+            (bool typeInfoSeenInSection, List<TypeInfo> types) = ScanSection(ref memory, richModule.ModuleInfo.Name, section, is32Bit, undecorate);
+            typeInfoSeenInModule = typeInfoSeenInModule || typeInfoSeenInSection;
+            if (typeInfoSeenInModule)
+            {
+                allModuleTypes.AddRange(types);
+            }
+        }
+        return allModuleTypes;
+    }
+
+    /// <summary>
+    /// Scans a section for vftables
+    /// </summary>
+    /// <param name="undecorate">Turns a class symbol (see <see cref="GetClassSymbol64{TMemory}"/>) into the full class name, or null if it can't</param>
+    /// <returns>Whether the "type_info" type was seen and the found types</returns>
+    private static (bool typeInfoSeen, List<TypeInfo> types) ScanSection<TMemory>(ref TMemory memory, string moduleName,
+        ModuleSection section, bool is32Bit, Func<string, string> undecorate) where TMemory : struct, IRttiMemory
+    {
+        nuint sectionBaseAddress = (nuint)section.BaseAddress;
+        nuint sectionSize = (nuint)section.Size;
+        List<TypeInfo> list = new();
+
+        // Whether the "type_info" type was seen.
+        // This is a sanity check for RTTI existence. If "type_info"
+        // is missing all our "findings" are actually false positives
+        bool typeInfoSeen = false;
+
+        // Used to FORCE the change of the vftable var value in the loop
+        nuint dummySum = 0;
+        nuint inc = (nuint)(is32Bit ? 4 : 8);
+        for (nuint offset = inc; offset < sectionSize; offset += inc)
+        {
+            nuint possibleVftableAddress = sectionBaseAddress + offset;
+            string classSymbol = is32Bit
+                ? GetClassSymbol32(ref memory, possibleVftableAddress)
+                : GetClassSymbol64(ref memory, possibleVftableAddress);
+            if (classSymbol != null && undecorate(classSymbol) is string fullClassName)
+            {
+                // Avoiding names with the "BEL" control ASCII char specifically.
+                // The heuristic search in this method finds a lot of garbage, but this one is particularly
+                // annoying because trying to print any type's "name" containing
+                // "BEL" to the console will trigger a *ding* sound.
+                if (fullClassName.Contains('\a'))
+                    continue;
+
+                if (fullClassName == "type_info")
+                    typeInfoSeen = true;
+
+                // split fullClassName into namespace and class name
+                int lastIndexOfColonColon = fullClassName.LastIndexOf("::");
+                // take into consideration that "::" might no be present at all, and the namespace is empty
+                string namespaceName = lastIndexOfColonColon == -1 ? "" : fullClassName.Substring(0, lastIndexOfColonColon);
+                string typeName = lastIndexOfColonColon == -1 ? fullClassName : fullClassName.Substring(lastIndexOfColonColon + 2);
+
+                list.Add(new FirstClassTypeInfo(moduleName, namespaceName, typeName, possibleVftableAddress, offset));
+            }
+
+            // Destroy false positives by moving to the next possible vftable address
+            possibleVftableAddress ^= 0xa5a5a5a5;
+            dummySum += possibleVftableAddress; // So the compiler doesn't optimize the above line out
+        }
+
+        // Use the dummySum to avoid compiler optimizations
+        dummySum.ToString();
+
+        return (typeInfoSeen, list);
+    }
+}
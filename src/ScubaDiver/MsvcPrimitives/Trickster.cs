@@ -52,60 +52,21 @@ public unsafe class Trickster
         _is32Bit = is32Bit;
     }
 
-    private (bool typeInfoSeen, List<TypeInfo>) ScanTypesCore(RichModuleInfo richModule, ModuleSection currSection)
+    private List<TypeInfo> ScanTypesCore(RichModuleInfo richModule)
     {
-        nuint sectionBaseAddress = (nuint)currSection.BaseAddress;
-        nuint sectionSize = (nuint)currSection.Size;
-        List<TypeInfo> list = new();
-
-        // Whether the "type_info" type was seen.
-        // This is a sanity check for RTTI existence. If "type_info"
-        // is missing all our "findings" are actually false positives
-        bool typeInfoSeen = false;
-
         ModuleInfo module = richModule.ModuleInfo;
-        IReadOnlyList<ModuleSection> sections = richModule.Sections;
-
-        // Used to FORCE the change of the vftable var value in the loop
-        nuint dummySum = 0;
-        using (RttiScanner processMemory = new(_processHandle, module.BaseAddress, module.Size, sections))
+        RttiScanner processMemory = new(_processHandle, module.BaseAddress, module.Size, richModule.Sections);
+        try
         {
-            nuint inc = (nuint)(_is32Bit ? 4 : 8);
-            Func<ulong, IReadOnlyList<ModuleSection>, string> getClassName = _is32Bit ? processMemory.GetClassName32 : processMemory.GetClassName64;
-            for (nuint offset = inc; offset < sectionSize; offset += inc)
-            {
-                nuint possibleVftableAddress = sectionBaseAddress + offset;
-                if (getClassName(possibleVftableAddress, sections) is string fullClassName)
-                {
-                    // Avoiding names with the "BEL" control ASCII char specifically.
-                    // The heuristic search in this method finds a lot of garbage, but this one is particularly 
-                    // annoying because trying to print any type's "name" containing
-                    // "BEL" to the console will trigger a *ding* sound.
-                    if (fullClassName.Contains('\a'))
-                        continue;
-
-                    if (fullClassName == "type_info")
-                        typeInfoSeen = true;
-
-                    // split fullClassName into namespace and class name
-                    int lastIndexOfColonColon = fullClassName.LastIndexOf("::");
-                    // take into consideration that "::" might no be present at all, and the namespace is empty
-                    string namespaceName = lastIndexOfColonColon == -1 ? "" : fullClassName.Substring(0, lastIndexOfColonColon);
-                    string typeName = lastIndexOfColonColon == -1 ? fullClassName : fullClassName.Substring(lastIndexOfColonColon + 2);
-
-                    list.Add(new FirstClassTypeInfo(module.Name, namespaceName, typeName, possibleVftableAddress, offset));
-                }
-
-                // Destroy false positives by moving to the next possible vftable address
-                possibleVftableAddress ^= 0xa5a5a5a5;
-                dummySum += possibleVftableAddress; // So the compiler doesn't optimize the above line out
-            }
+            Func<string, string> undecorate = _is32Bit
+                ? classSymbol => RttiScanner.UnDecorateSymbolNameWrapper(classSymbol, 0x1000)
+                : classSymbol => RttiScanner.UnDecorateSymbolNameWrapper(classSymbol);
+            return RttiTypeDiscovery.ScanModule(ref processMemory, richModule, _is32Bit, undecorate);
+        }
+        finally
+        {
+            processMemory.Dispose();
         }
-
-        // Use the dummySum to avoid compiler optimizations
-        dummySum.ToString();
-
-        return (typeInfoSeen, list);
     }
 
     private Dictionary<RichModuleInfo, List<TypeInfo>> ScanTypesCore()
@@ -116,50 +77,19 @@ public unsafe class Trickster
         List<RichModuleInfo> dataSections = GetRichModules(skip);
         foreach (RichModuleInfo richModule in dataSections)
         {
-            Func<ModuleSection, bool> filter = (s) => s.Name.ToUpper().Contains("DATA") ||
-                                                      s.Name.ToUpper().Contains("RTTI");
-            IReadOnlyList<ModuleSection> sections = richModule.GetSections(filter).ToList();
-
-            bool typeInfoSeenInModule = false;
-            List<TypeInfo> allModuleTypes = new();
-            foreach (ModuleSection section in sections)
+            if (res.ContainsKey(richModule))
             {
-                try
-                {
-                    (bool typeInfoSeenInSeg, List<TypeInfo> types) = ScanTypesCore(richModule, section);
-
-                    typeInfoSeenInModule = typeInfoSeenInModule || typeInfoSeenInSeg;
-
-                    if (typeInfoSeenInModule)
-                    {
-                        if (allModuleTypes.Count == 0)
-                        {
-                            // optimized(?) - swap lists instead of copy
-                            allModuleTypes = types;
-                        }
-                        else
-                        {
-                            allModuleTypes.AddRange(types);
-                        }
-                    }
-                }
-                catch (Exception ex)
-                {
-                    Console.WriteLine($"[Error] Couldn't scan for RTTI info in {richModule.ModuleInfo.Name}, EX: " + ex.GetType().Name);
-                }
+                Logger.Debug("[ScanTypesCore] WTF module alraedy exists in final dictionary... ???");
             }
 
-            if (typeInfoSeenInModule && allModuleTypes.Any())
+            try
             {
-                if (res.ContainsKey(richModule))
-                {
-                    Logger.Debug("[ScanTypesCore] WTF module alraedy exists in final dictionary... ???");
-                }
-                res[richModule] = allModuleTypes;
+                // Modules without types might just be non-MSVC ones, they get an empty list
+                res[richModule] = ScanTypesCore(richModule);
             }
-            else
+            catch (Exception ex)
             {
-                // No types in this module. Might just be non-MSVC one so we add a dummy
+                Console.WriteLine($"[Error] Couldn't scan for RTTI info in {richModule.ModuleInfo.Name}, EX: " + ex.GetType().Name);
                 res[richModule] = new List<TypeInfo>();
             }
         }
@@ -1,4 +1,5 @@
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Diagnostics;
 using System.Linq;
@@ -16,9 +17,15 @@ public class TricksterWrapper
 {
     private Trickster _trickster;
     private object _tricksterLock;
-    private Dictionary<string, UndecoratedModule> _undecModeulesCache = new Dictionary<string, UndecoratedModule>();
+    // Lazy entries make sure each module is only processed once, even when it's requested by several threads at once
+    private ConcurrentDictionary<string, Lazy<UndecoratedModule>> _undecModeulesCache = new();
     public ExportsMaster ExportsMaster { get; set; }
 
+    /// <summary>
+    /// Raised after every scan of the process' modules, whichever path triggered it. Handlers run under the wrapper's lock.
+    /// </summary>
+    public event Action ModulesScanned;
+
     public TricksterWrapper()
     {
         _trickster = null;
@@ -78,6 +85,8 @@ public class TricksterWrapper
             _lastRefreshModules = p.Modules.Cast<ProcessModule>()
                 .Select(pModule => pModule.ModuleName)
                 .ToHashSet();
+
+            ModulesScanned?.Invoke();
         }
     }
 
@@ -135,6 +144,7 @@ public class TricksterWrapper
     /// </summary>
     public List<UndecoratedModule> GetUndecoratedModules(Predicate<string> moduleNameFilter)
     {
+        List<KeyValuePair<RichModuleInfo, List<TypeInfo>>> matches;
         lock (_tricksterLock)
         {
             Dictionary<RichModuleInfo, List<TypeInfo>> modulesAndTypes = GetDecoratedTypes();
@@ -145,213 +155,209 @@ public class TricksterWrapper
                 modulesAndTypes = GetDecoratedTypes();
             }
 
-            List<UndecoratedModule> output = new();
-            foreach (KeyValuePair<RichModuleInfo, List<TypeInfo>> kvp in modulesAndTypes)
-            {
-                // First check if module passes the filter
-                RichModuleInfo module = kvp.Key;
-                ModuleInfo moduleInfo = module.ModuleInfo;
-                if (!moduleNameFilter(moduleInfo.Name))
-                    continue;
-
-                // Check in the cache if we already processed this module
-                if (!_undecModeulesCache.TryGetValue(moduleInfo.Name, out UndecoratedModule undecModule))
-                {
-                    // Unprocessed module. Processing now...
-                    // Generate the undecorated module and save in cache
-                    undecModule = GenerateUndecoratedModule(module, kvp.Value);
-                    _undecModeulesCache[module.ModuleInfo.Name] = undecModule;
-                }
+            matches = modulesAndTypes.Where(kvp => moduleNameFilter(kvp.Key.ModuleInfo.Name)).ToList();
+        }
 
-                // store this module for the output
-                output.Add(undecModule);
+        // Unprocessed modules are processed outside the lock and in parallel
+        UndecoratedModule[] output = new UndecoratedModule[matches.Count];
+        Parallel.For(0, matches.Count, i =>
+        {
+            RichModuleInfo module = matches[i].Key;
+            List<TypeInfo> types = matches[i].Value;
+            Lazy<UndecoratedModule> lazyModule = _undecModeulesCache.GetOrAdd(module.ModuleInfo.Name,
+                _ => new Lazy<UndecoratedModule>(() => GenerateUndecoratedModule(module, types)));
+            try
+            {
+                output[i] = lazyModule.Value;
             }
-
-            return output;
-        }
+            catch
+            {
+                // Don't cache failures, the next request tries again
+                _undecModeulesCache.TryRemove(new KeyValuePair<string, Lazy<UndecoratedModule>>(module.ModuleInfo.Name, lazyModule));
+                throw;
+            }
+        });
+        return output.ToList();
     }
 
     private UndecoratedModule GenerateUndecoratedModule(RichModuleInfo richModule, List<TypeInfo> firstClassTypes)
     {
-        lock (_tricksterLock)
+        UndecoratedModule undecModule = new UndecoratedModule(richModule.ModuleInfo.Name, richModule);
+
+        Dictionary<string, TypeInfo> allClassTypes = new();
+        foreach (TypeInfo curr in firstClassTypes)
         {
-            UndecoratedModule undecModule = new UndecoratedModule(richModule.ModuleInfo.Name, richModule);
+            FirstClassTypeInfo currFirstClassType = curr as FirstClassTypeInfo;
 
-            Dictionary<string, TypeInfo> allClassTypes = new();
-            foreach (TypeInfo curr in firstClassTypes)
+            if (allClassTypes.TryGetValue(curr.FullTypeName, out TypeInfo collectedClassType))
             {
-                FirstClassTypeInfo currFirstClassType = curr as FirstClassTypeInfo;
-
-                if (allClassTypes.TryGetValue(curr.FullTypeName, out TypeInfo collectedClassType))
-                {
-                    (collectedClassType as FirstClassTypeInfo).AddSecondaryVftable(currFirstClassType.VftableAddress);
-                }
-                else
-                {
-                    allClassTypes[curr.FullTypeName] = new FirstClassTypeInfo(
-                        currFirstClassType.ModuleName,
-                        currFirstClassType.Namespace,
-                        currFirstClassType.Name,
-                        currFirstClassType.VftableAddress,
-                        currFirstClassType.Offset);
-                }
+                (collectedClassType as FirstClassTypeInfo).AddSecondaryVftable(currFirstClassType.VftableAddress);
             }
-            HashSet<string> allClassTypesNames = allClassTypes.Select(x => x.Value.NamespaceAndName).ToHashSet();
-
-            // Collect 2nd-class types & removing ALL ctors from the exports list (for 1st or 2nd class types).
-
-            // First, going over exports and looking for constructors.
-            // Getting all UNEDCORATED exports, type funcs and typeless
-            HashSet<UndecoratedSymbol> allUndecoratedExports = ExportsMaster.GetUndecoratedExports(undecModule.ModuleInfo).ToHashSet();
-            foreach (UndecoratedSymbol undecSymbol in allUndecoratedExports)
+            else
             {
-                if (undecSymbol is not UndecoratedFunction ctor)
-                    continue;
-
-                string undecExportName = ctor.UndecoratedFullName;
-                if (!IsCtorName(undecExportName, out int lastDoubleColonIndex))
-                    continue;
+                allClassTypes[curr.FullTypeName] = new FirstClassTypeInfo(
+                    currFirstClassType.ModuleName,
+                    currFirstClassType.Namespace,
+                    currFirstClassType.Name,
+                    currFirstClassType.VftableAddress,
+                    currFirstClassType.Offset);
+            }
+        }
+        HashSet<string> allClassTypesNames = allClassTypes.Select(x => x.Value.NamespaceAndName).ToHashSet();
 
-                string nameAndNamespace = undecExportName[..lastDoubleColonIndex];
-                if (allClassTypesNames.Contains(nameAndNamespace))
-                {
-                    // This is a previously found first-class/second-class type.
-                    continue;
-                }
+        // Collect 2nd-class types & removing ALL ctors from the exports list (for 1st or 2nd class types).
 
-                // Split fullTypeName to namespace & type name
-                int lastIndexOfColonColon = nameAndNamespace.LastIndexOf("::");
-                // take into consideration that "::" might no be present at all, and the namespace is empty
-                string namespaceName = lastIndexOfColonColon == -1 ? "" : nameAndNamespace.Substring(0, lastIndexOfColonColon);
-                string typeName = lastIndexOfColonColon == -1 ? nameAndNamespace : nameAndNamespace.Substring(lastIndexOfColonColon + 2);
+        // First, going over exports and looking for constructors.
+        // Getting all UNEDCORATED exports, type funcs and typeless
+        HashSet<UndecoratedSymbol> allUndecoratedExports = ExportsMaster.GetUndecoratedExports(undecModule.ModuleInfo).ToHashSet();
+        foreach (UndecoratedSymbol undecSymbol in allUndecoratedExports)
+        {
+            if (undecSymbol is not UndecoratedFunction ctor)
+                continue;
 
-                // NEW 2nd-class type. Adding a new match!
-                TypeInfo ti = new SecondClassTypeInfo(undecModule.Name, namespaceName, typeName);
-                // Store aside as a member of this type
-                allClassTypes.Add(ti.FullTypeName, ti);
-                allClassTypesNames.Add(nameAndNamespace);
-            }
+            string undecExportName = ctor.UndecoratedFullName;
+            if (!IsCtorName(undecExportName, out int lastDoubleColonIndex))
+                continue;
 
-            // Let's find "static" exported classes
-            HashSet<string> staticClassNames = new();
-            foreach (UndecoratedSymbol undecSymbol in allUndecoratedExports)
+            string nameAndNamespace = undecExportName[..lastDoubleColonIndex];
+            if (allClassTypesNames.Contains(nameAndNamespace))
             {
-                if (undecSymbol is not UndecoratedFunction ctor)
-                    continue;
-
-                string undecExportName = ctor.UndecoratedFullName;
-                IsCtorName(undecExportName, out int lastDoubleColonIndex);
-                if (lastDoubleColonIndex == -1)
-                {
-                    // No C++ name format: namespace::classname
-                    continue;
-                }
+                // This is a previously found first-class/second-class type.
+                continue;
+            }
 
-                string nameAndNamespace = undecExportName[..lastDoubleColonIndex];
-                if (allClassTypesNames.Contains(nameAndNamespace))
-                {
-                    // This export belond to a previously found first-class/second-class type (last loop)
-                    continue;
-                }
+            // Split fullTypeName to namespace & type name
+            int lastIndexOfColonColon = nameAndNamespace.LastIndexOf("::");
+            // take into consideration that "::" might no be present at all, and the namespace is empty
+            string namespaceName = lastIndexOfColonColon == -1 ? "" : nameAndNamespace.Substring(0, lastIndexOfColonColon);
+            string typeName = lastIndexOfColonColon == -1 ? nameAndNamespace : nameAndNamespace.Substring(lastIndexOfColonColon + 2);
+
+            // NEW 2nd-class type. Adding a new match!
+            TypeInfo ti = new SecondClassTypeInfo(undecModule.Name, namespaceName, typeName);
+            // Store aside as a member of this type
+            allClassTypes.Add(ti.FullTypeName, ti);
+            allClassTypesNames.Add(nameAndNamespace);
+        }
 
-                if (staticClassNames.Contains(nameAndNamespace))
-                {
-                    // Already found this static class (this loop)
-                    continue;
-                }
+        // Let's find "static" exported classes
+        HashSet<string> staticClassNames = new();
+        foreach (UndecoratedSymbol undecSymbol in allUndecoratedExports)
+        {
+            if (undecSymbol is not UndecoratedFunction ctor)
+                continue;
 
-                // Trying to spot global methods (Might be directly under the first namespace)
-                if (!nameAndNamespace.Contains("::"))
-                {
-                    if (undecSymbol is UndecoratedExportedFunc exportedFunc && exportedFunc.IsGlobal)
-                        continue;
-                }
+            string undecExportName = ctor.UndecoratedFullName;
+            IsCtorName(undecExportName, out int lastDoubleColonIndex);
+            if (lastDoubleColonIndex == -1)
+            {
+                // No C++ name format: namespace::classname
+                continue;
+            }
 
+            string nameAndNamespace = undecExportName[..lastDoubleColonIndex];
+            if (allClassTypesNames.Contains(nameAndNamespace))
+            {
+                // This export belond to a previously found first-class/second-class type (last loop)
+                continue;
+            }
 
-                // Split fullTypeName to namespace & type name
-                int lastIndexOfColonColon = nameAndNamespace.LastIndexOf("::");
-                // take into consideration that "::" might no be present at all, and the namespace is empty
-                string namespaceName = lastIndexOfColonColon == -1 ? "" : nameAndNamespace.Substring(0, lastIndexOfColonColon);
-                string typeName = lastIndexOfColonColon == -1 ? nameAndNamespace : nameAndNamespace.Substring(lastIndexOfColonColon + 2);
+            if (staticClassNames.Contains(nameAndNamespace))
+            {
+                // Already found this static class (this loop)
+                continue;
+            }
 
-                // NEW 2nd-class type. Adding a new match!
-                TypeInfo ti = new SecondClassTypeInfo(undecModule.Name, namespaceName, typeName);
-                // Store aside as a member of this type
-                if (nameAndNamespace == "SPen")
-                {
-                    1.ToString();
+            // Trying to spot global methods (Might be directly under the first namespace)
+            if (!nameAndNamespace.Contains("::"))
+            {
+                if (undecSymbol is UndecoratedExportedFunc exportedFunc && exportedFunc.IsGlobal)
                     continue;
-                }
-
-                allClassTypes.Add(ti.FullTypeName, ti);
-                staticClassNames.Add(nameAndNamespace);
             }
 
 
-            // Now iterate all class Types & search any exports that match their names
-            foreach (TypeInfo typeInfo in allClassTypes.Values)
+            // Split fullTypeName to namespace & type name
+            int lastIndexOfColonColon = nameAndNamespace.LastIndexOf("::");
+            // take into consideration that "::" might no be present at all, and the namespace is empty
+            string namespaceName = lastIndexOfColonColon == -1 ? "" : nameAndNamespace.Substring(0, lastIndexOfColonColon);
+            string typeName = lastIndexOfColonColon == -1 ? nameAndNamespace : nameAndNamespace.Substring(lastIndexOfColonColon + 2);
+
+            // NEW 2nd-class type. Adding a new match!
+            TypeInfo ti = new SecondClassTypeInfo(undecModule.Name, namespaceName, typeName);
+            // Store aside as a member of this type
+            if (nameAndNamespace == "SPen")
             {
-                // $#@!: Is this a hack?
-                undecModule.GetOrAddType(typeInfo);
+                1.ToString();
+                continue;
+            }
 
-                // Find all exported members of the type
-                IEnumerable<UndecoratedSymbol> methods = ExportsMaster.GetExportedTypeMembers(undecModule.ModuleInfo, typeInfo.NamespaceAndName);
-                foreach (UndecoratedSymbol symbol in methods)
-                {
-                    if (symbol is not UndecoratedExportedFunc undecFunc) // TODO: Fields
-                        continue;
+            allClassTypes.Add(ti.FullTypeName, ti);
+            staticClassNames.Add(nameAndNamespace);
+        }
 
-                    // Store aside as a member of this type
-                    undecModule.AddTypeFunction(typeInfo, undecFunc);
 
-                    // Removing type func from allExports
-                    allUndecoratedExports.Remove(undecFunc);
-                }
-            }
+        // Now iterate all class Types & search any exports that match their names
+        foreach (TypeInfo typeInfo in allClassTypes.Values)
+        {
+            // $#@!: Is this a hack?
+            undecModule.GetOrAddType(typeInfo);
 
-            // This list should now hold only typeless symbols.
-            // Which means C++-style, non-class-associated funcs/variables.
-            foreach (UndecoratedSymbol export in allUndecoratedExports)
+            // Find all exported members of the type
+            IEnumerable<UndecoratedSymbol> methods = ExportsMaster.GetExportedTypeMembers(undecModule.ModuleInfo, typeInfo.NamespaceAndName);
+            foreach (UndecoratedSymbol symbol in methods)
             {
-                if (export is not UndecoratedFunction undecFunc)
-                {
-                    //// Logger.Debug("Typeless-export which isn't a function is discarded. Undecorated name: " + export.UndecoratedFullName);
+                if (symbol is not UndecoratedExportedFunc undecFunc) // TODO: Fields
                     continue;
-                }
 
-                undecModule.AddUndecoratedTypelessFunction(undecFunc);
+                // Store aside as a member of this type
+                undecModule.AddTypeFunction(typeInfo, undecFunc);
+
+                // Removing type func from allExports
+                allUndecoratedExports.Remove(undecFunc);
             }
+        }
 
-            // Which means C-style, non-class-associated funcs/variables.
-            List<DllExport> leftoverFunc = ExportsMaster.GetLeftoverExports(undecModule.ModuleInfo).ToList();
-            foreach (DllExport export in leftoverFunc)
+        // This list should now hold only typeless symbols.
+        // Which means C++-style, non-class-associated funcs/variables.
+        foreach (UndecoratedSymbol export in allUndecoratedExports)
+        {
+            if (export is not UndecoratedFunction undecFunc)
             {
-                undecModule.AddRegularTypelessFunction(export);
+                //// Logger.Debug("Typeless-export which isn't a function is discarded. Undecorated name: " + export.UndecoratedFullName);
+                continue;
             }
 
+            undecModule.AddUndecoratedTypelessFunction(undecFunc);
+        }
+
+        // Which means C-style, non-class-associated funcs/variables.
+        List<DllExport> leftoverFunc = ExportsMaster.GetLeftoverExports(undecModule.ModuleInfo).ToList();
+        foreach (DllExport export in leftoverFunc)
+        {
+            undecModule.AddRegularTypelessFunction(export);
+        }
+
 
-            // 'operator new' are most likely not exported. We need the trickster to tell us where they are.
-            if (TryGetOperatorNew(richModule, out List<nuint> operatorNewAddresses))
+        // 'operator new' are most likely not exported. We need the trickster to tell us where they are.
+        if (TryGetOperatorNew(richModule, out List<nuint> operatorNewAddresses))
+        {
+            foreach (nuint operatorNewAddr in operatorNewAddresses)
             {
-                foreach (nuint operatorNewAddr in operatorNewAddresses)
-                {
-                    UndecoratedFunction undecFunction =
-                        new UndecoratedInternalFunction(
-                            undecModule.ModuleInfo,
-                            undecoratedName: "operator new",
-                            undecoratedFullName: "operator new",
-                            decoratedName: "operator new",
-                            operatorNewAddr, 
-                            1,
-                            "void*");
-                    // TODO: Add this is a "regular" typeless func
-                    undecModule.AddUndecoratedTypelessFunction(undecFunction);
-                }
+                UndecoratedFunction undecFunction =
+                    new UndecoratedInternalFunction(
+                        undecModule.ModuleInfo,
+                        undecoratedName: "operator new",
+                        undecoratedFullName: "operator new",
+                        decoratedName: "operator new",
+                        operatorNewAddr, 
+                        1,
+                        "void*");
+                // TODO: Add this is a "regular" typeless func
+                undecModule.AddUndecoratedTypelessFunction(undecFunction);
             }
-
-            return undecModule;
         }
 
+        return undecModule;
+
 
         bool IsCtorName(string fullName, out int lastDoubleColonIndex)
         {
@@ -15,6 +15,7 @@ public class UndecoratedModule
 
     private Dictionary<string, Rtti.TypeInfo> _namesToTypes;
     private Dictionary<Rtti.TypeInfo, UndecoratedType> _types;
+    private TypeNameIndex<Rtti.TypeInfo> _typesIndex;
     private Dictionary<string, UndecoratedMethodGroup> _undecoratedTypelessFunctions;
     private Dictionary<string, List<DllExport>> _leftoverTypelessFunctions;
 
@@ -23,6 +24,7 @@ public class UndecoratedModule
         Name = name;
         _namesToTypes = new Dictionary<string, TypeInfo>();
         _types = new Dictionary<Rtti.TypeInfo, UndecoratedType>();
+        _typesIndex = new TypeNameIndex<TypeInfo>();
         _undecoratedTypelessFunctions = new Dictionary<string, UndecoratedMethodGroup>();
         _leftoverTypelessFunctions = new Dictionary<string, List<DllExport>>();
         RichModule = richModule;
@@ -31,6 +33,16 @@ public class UndecoratedModule
 
     public IEnumerable<Rtti.TypeInfo> Types => _types.Keys;
 
+    /// <summary>
+    /// Finds the types whose namespace and name match a "simple filter" (see <see cref="ScubaDiver.API.Utils.Filter"/>)
+    /// </summary>
+    public IEnumerable<Rtti.TypeInfo> FindTypes(string rawTypeFilter) => _typesIndex.Query(rawTypeFilter);
+
+    /// <summary>
+    /// Finds the types whose namespace and name are exactly <paramref name="namespaceAndName"/>, wildcards included
+    /// </summary>
+    public IEnumerable<Rtti.TypeInfo> FindTypesByExactName(string namespaceAndName) => _typesIndex.Exact(namespaceAndName);
+
     public bool TryGetType(Rtti.TypeInfo type, out UndecoratedType res)
         => _types.TryGetValue(type, out res);
     public bool TryGetType(string name, out UndecoratedType res)
@@ -90,7 +102,10 @@ public class UndecoratedModule
             _namesToTypes[type.Name] = type;
 
         if (!_types.ContainsKey(type))
+        {
             _types[type] = new UndecoratedType();
+            _typesIndex.Add(type.NamespaceAndName, type);
+        }
         return _types[type];
     }
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+using System;
+using System.Collections.Concurrent;
+using System.Diagnostics;
+using System.Threading;
+
+namespace ScubaDiver;
+
+/// <summary>
+/// Schedules diver requests on two lanes:
+/// * Interactive - Short requests (get_field, invoke, ping, ...) which a user is usually actively waiting for.
+/// * Bulk - Heavy requests (heap scans, types dumps, ...) which may run for seconds.
+/// Each lane has its own workers so a storm of bulk requests can't delay interactive ones.
+/// Every scheduled request gets its own cancellation token, linked to its connection's one, which can be
+/// cancelled by request ID using <see cref="Cancel"/>.
+/// </summary>
+public class RequestsScheduler : IDisposable
+{
+    public const int BulkWorkersCount = 2;
+
+    private readonly Action<ScubaDiverMessage> _execute;
+    private readonly Predicate<string> _isBulkEndpoint;
+    private readonly RequestsWorkerPool _interactiveLane;
+    private readonly RequestsWorkerPool _bulkLane;
+
+    // <(Connection ID, Request ID) to: Cancellation source of the request>
+    private readonly ConcurrentDictionary<(int, string), CancellationTokenSource> _pending = new();
+
+    public RequestsScheduler(string name, Action<ScubaDiverMessage> execute, Predicate<string> isBulkEndpoint)
+    {
+        _execute = execute;
+        _isBulkEndpoint = isBulkEndpoint;
+        _interactiveLane = new RequestsWorkerPool($"{name} Interactive", RequestsWorkerPool.DefaultWorkersCount);
+        _bulkLane = new RequestsWorkerPool($"{name} Bulk", BulkWorkersCount);
+    }
+
+    public int InteractiveQueuedCount => _interactiveLane.QueuedCount;
+    public int BulkQueuedCount => _bulkLane.QueuedCount;
+
+    public void Schedule(ScubaDiverMessage request)
+    {
+        CancellationTokenSource cts = CancellationTokenSource.CreateLinkedTokenSource(request.CancellationToken);
+        request.CancellationToken = cts.Token;
+        request.ScheduledTimestamp = Stopwatch.GetTimestamp();
+
+        (int, string) key = (request.ConnectionId, request.RequestId);
+        bool tracked = key.Item2 != null && _pending.TryAdd(key, cts);
+
+        RequestsWorkerPool lane = _isBulkEndpoint(request.UrlAbsolutePath) ? _bulkLane : _interactiveLane;
+        lane.Enqueue(() =>
+        {
+            try
+            {
+                // Requests cancelled while queued are still handed to the executor so they get an answer.
+                _execute(request);
+            }
+            finally
+            {
+                if (tracked)
+                    _pending.TryRemove(key, out _);
+                cts.Dispose();
+            }
+        });
+    }
+
+    /// <returns>True if a pending request was found and signaled, False otherwise</returns>
+    public bool Cancel(int connectionId, string requestId)
+    {
+        if (!_pending.TryGetValue((connectionId, requestId), out CancellationTokenSource cts))
+            return false;
+
+        try
+        {
+            cts.Cancel();
+            return true;
+        }
+        catch (ObjectDisposedException)
+        {
+            // Request finished in the meantime
+            return false;
+        }
+    }
+
+    public void Dispose()
+    {
+        _interactiveLane.Dispose();
+        _bulkLane.Dispose();
+    }
+}
@@ -0,0 +1,73 @@
+using System;
+using System.Collections.Concurrent;
+using System.Threading;
+using ScubaDiver.Hooking;
+
+namespace ScubaDiver;
+
+/// <summary>
+/// A fixed set of dedicated threads which execute diver requests.
+/// Using our own threads (instead of a Task.Run per request) means a burst of heavy requests can't starve the
+/// thread pool, which is where the sockets' async reads and writes complete.
+/// </summary>
+public class RequestsWorkerPool : IDisposable
+{
+    private readonly BlockingCollection<Action> _queue = new();
+    private readonly Thread[] _workers;
+
+    public static int DefaultWorkersCount => Math.Max(2, Math.Min(Environment.ProcessorCount, 8));
+
+    public int QueuedCount => _queue.Count;
+
+    public RequestsWorkerPool(string name, int workersCount)
+    {
+        if (workersCount <= 0)
+            throw new ArgumentOutOfRangeException(nameof(workersCount));
+
+        _workers = new Thread[workersCount];
+        for (int i = 0; i < workersCount; i++)
+        {
+            _workers[i] = new Thread(WorkerLoop)
+            {
+                IsBackground = true,
+                Name = $"{name} Worker #{i}"
+            };
+            _workers[i].Start();
+        }
+    }
+
+    public void Enqueue(Action work) => _queue.Add(work);
+
+    private void WorkerLoop()
+    {
+        // Workers only run framework code. Hooks should not trigger on them (unless explicitly allowed).
+        HarmonyWrapper.Instance.RegisterFrameworkThread(Thread.CurrentThread.ManagedThreadId);
+        try
+        {
+            foreach (Action work in _queue.GetConsumingEnumerable())
+            {
+                try
+                {
+                    work();
+                }
+                catch (Exception ex)
+                {
+                    Logger.Debug($"[RequestsWorkerPool] Work item faulted! Exception: {ex}");
+                }
+            }
+        }
+        finally
+        {
+            HarmonyWrapper.Instance.UnregisterFrameworkThread(Thread.CurrentThread.ManagedThreadId);
+        }
+    }
+
+    public void Dispose()
+    {
+        _queue.CompleteAdding();
+        foreach (Thread worker in _workers)
+        {
+            worker.Join(TimeSpan.FromMilliseconds(200));
+        }
+    }
+}
@@ -0,0 +1,188 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Net;
+using System.Net.Sockets;
+using System.Threading;
+using System.Threading.Tasks;
+using ScubaDiver.API.Protocol.SimpleHttp;
+
+namespace ScubaDiver;
+
+/// <summary>
+/// Serves a single RNET (SimpleHttp over TCP) connection.
+/// Requests are read asynchronously, handed to the dispatcher (which is expected to queue them and return quickly)
+/// and answered through a single writer, so responses of concurrent requests never interleave on the stream.
+/// At most <c>maxInFlightRequests</c> requests of the connection are processed at any given time. Once that limit
+/// is reached we stop reading from the socket and let TCP push back on the client.
+/// When the client disconnects, the cancellation tokens of its in-flight requests are signaled.
+/// </summary>
+public class RnetConnection : IDisposable
+{
+    private readonly TcpClient _client;
+    private readonly NetworkStream _stream;
+    private readonly SimpleHttpFrameReader _reader;
+    private readonly SemaphoreSlim _inFlight;
+    private readonly int _maxInFlightRequests;
+    private readonly BlockingCollection<byte[]> _responses = new();
+    private readonly Task _writer;
+    private readonly CancellationTokenSource _disconnected = new();
+
+    private static int _nextConnectionId;
+    public int ConnectionId { get; } = Interlocked.Increment(ref _nextConnectionId);
+
+    public RnetConnection(TcpClient client, int maxInFlightRequests)
+    {
+        _client = client;
+        _stream = client.GetStream();
+        _reader = new SimpleHttpFrameReader(_stream);
+        _maxInFlightRequests = maxInFlightRequests;
+        _inFlight = new SemaphoreSlim(maxInFlightRequests, maxInFlightRequests);
+        _writer = Task.Factory.StartNew(Writer, TaskCreationOptions.LongRunning);
+    }
+
+    /// <summary>
+    /// Reads requests until the connection closes or <paramref name="stayAlive"/> returns false.
+    /// Every request is handed to <paramref name="dispatch"/> from the reading loop.
+    /// </summary>
+    public async Task RunAsync(Func<bool> stayAlive, Action<ScubaDiverMessage> dispatch)
+    {
+        try
+        {
+            while (stayAlive() && _client.Connected)
+            {
+                // Backpressure: Don't read the next request until one of the in-flight ones is answered
+                await _inFlight.WaitAsync().ConfigureAwait(false);
+
+                byte[] frame;
+                try
+                {
+                    frame = await _reader.ReadFrameAsync(CancellationToken.None).ConfigureAwait(false);
+                }
+                catch (Exception ex) when (ex is IOException || ex is ObjectDisposedException)
+                {
+                    // Connection dropped
+                    frame = null;
+                }
+
+                if (frame == null)
+                {
+                    _inFlight.Release();
+                    // Nobody is waiting for the responses anymore
+                    _disconnected.Cancel();
+                    break;
+                }
+
+                if (SimpleHttpEncoder.TryParseHttpRequest(frame, out HttpRequestSummary request) == 0)
+                {
+                    _inFlight.Release();
+                    _disconnected.Cancel();
+                    Logger.Debug("[RnetConnection] Failed to parse a request. Closing connection.");
+                    break;
+                }
+
+                Dispatch(request, dispatch);
+            }
+
+            // Let in-flight requests finish so their responses (e.g., the reply to "/die") still make it out.
+            for (int i = 0; i < _maxInFlightRequests; i++)
+            {
+                await _inFlight.WaitAsync().ConfigureAwait(false);
+            }
+        }
+        finally
+        {
+            _responses.CompleteAdding();
+        }
+
+        await _writer.ConfigureAwait(false);
+    }
+
+    private void Dispatch(HttpRequestSummary request, Action<ScubaDiverMessage> dispatch)
+    {
+        int responded = 0;
+        Dictionary<string, string> ResponseHeaders()
+        {
+            Dictionary<string, string> headers = new Dictionary<string, string>();
+            string requestId = request.QueryString.Get("requestId");
+            if (!string.IsNullOrWhiteSpace(requestId))
+                headers["requestId"] = requestId;
+            return headers;
+        }
+        void RespondFunc(string body) => Respond(() => HttpResponseSummary.FromJson(HttpStatusCode.OK, body, ResponseHeaders()));
+        void BinaryRespondFunc(byte[] body) => Respond(() => HttpResponseSummary.FromBinary(HttpStatusCode.OK, body, ResponseHeaders()));
+        void TextRespondFunc(string body) => Respond(() => HttpResponseSummary.FromText(HttpStatusCode.OK, body, ResponseHeaders()));
+        void Respond(Func<HttpResponseSummary> createResponse)
+        {
+            if (Interlocked.Exchange(ref responded, 1) != 0)
+            {
+                Logger.Debug($"[RnetConnection] Request {request.Url} was responded to more than once. Ignoring.");
+                return;
+            }
+
+            var resp = createResponse();
+            if (!SimpleHttpEncoder.TryEncodeHttpResponse(resp, out byte[] encoded))
+            {
+                _inFlight.Release();
+                throw new Exception($"SimpleHttpEncoder failed to encode a response. Response: {resp}");
+            }
+
+            try
+            {
+                _responses.Add(encoded);
+            }
+            catch (InvalidOperationException)
+            {
+                // Connection is already closed
+                _inFlight.Release();
+            }
+        }
+
+        ScubaDiverMessage msg = new ScubaDiverMessage(request.QueryString, request.Url, request.BodyString, RespondFunc)
+        {
+            BinaryResponseSender = BinaryRespondFunc,
+            TextResponseSender = TextRespondFunc,
+            CancellationToken = _disconnected.Token,
+            ConnectionId = ConnectionId
+        };
+        try
+        {
+            dispatch(msg);
+        }
+        catch (Exception ex)
+        {
+            Logger.Debug($"[RnetConnection] Dispatching request {request.Url} faulted. Exception: {ex}");
+            // Handler never answered. Free its slot anyway.
+            if (Interlocked.Exchange(ref responded, 1) == 0)
+                _inFlight.Release();
+        }
+    }
+
+    private void Writer()
+    {
+        foreach (byte[] response in _responses.GetConsumingEnumerable())
+        {
+            try
+            {
+                _stream.Write(response, 0, response.Length);
+            }
+            catch (Exception ex) when (ex is IOException || ex is ObjectDisposedException)
+            {
+                // Client is gone. Keep draining so the in-flight slots are released.
+            }
+            finally
+            {
+                _inFlight.Release();
+            }
+        }
+    }
+
+    public void Dispose()
+    {
+        try { _client.Close(); } catch { }
+        _reader.Dispose();
+        _responses.Dispose();
+        _disconnected.Dispose();
+    }
+}
@@ -2,6 +2,7 @@ using System;
 using System.Collections.Generic;
 using System.Collections.Specialized;
 using System.Linq;
+using System.Threading;
 
 namespace ScubaDiver;
 
@@ -11,6 +12,29 @@ public class ScubaDiverMessage
     public string UrlAbsolutePath { get; set; }
     public string Body { get; set; }
     public Action<string> ResponseSender { get; set; }
+    /// <summary>
+    /// Sends a binary (application/octet-stream) response instead of a JSON one. Errors are still sent with <see cref="ResponseSender"/>.
+    /// </summary>
+    public Action<byte[]> BinaryResponseSender { get; set; }
+    /// <summary>
+    /// Sends a plain text response (e.g. Prometheus metrics) instead of a JSON one. Falls back to <see cref="ResponseSender"/> if not set.
+    /// </summary>
+    public Action<string> TextResponseSender { get; set; }
+
+    /// <summary>
+    /// Signaled when the client no longer waits for the response (connection dropped or the request was cancelled).
+    /// Long-running handlers should observe it.
+    /// </summary>
+    public CancellationToken CancellationToken { get; set; }
+    /// <summary>
+    /// Identifies the connection the request arrived on. Request IDs are only unique within a connection.
+    /// </summary>
+    public int ConnectionId { get; set; }
+    /// <summary>
+    /// <see cref="System.Diagnostics.Stopwatch"/> timestamp of when the request was scheduled. 0 if it wasn't.
+    /// </summary>
+    public long ScheduledTimestamp { get; set; }
+    public string RequestId => QueryString.Get("requestId");
 
     public ScubaDiverMessage(Dictionary<string, string> queryString, string urlAbsolutePath, string body, Action<string> responseSender)
     {
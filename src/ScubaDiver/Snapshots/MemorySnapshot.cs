@@ -0,0 +1,341 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.Compression;
+using System.IO.MemoryMappedFiles;
+using System.Threading;
+using System.Threading.Tasks;
+using ScubaDiver.Rtti;
+
+namespace ScubaDiver.Snapshots
+{
+    /// <summary>
+    /// Visits a chunk of snapshotted memory
+    /// </summary>
+    /// <param name="bufferAddress">Address of the first byte in the buffer</param>
+    /// <param name="scanStart">Offset of the chunk in the buffer. Bytes before it are the tail of the previous chunk.</param>
+    public unsafe delegate void SnapshotChunkVisitor(SnapshotRegion region, ulong bufferAddress, byte* buffer, nuint scanStart, nuint size);
+
+    /// <summary>
+    /// A snapshot file written by <see cref="MemorySnapshotWriter"/>, mapped into memory.
+    /// Chunks stored raw are used in place. Deflated chunks are inflated when read.
+    /// </summary>
+    public unsafe class MemorySnapshot : IDisposable
+    {
+        private class InflatedChunk
+        {
+            public int Index = -1;
+            public byte[] Data;
+        }
+
+        private readonly MemoryMappedFile _file;
+        private readonly MemoryMappedViewAccessor _view;
+        private readonly byte* _pointer;
+        private readonly long _length;
+        private readonly SnapshotRegion[] _regions;
+        private readonly ulong[] _regionStarts;
+        private readonly SnapshotChunk[] _chunks;
+        // Random reads tend to hit the same chunk over and over
+        private readonly ThreadLocal<InflatedChunk> _lastInflated;
+
+        public int PointerSize { get; }
+        public int ChunkSize { get; }
+        public IReadOnlyList<RichModuleInfo> Modules { get; }
+        /// <summary>
+        /// Regions, by address
+        /// </summary>
+        public IReadOnlyList<SnapshotRegion> Regions => _regions;
+        public IReadOnlyList<SnapshotChunk> Chunks => _chunks;
+
+        public MemorySnapshot(string path)
+        {
+            _file = MemoryMappedFile.CreateFromFile(path, FileMode.Open, null, 0, MemoryMappedFileAccess.Read);
+            try
+            {
+                _view = _file.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+                byte* pointer = null;
+                _view.SafeMemoryMappedViewHandle.AcquirePointer(ref pointer);
+                _pointer = pointer + _view.PointerOffset;
+                _length = new FileInfo(path).Length;
+
+                int footerSize = sizeof(long) + MemorySnapshotWriter.Magic.Length;
+                if (_length < MemorySnapshotWriter.Magic.Length + 3 * sizeof(int) + footerSize ||
+                    !HasMagic(0) || !HasMagic(_length - MemorySnapshotWriter.Magic.Length))
+                    throw new InvalidDataException("Not a memory snapshot");
+
+                using BinaryReader header = OpenReader(MemorySnapshotWriter.Magic.Length, _length);
+                int version = header.ReadInt32();
+                if (version != MemorySnapshotWriter.Version)
+                    throw new InvalidDataException($"Unsupported snapshot version {version}");
+                PointerSize = header.ReadInt32();
+                ChunkSize = header.ReadInt32();
+
+                long indexOffset;
+                using (BinaryReader footer = OpenReader(_length - footerSize, _length))
+                    indexOffset = footer.ReadInt64();
+                if (indexOffset < 0 || indexOffset > _length - footerSize)
+                    throw new InvalidDataException("Corrupted snapshot index offset");
+
+                using BinaryReader index = OpenReader(indexOffset, _length - footerSize);
+                Modules = ReadModules(index);
+                _regions = ReadRegions(index);
+                _chunks = ReadChunks(index);
+            }
+            catch
+            {
+                Dispose();
+                throw;
+            }
+
+            Array.Sort(_regions, (a, b) => a.BaseAddress.CompareTo(b.BaseAddress));
+            _regionStarts = Array.ConvertAll(_regions, region => region.BaseAddress);
+            // Inflated buffers are pinned so pointers into them stay valid
+            _lastInflated = new ThreadLocal<InflatedChunk>(() => new InflatedChunk() { Data = GC.AllocateArray<byte>(ChunkSize, pinned: true) });
+        }
+
+        private bool HasMagic(long offset) =>
+            new ReadOnlySpan<byte>(_pointer + offset, MemorySnapshotWriter.Magic.Length).SequenceEqual(MemorySnapshotWriter.Magic);
+
+        private BinaryReader OpenReader(long start, long end) =>
+            new BinaryReader(new UnmanagedMemoryStream(_pointer + start, end - start));
+
+        private static List<RichModuleInfo> ReadModules(BinaryReader reader)
+        {
+            int count = reader.ReadInt32();
+            List<RichModuleInfo> modules = new List<RichModuleInfo>(count);
+            for (int i = 0; i < count; i++)
+            {
+                ModuleInfo moduleInfo = new ModuleInfo(reader.ReadString(), (nuint)reader.ReadUInt64(), (nuint)reader.ReadUInt64());
+                int sectionsCount = reader.ReadInt32();
+                List<ModuleSection> sections = new List<ModuleSection>(sectionsCount);
+                for (int j = 0; j < sectionsCount; j++)
+                    sections.Add(new ModuleSection(reader.ReadString(), reader.ReadUInt64(), reader.ReadUInt64()));
+                modules.Add(new RichModuleInfo(moduleInfo, sections));
+            }
+            return modules;
+        }
+
+        private static SnapshotRegion[] ReadRegions(BinaryReader reader)
+        {
+            SnapshotRegion[] regions = new SnapshotRegion[reader.ReadInt32()];
+            for (int i = 0; i < regions.Length; i++)
+                regions[i] = new SnapshotRegion(reader.ReadUInt64(), reader.ReadUInt64(), reader.ReadInt32(), reader.ReadInt32());
+            return regions;
+        }
+
+        private SnapshotChunk[] ReadChunks(BinaryReader reader)
+        {
+            SnapshotChunk[] chunks = new SnapshotChunk[reader.ReadInt32()];
+            for (int i = 0; i < chunks.Length; i++)
+            {
+                SnapshotChunk chunk = new SnapshotChunk(reader.ReadInt64(), reader.ReadInt32(), reader.ReadInt32(), (SnapshotChunkFlags)reader.ReadByte());
+                if (chunk.Offset < 0 || chunk.StoredLength < 0 || chunk.Offset + chunk.StoredLength > _length || chunk.Length > ChunkSize)
+                    throw new InvalidDataException($"Corrupted snapshot chunk {i}");
+                chunks[i] = chunk;
+            }
+            return chunks;
+        }
+
+        /// <summary>
+        /// Copies a chunk's memory into a buffer of at least <see cref="ChunkSize"/> bytes
+        /// </summary>
+        /// <returns>False if the chunk couldn't be read when the snapshot was taken</returns>
+        private bool CopyChunk(int chunkIndex, byte* destination)
+        {
+            SnapshotChunk chunk = _chunks[chunkIndex];
+            if (chunk.Flags.HasFlag(SnapshotChunkFlags.Unreadable))
+                return false;
+
+            if (!chunk.Flags.HasFlag(SnapshotChunkFlags.Deflated))
+            {
+                Buffer.MemoryCopy(_pointer + chunk.Offset, destination, chunk.Length, chunk.Length);
+                return true;
+            }
+
+            using UnmanagedMemoryStream stored = new UnmanagedMemoryStream(_pointer + chunk.Offset, chunk.StoredLength);
+            using DeflateStream inflate = new DeflateStream(stored, CompressionMode.Decompress);
+            Span<byte> output = new Span<byte>(destination, chunk.Length);
+            while (output.Length > 0)
+            {
+                int read = inflate.Read(output);
+                if (read == 0)
+                    throw new InvalidDataException($"Snapshot chunk {chunkIndex} is truncated");
+                output = output.Slice(read);
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Memory of a chunk. Raw chunks point into the mapped file, deflated ones into a per-thread buffer which the next read replaces.
+        /// </summary>
+        private bool TryGetChunk(int chunkIndex, out byte* data)
+        {
+            SnapshotChunk chunk = _chunks[chunkIndex];
+            data = null;
+            if (chunk.Flags.HasFlag(SnapshotChunkFlags.Unreadable))
+                return false;
+            if (!chunk.Flags.HasFlag(SnapshotChunkFlags.Deflated))
+            {
+                data = _pointer + chunk.Offset;
+                return true;
+            }
+
+            InflatedChunk inflated = _lastInflated.Value;
+            fixed (byte* buffer = inflated.Data)
+            {
+                if (inflated.Index != chunkIndex)
+                {
+                    inflated.Index = -1;
+                    CopyChunk(chunkIndex, buffer);
+                    inflated.Index = chunkIndex;
+                }
+                data = buffer;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Index of the region holding the address, or -1
+        /// </summary>
+        public int FindRegion(ulong address)
+        {
+            int index = Array.BinarySearch(_regionStarts, address);
+            if (index < 0)
+                index = ~index - 1;
+            if (index < 0 || address - _regions[index].BaseAddress >= _regions[index].Size)
+                return -1;
+            return index;
+        }
+
+        /// <summary>
+        /// Reads snapshotted memory. Reads may span chunks and adjacent regions.
+        /// </summary>
+        /// <returns>False if any of the bytes weren't captured</returns>
+        public bool TryRead(ulong address, Span<byte> destination)
+        {
+            while (destination.Length > 0)
+            {
+                int regionIndex = FindRegion(address);
+                if (regionIndex == -1)
+                    return false;
+                SnapshotRegion region = _regions[regionIndex];
+                ulong offsetInRegion = address - region.BaseAddress;
+                int chunkIndex = region.FirstChunk + (int)(offsetInRegion / (ulong)ChunkSize);
+                int offsetInChunk = (int)(offsetInRegion % (ulong)ChunkSize);
+                if (!TryGetChunk(chunkIndex, out byte* data))
+                    return false;
+
+                int count = Math.Min(destination.Length, _chunks[chunkIndex].Length - offsetInChunk);
+                new ReadOnlySpan<byte>(data + offsetInChunk, count).CopyTo(destination);
+                destination = destination.Slice(count);
+                address += (ulong)count;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Copies the memory of a module (its headers and sections) to an image which RTTI discovery can read quickly
+        /// </summary>
+        public SnapshotModuleMemory LoadModule(RichModuleInfo module)
+        {
+            byte[] image = new byte[(ulong)module.ModuleInfo.Size];
+            foreach (ModuleSection section in module.Sections)
+            {
+                ulong distance = section.BaseAddress - (ulong)module.ModuleInfo.BaseAddress;
+                if (distance >= (ulong)image.Length)
+                    continue;
+                int length = (int)Math.Min(section.Size, (ulong)image.Length - distance);
+                TryRead(section.BaseAddress, image.AsSpan((int)distance, length));
+            }
+            return new SnapshotModuleMemory(this, (ulong)module.ModuleInfo.BaseAddress, image);
+        }
+
+        /// <summary>
+        /// Visits all readable chunks in parallel
+        /// </summary>
+        /// <param name="lookbehind">How many bytes of the previous chunk in the region to put before every chunk</param>
+        public void ForEachChunk(int lookbehind, SnapshotChunkVisitor visitor, CancellationToken cancellationToken = default)
+        {
+            lookbehind = Math.Min(Math.Max(lookbehind, 0), ChunkSize);
+            List<(SnapshotRegion region, int chunkIndex)> work = new();
+            foreach (SnapshotRegion region in _regions)
+            {
+                for (int i = 0; i < region.ChunksCount; i++)
+                    work.Add((region, region.FirstChunk + i));
+            }
+
+            ParallelOptions options = new ParallelOptions() { CancellationToken = cancellationToken };
+            Parallel.For(0, work.Count, options,
+                () => new byte[ChunkSize + lookbehind],
+                (i, loopState, scratch) =>
+                {
+                    (SnapshotRegion region, int chunkIndex) = work[i];
+                    SnapshotChunk chunk = _chunks[chunkIndex];
+                    if (chunk.Flags.HasFlag(SnapshotChunkFlags.Unreadable))
+                        return scratch;
+                    ulong chunkAddress = region.BaseAddress + (ulong)(chunkIndex - region.FirstChunk) * (ulong)ChunkSize;
+
+                    if (lookbehind == 0 && !chunk.Flags.HasFlag(SnapshotChunkFlags.Deflated))
+                    {
+                        visitor(region, chunkAddress, _pointer + chunk.Offset, 0, (nuint)chunk.Length);
+                        return scratch;
+                    }
+
+                    fixed (byte* buffer = scratch)
+                    {
+                        // The tail of the previous chunk, when it was captured, so owners of pointers at the start of the chunk can be found
+                        int tail = 0;
+                        if (lookbehind > 0 && chunkIndex > region.FirstChunk &&
+                            TryGetChunk(chunkIndex - 1, out byte* previous))
+                        {
+                            tail = lookbehind;
+                            Buffer.MemoryCopy(previous + ChunkSize - tail, buffer, tail, tail);
+                        }
+                        CopyChunk(chunkIndex, buffer + tail);
+                        visitor(region, chunkAddress - (ulong)tail, buffer, (nuint)tail, (nuint)(tail + chunk.Length));
+                    }
+                    return scratch;
+                },
+                scratch => { });
+        }
+
+        public void Dispose()
+        {
+            _lastInflated?.Dispose();
+            if (_view != null)
+            {
+                _view.SafeMemoryMappedViewHandle.ReleasePointer();
+                _view.Dispose();
+            }
+            _file?.Dispose();
+        }
+    }
+
+    /// <summary>
+    /// A module's memory copied out of a snapshot. Reads outside of the module go to the snapshot.
+    /// </summary>
+    public readonly unsafe struct SnapshotModuleMemory : IRttiMemory
+    {
+        private readonly MemorySnapshot _snapshot;
+        private readonly ulong _baseAddress;
+        private readonly byte[] _image;
+
+        public SnapshotModuleMemory(MemorySnapshot snapshot, ulong baseAddress, byte[] image)
+        {
+            _snapshot = snapshot;
+            _baseAddress = baseAddress;
+            _image = image;
+        }
+
+        public bool TryRead(ulong address, int count, void* buffer)
+        {
+            ulong offset = address - _baseAddress;
+            if (address >= _baseAddress && offset <= (ulong)_image.Length && (ulong)count <= (ulong)_image.Length - offset)
+            {
+                new ReadOnlySpan<byte>(_image, (int)offset, count).CopyTo(new Span<byte>(buffer, count));
+                return true;
+            }
+            return _snapshot.TryRead(address, new Span<byte>(buffer, count));
+        }
+    }
+}
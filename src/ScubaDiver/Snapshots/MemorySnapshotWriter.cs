@@ -0,0 +1,206 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.Compression;
+using System.Threading;
+using ScubaDiver.Rtti;
+
+namespace ScubaDiver.Snapshots
+{
+    /// <summary>
+    /// Reads memory of the snapshotted process into a buffer
+    /// </summary>
+    /// <returns>False if the memory couldn't be read</returns>
+    public unsafe delegate bool SnapshotMemoryReader(ulong address, int count, byte* buffer);
+
+    /// <summary>
+    /// Streams a process' memory into a snapshot file (read by <see cref="MemorySnapshot"/>).
+    /// <para>
+    /// Layout, all little-endian:
+    /// <list type="bullet">
+    /// <item>Header: "RNETSNAP", u32 version, u32 pointer size, u32 chunk size</item>
+    /// <item>Chunks: Up to chunk size bytes of a region each, deflated unless that doesn't make them smaller</item>
+    /// <item>Index: Modules (name, base, size, sections), regions (base, size, first chunk, chunks count) and chunks (file offset, stored length, length, flags)</item>
+    /// <item>Footer: u64 index offset, "RNETSNAP"</item>
+    /// </list>
+    /// </para>
+    /// Regions are written one after the other so the process memory is never copied as a whole.
+    /// </summary>
+    public class MemorySnapshotWriter : IDisposable
+    {
+        public static readonly byte[] Magic = { (byte)'R', (byte)'N', (byte)'E', (byte)'T', (byte)'S', (byte)'N', (byte)'A', (byte)'P' };
+        public const int Version = 1;
+        public const int DefaultChunkSize = 1024 * 1024;
+
+        private readonly Stream _stream;
+        private readonly BinaryWriter _writer;
+        private readonly int _chunkSize;
+        private readonly List<RichModuleInfo> _modules = new();
+        private readonly List<SnapshotRegion> _regions = new();
+        private readonly List<SnapshotChunk> _chunks = new();
+        private readonly byte[] _chunkBuffer;
+        private readonly MemoryStream _compressed;
+        private bool _finished;
+
+        public long BytesWritten => _stream.Position;
+        public ulong MemoryBytes { get; private set; }
+        public int RegionsCount => _regions.Count;
+
+        public MemorySnapshotWriter(Stream stream, int pointerSize, int chunkSize = DefaultChunkSize)
+        {
+            _stream = stream;
+            _writer = new BinaryWriter(stream);
+            _chunkSize = chunkSize;
+            _chunkBuffer = new byte[chunkSize];
+            _compressed = new MemoryStream(chunkSize);
+
+            _writer.Write(Magic);
+            _writer.Write(Version);
+            _writer.Write(pointerSize);
+            _writer.Write(chunkSize);
+        }
+
+        public void AddModule(RichModuleInfo module) => _modules.Add(module);
+
+        /// <summary>
+        /// Writes a region of memory, one chunk at a time. Chunks which can't be read are recorded as missing.
+        /// </summary>
+        public unsafe void WriteRegion(ulong baseAddress, ulong size, SnapshotMemoryReader read, CancellationToken cancellationToken = default)
+        {
+            SnapshotRegion region = new SnapshotRegion(baseAddress, size, _chunks.Count, (int)((size + (ulong)_chunkSize - 1) / (ulong)_chunkSize));
+            fixed (byte* buffer = _chunkBuffer)
+            {
+                for (ulong offset = 0; offset < size; offset += (ulong)_chunkSize)
+                {
+                    cancellationToken.ThrowIfCancellationRequested();
+                    int length = (int)Math.Min((ulong)_chunkSize, size - offset);
+                    if (!read(baseAddress + offset, length, buffer))
+                    {
+                        _chunks.Add(new SnapshotChunk(_stream.Position, 0, length, SnapshotChunkFlags.Unreadable));
+                        continue;
+                    }
+                    WriteChunk(length);
+                }
+                // Don't leave copies of the process memory behind
+                new Span<byte>(buffer, _chunkSize).Clear();
+            }
+            _regions.Add(region);
+            MemoryBytes += size;
+        }
+
+        private void WriteChunk(int length)
+        {
+            _compressed.SetLength(0);
+            using (DeflateStream deflate = new DeflateStream(_compressed, CompressionLevel.Fastest, leaveOpen: true))
+            {
+                deflate.Write(_chunkBuffer, 0, length);
+            }
+
+            long offset = _stream.Position;
+            if (_compressed.Length < length)
+            {
+                _stream.Write(_compressed.GetBuffer(), 0, (int)_compressed.Length);
+                _chunks.Add(new SnapshotChunk(offset, (int)_compressed.Length, length, SnapshotChunkFlags.Deflated));
+            }
+            else
+            {
+                _stream.Write(_chunkBuffer, 0, length);
+                _chunks.Add(new SnapshotChunk(offset, length, length, SnapshotChunkFlags.None));
+            }
+        }
+
+        /// <summary>
+        /// Writes the index and the footer. The snapshot can't be read before this is called.
+        /// </summary>
+        public void Finish()
+        {
+            if (_finished)
+                return;
+            _finished = true;
+
+            long indexOffset = _stream.Position;
+            _writer.Write(_modules.Count);
+            foreach (RichModuleInfo module in _modules)
+            {
+                _writer.Write(module.ModuleInfo.Name ?? string.Empty);
+                _writer.Write((ulong)module.ModuleInfo.BaseAddress);
+                _writer.Write((ulong)module.ModuleInfo.Size);
+                _writer.Write(module.Sections.Count);
+                foreach (ModuleSection section in module.Sections)
+                {
+                    _writer.Write(section.Name ?? string.Empty);
+                    _writer.Write(section.BaseAddress);
+                    _writer.Write(section.Size);
+                }
+            }
+            _writer.Write(_regions.Count);
+            foreach (SnapshotRegion region in _regions)
+            {
+                _writer.Write(region.BaseAddress);
+                _writer.Write(region.Size);
+                _writer.Write(region.FirstChunk);
+                _writer.Write(region.ChunksCount);
+            }
+            _writer.Write(_chunks.Count);
+            foreach (SnapshotChunk chunk in _chunks)
+            {
+                _writer.Write(chunk.Offset);
+                _writer.Write(chunk.StoredLength);
+                _writer.Write(chunk.Length);
+                _writer.Write((byte)chunk.Flags);
+            }
+
+            _writer.Write(indexOffset);
+            _writer.Write(Magic);
+            _writer.Flush();
+        }
+
+        public void Dispose()
+        {
+            _writer.Dispose();
+            _compressed.Dispose();
+        }
+    }
+
+    [Flags]
+    public enum SnapshotChunkFlags : byte
+    {
+        None = 0,
+        Deflated = 1,
+        Unreadable = 2
+    }
+
+    public readonly struct SnapshotChunk
+    {
+        public long Offset { get; }
+        public int StoredLength { get; }
+        public int Length { get; }
+        public SnapshotChunkFlags Flags { get; }
+
+        public SnapshotChunk(long offset, int storedLength, int length, SnapshotChunkFlags flags)
+        {
+            Offset = offset;
+            StoredLength = storedLength;
+            Length = length;
+            Flags = flags;
+        }
+    }
+
+    public readonly struct SnapshotRegion
+    {
+        public ulong BaseAddress { get; }
+        public ulong Size { get; }
+        public int FirstChunk { get; }
+        public int ChunksCount { get; }
+
+        public SnapshotRegion(ulong baseAddress, ulong size, int firstChunk, int chunksCount)
+        {
+            BaseAddress = baseAddress;
+            Size = size;
+            FirstChunk = firstChunk;
+            ChunksCount = chunksCount;
+        }
+
+        public override string ToString() => $"0x{BaseAddress:x16} - 0x{BaseAddress + Size:x16} ({Size} bytes)";
+    }
+}
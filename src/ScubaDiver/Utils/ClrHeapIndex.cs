@@ -0,0 +1,115 @@
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using Microsoft.Diagnostics.Runtime;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Managed heap objects, grouped by type name, as enumerated from a ClrMD snapshot.
+    /// Objects only move or get collected during GCs, so the index stays valid until the collection count of any generation changes.
+    /// Objects allocated after the index was built are missing from it until then.
+    /// </summary>
+    public class ClrHeapIndex
+    {
+        public readonly struct Instance
+        {
+            public readonly ulong Address;
+            public readonly ulong MethodTable;
+
+            public Instance(ulong address, ulong methodTable)
+            {
+                Address = address;
+                MethodTable = methodTable;
+            }
+        }
+
+        public class TypeInstances
+        {
+            public string TypeName { get; }
+            public List<Instance> Instances { get; } = new();
+
+            public TypeInstances(string typeName)
+            {
+                TypeName = typeName;
+            }
+        }
+
+        private readonly int[] _collectionCounts;
+        private readonly TypeNameIndex<TypeInstances> _types = new();
+
+        public int ObjectsCount { get; }
+
+        /// <summary>
+        /// False once a GC occurred since the index was built
+        /// </summary>
+        public bool IsCurrent => _collectionCounts.SequenceEqual(GetCollectionCounts());
+
+        private ClrHeapIndex(int[] collectionCounts, IEnumerable<TypeInstances> types)
+        {
+            _collectionCounts = collectionCounts;
+            foreach (TypeInstances typeInstances in types)
+            {
+                _types.Add(typeInstances.TypeName, typeInstances);
+                ObjectsCount += typeInstances.Instances.Count;
+            }
+        }
+
+        public static int[] GetCollectionCounts()
+        {
+            int[] counts = new int[GC.MaxGeneration + 1];
+            for (int generation = 0; generation < counts.Length; generation++)
+                counts[generation] = GC.CollectionCount(generation);
+            return counts;
+        }
+
+        /// <summary>
+        /// Enumerates the heap's segments in parallel and groups their objects by type
+        /// </summary>
+        /// <param name="collectionCounts">Result of <see cref="GetCollectionCounts"/> from before the snapshot of <paramref name="heap"/> was taken</param>
+        public static ClrHeapIndex Build(ClrHeap heap, int[] collectionCounts, CancellationToken cancellationToken = default)
+        {
+            ClrSegment[] segments = heap.Segments.ToArray();
+            Dictionary<string, TypeInstances>[] segmentsTypes = new Dictionary<string, TypeInstances>[segments.Length];
+            ParallelOptions options = new() { CancellationToken = cancellationToken };
+            Parallel.For(0, segments.Length, options, i =>
+            {
+                Dictionary<string, TypeInstances> segmentTypes = new();
+                foreach (ClrObject clrObj in segments[i].EnumerateObjects())
+                {
+                    // Unknown types can't be converted to objects anyway
+                    if (clrObj.IsFree || clrObj.Type == null)
+                        continue;
+
+                    string typeName = clrObj.Type.Name ?? "Unknown";
+                    if (!segmentTypes.TryGetValue(typeName, out TypeInstances typeInstances))
+                    {
+                        typeInstances = new TypeInstances(typeName);
+                        segmentTypes[typeName] = typeInstances;
+                    }
+                    typeInstances.Instances.Add(new Instance(clrObj.Address, clrObj.Type.MethodTable));
+                }
+                segmentsTypes[i] = segmentTypes;
+            });
+
+            // Merging in segments order so each type's instances are listed in heap order
+            Dictionary<string, TypeInstances> types = new();
+            foreach (Dictionary<string, TypeInstances> segmentTypes in segmentsTypes)
+            {
+                foreach (TypeInstances segmentInstances in segmentTypes.Values)
+                {
+                    if (types.TryGetValue(segmentInstances.TypeName, out TypeInstances typeInstances))
+                        typeInstances.Instances.AddRange(segmentInstances.Instances);
+                    else
+                        types[segmentInstances.TypeName] = segmentInstances;
+                }
+            }
+            return new ClrHeapIndex(collectionCounts, types.Values);
+        }
+
+        /// <param name="typeFilter">A "simple filter" (see <see cref="API.Utils.Filter"/>) of type names</param>
+        public List<TypeInstances> Query(string typeFilter) => _types.Query(typeFilter);
+    }
+}
@@ -0,0 +1,273 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.Linq;
+using System.Text;
+using System.Threading;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Histogram of durations with fixed buckets. Recording is lock-free (one interlocked increment per bucket and sum)
+    /// so it's cheap enough for every request.
+    /// </summary>
+    public class FixedBucketHistogram
+    {
+        /// <summary>
+        /// Upper bounds of the buckets, in seconds. From half a millisecond for pings up to heap scans.
+        /// </summary>
+        public static readonly double[] DefaultBounds = { 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30 };
+
+        private readonly double[] _bounds;
+        private readonly long[] _boundsTicks;
+        // Last one is the "+Inf" bucket
+        private readonly long[] _counts;
+        private long _sumTicks;
+
+        public FixedBucketHistogram() : this(DefaultBounds)
+        {
+        }
+
+        public FixedBucketHistogram(double[] bounds)
+        {
+            _bounds = bounds;
+            _boundsTicks = bounds.Select(b => (long)(b * Stopwatch.Frequency)).ToArray();
+            _counts = new long[bounds.Length + 1];
+        }
+
+        /// <param name="elapsedTicks">Duration in <see cref="Stopwatch"/> ticks</param>
+        public void Record(long elapsedTicks)
+        {
+            if (elapsedTicks < 0)
+                elapsedTicks = 0;
+            int i = 0;
+            while (i < _boundsTicks.Length && elapsedTicks > _boundsTicks[i])
+                i++;
+            Interlocked.Increment(ref _counts[i]);
+            Interlocked.Add(ref _sumTicks, elapsedTicks);
+        }
+
+        public void Record(TimeSpan elapsed) => Record((long)(elapsed.TotalSeconds * Stopwatch.Frequency));
+
+        public long Count
+        {
+            get
+            {
+                long count = 0;
+                for (int i = 0; i < _counts.Length; i++)
+                    count += Interlocked.Read(ref _counts[i]);
+                return count;
+            }
+        }
+
+        public double SumSeconds => (double)Interlocked.Read(ref _sumTicks) / Stopwatch.Frequency;
+
+        /// <summary>
+        /// Writes the "_bucket", "_sum" and "_count" samples. Buckets are cumulative, as Prometheus expects.
+        /// </summary>
+        internal void WriteSamples(StringBuilder sb, string name, string labels)
+        {
+            string prefix = string.IsNullOrEmpty(labels) ? "" : labels + ",";
+            long cumulative = 0;
+            for (int i = 0; i < _counts.Length; i++)
+            {
+                cumulative += Interlocked.Read(ref _counts[i]);
+                string le = i < _bounds.Length ? DiverMetrics.FormatValue(_bounds[i]) : "+Inf";
+                sb.Append(name).Append("_bucket{").Append(prefix).Append("le=\"").Append(le).Append("\"} ")
+                    .Append(cumulative.ToString(CultureInfo.InvariantCulture)).Append('\n');
+            }
+            // Count is taken from the buckets just read so it always matches "+Inf"
+            DiverMetrics.WriteSample(sb, name + "_sum", labels, SumSeconds);
+            DiverMetrics.WriteSample(sb, name + "_count", labels, cumulative);
+        }
+    }
+
+    /// <summary>
+    /// Counters and latency histograms of a single endpoint
+    /// </summary>
+    public class EndpointMetrics
+    {
+        private long _requests;
+        private long _failures;
+        private long _bytesOut;
+
+        /// <summary>
+        /// From the moment the request was scheduled until a worker picked it up
+        /// </summary>
+        public FixedBucketHistogram QueueTime { get; } = new();
+        /// <summary>
+        /// Running the endpoint's handler, which creates the response's body
+        /// </summary>
+        public FixedBucketHistogram HandlerTime { get; } = new();
+        /// <summary>
+        /// Encoding the response and handing it to the connection
+        /// </summary>
+        public FixedBucketHistogram SerializationTime { get; } = new();
+
+        public long Requests => Interlocked.Read(ref _requests);
+        public long Failures => Interlocked.Read(ref _failures);
+        public long BytesOut => Interlocked.Read(ref _bytesOut);
+
+        public void RecordResponse(long bytes, bool failed)
+        {
+            Interlocked.Increment(ref _requests);
+            Interlocked.Add(ref _bytesOut, bytes);
+            if (failed)
+                Interlocked.Increment(ref _failures);
+        }
+    }
+
+    /// <summary>
+    /// The diver's metrics, exported by /metrics in the Prometheus text format.
+    /// Per-endpoint counters and histograms are updated lock-free on every request.
+    /// Gauges are read only when exporting.
+    /// </summary>
+    public class DiverMetrics
+    {
+        public const string ContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+        private class Gauge
+        {
+            public string Name;
+            public string Help;
+            public Func<IEnumerable<(string labels, double value)>> Read;
+        }
+
+        private class ScanStats
+        {
+            public long Count;
+            public long LastTicks;
+            public readonly FixedBucketHistogram Durations = new();
+        }
+
+        private readonly ConcurrentDictionary<string, EndpointMetrics> _endpoints = new();
+        private readonly ConcurrentDictionary<string, ScanStats> _scans = new();
+        private readonly object _gaugesLock = new();
+        private readonly List<Gauge> _gauges = new();
+
+        public EndpointMetrics ForEndpoint(string endpoint) => _endpoints.GetOrAdd(endpoint, _ => new EndpointMetrics());
+
+        public void AddGauge(string name, string help, Func<double> read) => AddGauge(name, help, () => new[] { ((string)null, read()) });
+
+        /// <param name="read">Samples of the gauge. Labels are formatted like 'lane="bulk"'.</param>
+        public void AddGauge(string name, string help, Func<IEnumerable<(string labels, double value)>> read)
+        {
+            lock (_gaugesLock)
+            {
+                _gauges.Add(new Gauge() { Name = name, Help = help, Read = read });
+            }
+        }
+
+        /// <summary>
+        /// Records a scan of the heap or of the process' memory
+        /// </summary>
+        /// <param name="kind">What was scanned, used as a label</param>
+        public void RecordScan(string kind, TimeSpan elapsed)
+        {
+            ScanStats stats = _scans.GetOrAdd(kind, _ => new ScanStats());
+            long ticks = (long)(elapsed.TotalSeconds * Stopwatch.Frequency);
+            Interlocked.Increment(ref stats.Count);
+            Interlocked.Exchange(ref stats.LastTicks, ticks);
+            stats.Durations.Record(ticks);
+        }
+
+        public string Export()
+        {
+            StringBuilder sb = new StringBuilder();
+            List<KeyValuePair<string, EndpointMetrics>> endpoints = _endpoints.OrderBy(kvp => kvp.Key, StringComparer.Ordinal).ToList();
+
+            WriteHeader(sb, "diver_requests_total", "counter", "Requests answered, by endpoint");
+            foreach (var kvp in endpoints)
+                WriteSample(sb, "diver_requests_total", EndpointLabel(kvp.Key), kvp.Value.Requests);
+            WriteHeader(sb, "diver_request_failures_total", "counter", "Requests whose handler threw, was cancelled or didn't exist, by endpoint");
+            foreach (var kvp in endpoints)
+                WriteSample(sb, "diver_request_failures_total", EndpointLabel(kvp.Key), kvp.Value.Failures);
+            WriteHeader(sb, "diver_response_bytes_total", "counter", "Bytes of response bodies sent, by endpoint");
+            foreach (var kvp in endpoints)
+                WriteSample(sb, "diver_response_bytes_total", EndpointLabel(kvp.Key), kvp.Value.BytesOut);
+
+            WriteHistograms(sb, "diver_request_queue_seconds", "Time requests waited for a worker", endpoints, m => m.QueueTime);
+            WriteHistograms(sb, "diver_request_handler_seconds", "Time spent in endpoint handlers", endpoints, m => m.HandlerTime);
+            WriteHistograms(sb, "diver_response_serialization_seconds", "Time spent encoding and sending responses", endpoints, m => m.SerializationTime);
+
+            List<KeyValuePair<string, ScanStats>> scans = _scans.OrderBy(kvp => kvp.Key, StringComparer.Ordinal).ToList();
+            WriteHeader(sb, "diver_scans_total", "counter", "Heap and memory scans, by kind");
+            foreach (var kvp in scans)
+                WriteSample(sb, "diver_scans_total", Label("kind", kvp.Key), Interlocked.Read(ref kvp.Value.Count));
+            WriteHeader(sb, "diver_last_scan_duration_seconds", "gauge", "Duration of the latest scan, by kind");
+            foreach (var kvp in scans)
+                WriteSample(sb, "diver_last_scan_duration_seconds", Label("kind", kvp.Key), (double)Interlocked.Read(ref kvp.Value.LastTicks) / Stopwatch.Frequency);
+            WriteHeader(sb, "diver_scan_duration_seconds", "histogram", "Durations of scans, by kind");
+            foreach (var kvp in scans)
+                kvp.Value.Durations.WriteSamples(sb, "diver_scan_duration_seconds", Label("kind", kvp.Key));
+
+            List<Gauge> gauges;
+            lock (_gaugesLock)
+            {
+                gauges = _gauges.ToList();
+            }
+            foreach (Gauge gauge in gauges)
+            {
+                List<(string labels, double value)> samples;
+                try
+                {
+                    samples = gauge.Read().ToList();
+                }
+                catch (Exception ex)
+                {
+                    // A broken gauge shouldn't fail the whole scrape
+                    Logger.Debug($"[DiverMetrics] Failed to read gauge {gauge.Name}. Error: {ex.Message}");
+                    continue;
+                }
+                WriteHeader(sb, gauge.Name, "gauge", gauge.Help);
+                foreach ((string labels, double value) in samples)
+                    WriteSample(sb, gauge.Name, labels, value);
+            }
+
+            return sb.ToString();
+        }
+
+        private static void WriteHistograms(StringBuilder sb, string name, string help, List<KeyValuePair<string, EndpointMetrics>> endpoints,
+            Func<EndpointMetrics, FixedBucketHistogram> select)
+        {
+            WriteHeader(sb, name, "histogram", help);
+            foreach (var kvp in endpoints)
+                select(kvp.Value).WriteSamples(sb, name, EndpointLabel(kvp.Key));
+        }
+
+        private static void WriteHeader(StringBuilder sb, string name, string type, string help)
+        {
+            sb.Append("# HELP ").Append(name).Append(' ').Append(help.Replace("\\", "\\\\").Replace("\n", "\\n")).Append('\n');
+            sb.Append("# TYPE ").Append(name).Append(' ').Append(type).Append('\n');
+        }
+
+        internal static void WriteSample(StringBuilder sb, string name, string labels, double value)
+        {
+            sb.Append(name);
+            if (!string.IsNullOrEmpty(labels))
+                sb.Append('{').Append(labels).Append('}');
+            sb.Append(' ').Append(FormatValue(value)).Append('\n');
+        }
+
+        internal static string FormatValue(double value)
+        {
+            if (double.IsPositiveInfinity(value))
+                return "+Inf";
+            if (double.IsNegativeInfinity(value))
+                return "-Inf";
+            if (double.IsNaN(value))
+                return "NaN";
+            return value.ToString("R", CultureInfo.InvariantCulture);
+        }
+
+        private static string EndpointLabel(string endpoint) => Label("endpoint", endpoint);
+
+        public static string Label(string name, string value)
+        {
+            string escaped = value.Replace("\\", "\\\\").Replace("\"", "\\\"").Replace("\n", "\\n");
+            return $"{name}=\"{escaped}\"";
+        }
+    }
+}
@@ -0,0 +1,121 @@
+using System;
+using System.Collections;
+using System.Collections.Generic;
+using System.Linq;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Enumerations of remote collections which are read a page at a time (/get_items).
+    /// Each cursor keeps its enumerator between requests. Cursors which aren't read for longer than the idle timeout are closed.
+    /// </summary>
+    public class EnumerationCursors
+    {
+        private class Cursor
+        {
+            public IEnumerator Enumerator;
+            public DateTime LastUsed;
+        }
+
+        private readonly object _lock = new();
+        private readonly Dictionary<long, Cursor> _cursors = new();
+        private readonly Func<DateTime> _clock;
+        private long _nextId = 1;
+
+        public TimeSpan IdleTimeout { get; }
+
+        public EnumerationCursors(TimeSpan idleTimeout, Func<DateTime> clock = null)
+        {
+            IdleTimeout = idleTimeout;
+            _clock = clock ?? (() => DateTime.UtcNow);
+        }
+
+        public int Count
+        {
+            get
+            {
+                lock (_lock)
+                {
+                    return _cursors.Count;
+                }
+            }
+        }
+
+        /// <returns>The new cursor's id. Never 0.</returns>
+        public long Open(IEnumerator enumerator)
+        {
+            lock (_lock)
+            {
+                long id = _nextId++;
+                _cursors[id] = new Cursor() { Enumerator = enumerator, LastUsed = _clock() };
+                return id;
+            }
+        }
+
+        /// <summary>
+        /// Reads up to <paramref name="count"/> items from a cursor. Cursors are closed once they run out of items.
+        /// </summary>
+        /// <param name="done">Whether the enumeration ended</param>
+        /// <returns>False if the cursor doesn't exist (never opened, closed or expired)</returns>
+        public bool TryRead(long id, int count, List<object> items, out bool done)
+        {
+            done = false;
+            Cursor cursor;
+            lock (_lock)
+            {
+                if (!_cursors.TryGetValue(id, out cursor))
+                    return false;
+                cursor.LastUsed = _clock();
+            }
+
+            // Enumerators aren't thread safe. A client only reads a cursor from one thread anyway.
+            lock (cursor)
+            {
+                while (items.Count < count)
+                {
+                    if (!cursor.Enumerator.MoveNext())
+                    {
+                        done = true;
+                        break;
+                    }
+                    items.Add(cursor.Enumerator.Current);
+                }
+            }
+            if (done)
+                Close(id);
+            return true;
+        }
+
+        /// <returns>False if the cursor doesn't exist</returns>
+        public bool Close(long id)
+        {
+            Cursor cursor;
+            lock (_lock)
+            {
+                if (!_cursors.TryGetValue(id, out cursor))
+                    return false;
+                _cursors.Remove(id);
+            }
+            lock (cursor)
+            {
+                (cursor.Enumerator as IDisposable)?.Dispose();
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Closes cursors which weren't read for longer than <see cref="IdleTimeout"/>
+        /// </summary>
+        /// <returns>How many cursors were closed</returns>
+        public int CloseIdle()
+        {
+            List<long> idle;
+            lock (_lock)
+            {
+                DateTime now = _clock();
+                idle = _cursors.Where(kvp => now - kvp.Value.LastUsed > IdleTimeout).Select(kvp => kvp.Key).ToList();
+            }
+            return idle.Count(Close);
+        }
+    }
+}
@@ -1,24 +1,49 @@
-﻿using System.Collections.Generic;
+﻿using System;
+using System.Collections.Generic;
 using System.Linq;
+using System.Runtime.CompilerServices;
 using System.Threading;
 using System.Threading.Tasks;
 
 namespace ScubaDiver;
 
+/// <summary>
+/// Objects pinned in place so their addresses can be handed out.
+/// Objects are pinned by freezer tasks, each freezing a bucket of up to <see cref="BucketCapacity"/> objects.
+/// Pinning and unpinning only re-freeze the buckets involved so their cost doesn't grow with the amount of pinned objects.
+/// </summary>
 public class FrozenObjectsCollection
 {
+    public const int BucketCapacity = 256;
+
+    private class Bucket
+    {
+        public readonly List<object> Objects = new();
+        public Task FreezerTask;
+        public ManualResetEvent UnfreezeRequested;
+    }
+
+    private class ReferenceComparer : IEqualityComparer<object>
+    {
+        public static readonly ReferenceComparer Instance = new();
+        public new bool Equals(object x, object y) => ReferenceEquals(x, y);
+        public int GetHashCode(object obj) => RuntimeHelpers.GetHashCode(obj);
+    }
+
     private object _lock;
-    Dictionary<object, ulong> _frozenObjects;
-    private Task _freezerTask;
-    private ManualResetEvent _unfreezeRequested;
+    // Pinned objects are told apart by reference, objects which are merely equal have their own addresses
+    Dictionary<object, (ulong address, Bucket bucket)> _frozenObjects;
+    Dictionary<ulong, object> _addressesToObjects;
+    // Buckets with room for more objects
+    private HashSet<Bucket> _openBuckets;
 
 
     public FrozenObjectsCollection()
     {
         _lock = new object();
-        _frozenObjects = new Dictionary<object, ulong>();
-        _freezerTask = null;
-        _unfreezeRequested = null;
+        _frozenObjects = new Dictionary<object, (ulong, Bucket)>(ReferenceComparer.Instance);
+        _addressesToObjects = new Dictionary<ulong, object>();
+        _openBuckets = new HashSet<Bucket>();
     }
 
     /// <summary>
@@ -29,61 +54,97 @@ public class FrozenObjectsCollection
     {
         lock (_lock)
         {
-            return _frozenObjects.TryGetValue(o, out addr);
+            bool found = _frozenObjects.TryGetValue(o, out var pinned);
+            addr = pinned.address;
+            return found;
         }
     }
 
-    private void PinInternal(object[] newfrozenObjects)
+    /// <summary>
+    /// Re-freezes a bucket after objects were added to or removed from it.
+    /// Objects that stay in the bucket are held by the previous freezer until the new one has them, so they don't move.
+    /// </summary>
+    private void Refreeze(Bucket bucket)
     {
-        lock (_lock)
-        {
-            if (newfrozenObjects.Length == 0)
-            {
-                UnpinAll();
-                return;
-            }
+        object[] objects = bucket.Objects.ToArray();
+        Task previousFreezerTask = bucket.FreezerTask;
+        ManualResetEvent previousUnfreezeRequested = bucket.UnfreezeRequested;
+        bucket.FreezerTask = null;
+        bucket.UnfreezeRequested = null;
 
-            ulong[] addresses = new ulong[newfrozenObjects.Length];
+        if (objects.Length > 0)
+        {
+            ulong[] addresses = new ulong[objects.Length];
             ManualResetEvent frozenFeedback = new ManualResetEvent(false);
             ManualResetEvent unfreezeRequested = new ManualResetEvent(false);
 
-            // Call freeze
-            var func = FreezeFuncsFactory.Generate(newfrozenObjects.Length);
-            Task freezerTask = Task.Run(() => func(newfrozenObjects, addresses, frozenFeedback, unfreezeRequested));
+            // Call freeze. Freezers block until released so each gets its own thread rather than a thread pool one.
+            var func = FreezeFuncsFactory.Generate(objects.Length);
+            Task freezerTask = Task.Factory.StartNew(() => func(objects, addresses, frozenFeedback, unfreezeRequested),
+                TaskCreationOptions.LongRunning);
 
             // Wait for the freezer task to signal to us
             frozenFeedback.WaitOne();
+            frozenFeedback.Dispose();
 
-
-            // Dispose of last Freezer
-            _unfreezeRequested?.Set();
-            _freezerTask?.Wait();
-
-            // Save new Task & event
-            _unfreezeRequested = unfreezeRequested;
-            _freezerTask = freezerTask;
-
-            // Now all addresses are set in the array. Re-create dict
-            _frozenObjects.Clear();
-            for (int i = 0; i < newfrozenObjects.Length; i++)
+            bucket.FreezerTask = freezerTask;
+            bucket.UnfreezeRequested = unfreezeRequested;
+            for (int i = 0; i < objects.Length; i++)
             {
-                _frozenObjects[newfrozenObjects[i]] = addresses[i];
+                _frozenObjects[objects[i]] = (addresses[i], bucket);
+                _addressesToObjects[addresses[i]] = objects[i];
             }
         }
+
+        // Dispose of last Freezer
+        Release(previousFreezerTask, previousUnfreezeRequested);
+    }
+
+    private static void Release(Task freezerTask, ManualResetEvent unfreezeRequested)
+    {
+        unfreezeRequested?.Set();
+        freezerTask?.Wait();
+        unfreezeRequested?.Dispose();
     }
 
-    public ulong Pin(object o)
+    public ulong Pin(object o) => PinMany(new[] { o })[0];
+
+    /// <summary>
+    /// Pins several objects, re-freezing each bucket they go into once.
+    /// </summary>
+    /// <returns>The address of every object, in order</returns>
+    public ulong[] PinMany(IReadOnlyList<object> objects)
     {
         lock (_lock)
         {
-            if (_frozenObjects.TryGetValue(o, out ulong addr))
-                return addr;
+            HashSet<object> queued = new HashSet<object>(ReferenceComparer.Instance);
+            HashSet<Bucket> touchedBuckets = new HashSet<Bucket>();
+            foreach (object o in objects)
+            {
+                if (o == null)
+                    throw new ArgumentNullException(nameof(objects), "Can't pin null");
+                if (_frozenObjects.ContainsKey(o) || !queued.Add(o))
+                    continue;
+
+                Bucket bucket = _openBuckets.FirstOrDefault();
+                if (bucket == null)
+                {
+                    bucket = new Bucket();
+                    _openBuckets.Add(bucket);
+                }
+                bucket.Objects.Add(o);
+                if (bucket.Objects.Count == BucketCapacity)
+                    _openBuckets.Remove(bucket);
+                touchedBuckets.Add(bucket);
+            }
 
-            // Prepare parameters
-            object[] objs = _frozenObjects.Keys.Concat(new object[] { o }).ToArray();
-            PinInternal(objs);
+            foreach (Bucket bucket in touchedBuckets)
+                Refreeze(bucket);
 
-            return _frozenObjects[o];
+            ulong[] addresses = new ulong[objects.Count];
+            for (int i = 0; i < addresses.Length; i++)
+                addresses[i] = _frozenObjects[objects[i]].address;
+            return addresses;
         }
     }
 
@@ -91,17 +152,7 @@ public class FrozenObjectsCollection
     {
         lock (_lock)
         {
-            foreach (var frozenObject in _frozenObjects)
-            {
-                if (frozenObject.Value == addr)
-                {
-                    o = frozenObject.Key;
-                    return true;
-                }
-            }
-
-            o = null;
-            return false;
+            return _addressesToObjects.TryGetValue(addr, out o);
         }
     }
 
@@ -109,23 +160,42 @@ public class FrozenObjectsCollection
     /// Unpins an object
     /// </summary>
     /// <returns>True if it was pinned, false if not.</returns>
-    public bool Unpin(ulong objAddress)
+    public bool Unpin(ulong objAddress) => UnpinMany(new[] { objAddress }).Count == 0;
+
+    /// <summary>
+    /// Unpins several objects, re-freezing each bucket they're taken out of once.
+    /// </summary>
+    /// <returns>The addresses which weren't pinned</returns>
+    public List<ulong> UnpinMany(IEnumerable<ulong> objAddresses)
     {
         lock (_lock)
         {
-            object[] objs = _frozenObjects
-                .Where(kvp => kvp.Value != objAddress)
-                .Select(kvp => kvp.Key)
-                .ToArray();
-
-            // Making sure that adress was even in the dictionary.
-            // Otherwise, we don't need to re-pin all objects.
-            if (objs.Length == _frozenObjects.Count)
-                return false;
+            List<ulong> notPinned = new List<ulong>();
+            HashSet<Bucket> touchedBuckets = new HashSet<Bucket>();
+            foreach (ulong objAddress in objAddresses)
+            {
+                if (!_addressesToObjects.TryGetValue(objAddress, out object o))
+                {
+                    notPinned.Add(objAddress);
+                    continue;
+                }
 
-            PinInternal(objs);
+                Bucket bucket = _frozenObjects[o].bucket;
+                bucket.Objects.RemoveAt(bucket.Objects.FindIndex(bucketObject => ReferenceEquals(bucketObject, o)));
+                _frozenObjects.Remove(o);
+                _addressesToObjects.Remove(objAddress);
+                touchedBuckets.Add(bucket);
+            }
 
-            return true;
+            foreach (Bucket bucket in touchedBuckets)
+            {
+                Refreeze(bucket);
+                if (bucket.Objects.Count == 0)
+                    _openBuckets.Remove(bucket);
+                else
+                    _openBuckets.Add(bucket);
+            }
+            return notPinned;
         }
     }
 
@@ -133,13 +203,14 @@ public class FrozenObjectsCollection
     {
         lock (_lock)
         {
-            // Dispose of last Freezer
-            _unfreezeRequested?.Set();
-            _freezerTask?.Wait();
-            _unfreezeRequested = null;
-            _freezerTask = null;
-
+            // Dispose of all Freezers
+            foreach (Bucket bucket in _frozenObjects.Values.Select(pinned => pinned.bucket).Distinct())
+            {
+                Release(bucket.FreezerTask, bucket.UnfreezeRequested);
+            }
+            _openBuckets.Clear();
             _frozenObjects.Clear();
+            _addressesToObjects.Clear();
         }
     }
-}
\ No newline at end of file
+}
@@ -1,14 +1,29 @@
 ﻿using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Linq;
 using System.Reflection;
+using ScubaDiver.API;
 using ScubaDiver.API.Interactions.Dumps;
+using ScubaDiver.API.Interactions.Object;
 using ScubaDiver.API.Utils;
 
 namespace ScubaDiver
 {
     public static class ObjectDumpFactory
     {
+        private static readonly ConcurrentDictionary<Type, FieldInfo[]> _dumpedFields = new();
+
+        /// <summary>
+        /// Fields of a type, excluding the backing fields of events
+        /// </summary>
+        private static FieldInfo[] GetDumpedFields(Type type) =>
+            _dumpedFields.GetOrAdd(type, t =>
+            {
+                var eventNames = new HashSet<string>(t.GetEvents((BindingFlags)0xffff).Select(eventInfo => eventInfo.Name));
+                return t.GetFields((BindingFlags)0xffff).Where(fieldInfo => !eventNames.Contains(fieldInfo.Name)).ToArray();
+            });
+
         public static ObjectDump Create(object instance, ulong retrievalAddr, ulong pinAddr)
         {
             Type dumpedObjType = instance.GetType();
@@ -81,8 +96,7 @@ namespace ScubaDiver
 
 
             List<MemberDump> fields = new();
-            var eventNames = dumpedObjType.GetEvents((BindingFlags)0xffff).Select(eventInfo => eventInfo.Name);
-            foreach (var fieldInfo in dumpedObjType.GetFields((BindingFlags)0xffff).Where(fieldInfo => !eventNames.Contains(fieldInfo.Name)))
+            foreach (var fieldInfo in GetDumpedFields(dumpedObjType))
             {
                 try
                 {
@@ -162,5 +176,49 @@ namespace ScubaDiver
 
             return od;
         }
-}
+
+        /// <summary>
+        /// Reads the values of all primitive (and null) fields of an object.
+        /// Fields referencing other objects are left out: Unless pinned, their addresses are only good until the next GC,
+        /// and pinning every referenced object would keep them alive for the sake of a cache. Those are read with /get_field.
+        /// </summary>
+        public static ObjectsSnapshot.ObjectSnapshot CreateSnapshot(object instance, ulong address)
+        {
+            Type dumpedObjType = instance.GetType();
+            ObjectsSnapshot.ObjectSnapshot snapshot = new()
+            {
+                Address = address,
+                Type = dumpedObjType.FullName
+            };
+            if (dumpedObjType.IsPrimitiveEtc() || instance is Array)
+            {
+                // No fields to read. Users are expected to dump these objects anyway.
+                return snapshot;
+            }
+
+            foreach (var fieldInfo in GetDumpedFields(dumpedObjType))
+            {
+                // Hidden fields of base types share the name of the hiding field, the most derived one wins
+                if (snapshot.Fields.ContainsKey(fieldInfo.Name))
+                    continue;
+
+                object fieldValue;
+                try
+                {
+                    fieldValue = fieldInfo.GetValue(instance);
+                }
+                catch
+                {
+                    // Left out. Reading it with /get_field will report the error.
+                    continue;
+                }
+
+                if (fieldValue == null)
+                    snapshot.Fields[fieldInfo.Name] = ObjectOrRemoteAddress.Null;
+                else if (fieldValue.GetType().IsPrimitiveEtc())
+                    snapshot.Fields[fieldInfo.Name] = ObjectOrRemoteAddress.FromObj(fieldValue);
+            }
+            return snapshot;
+        }
+    }
 }
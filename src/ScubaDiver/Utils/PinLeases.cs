@@ -0,0 +1,192 @@
+using System;
+using System.Collections.Generic;
+using System.Linq;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Tracks which clients hold every pinned address so pins can be released once all of their holders are gone.
+    /// A client's lease is renewed by its traffic and ends when it unregisters or stays silent for longer than the lease duration.
+    /// Addresses pinned without a client (old clients, synchronous hook callbacks) aren't leased and stay pinned until explicitly unpinned.
+    /// </summary>
+    public class PinLeases
+    {
+        private class Lease
+        {
+            public DateTime LastSeen;
+            public readonly HashSet<ulong> Addresses = new();
+        }
+
+        private readonly object _lock = new();
+        private readonly Dictionary<int, Lease> _leases = new();
+        // <Pinned address to: Clients holding it>
+        private readonly Dictionary<ulong, HashSet<int>> _holders = new();
+        private readonly Func<DateTime> _clock;
+
+        public TimeSpan LeaseDuration { get; }
+
+        /// <summary>
+        /// Distinct addresses held by any client
+        /// </summary>
+        public int PinnedCount
+        {
+            get
+            {
+                lock (_lock)
+                {
+                    return _holders.Count;
+                }
+            }
+        }
+
+        public PinLeases(TimeSpan leaseDuration, Func<DateTime> clock = null)
+        {
+            LeaseDuration = leaseDuration;
+            _clock = clock ?? (() => DateTime.UtcNow);
+        }
+
+        /// <summary>
+        /// Starts or extends the lease of a client
+        /// </summary>
+        public void Renew(int clientId)
+        {
+            lock (_lock)
+            {
+                GetOrAddLease(clientId).LastSeen = _clock();
+            }
+        }
+
+        /// <summary>
+        /// Records that a client holds a pinned address. Also renews the client's lease.
+        /// </summary>
+        public void Add(int clientId, ulong address)
+        {
+            lock (_lock)
+            {
+                Lease lease = GetOrAddLease(clientId);
+                lease.LastSeen = _clock();
+                lease.Addresses.Add(address);
+                if (!_holders.TryGetValue(address, out HashSet<int> holders))
+                {
+                    holders = new HashSet<int>();
+                    _holders[address] = holders;
+                }
+                holders.Add(clientId);
+            }
+        }
+
+        /// <summary>
+        /// Drops an address from all leases, for addresses which were explicitly unpinned
+        /// </summary>
+        public void Forget(ulong address)
+        {
+            lock (_lock)
+            {
+                if (!_holders.TryGetValue(address, out HashSet<int> holders))
+                    return;
+                foreach (int clientId in holders)
+                    _leases[clientId].Addresses.Remove(address);
+                _holders.Remove(address);
+            }
+        }
+
+        /// <summary>
+        /// Drops a single address from a client's lease
+        /// </summary>
+        /// <returns>True if no client holds the address anymore. It should be unpinned.</returns>
+        public bool Remove(int clientId, ulong address)
+        {
+            lock (_lock)
+            {
+                if (_leases.TryGetValue(clientId, out Lease lease))
+                    lease.Addresses.Remove(address);
+                if (!_holders.TryGetValue(address, out HashSet<int> holders))
+                    return true;
+                holders.Remove(clientId);
+                if (holders.Count != 0)
+                    return false;
+                _holders.Remove(address);
+                return true;
+            }
+        }
+
+        public bool IsHeld(ulong address)
+        {
+            lock (_lock)
+            {
+                return _holders.ContainsKey(address);
+            }
+        }
+
+        /// <summary>
+        /// Ends the lease of a client
+        /// </summary>
+        /// <returns>The addresses which no other client holds. Those should be unpinned.</returns>
+        public List<ulong> Release(int clientId)
+        {
+            lock (_lock)
+            {
+                List<ulong> released = new List<ulong>();
+                if (!_leases.TryGetValue(clientId, out Lease lease))
+                    return released;
+                _leases.Remove(clientId);
+
+                foreach (ulong address in lease.Addresses)
+                {
+                    HashSet<int> holders = _holders[address];
+                    holders.Remove(clientId);
+                    if (holders.Count == 0)
+                    {
+                        _holders.Remove(address);
+                        released.Add(address);
+                    }
+                }
+                return released;
+            }
+        }
+
+        /// <returns>Clients which weren't heard from for longer than <see cref="LeaseDuration"/></returns>
+        public List<int> GetExpiredClients()
+        {
+            lock (_lock)
+            {
+                DateTime now = _clock();
+                return _leases.Where(kvp => now - kvp.Value.LastSeen > LeaseDuration).Select(kvp => kvp.Key).ToList();
+            }
+        }
+
+        /// <summary>
+        /// Amount and total size of the addresses held by each client
+        /// </summary>
+        /// <param name="sizeOf">Size of the object pinned at an address</param>
+        public Dictionary<int, (int count, ulong bytes)> GetStats(Func<ulong, ulong> sizeOf)
+        {
+            // Sizes are measured outside the lock, measuring might take a while
+            Dictionary<int, List<ulong>> addresses;
+            lock (_lock)
+            {
+                addresses = _leases.ToDictionary(kvp => kvp.Key, kvp => kvp.Value.Addresses.ToList());
+            }
+
+            Dictionary<int, (int, ulong)> stats = new Dictionary<int, (int, ulong)>();
+            foreach (KeyValuePair<int, List<ulong>> kvp in addresses)
+            {
+                ulong bytes = 0;
+                foreach (ulong address in kvp.Value)
+                    bytes += sizeOf(address);
+                stats[kvp.Key] = (kvp.Value.Count, bytes);
+            }
+            return stats;
+        }
+
+        private Lease GetOrAddLease(int clientId)
+        {
+            if (!_leases.TryGetValue(clientId, out Lease lease))
+            {
+                lease = new Lease();
+                _leases[clientId] = lease;
+            }
+            return lease;
+        }
+    }
+}
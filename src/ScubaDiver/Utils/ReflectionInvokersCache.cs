@@ -0,0 +1,307 @@
+using System;
+using System.Collections.Concurrent;
+using System.Linq;
+using System.Linq.Expressions;
+using System.Reflection;
+using System.Threading;
+using ScubaDiver.API.Extensions;
+using ScubaDiver.API.Utils;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Resolved members and compiled delegates for the reflection heavy endpoints (/invoke, /get_field, /set_field, /create_object).
+    /// Resolving a member by name scans all of the type's (and its ancestors') members, and invoking it through
+    /// <see cref="MethodInfo.Invoke(object, object[])"/> costs far more than a direct call. Both are done once per
+    /// (type, member, argument types) here.
+    /// Delegates are only compiled once a member was used <see cref="CompileThreshold"/> times, so one-off calls don't pay for compilation.
+    /// </summary>
+    public class ReflectionInvokersCache
+    {
+        public delegate object MethodInvoker(object instance, object[] args);
+        public delegate object FieldGetter(object instance);
+        public delegate void FieldSetter(object instance, object value);
+        public delegate object ConstructorInvoker(object[] args);
+
+        public const int CompileThreshold = 2;
+        // Entries are tiny but keys come from the client. Past this the cache starts over.
+        public const int MaxEntries = 4096;
+
+        /// <summary>
+        /// Member key. Argument types of null arguments are <see cref="WildCardType"/>s, which all match each other.
+        /// </summary>
+        private sealed class MemberKey : IEquatable<MemberKey>
+        {
+            private readonly Type _type;
+            private readonly string _name;
+            private readonly Type[] _genericArgs;
+            private readonly Type[] _argTypes;
+            private readonly int _hash;
+
+            public MemberKey(Type type, string name, Type[] genericArgs, Type[] argTypes)
+            {
+                _type = type;
+                _name = name ?? string.Empty;
+                _genericArgs = genericArgs ?? Type.EmptyTypes;
+                _argTypes = argTypes ?? Type.EmptyTypes;
+
+                int hash = _type.GetHashCode() * 31 + _name.GetHashCode();
+                foreach (Type t in _genericArgs)
+                    hash = hash * 31 + t.GetHashCode();
+                foreach (Type t in _argTypes)
+                    hash = hash * 31 + (t is WildCardType ? 1 : t.GetHashCode());
+                _hash = hash;
+            }
+
+            public bool Equals(MemberKey other)
+            {
+                if (other == null || _hash != other._hash || _type != other._type || _name != other._name)
+                    return false;
+                return _genericArgs.SequenceEqual(other._genericArgs) &&
+                       _argTypes.SequenceEqual(other._argTypes, ArgTypeComparer.Instance);
+            }
+
+            public override bool Equals(object obj) => Equals(obj as MemberKey);
+            public override int GetHashCode() => _hash;
+
+            private class ArgTypeComparer : System.Collections.Generic.IEqualityComparer<Type>
+            {
+                public static readonly ArgTypeComparer Instance = new();
+                public bool Equals(Type x, Type y) => x == y || (x is WildCardType && y is WildCardType);
+                public int GetHashCode(Type obj) => obj is WildCardType ? 1 : obj.GetHashCode();
+            }
+        }
+
+        /// <summary>
+        /// A resolved member which swaps to a compiled delegate after being used enough
+        /// </summary>
+        public abstract class CachedMember<TDelegate> where TDelegate : Delegate
+        {
+            private int _uses;
+            private TDelegate _compiled;
+
+            protected TDelegate Current
+            {
+                get
+                {
+                    TDelegate compiled = _compiled;
+                    if (compiled != null)
+                        return compiled;
+                    if (Interlocked.Increment(ref _uses) < CompileThreshold)
+                        return Reflected;
+
+                    try
+                    {
+                        compiled = Compile() ?? Reflected;
+                    }
+                    catch (Exception ex)
+                    {
+                        Logger.Debug($"[ReflectionInvokersCache] Failed to compile {this}, using reflection. Exception: {ex.Message}");
+                        compiled = Reflected;
+                    }
+                    _compiled = compiled;
+                    return compiled;
+                }
+            }
+
+            protected abstract TDelegate Reflected { get; }
+            /// <returns>Compiled delegate or null if this member must go through reflection</returns>
+            protected abstract TDelegate Compile();
+        }
+
+        public class CachedMethod : CachedMember<MethodInvoker>
+        {
+            public MethodInfo Method { get; }
+            public CachedMethod(MethodInfo method) => Method = method;
+
+            public object Invoke(object instance, object[] args) => Current(instance, args);
+
+            protected override MethodInvoker Reflected => Method.Invoke;
+            protected override MethodInvoker Compile()
+            {
+                // Reflection handles what a plain call can't: ref/out args written back, mutating boxed structs, pointers
+                ParameterInfo[] parameters = Method.GetParameters();
+                if (Method.ContainsGenericParameters ||
+                    (!Method.IsStatic && Method.DeclaringType.IsValueType) ||
+                    Method.ReturnType.IsByRef || Method.ReturnType.IsPointer ||
+                    parameters.Any(p => p.ParameterType.IsByRef || p.ParameterType.IsPointer))
+                {
+                    return null;
+                }
+
+                ParameterExpression instance = Expression.Parameter(typeof(object), "instance");
+                ParameterExpression args = Expression.Parameter(typeof(object[]), "args");
+                Expression[] callArgs = parameters.Select((p, i) => Unbox(Expression.ArrayIndex(args, Expression.Constant(i)), p.ParameterType)).ToArray();
+                Expression call = Method.IsStatic
+                    ? Expression.Call(Method, callArgs)
+                    : Expression.Call(Expression.Convert(instance, Method.DeclaringType), Method, callArgs);
+                return Expression.Lambda<MethodInvoker>(BoxResult(call), instance, args).Compile();
+            }
+
+            public override string ToString() => $"{Method.DeclaringType}.{Method.Name}";
+        }
+
+        public class CachedField
+        {
+            public FieldInfo Field { get; }
+            private readonly Getter _getter;
+            private readonly Setter _setter;
+
+            public CachedField(FieldInfo field)
+            {
+                Field = field;
+                _getter = new Getter(field);
+                _setter = new Setter(field);
+            }
+
+            public object GetValue(object instance) => _getter.Invoke(instance);
+            public void SetValue(object instance, object value) => _setter.Invoke(instance, value);
+
+            // Fields a compiled accessor can't read/write as reflection does: constants, readonly fields, fields of boxed structs
+            private static bool ReflectionOnly(FieldInfo field, bool write) =>
+                field.IsLiteral || (write && field.IsInitOnly) || (!field.IsStatic && field.DeclaringType.IsValueType) ||
+                field.FieldType.IsPointer || field.DeclaringType.ContainsGenericParameters;
+
+            private class Getter : CachedMember<FieldGetter>
+            {
+                private readonly FieldInfo _field;
+                public Getter(FieldInfo field) => _field = field;
+                public object Invoke(object instance) => Current(instance);
+
+                protected override FieldGetter Reflected => _field.GetValue;
+                protected override FieldGetter Compile()
+                {
+                    if (ReflectionOnly(_field, write: false))
+                        return null;
+                    ParameterExpression instance = Expression.Parameter(typeof(object), "instance");
+                    Expression field = Expression.Field(_field.IsStatic ? null : Expression.Convert(instance, _field.DeclaringType), _field);
+                    return Expression.Lambda<FieldGetter>(Expression.Convert(field, typeof(object)), instance).Compile();
+                }
+
+                public override string ToString() => $"get {_field.DeclaringType}.{_field.Name}";
+            }
+
+            private class Setter : CachedMember<FieldSetter>
+            {
+                private readonly FieldInfo _field;
+                public Setter(FieldInfo field) => _field = field;
+                public void Invoke(object instance, object value) => Current(instance, value);
+
+                protected override FieldSetter Reflected => _field.SetValue;
+                protected override FieldSetter Compile()
+                {
+                    if (ReflectionOnly(_field, write: true))
+                        return null;
+                    ParameterExpression instance = Expression.Parameter(typeof(object), "instance");
+                    ParameterExpression value = Expression.Parameter(typeof(object), "value");
+                    Expression field = Expression.Field(_field.IsStatic ? null : Expression.Convert(instance, _field.DeclaringType), _field);
+                    return Expression.Lambda<FieldSetter>(Expression.Assign(field, Unbox(value, _field.FieldType)), instance, value).Compile();
+                }
+
+                public override string ToString() => $"set {_field.DeclaringType}.{_field.Name}";
+            }
+        }
+
+        public class CachedConstructor : CachedMember<ConstructorInvoker>
+        {
+            public ConstructorInfo Constructor { get; }
+            public CachedConstructor(ConstructorInfo ctor) => Constructor = ctor;
+
+            public object Invoke(object[] args) => Current(args);
+
+            protected override ConstructorInvoker Reflected => Constructor.Invoke;
+            protected override ConstructorInvoker Compile()
+            {
+                ParameterInfo[] parameters = Constructor.GetParameters();
+                if (Constructor.DeclaringType.ContainsGenericParameters || Constructor.DeclaringType.IsAbstract ||
+                    parameters.Any(p => p.ParameterType.IsByRef || p.ParameterType.IsPointer))
+                {
+                    return null;
+                }
+
+                ParameterExpression args = Expression.Parameter(typeof(object[]), "args");
+                Expression[] ctorArgs = parameters.Select((p, i) => Unbox(Expression.ArrayIndex(args, Expression.Constant(i)), p.ParameterType)).ToArray();
+                Expression created = Expression.Convert(Expression.New(Constructor, ctorArgs), typeof(object));
+                return Expression.Lambda<ConstructorInvoker>(created, args).Compile();
+            }
+
+            public override string ToString() => $"{Constructor.DeclaringType}..ctor";
+        }
+
+        /// <summary>
+        /// Converts a boxed argument to the parameter's type. Null for a value type becomes its default, like reflection does.
+        /// </summary>
+        private static Expression Unbox(Expression boxed, Type type)
+        {
+            if (!type.IsValueType || Nullable.GetUnderlyingType(type) != null)
+                return Expression.Convert(boxed, type);
+            return Expression.Condition(Expression.Equal(boxed, Expression.Constant(null)),
+                Expression.Default(type),
+                Expression.Convert(boxed, type));
+        }
+
+        private static Expression BoxResult(Expression call)
+        {
+            if (call.Type == typeof(void))
+                return Expression.Block(call, Expression.Constant(null));
+            return Expression.Convert(call, typeof(object));
+        }
+
+        private static readonly TypeExt.WildCardEnabledTypesComparer WildCardTypesComparer = new();
+
+        private readonly ConcurrentDictionary<MemberKey, CachedMethod> _methods = new();
+        private readonly ConcurrentDictionary<MemberKey, CachedField> _fields = new();
+        private readonly ConcurrentDictionary<MemberKey, CachedConstructor> _ctors = new();
+
+        /// <returns>The method matching the arguments' types (see <see cref="TypeExt.GetMethodRecursive(Type, string, Type[], Type[])"/>) or null</returns>
+        public CachedMethod GetMethod(Type type, string methodName, Type[] genericArgumentTypes, Type[] argumentTypes)
+        {
+            MemberKey key = new(type, methodName, genericArgumentTypes, argumentTypes);
+            if (_methods.TryGetValue(key, out CachedMethod cached))
+                return cached;
+
+            MethodInfo method = type.GetMethodRecursive(methodName, genericArgumentTypes, argumentTypes);
+            if (method == null)
+                return null;
+            return Add(_methods, key, new CachedMethod(method));
+        }
+
+        /// <returns>The field (see <see cref="TypeExt.GetFieldRecursive"/>) or null</returns>
+        public CachedField GetField(Type type, string fieldName)
+        {
+            MemberKey key = new(type, fieldName, null, null);
+            if (_fields.TryGetValue(key, out CachedField cached))
+                return cached;
+
+            FieldInfo field = type.GetFieldRecursive(fieldName);
+            if (field == null)
+                return null;
+            return Add(_fields, key, new CachedField(field));
+        }
+
+        /// <returns>The single public constructor matching the arguments' types or null</returns>
+        public CachedConstructor GetConstructor(Type type, Type[] argumentTypes)
+        {
+            MemberKey key = new(type, null, null, argumentTypes);
+            if (_ctors.TryGetValue(key, out CachedConstructor cached))
+                return cached;
+
+            // Public instance constructors only, like Activator.CreateInstance. Exact match first, then allowing wild cards and base types.
+            ConstructorInfo[] ctors = type.GetConstructors();
+            ConstructorInfo[] matches = ctors.Where(c => c.GetParameters().Select(p => p.ParameterType).SequenceEqual(argumentTypes)).ToArray();
+            if (matches.Length != 1)
+                matches = ctors.Where(c => c.GetParameters().Select(p => p.ParameterType).SequenceEqual(argumentTypes, WildCardTypesComparer)).ToArray();
+            if (matches.Length != 1)
+                return null;
+            ConstructorInfo ctor = matches[0];
+            return Add(_ctors, key, new CachedConstructor(ctor));
+        }
+
+        private static T Add<T>(ConcurrentDictionary<MemberKey, T> cache, MemberKey key, T value)
+        {
+            if (cache.Count >= MaxEntries)
+                cache.Clear();
+            return cache.GetOrAdd(key, value);
+        }
+    }
+}
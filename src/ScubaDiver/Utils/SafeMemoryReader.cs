@@ -0,0 +1,142 @@
+using System;
+using System.Runtime.InteropServices;
+using ScubaDiver.API.Interactions.Memory;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Reads ranges of the current process' memory without risking access violations.
+    /// Copying is done with ReadProcessMemory on our own process, which fails (rather than crashes) on unmapped or guarded pages.
+    /// Ranges that lie close to each other are read with a single call.
+    /// </summary>
+    public static class SafeMemoryReader
+    {
+        /// <summary>
+        /// Ranges at most this many bytes apart are read together
+        /// </summary>
+        public const int CoalesceGap = 256;
+        public const int MaxCoalescedLength = 64 * 1024;
+
+        private static readonly IntPtr CurrentProcess = new IntPtr(-1);
+
+        [ThreadStatic]
+        private static byte[] _scratch;
+
+        /// <summary>
+        /// Reads the ranges into a /read_memory response body: A status byte per range followed by the data of all ranges.
+        /// </summary>
+        public static unsafe byte[] ReadRanges(ulong[] addresses, int[] lengths)
+        {
+            if (addresses.Length != lengths.Length)
+                throw new ArgumentException("Every address requires a length");
+
+            int count = addresses.Length;
+            int[] offsets = new int[count];
+            long total = count;
+            for (int i = 0; i < count; i++)
+            {
+                if (lengths[i] < 0)
+                    throw new ArgumentException($"Negative length for range #{i}");
+                offsets[i] = (int)total;
+                total += lengths[i];
+                if (total - count > ReadMemoryRequest.MaxTotalLength)
+                    throw new ArgumentException($"Requested ranges exceed the limit of {ReadMemoryRequest.MaxTotalLength} bytes");
+            }
+            byte[] response = new byte[total];
+
+            // Visiting the ranges by address so neighbours can be read together
+            ulong[] sortedAddresses = (ulong[])addresses.Clone();
+            int[] order = new int[count];
+            for (int i = 0; i < count; i++)
+                order[i] = i;
+            Array.Sort(sortedAddresses, order);
+
+            fixed (byte* pResponse = response)
+            {
+                int groupStart = 0;
+                while (groupStart < count)
+                {
+                    int first = order[groupStart];
+                    ulong spanStart = addresses[first];
+                    ulong spanEnd = spanStart + (ulong)lengths[first];
+                    int groupEnd = groupStart + 1;
+                    if (spanEnd >= spanStart)
+                    {
+                        while (groupEnd < count)
+                        {
+                            int next = order[groupEnd];
+                            ulong nextEnd = addresses[next] + (ulong)lengths[next];
+                            if (nextEnd < addresses[next] || addresses[next] > spanEnd + CoalesceGap)
+                                break;
+                            ulong newEnd = Math.Max(spanEnd, nextEnd);
+                            if (newEnd - spanStart > MaxCoalescedLength)
+                                break;
+                            spanEnd = newEnd;
+                            groupEnd++;
+                        }
+                    }
+
+                    if (groupEnd - groupStart == 1)
+                    {
+                        ReadSingle(addresses[first], lengths[first], first, response, pResponse, offsets[first]);
+                    }
+                    else
+                    {
+                        int spanLength = (int)(spanEnd - spanStart);
+                        if (_scratch == null || _scratch.Length < spanLength)
+                            _scratch = new byte[Math.Max(spanLength, 4096)];
+                        bool read;
+                        fixed (byte* pScratch = _scratch)
+                        {
+                            read = TryRead(spanStart, pScratch, spanLength);
+                        }
+
+                        for (int i = groupStart; i < groupEnd; i++)
+                        {
+                            int index = order[i];
+                            if (!read)
+                            {
+                                // Some of the span is unreadable. It might not be in this range so each gets its own chance.
+                                ReadSingle(addresses[index], lengths[index], index, response, pResponse, offsets[index]);
+                                continue;
+                            }
+                            Buffer.BlockCopy(_scratch, (int)(addresses[index] - spanStart), response, offsets[index], lengths[index]);
+                            response[index] = (byte)ReadMemoryRequest.RangeStatus.Read;
+                        }
+                    }
+                    groupStart = groupEnd;
+                }
+            }
+            return response;
+        }
+
+        private static unsafe void ReadSingle(ulong address, int length, int index, byte[] response, byte* pResponse, int offset)
+        {
+            bool read = TryRead(address, pResponse + offset, length);
+            if (!read)
+            {
+                // Partial reads might have left something behind
+                Array.Clear(response, offset, length);
+            }
+            response[index] = (byte)(read ? ReadMemoryRequest.RangeStatus.Read : ReadMemoryRequest.RangeStatus.Faulted);
+        }
+
+        /// <summary>
+        /// Reads memory of the current process without risking an access violation
+        /// </summary>
+        /// <returns>False if any of the range couldn't be read</returns>
+        public static unsafe bool TryRead(ulong address, byte* destination, int length)
+        {
+            if (length == 0)
+                return true;
+            if (address + (ulong)length < address)
+                return false;
+            return ReadProcessMemory(CurrentProcess, new IntPtr((long)address), destination, new UIntPtr((uint)length), out UIntPtr bytesRead) &&
+                   bytesRead.ToUInt64() == (ulong)length;
+        }
+
+        [DllImport("kernel32.dll", SetLastError = true)]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        private static extern unsafe bool ReadProcessMemory(IntPtr hProcess, IntPtr lpBaseAddress, byte* lpBuffer, UIntPtr nSize, out UIntPtr lpNumberOfBytesRead);
+    }
+}
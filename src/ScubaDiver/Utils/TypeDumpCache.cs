@@ -0,0 +1,106 @@
+using System;
+using System.Collections.Concurrent;
+using System.Threading;
+using ScubaDiver.API.Interactions.Dumps;
+using ScubaDiver.API.Utils;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Serialized <see cref="TypeDump"/>s, keyed by the identity of the dumped type.
+    /// Dumping a type reflects over all of its members (or analyzes its vftables) so repeated requests are served from here
+    /// until <see cref="Invalidate"/> is called, which should happen whenever new assemblies or modules are loaded.
+    /// </summary>
+    public class TypeDumpCache
+    {
+        // Keys come from the client. Past this the cache starts over.
+        public const int MaxEntries = 1024;
+
+        private class Entry
+        {
+            public string Json;
+            public string ETag;
+            public string NotModifiedJson;
+        }
+
+        private readonly ConcurrentDictionary<string, Entry> _entries = new();
+        private long _generation;
+
+        public int Count => _entries.Count;
+
+        /// <summary>
+        /// Gets the serialized dump of a type, creating it if it isn't cached.
+        /// </summary>
+        /// <param name="key">Identity of the type</param>
+        /// <param name="createDump">Dumps the type. Returning null means it wasn't found, which isn't cached.</param>
+        /// <param name="ifNoneMatch">ETag the client already has</param>
+        /// <returns>The serialized dump, a "not modified" dump if the client's ETag is current or null if the type wasn't found</returns>
+        public string GetOrCreate(string key, Func<TypeDump> createDump, string ifNoneMatch = null)
+        {
+            if (!_entries.TryGetValue(key, out Entry entry))
+            {
+                long generation = Interlocked.Read(ref _generation);
+                TypeDump dump = createDump();
+                if (dump == null)
+                    return null;
+                entry = CreateEntry(dump);
+
+                // Types dumped before an invalidation might already be stale, those are only handed to this caller
+                if (Interlocked.Read(ref _generation) == generation)
+                {
+                    if (_entries.Count >= MaxEntries)
+                        _entries.Clear();
+                    _entries[key] = entry;
+                }
+            }
+
+            return ifNoneMatch != null && ifNoneMatch == entry.ETag ? entry.NotModifiedJson : entry.Json;
+        }
+
+        public void Invalidate()
+        {
+            Interlocked.Increment(ref _generation);
+            _entries.Clear();
+        }
+
+        // How a dump without an ETag ends. ETag and NotModified are TypeDump's last properties.
+        private const string NoETagSuffix = "\"ETag\":null,\"NotModified\":false}";
+
+        private static Entry CreateEntry(TypeDump dump)
+        {
+            // The ETag only depends on the content so dumps that didn't change across invalidations keep it
+            dump.ETag = null;
+            dump.NotModified = false;
+            string json = JsonConvert.SerializeObject(dump);
+            string etag = ComputeETag(json);
+            // Dumps can be large, so the ETag is written into the hashed JSON instead of serializing the dump again
+            if (json.EndsWith(NoETagSuffix, StringComparison.Ordinal))
+            {
+                json = json.Substring(0, json.Length - NoETagSuffix.Length) + $"\"ETag\":\"{etag}\",\"NotModified\":false}}";
+            }
+            else
+            {
+                dump.ETag = etag;
+                json = JsonConvert.SerializeObject(dump);
+            }
+            return new Entry()
+            {
+                Json = json,
+                ETag = etag,
+                NotModifiedJson = JsonConvert.SerializeObject(new TypeDump() { ETag = etag, NotModified = true })
+            };
+        }
+
+        private static string ComputeETag(string json)
+        {
+            // FNV-1a
+            ulong hash = 14695981039346656037;
+            foreach (char c in json)
+            {
+                hash ^= c;
+                hash *= 1099511628211;
+            }
+            return hash.ToString("x16");
+        }
+    }
+}
@@ -0,0 +1,207 @@
+using System;
+using System.Collections.Generic;
+using ScubaDiver.API.Utils;
+
+namespace ScubaDiver
+{
+    /// <summary>
+    /// Index of type names for resolving "simple filters" (see <see cref="Filter"/>) without testing every known name.
+    /// Exact names are looked up in a dictionary, prefixes ("ns::Foo*") are binary searched in a sorted view of the names
+    /// and any other wildcard filter is narrowed down with trigrams of its literal parts before being matched.
+    /// Names can be added at any time, the sorted view and the trigrams catch up on the next query that needs them.
+    /// </summary>
+    public class TypeNameIndex<T>
+    {
+        private const int GramLength = 3;
+
+        private readonly Dictionary<string, int> _ids = new(StringComparer.Ordinal);
+        private readonly List<string> _names = new();
+        private readonly List<List<T>> _items = new();
+        private readonly object _lock = new();
+
+        // Ids ordered by name. Null when names were added since it was sorted.
+        private int[] _sortedIds;
+
+        // <Trigram to: Ids of the names containing it, ascending>
+        // Names are only broken into trigrams once a substring query needs them
+        private readonly Dictionary<ulong, List<int>> _trigrams = new();
+        private int _trigramsIndexedCount;
+
+        public int Count
+        {
+            get
+            {
+                lock (_lock)
+                {
+                    return _names.Count;
+                }
+            }
+        }
+
+        public void Add(string name, T item)
+        {
+            if (name == null)
+                return;
+
+            lock (_lock)
+            {
+                if (!_ids.TryGetValue(name, out int id))
+                {
+                    id = _names.Count;
+                    _ids[name] = id;
+                    _names.Add(name);
+                    _items.Add(new List<T>(1));
+                    _sortedIds = null;
+                }
+                List<T> items = _items[id];
+                if (!items.Contains(item))
+                    items.Add(item);
+            }
+        }
+
+        /// <summary>
+        /// Gets the items of a name. Wildcards in it are taken literally.
+        /// </summary>
+        public List<T> Exact(string name)
+        {
+            lock (_lock)
+            {
+                return name != null && _ids.TryGetValue(name, out int id) ? new List<T>(_items[id]) : new List<T>();
+            }
+        }
+
+        /// <summary>
+        /// Gets the items of the names matching the filter, in the order they were added.
+        /// An item registered under several matching names is returned once per name.
+        /// </summary>
+        /// <param name="filter">A string that only allows '*' as a wild card meaning "0 or more characters". Null matches everything.</param>
+        public List<T> Query(string filter)
+        {
+            lock (_lock)
+            {
+                if (string.IsNullOrEmpty(filter) || filter.Trim('*').Length == 0)
+                    return CollectItems(null);
+
+                if (!filter.Contains("*"))
+                    return Exact(filter);
+
+                int firstWildcard = filter.IndexOf('*');
+                if (firstWildcard == filter.Length - 1)
+                {
+                    // Prefix query, every name in range matches
+                    List<int> prefixIds = GetPrefixRange(filter.Substring(0, firstWildcard));
+                    prefixIds.Sort();
+                    return CollectItems(prefixIds);
+                }
+
+                List<int> candidates = GetCandidates(filter, firstWildcard);
+                Predicate<string> matchesFilter = Filter.CreatePredicate(filter);
+                List<int> matchingIds = new List<int>();
+                IEnumerable<int> idsToTest = candidates ?? AllIds();
+                foreach (int id in idsToTest)
+                {
+                    if (matchesFilter(_names[id]))
+                        matchingIds.Add(id);
+                }
+                return CollectItems(matchingIds);
+            }
+        }
+
+        /// <returns>Ids of names that might match the filter or null if the filter can't narrow them down</returns>
+        private List<int> GetCandidates(string filter, int firstWildcard)
+        {
+            List<int> prefixRange = firstWildcard > 0 ? GetPrefixRange(filter.Substring(0, firstWildcard)) : null;
+            List<int> best = prefixRange;
+
+            IndexPendingTrigrams();
+            foreach (string literal in filter.Split(new[] { '*' }, StringSplitOptions.RemoveEmptyEntries))
+            {
+                for (int i = 0; i + GramLength <= literal.Length; i++)
+                {
+                    if (!_trigrams.TryGetValue(MakeTrigram(literal, i), out List<int> postings))
+                        return new List<int>(); // Nothing contains this part of the filter
+                    if (best == null || postings.Count < best.Count)
+                        best = postings;
+                }
+            }
+
+            // Prefix ranges come in name order
+            if (best != null && best == prefixRange)
+                best.Sort();
+            return best;
+        }
+
+        private List<int> GetPrefixRange(string prefix)
+        {
+            if (_sortedIds == null)
+            {
+                _sortedIds = new int[_names.Count];
+                for (int i = 0; i < _sortedIds.Length; i++)
+                    _sortedIds[i] = i;
+                Array.Sort(_sortedIds, (x, y) => string.CompareOrdinal(_names[x], _names[y]));
+            }
+
+            // Lower bound of the prefix
+            int low = 0;
+            int high = _sortedIds.Length;
+            while (low < high)
+            {
+                int mid = (low + high) / 2;
+                if (string.CompareOrdinal(_names[_sortedIds[mid]], prefix) < 0)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+
+            List<int> output = new List<int>();
+            for (int i = low; i < _sortedIds.Length; i++)
+            {
+                int id = _sortedIds[i];
+                if (!_names[id].StartsWith(prefix, StringComparison.Ordinal))
+                    break;
+                output.Add(id);
+            }
+            return output;
+        }
+
+        private void IndexPendingTrigrams()
+        {
+            HashSet<ulong> nameTrigrams = new HashSet<ulong>();
+            for (int id = _trigramsIndexedCount; id < _names.Count; id++)
+            {
+                string name = _names[id];
+                nameTrigrams.Clear();
+                for (int i = 0; i + GramLength <= name.Length; i++)
+                {
+                    ulong trigram = MakeTrigram(name, i);
+                    if (!nameTrigrams.Add(trigram))
+                        continue;
+                    if (!_trigrams.TryGetValue(trigram, out List<int> postings))
+                    {
+                        postings = new List<int>();
+                        _trigrams[trigram] = postings;
+                    }
+                    postings.Add(id);
+                }
+            }
+            _trigramsIndexedCount = _names.Count;
+        }
+
+        private static ulong MakeTrigram(string s, int index) =>
+            ((ulong)s[index] << 32) | ((ulong)s[index + 1] << 16) | s[index + 2];
+
+        private IEnumerable<int> AllIds()
+        {
+            for (int id = 0; id < _names.Count; id++)
+                yield return id;
+        }
+
+        private List<T> CollectItems(List<int> ids)
+        {
+            List<T> output = new List<T>();
+            foreach (int id in ids ?? AllIds())
+                output.AddRange(_items[id]);
+            return output;
+        }
+    }
+}
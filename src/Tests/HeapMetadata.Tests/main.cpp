@@ -0,0 +1,364 @@
+// Tests HeapMetadata (object sizes from NT heap block headers) on Linux.
+// Heaps are built in a fake address space, with the segments and encoded block headers where Windows puts them.
+//   HeapMetadataTests   Runs all checks (used by ctest)
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "HeapMetadata.h"
+
+static int g_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "CHECK FAILED: %s (%s:%d)\n", #cond, __FILE__, __LINE__); \
+            ++g_failures; \
+        } \
+    } while (0)
+
+// ----------------
+// Fake Address Space
+// ----------------
+
+struct FakeMemory {
+    std::map<uint64_t, std::vector<uint8_t>> regions;
+    // Sizes the fallback knows, by address
+    std::map<uint64_t, uint64_t> fallbackSizes;
+    int fallbackCalls = 0;
+
+    void Map(uint64_t address, size_t size) {
+        regions[address] = std::vector<uint8_t>(size, 0);
+    }
+
+    uint8_t* At(uint64_t address, size_t size) {
+        auto it = regions.upper_bound(address);
+        if (it == regions.begin()) {
+            return nullptr;
+        }
+        --it;
+        uint64_t offset = address - it->first;
+        if (offset + size > it->second.size()) {
+            return nullptr;
+        }
+        return it->second.data() + offset;
+    }
+
+    void Write(uint64_t address, const void* data, size_t size) {
+        uint8_t* destination = At(address, size);
+        CHECK(destination != nullptr);
+        if (destination != nullptr) {
+            memcpy(destination, data, size);
+        }
+    }
+
+    void Write32(uint64_t address, uint32_t value) {
+        Write(address, &value, sizeof(value));
+    }
+
+    void WritePointer(uint64_t address, uint64_t value, uint32_t pointerSize) {
+        Write(address, &value, pointerSize);
+    }
+};
+
+static bool ReadFake(void* context, uint64_t address, void* buffer, size_t size) {
+    uint8_t* source = ((FakeMemory*)context)->At(address, size);
+    if (source == nullptr) {
+        return false;
+    }
+    memcpy(buffer, source, size);
+    return true;
+}
+
+static uint64_t FallbackFake(void* context, uint64_t /* heap */, uint64_t address) {
+    FakeMemory* memory = (FakeMemory*)context;
+    memory->fallbackCalls++;
+    auto it = memory->fallbackSizes.find(address);
+    return it == memory->fallbackSizes.end() ? 0 : it->second;
+}
+
+static const uint8_t Key[8] = { 0x5A, 0xC3, 0x17, 0x00, 0x9E, 0x21, 0x00, 0x00 };
+
+// Builds an NT heap at `heap` whose segments are the heap itself and every address in `extraSegments`.
+// Each segment is `segmentSize` bytes, with its blocks starting 0x800 bytes in.
+static void BuildHeap(FakeMemory& memory, uint32_t pointerSize, uint64_t heap, bool encoded,
+    const std::vector<uint64_t>& extraSegments, size_t segmentSize = 0x4000) {
+    NtHeapLayout layout = NtHeapLayout::For(pointerSize);
+    std::vector<uint64_t> segments = { heap };
+    segments.insert(segments.end(), extraSegments.begin(), extraSegments.end());
+
+    for (uint64_t segment : segments) {
+        memory.Map(segment, segmentSize);
+        memory.Write32(segment + layout.signature, NtHeapSignature);
+        memory.WritePointer(segment + layout.firstEntry, segment + 0x800, pointerSize);
+        memory.WritePointer(segment + layout.lastValidEntry, segment + segmentSize, pointerSize);
+    }
+    memory.Write32(heap + layout.encodeFlagMask, encoded ? 0x00100000 : 0);
+    memory.Write(heap + layout.encoding + layout.entrySize, Key, sizeof(Key));
+
+    // head -> heap -> extra segments -> head
+    uint64_t head = heap + layout.segmentList;
+    uint64_t previous = head;
+    for (uint64_t segment : segments) {
+        memory.WritePointer(previous, segment + layout.segmentListEntry, pointerSize);
+        previous = segment + layout.segmentListEntry;
+    }
+    memory.WritePointer(previous, head, pointerSize);
+}
+
+static HeapInfo ReadHeap(FakeMemory& memory, uint64_t heap, uint32_t pointerSize) {
+    HeapInfo info;
+    CHECK(ReadHeapInfo(ReadFake, &memory, heap, pointerSize, &info));
+    return info;
+}
+
+// Writes the header of a block holding `userSize` bytes at `userAddress`, encoded like the heap encodes it
+static void WriteBlock(FakeMemory& memory, const HeapInfo& heap, uint64_t userAddress, uint64_t userSize,
+    uint8_t flags = HeapEntryBusy, bool breakChecksum = false) {
+    uint32_t granularity = heap.layout.granularity;
+    // Requested size plus the header, rounded up to the heap's unit
+    uint64_t blockSize = (userSize + granularity + granularity - 1) / granularity * granularity;
+    uint16_t units = (uint16_t)(blockSize / granularity);
+    uint8_t entry[8] = {
+        (uint8_t)(units & 0xFF), (uint8_t)(units >> 8), flags, 0,
+        0x02, 0x00, 0x00, (uint8_t)(blockSize - userSize) };
+    entry[3] = entry[0] ^ entry[1] ^ entry[2];
+    if (breakChecksum) {
+        entry[3] ^= 0x40;
+    }
+    for (size_t i = 0; heap.encoded && i < sizeof(entry); ++i) {
+        entry[i] ^= heap.encoding[i];
+    }
+    memory.Write(userAddress - granularity + heap.layout.entrySize, entry, sizeof(entry));
+}
+
+// LFH block headers are encoded with the subsegment's key, only UnusedBytes is readable
+static void WriteLfhBlock(FakeMemory& memory, const HeapInfo& heap, uint64_t userAddress) {
+    uint8_t entry[8] = { 0x3B, 0x91, 0xE4, 0x07, 0x6C, 0x12, 0x00, HeapEntryLfh | 0x08 };
+    memory.Write(userAddress - heap.layout.granularity + heap.layout.entrySize, entry, sizeof(entry));
+}
+
+static uint64_t Decode(FakeMemory& memory, const HeapInfo& heap, uint64_t address, HeapBlockKind expectedKind) {
+    uint64_t size = 0;
+    HeapBlockKind kind = DecodeHeapBlock(ReadFake, &memory, heap, address, &size);
+    CHECK(kind == expectedKind);
+    return kind == HeapBlockKind::Backend ? size : 0;
+}
+
+// ----------------
+// Checks
+// ----------------
+
+static void VerifyReadHeapInfo() {
+    FakeMemory memory;
+    BuildHeap(memory, 8, 0x10000000, true, { 0x20000000 });
+    HeapInfo heap = ReadHeap(memory, 0x10000000, 8);
+    CHECK(heap.kind == HeapKind::Nt);
+    CHECK(heap.encoded);
+    CHECK(memcmp(heap.encoding, Key, sizeof(Key)) == 0);
+    CHECK(heap.segments.size() == 2);
+    CHECK(heap.InSegments(0x10000800));
+    CHECK(!heap.InSegments(0x100007F0));
+    CHECK(heap.InSegments(0x20003FF0));
+    CHECK(!heap.InSegments(0x20004000));
+
+    // Not a heap
+    HeapInfo notHeap;
+    memory.Map(0x30000000, 0x1000);
+    CHECK(!ReadHeapInfo(ReadFake, &memory, 0x30000000, 8, &notHeap));
+    CHECK(!ReadHeapInfo(ReadFake, &memory, 0x40000000, 8, &notHeap));
+
+    // Segment heap
+    memory.Map(0x50000000, 0x1000);
+    memory.Write32(0x50000000 + 0x10, SegmentHeapSignature);
+    HeapInfo segmentHeap;
+    CHECK(ReadHeapInfo(ReadFake, &memory, 0x50000000, 8, &segmentHeap));
+    CHECK(segmentHeap.kind == HeapKind::Segment);
+}
+
+static void VerifyBackendBlocks() {
+    FakeMemory memory;
+    BuildHeap(memory, 8, 0x10000000, true, { 0x20000000 });
+    HeapInfo heap = ReadHeap(memory, 0x10000000, 8);
+
+    WriteBlock(memory, heap, 0x10000810, 0x48);
+    WriteBlock(memory, heap, 0x10000900, 0x1);
+    WriteBlock(memory, heap, 0x10001000, 0x3F0);
+    WriteBlock(memory, heap, 0x20000A00, 0x128);
+    CHECK(Decode(memory, heap, 0x10000810, HeapBlockKind::Backend) == 0x48);
+    CHECK(Decode(memory, heap, 0x10000900, HeapBlockKind::Backend) == 0x1);
+    CHECK(Decode(memory, heap, 0x10001000, HeapBlockKind::Backend) == 0x3F0);
+    // In the second segment
+    CHECK(Decode(memory, heap, 0x20000A00, HeapBlockKind::Backend) == 0x128);
+}
+
+static void VerifyRejectedBlocks() {
+    FakeMemory memory;
+    BuildHeap(memory, 8, 0x10000000, true, {});
+    HeapInfo heap = ReadHeap(memory, 0x10000000, 8);
+
+    // Free
+    WriteBlock(memory, heap, 0x10000810, 0x48, 0);
+    Decode(memory, heap, 0x10000810, HeapBlockKind::NotFound);
+    // Corrupt or not a header at all
+    WriteBlock(memory, heap, 0x10000900, 0x48, HeapEntryBusy, true);
+    Decode(memory, heap, 0x10000900, HeapBlockKind::NotFound);
+    Decode(memory, heap, 0x10000A00, HeapBlockKind::NotFound);
+    // Allocated with VirtualAlloc, the header's size is meaningless
+    WriteBlock(memory, heap, 0x10000B00, 0x48, HeapEntryBusy | HeapEntryVirtualAlloc);
+    Decode(memory, heap, 0x10000B00, HeapBlockKind::NotFound);
+    // Misaligned
+    WriteBlock(memory, heap, 0x10000C00, 0x48);
+    Decode(memory, heap, 0x10000C08, HeapBlockKind::NotFound);
+    // Before the first block and outside the heap
+    Decode(memory, heap, 0x10000200, HeapBlockKind::NotFound);
+    Decode(memory, heap, 0x30000000, HeapBlockKind::NotFound);
+
+    // Not encoded with the heap's key
+    FakeMemory otherMemory;
+    BuildHeap(otherMemory, 8, 0x10000000, false, {});
+    HeapInfo unencodedHeap = ReadHeap(otherMemory, 0x10000000, 8);
+    WriteBlock(otherMemory, unencodedHeap, 0x10000810, 0x48);
+    Decode(otherMemory, heap, 0x10000810, HeapBlockKind::NotFound);
+}
+
+static void VerifyUnencodedHeap() {
+    FakeMemory memory;
+    BuildHeap(memory, 8, 0x10000000, false, {});
+    HeapInfo heap = ReadHeap(memory, 0x10000000, 8);
+    CHECK(!heap.encoded);
+    WriteBlock(memory, heap, 0x10000810, 0x60);
+    CHECK(Decode(memory, heap, 0x10000810, HeapBlockKind::Backend) == 0x60);
+}
+
+static void VerifyX86Heap() {
+    FakeMemory memory;
+    BuildHeap(memory, 4, 0x00800000, true, { 0x00A00000 });
+    HeapInfo heap = ReadHeap(memory, 0x00800000, 4);
+    CHECK(heap.layout.granularity == 8);
+    CHECK(heap.segments.size() == 2);
+    WriteBlock(memory, heap, 0x00800808, 0x24);
+    WriteBlock(memory, heap, 0x00A01000, 0x7);
+    CHECK(Decode(memory, heap, 0x00800808, HeapBlockKind::Backend) == 0x24);
+    CHECK(Decode(memory, heap, 0x00A01000, HeapBlockKind::Backend) == 0x7);
+    Decode(memory, heap, 0x00800804, HeapBlockKind::NotFound);
+}
+
+static void VerifyLfhBlocks() {
+    FakeMemory memory;
+    BuildHeap(memory, 8, 0x10000000, true, {});
+    std::vector<HeapInfo> heaps = { ReadHeap(memory, 0x10000000, 8) };
+    WriteLfhBlock(memory, heaps[0], 0x10000810);
+    WriteLfhBlock(memory, heaps[0], 0x10000900);
+    Decode(memory, heaps[0], 0x10000810, HeapBlockKind::Lfh);
+
+    // The fallback measures LFH blocks. Blocks it doesn't know stay unknown.
+    memory.fallbackSizes[0x10000810] = 0x30;
+    VftableSizeCache cache;
+    uint64_t addresses[] = { 0x10000810, 0x10000900 };
+    uint64_t vftables[] = { 0x7FF600001000, 0x7FF600002000 };
+    uint64_t sizes[2];
+    CHECK(QueryObjectSizes(ReadFake, FallbackFake, &memory, heaps, cache, addresses, vftables, 2, sizes) == 1);
+    CHECK(sizes[0] == 0x30);
+    CHECK(sizes[1] == 0);
+    CHECK(memory.fallbackCalls == 2);
+
+    // Without a fallback
+    CHECK(QueryObjectSizes(ReadFake, nullptr, &memory, heaps, cache, addresses + 1, vftables + 1, 1, sizes) == 0);
+}
+
+static void VerifySegmentHeap() {
+    FakeMemory memory;
+    memory.Map(0x50000000, 0x1000);
+    memory.Write32(0x50000000 + 0x10, SegmentHeapSignature);
+    BuildHeap(memory, 8, 0x10000000, true, {});
+    std::vector<HeapInfo> heaps = { ReadHeap(memory, 0x50000000, 8), ReadHeap(memory, 0x10000000, 8) };
+    WriteBlock(memory, heaps[1], 0x10000810, 0x48);
+    memory.fallbackSizes[0x60000040] = 0x90;
+
+    VftableSizeCache cache;
+    uint64_t addresses[] = { 0x60000040, 0x10000810 };
+    uint64_t vftables[] = { 0x7FF600001000, 0x7FF600002000 };
+    uint64_t sizes[2];
+    CHECK(QueryObjectSizes(ReadFake, FallbackFake, &memory, heaps, cache, addresses, vftables, 2, sizes) == 2);
+    CHECK(sizes[0] == 0x90);
+    CHECK(sizes[1] == 0x48);
+}
+
+static void VerifyCache() {
+    FakeMemory memory;
+    BuildHeap(memory, 8, 0x10000000, true, {});
+    std::vector<HeapInfo> heaps = { ReadHeap(memory, 0x10000000, 8) };
+    WriteBlock(memory, heaps[0], 0x10000810, 0x58);
+    WriteBlock(memory, heaps[0], 0x10000900, 0x48);
+    WriteLfhBlock(memory, heaps[0], 0x10000A00);
+
+    VftableSizeCache cache;
+    uint64_t addresses[] = { 0x10000810, 0x10000900 };
+    uint64_t vftables[] = { 0x7FF600001000, 0x7FF600001000 };
+    uint64_t sizes[2];
+    // The first object is measured, the second is answered from the cache
+    CHECK(QueryObjectSizes(ReadFake, FallbackFake, &memory, heaps, cache, addresses, vftables, 2, sizes) == 2);
+    CHECK(sizes[0] == 0x58);
+    CHECK(sizes[1] == 0x58);
+    CHECK(cache.Count() == 1);
+
+    // Smaller sizes replace bigger ones
+    cache.Add(0x7FF600001000, 0x48);
+    cache.Add(0x7FF600001000, 0x100);
+    uint64_t size = 0;
+    CHECK(cache.TryGet(0x7FF600001000, &size));
+    CHECK(size == 0x48);
+    CHECK(!cache.TryGet(0x7FF600002000, &size));
+
+    // Cached vftables don't touch the heap, not even the fallback
+    uint64_t lfhAddress = 0x10000A00;
+    uint64_t lfhVftable = 0x7FF600001000;
+    CHECK(QueryObjectSizes(ReadFake, FallbackFake, &memory, heaps, cache, &lfhAddress, &lfhVftable, 1, sizes) == 1);
+    CHECK(sizes[0] == 0x48);
+    CHECK(memory.fallbackCalls == 0);
+}
+
+static void VerifyVftablesFromObjects() {
+    FakeMemory memory;
+    BuildHeap(memory, 8, 0x10000000, true, {});
+    std::vector<HeapInfo> heaps = { ReadHeap(memory, 0x10000000, 8) };
+    WriteBlock(memory, heaps[0], 0x10000810, 0x40);
+    WriteBlock(memory, heaps[0], 0x10000900, 0x40);
+    memory.WritePointer(0x10000810, 0x7FF600003000, 8);
+    memory.WritePointer(0x10000900, 0x7FF600003000, 8);
+
+    VftableSizeCache cache;
+    uint64_t addresses[] = { 0x10000810, 0x10000900, 0x30000000 };
+    uint64_t sizes[3];
+    CHECK(QueryObjectSizes(ReadFake, FallbackFake, &memory, heaps, cache, addresses, nullptr, 3, sizes) == 2);
+    CHECK(sizes[0] == 0x40);
+    CHECK(sizes[1] == 0x40);
+    CHECK(sizes[2] == 0);
+    uint64_t size = 0;
+    CHECK(cache.TryGet(0x7FF600003000, &size));
+    CHECK(size == 0x40);
+
+    // No heaps at all
+    CHECK(QueryObjectSizes(ReadFake, FallbackFake, &memory, {}, cache, addresses, nullptr, 3, sizes) == 0);
+    CHECK(sizes[0] == 0);
+}
+
+int main() {
+    VerifyReadHeapInfo();
+    VerifyBackendBlocks();
+    VerifyRejectedBlocks();
+    VerifyUnencodedHeap();
+    VerifyX86Heap();
+    VerifyLfhBlocks();
+    VerifySegmentHeap();
+    VerifyCache();
+    VerifyVftablesFromObjects();
+    if (g_failures != 0) {
+        fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,268 @@
+using System.Collections.Specialized;
+using System.Diagnostics;
+using System.Net;
+using System.Net.Sockets;
+using System.Text;
+using ScubaDiver.API.Protocol.SimpleHttp;
+
+namespace Lifeboat.Bench;
+
+/// <summary>
+/// Measures Lifeboat's relay throughput and the latency it adds.
+/// The benchmark runs three processes, like a real deployment:
+///  1. This process - Hosts the clients.
+///  2. A stand-in diver (this executable with the 'diver' argument) which echoes every request. It reverse-connects to
+///     Lifeboat like RnetReverseRequestsListener and also accepts direct connections for the baseline.
+///  3. Lifeboat, bound to the stand-in diver's PID.
+/// </summary>
+public class Program
+{
+    private const string Usage =
+        "Usage: Lifeboat.Bench [--clients N] [--threads N] [--requests N] [--body BYTES]\n" +
+        "       Lifeboat.Bench diver <port>   (stand-in diver, started by the benchmark)";
+
+    public static int Main(string[] args)
+    {
+        if (args.Length == 2 && args[0] == "diver")
+        {
+            StandInDiver.RunAsync(int.Parse(args[1])).GetAwaiter().GetResult();
+            return 0;
+        }
+
+        if (args.Contains("-h"))
+        {
+            Console.WriteLine(Usage);
+            return 0;
+        }
+
+        int clients = GetArg(args, "--clients", 4);
+        int threads = GetArg(args, "--threads", 8);
+        int requests = GetArg(args, "--requests", 2000);
+        int bodySize = GetArg(args, "--body", 256);
+
+        int port = GetFreePort();
+        using Process diver = StartSelf($"diver {port}");
+        using Process lifeboat = StartLifeboat(diver.Id, port);
+        try
+        {
+            // Direct connections are served on the port after Lifeboat's
+            LoadResult direct = Load.Run(port + 1, clients, threads, requests, bodySize);
+            WaitForDiverConnections(port);
+            LoadResult relayed = Load.Run(port, clients, threads, requests, bodySize);
+
+            Console.WriteLine($"{clients} clients x {threads} threads x {requests} requests, {bodySize} bytes bodies");
+            Console.WriteLine(LoadResult.Header);
+            Console.WriteLine(direct.Format("Direct"));
+            Console.WriteLine(relayed.Format("Lifeboat"));
+            Console.WriteLine($"Added latency: p50 +{relayed.P50Ms - direct.P50Ms:F3}ms, p99 +{relayed.P99Ms - direct.P99Ms:F3}ms");
+        }
+        finally
+        {
+            try { lifeboat.Kill(); } catch { }
+            try { diver.Kill(); } catch { }
+        }
+        return 0;
+    }
+
+    private static int GetArg(string[] args, string name, int defaultValue)
+    {
+        int index = Array.IndexOf(args, name);
+        return index != -1 && index + 1 < args.Length ? int.Parse(args[index + 1]) : defaultValue;
+    }
+
+    private static int GetFreePort()
+    {
+        // Lifeboat listens on 'port' and the stand-in diver on 'port + 1' so we need both free
+        while (true)
+        {
+            TcpListener l = new TcpListener(IPAddress.Loopback, 0);
+            l.Start();
+            int port = ((IPEndPoint)l.LocalEndpoint).Port;
+            l.Stop();
+            if (port >= ushort.MaxValue)
+                continue;
+            try
+            {
+                TcpListener next = new TcpListener(IPAddress.Loopback, port + 1);
+                next.Start();
+                next.Stop();
+                return port;
+            }
+            catch (SocketException)
+            {
+            }
+        }
+    }
+
+    private static Process StartSelf(string args)
+    {
+        string processPath = Environment.ProcessPath;
+        bool viaDotnet = Path.GetFileNameWithoutExtension(processPath) == "dotnet";
+        ProcessStartInfo psi = viaDotnet
+            ? new ProcessStartInfo(processPath, $"\"{typeof(Program).Assembly.Location}\" {args}")
+            : new ProcessStartInfo(processPath, args);
+        return Process.Start(psi);
+    }
+
+    private static Process StartLifeboat(int diverPid, int port)
+    {
+        // Lifeboat listens on <pid> + <offset>
+        string lifeboatDll = Path.Combine(AppContext.BaseDirectory, "Lifeboat.dll");
+        ProcessStartInfo psi = new ProcessStartInfo("dotnet", $"\"{lifeboatDll}\" {diverPid} {port - diverPid}")
+        {
+            RedirectStandardOutput = true
+        };
+        Process lifeboat = Process.Start(psi);
+        // Lifeboat is chatty, keep its output out of the results
+        lifeboat.OutputDataReceived += (_, _) => { };
+        lifeboat.BeginOutputReadLine();
+        return lifeboat;
+    }
+
+    private static void WaitForDiverConnections(int port)
+    {
+        Stopwatch sw = Stopwatch.StartNew();
+        while (sw.Elapsed < TimeSpan.FromSeconds(30))
+        {
+            try
+            {
+                using TcpClient tcpClient = new TcpClient();
+                tcpClient.Connect(IPAddress.Loopback, port);
+                using ConcurrentHttpClient client = new ConcurrentHttpClient(tcpClient, -1);
+                HttpResponseSummary resp = client.Send(HttpRequestSummary.FromJson("/ping", new NameValueCollection(), null));
+                if (!resp.BodyString.Contains("\"error\""))
+                    return;
+            }
+            catch (SocketException)
+            {
+                // Lifeboat isn't up yet
+            }
+            Thread.Sleep(100);
+        }
+        throw new TimeoutException("Stand-in diver didn't connect to Lifeboat");
+    }
+}
+
+public static class StandInDiver
+{
+    private const int ReverseConnectionsCount = 4;
+
+    public static async Task RunAsync(int lifeboatPort)
+    {
+        TcpListener direct = new TcpListener(IPAddress.Loopback, lifeboatPort + 1);
+        direct.Start();
+        _ = AcceptDirectAsync(direct);
+
+        Task[] reverse = Enumerable.Range(0, ReverseConnectionsCount).Select(_ => ReverseConnectAsync(lifeboatPort)).ToArray();
+        await Task.WhenAll(reverse);
+    }
+
+    private static async Task AcceptDirectAsync(TcpListener listener)
+    {
+        while (true)
+        {
+            TcpClient client = await listener.AcceptTcpClientAsync();
+            client.NoDelay = true;
+            _ = ServeAsync(client, new SimpleHttpFrameReader(client.GetStream()));
+        }
+    }
+
+    private static async Task ReverseConnectAsync(int lifeboatPort)
+    {
+        TcpClient client = new TcpClient() { NoDelay = true };
+        while (true)
+        {
+            try
+            {
+                await client.ConnectAsync(IPAddress.Loopback, lifeboatPort);
+                break;
+            }
+            catch (SocketException)
+            {
+                await Task.Delay(50);
+            }
+        }
+
+        HttpRequestSummary intro = HttpRequestSummary.FromJson("/proxy_intro", new NameValueCollection(), "{\"role\":\"diver\"}");
+        SimpleHttpEncoder.TryEncodeHttpRequest(intro, out byte[] introBytes);
+        await client.GetStream().WriteAsync(introBytes);
+
+        SimpleHttpFrameReader reader = new SimpleHttpFrameReader(client.GetStream());
+        await reader.ReadFrameAsync(CancellationToken.None);
+        await ServeAsync(client, reader);
+    }
+
+    private static async Task ServeAsync(TcpClient client, SimpleHttpFrameReader reader)
+    {
+        using (client)
+        using (reader)
+        {
+            NetworkStream stream = client.GetStream();
+            byte[] frame;
+            while ((frame = await reader.ReadFrameAsync(CancellationToken.None)) != null)
+            {
+                SimpleHttpEncoder.TryParseHttpRequest(frame, out HttpRequestSummary request);
+                Dictionary<string, string> headers = new Dictionary<string, string> { ["requestId"] = request.RequestId };
+                string body = request.Body.Length > 0 ? request.BodyString : "{\"status\":\"pong\"}";
+                HttpResponseSummary response = HttpResponseSummary.FromJson(HttpStatusCode.OK, body, headers);
+                SimpleHttpEncoder.TryEncodeHttpResponse(response, out byte[] encoded);
+                await stream.WriteAsync(encoded);
+            }
+        }
+    }
+}
+
+public record LoadResult(int Requests, TimeSpan Elapsed, long Bytes, double P50Ms, double P99Ms, double MaxMs)
+{
+    public const string Header = "Mode      | Requests/s |     MB/s | p50 (ms) | p99 (ms) | max (ms)";
+
+    public string Format(string mode) =>
+        $"{mode,-9} | {Requests / Elapsed.TotalSeconds,10:F0} | {Bytes / Elapsed.TotalSeconds / (1024 * 1024),8:F2} | " +
+        $"{P50Ms,8:F3} | {P99Ms,8:F3} | {MaxMs,8:F3}";
+}
+
+public static class Load
+{
+    public static LoadResult Run(int port, int clientsCount, int threadsPerClient, int requestsPerThread, int bodySize)
+    {
+        string body = "{\"payload\":\"" + new string('x', Math.Max(0, bodySize - 14)) + "\"}";
+        List<ConcurrentHttpClient> clients = new List<ConcurrentHttpClient>();
+        for (int i = 0; i < clientsCount; i++)
+        {
+            TcpClient tcpClient = new TcpClient() { NoDelay = true };
+            tcpClient.Connect(IPAddress.Loopback, port);
+            clients.Add(new ConcurrentHttpClient(tcpClient, -1));
+        }
+
+        // Warm up
+        foreach (ConcurrentHttpClient client in clients)
+        {
+            for (int i = 0; i < 100; i++)
+                client.Send(HttpRequestSummary.FromJson("/echo", new NameValueCollection(), body));
+        }
+
+        double[][] latencies = new double[clientsCount * threadsPerClient][];
+        Stopwatch total = Stopwatch.StartNew();
+        Parallel.For(0, latencies.Length, new ParallelOptions { MaxDegreeOfParallelism = latencies.Length }, t =>
+        {
+            ConcurrentHttpClient client = clients[t % clientsCount];
+            double[] mine = new double[requestsPerThread];
+            for (int i = 0; i < requestsPerThread; i++)
+            {
+                long start = Stopwatch.GetTimestamp();
+                HttpResponseSummary resp = client.Send(HttpRequestSummary.FromJson("/echo", new NameValueCollection(), body));
+                mine[i] = Stopwatch.GetElapsedTime(start).TotalMilliseconds;
+                if (resp.Body.Length != Encoding.UTF8.GetByteCount(body))
+                    throw new Exception("Echo mismatch");
+            }
+            latencies[t] = mine;
+        });
+        total.Stop();
+        clients.ForEach(c => c.Dispose());
+
+        double[] all = latencies.SelectMany(l => l).OrderBy(l => l).ToArray();
+        double Percentile(double p) => all[Math.Min(all.Length - 1, (int)(p / 100 * all.Length))];
+        long bytes = (long)all.Length * Encoding.UTF8.GetByteCount(body) * 2;
+        return new LoadResult(all.Length, total.Elapsed, bytes, Percentile(50), Percentile(99), all[^1]);
+    }
+}
@@ -1,10 +1,13 @@
-﻿using System.Text;
+﻿using System.Collections.Generic;
+using System.Linq;
+using System.Text;
 
 namespace RemoteNET.Vessel
 {
     public class TestClass
     {
         public int TestField1 = 5;
+        public List<int> TestList = Enumerable.Range(0, 300).ToList();
         public int TestProp1 => 6;
 
         public int TestProp2
@@ -0,0 +1,242 @@
+// Benchmarks ThisFilter (the `this` filter of detoured MSVC functions) on Linux.
+//   ThisFilterBench            Lookup and stub costs for growing address sets
+//   ThisFilterBench --verify   Correctness checks only (used by ctest)
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ThisFilter.h"
+
+#if THIS_FILTER_STUB_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+static int g_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "CHECK FAILED: %s (%s:%d)\n", #cond, __FILE__, __LINE__); \
+            ++g_failures; \
+        } \
+    } while (0)
+
+static std::vector<uintptr_t> MakeAddresses(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<uintptr_t> addresses(count);
+    for (uintptr_t& address : addresses) {
+        // Heap-like, 16 bytes aligned
+        address = (uintptr_t)((rng() & 0x00007FFFFFFFFFF0ull) | 0x10);
+    }
+    return addresses;
+}
+
+static double NanosPerOp(std::chrono::steady_clock::duration elapsed, size_t ops) {
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (double)ops;
+}
+
+// ----------------
+// Address Set
+// ----------------
+
+static void VerifySet() {
+    ThisFilter filter;
+    CHECK(!filter.Contains(0x1000));
+    CHECK(!filter.Contains(0));
+
+    std::vector<uintptr_t> addresses = MakeAddresses(10000, 1);
+    addresses.push_back(0); // Ignored
+    filter.Set(addresses.data(), addresses.size());
+    for (uintptr_t address : addresses) {
+        CHECK(filter.Contains(address) == (address != 0));
+    }
+    for (uintptr_t address : MakeAddresses(10000, 2)) {
+        CHECK(!filter.Contains(address + 8)); // Never in the set (set's addresses end with 0x..0)
+    }
+
+    filter.Set(nullptr, 0);
+    CHECK(!filter.Contains(addresses[0]));
+}
+
+static void VerifyConcurrentUpdates() {
+    // Readers must always see either the old or the new set, never a torn one
+    ThisFilter filter;
+    std::vector<uintptr_t> stable = MakeAddresses(64, 3);
+    filter.Set(stable.data(), stable.size());
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> misses(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!stop.load()) {
+                for (uintptr_t address : stable) {
+                    if (!filter.Contains(address))
+                        misses++;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 200; ++i) {
+        std::vector<uintptr_t> next = stable;
+        std::vector<uintptr_t> extra = MakeAddresses(i * 10, 100 + i);
+        next.insert(next.end(), extra.begin(), extra.end());
+        filter.Set(next.data(), next.size());
+    }
+    stop = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    CHECK(misses.load() == 0);
+}
+
+static void BenchSet(size_t count) {
+    ThisFilter filter;
+    std::vector<uintptr_t> addresses = MakeAddresses(count, 7);
+    filter.Set(addresses.data(), addresses.size());
+    std::vector<uintptr_t> others = MakeAddresses(4096, 8);
+    for (uintptr_t& address : others) {
+        address += 8;
+    }
+
+    const size_t iterations = 20000000;
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        found += filter.Contains(addresses[i % addresses.size()]);
+    }
+    double hitNs = NanosPerOp(std::chrono::steady_clock::now() - start, iterations);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        found += filter.Contains(others[i & 4095]);
+    }
+    double missNs = NanosPerOp(std::chrono::steady_clock::now() - start, iterations);
+
+    printf("Set of %7zu addresses | hit %6.2f ns | miss %6.2f ns | (%zu)\n", count, hitNs, missNs, found);
+}
+
+// ----------------
+// Stub
+// ----------------
+
+#if THIS_FILTER_STUB_SUPPORTED
+
+typedef uint64_t(THIS_FILTER_STUB_CALL* HookedFunc)(uintptr_t self, double a, uint64_t b, double c);
+
+static volatile uint64_t g_sink;
+
+// Stand-ins for the managed hook and the original function. Both check every argument survived the stub.
+static uint64_t THIS_FILTER_STUB_CALL OnHit(uintptr_t self, double a, uint64_t b, double c) {
+    g_sink = self;
+    return (a == 1.5 && b == 42 && c == -2.25) ? 1 : 100;
+}
+
+static uint64_t THIS_FILTER_STUB_CALL Original(uintptr_t self, double a, uint64_t b, double c) {
+    g_sink = self;
+    return (a == 1.5 && b == 42 && c == -2.25) ? 2 : 200;
+}
+
+struct Stub {
+    uint8_t* memory;
+    HookedFunc entry;
+    ThisFilter filter;
+
+    Stub() {
+        memory = (uint8_t*)mmap(nullptr, ThisFilterStubSize, PROT_READ | PROT_WRITE | PROT_EXEC,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        entry = (HookedFunc)WriteThisFilterStub(memory, (void*)&OnHit, &filter);
+        GetThisFilterStubData((void*)entry)->onMiss = (void*)&Original;
+    }
+
+    ~Stub() {
+        munmap(memory, ThisFilterStubSize);
+    }
+
+    void Filter(const std::vector<uintptr_t>& addresses) {
+        filter.Set(addresses.data(), addresses.size());
+        GetThisFilterStubData((void*)entry)->passAll = 0;
+    }
+};
+
+static void VerifyStub() {
+    Stub stub;
+    std::vector<uintptr_t> addresses = MakeAddresses(1000, 9);
+
+    // Pass-all mode
+    CHECK(stub.entry(0x1230, 1.5, 42, -2.25) == 1);
+
+    stub.Filter(addresses);
+    CHECK(stub.entry(addresses[500], 1.5, 42, -2.25) == 1);
+    CHECK(g_sink == addresses[500]);
+    CHECK(stub.entry(addresses[500] + 8, 1.5, 42, -2.25) == 2);
+    CHECK(g_sink == addresses[500] + 8);
+
+    // No miss target yet, everything goes to the hook
+    GetThisFilterStubData((void*)stub.entry)->onMiss = nullptr;
+    CHECK(stub.entry(addresses[500] + 8, 1.5, 42, -2.25) == 1);
+
+    // Hooked again: back to pass-all with the new hook, until the new miss target is set and filtering resumes
+    RetargetThisFilterStub((void*)stub.entry, (void*)&Original);
+    CHECK(stub.entry(addresses[500] + 8, 1.5, 42, -2.25) == 2);
+    GetThisFilterStubData((void*)stub.entry)->onMiss = (void*)&OnHit;
+    stub.Filter(addresses);
+    CHECK(stub.entry(addresses[500], 1.5, 42, -2.25) == 2);
+    CHECK(stub.entry(addresses[500] + 8, 1.5, 42, -2.25) == 1);
+}
+
+static void BenchStub(size_t count) {
+    Stub stub;
+    std::vector<uintptr_t> addresses = MakeAddresses(count, 10);
+    stub.Filter(addresses);
+
+    const size_t iterations = 20000000;
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += Original(addresses[0] + 8, 1.5, 42, -2.25);
+    }
+    double directNs = NanosPerOp(std::chrono::steady_clock::now() - start, iterations);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += stub.entry(addresses[0] + 8, 1.5, 42, -2.25);
+    }
+    double missNs = NanosPerOp(std::chrono::steady_clock::now() - start, iterations);
+
+    printf("Stub, set of %7zu     | direct call %6.2f ns | filtered miss %6.2f ns | (%llu)\n", count, directNs, missNs,
+           (unsigned long long)sum);
+}
+
+#endif
+
+int main(int argc, char** argv) {
+    bool verifyOnly = argc > 1 && strcmp(argv[1], "--verify") == 0;
+
+    VerifySet();
+    VerifyConcurrentUpdates();
+#if THIS_FILTER_STUB_SUPPORTED
+    VerifyStub();
+#endif
+    if (g_failures != 0) {
+        fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    if (verifyOnly) {
+        printf("All checks passed\n");
+        return 0;
+    }
+
+    for (size_t count : {1, 16, 1000, 50000, 1000000}) {
+        BenchSet(count);
+    }
+#if THIS_FILTER_STUB_SUPPORTED
+    for (size_t count : {1, 50000}) {
+        BenchStub(count);
+    }
+#endif
+    return 0;
+}